@@ -45,6 +45,7 @@
 #include "asio/bind_allocator.hpp"
 #include "asio/bind_cancellation_slot.hpp"
 #include "asio/bind_executor.hpp"
+#include "asio/broadcast.hpp"
 #include "asio/buffer.hpp"
 #include "asio/buffer_registration.hpp"
 #include "asio/buffered_read_stream_fwd.hpp"
@@ -60,6 +61,7 @@
 #include "asio/co_spawn.hpp"
 #include "asio/completion_condition.hpp"
 #include "asio/compose.hpp"
+#include "asio/config.hpp"
 #include "asio/connect.hpp"
 #include "asio/connect_pipe.hpp"
 #include "asio/coroutine.hpp"
@@ -67,7 +69,10 @@
 #include "asio/defer.hpp"
 #include "asio/deferred.hpp"
 #include "asio/detached.hpp"
+#include "asio/dfa_matcher.hpp"
 #include "asio/dispatch.hpp"
+#include "asio/dynamic_chunk_buffer.hpp"
+#include "asio/dynamic_ring_buffer.hpp"
 #include "asio/error.hpp"
 #include "asio/error_code.hpp"
 #include "asio/execution.hpp"
@@ -88,6 +93,7 @@
 #include "asio/execution/operation_state.hpp"
 #include "asio/execution/outstanding_work.hpp"
 #include "asio/execution/prefer_only.hpp"
+#include "asio/execution/priority.hpp"
 #include "asio/execution/receiver.hpp"
 #include "asio/execution/receiver_invocation_error.hpp"
 #include "asio/execution/relationship.hpp"
@@ -125,6 +131,7 @@
 #include "asio/ip/network_v4.hpp"
 #include "asio/ip/network_v6.hpp"
 #include "asio/ip/bad_address_cast.hpp"
+#include "asio/ip/basic_dns_resolver.hpp"
 #include "asio/ip/basic_endpoint.hpp"
 #include "asio/ip/basic_resolver.hpp"
 #include "asio/ip/basic_resolver_entry.hpp"
@@ -149,7 +156,10 @@
 #include "asio/local/datagram_protocol.hpp"
 #include "asio/local/stream_protocol.hpp"
 #include "asio/multiple_exceptions.hpp"
+#include "asio/offload.hpp"
 #include "asio/packaged_task.hpp"
+#include "asio/parallel_for.hpp"
+#include "asio/parallel_reduce.hpp"
 #include "asio/placeholders.hpp"
 #include "asio/posix/basic_descriptor.hpp"
 #include "asio/posix/basic_stream_descriptor.hpp"
@@ -160,6 +170,7 @@
 #include "asio/prefer.hpp"
 #include "asio/prepend.hpp"
 #include "asio/query.hpp"
+#include "asio/race_connect.hpp"
 #include "asio/random_access_file.hpp"
 #include "asio/read.hpp"
 #include "asio/read_at.hpp"
@@ -168,10 +179,13 @@
 #include "asio/recycling_allocator.hpp"
 #include "asio/redirect_error.hpp"
 #include "asio/registered_buffer.hpp"
+#include "asio/relay.hpp"
 #include "asio/require.hpp"
 #include "asio/require_concept.hpp"
+#include "asio/run_threads.hpp"
 #include "asio/serial_port.hpp"
 #include "asio/serial_port_base.hpp"
+#include "asio/shared_const_buffer.hpp"
 #include "asio/signal_set.hpp"
 #include "asio/socket_base.hpp"
 #include "asio/static_thread_pool.hpp"
@@ -185,6 +199,7 @@
 #include "asio/system_timer.hpp"
 #include "asio/this_coro.hpp"
 #include "asio/thread.hpp"
+#include "asio/thread_affinity.hpp"
 #include "asio/thread_pool.hpp"
 #include "asio/time_traits.hpp"
 #include "asio/use_awaitable.hpp"
@@ -204,5 +219,6 @@
 #include "asio/writable_pipe.hpp"
 #include "asio/write.hpp"
 #include "asio/write_at.hpp"
+#include "asio/write_queue.hpp"
 
 #endif // ASIO_HPP
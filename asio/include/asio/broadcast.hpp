@@ -0,0 +1,207 @@
+//
+// broadcast.hpp
+// ~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_BROADCAST_HPP
+#define ASIO_BROADCAST_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if (defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)) \
+  || defined(GENERATING_DOCUMENTATION)
+
+#include <cstddef>
+#include "asio/async_result.hpp"
+#include "asio/detail/chrono.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/error.hpp"
+#include "asio/shared_const_buffer.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+class initiate_async_broadcast;
+
+} // namespace detail
+
+/**
+ * @defgroup async_broadcast asio::async_broadcast
+ *
+ * @brief The @c async_broadcast function is a composed asynchronous operation
+ * that writes the same data to each stream in a sequence.
+ */
+/*@{*/
+
+/// Start an asynchronous operation to write the same data to many streams,
+/// evicting the streams that are too slow.
+/**
+ * This function writes all of the data in @c message to each of the streams
+ * in the range [@c begin, @c end), using asio::async_write. The writes all
+ * share the same copy of the data. A write that has not completed by the
+ * time @c timeout expires is cancelled, so that a slow consumer cannot hold
+ * up the operation indefinitely.
+ *
+ * The destination handler is called as each write completes. It is invoked
+ * using the executor associated with the stream, and may be called
+ * concurrently for streams whose executors run on different threads. The
+ * operation completes once the destination handler has been called for every
+ * stream.
+ *
+ * It is an initiating function for an @ref asynchronous_operation, and always
+ * returns immediately.
+ *
+ * @param begin An iterator to the first stream. Dereferencing the iterator
+ * must yield either a reference to a stream that meets the AsyncWriteStream
+ * type requirements, or a pointer to such a stream. The streams must remain
+ * valid until the destination handler has been called for them, and must not
+ * have any other write operations outstanding.
+ *
+ * @param end An iterator to one past the last stream.
+ *
+ * @param message The data to be written. The streams share the data, which is
+ * not copied.
+ *
+ * @param timeout How long each write may take before it is cancelled. A write
+ * cancelled in this way is reported to the destination handler with the error
+ * asio::error::timed_out. Only part of the message may have been
+ * written to that stream, which should normally be closed.
+ *
+ * @param destination_handler A function object to be called as each write
+ * completes. Its signature must be:
+ * @code void destination_handler(
+ *   // Result of the write to this stream.
+ *   const asio::error_code& error,
+ *
+ *   // Number of bytes written to this stream.
+ *   std::size_t bytes_transferred,
+ *
+ *   // The stream that was written to.
+ *   ForwardIterator destination
+ * ); @endcode
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler, which will be called when all of the writes have
+ * completed. Potential completion tokens include @ref use_future, @ref
+ * use_awaitable, @ref yield_context, or a function object with the correct
+ * completion signature. The function signature of the completion handler must
+ * be:
+ * @code void handler(
+ *   // Result of operation. Set to asio::error::operation_aborted
+ *   // if the operation was cancelled.
+ *   const asio::error_code& error,
+ *
+ *   // The number of streams to which the whole message was written.
+ *   std::size_t delivered
+ * ); @endcode
+ * Regardless of whether the asynchronous operation completes immediately or
+ * not, the completion handler will not be invoked from within this function.
+ * On immediate completion, invocation of the handler will be performed in a
+ * manner equivalent to using asio::post().
+ *
+ * @par Completion Signature
+ * @code void(asio::error_code, std::size_t) @endcode
+ *
+ * @par Example
+ * @code std::vector<tcp::socket*> subscribers = ...;
+ * asio::shared_const_buffer message(asio::buffer(data));
+ * asio::async_broadcast(subscribers.begin(), subscribers.end(),
+ *     message, std::chrono::seconds(5),
+ *     [](asio::error_code ec, std::size_t,
+ *       std::vector<tcp::socket*>::iterator subscriber)
+ *     {
+ *       if (ec)
+ *         (*subscriber)->close();
+ *     },
+ *     [](asio::error_code ec, std::size_t delivered)
+ *     {
+ *       ...
+ *     }); @endcode
+ *
+ * @par Per-Operation Cancellation
+ * This asynchronous operation supports cancellation for the following
+ * asio::cancellation_type values:
+ *
+ * @li @c cancellation_type::terminal
+ *
+ * @li @c cancellation_type::partial
+ *
+ * @li @c cancellation_type::total
+ *
+ * Cancellation is forwarded to each write that has not yet completed.
+ */
+template <typename ForwardIterator, typename DestinationHandler,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      std::size_t)) BroadcastToken>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(BroadcastToken,
+    void (asio::error_code, std::size_t))
+async_broadcast(ForwardIterator begin, ForwardIterator end,
+    const shared_const_buffer& message,
+    const chrono::steady_clock::duration& timeout,
+    ASIO_MOVE_ARG(DestinationHandler) destination_handler,
+    ASIO_MOVE_ARG(BroadcastToken) token)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<BroadcastToken,
+      void (asio::error_code, std::size_t)>(
+        declval<detail::initiate_async_broadcast>(), token, begin, end,
+        message, timeout,
+        ASIO_MOVE_CAST(DestinationHandler)(destination_handler))));
+
+/// Start an asynchronous operation to write the same data to many streams.
+/**
+ * This function writes all of the data in @c message to each of the streams
+ * in the range [@c begin, @c end), without a timeout. See the overload that
+ * takes a @c timeout for details.
+ *
+ * @par Completion Signature
+ * @code void(asio::error_code, std::size_t) @endcode
+ *
+ * @par Per-Operation Cancellation
+ * This asynchronous operation supports cancellation for the following
+ * asio::cancellation_type values:
+ *
+ * @li @c cancellation_type::terminal
+ *
+ * @li @c cancellation_type::partial
+ *
+ * @li @c cancellation_type::total
+ */
+template <typename ForwardIterator, typename DestinationHandler,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      std::size_t)) BroadcastToken>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(BroadcastToken,
+    void (asio::error_code, std::size_t))
+async_broadcast(ForwardIterator begin, ForwardIterator end,
+    const shared_const_buffer& message,
+    ASIO_MOVE_ARG(DestinationHandler) destination_handler,
+    ASIO_MOVE_ARG(BroadcastToken) token)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<BroadcastToken,
+      void (asio::error_code, std::size_t)>(
+        declval<detail::initiate_async_broadcast>(), token, begin, end,
+        message, declval<chrono::steady_clock::duration>(),
+        ASIO_MOVE_CAST(DestinationHandler)(destination_handler))));
+
+/*@}*/
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/broadcast.hpp"
+
+#endif // (defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO))
+       //   || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_BROADCAST_HPP
@@ -0,0 +1,188 @@
+//
+// config.hpp
+// ~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_CONFIG_HPP
+#define ASIO_CONFIG_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <string>
+#include "asio/execution_context.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+/// Base class for configuration implementations.
+/**
+ * The config_service is consulted by the implementation's internal services
+ * to obtain runtime tuning parameters. The default implementation supplies no
+ * values, so that every parameter takes its built-in default.
+ *
+ * Configuration values are identified by a section name (such as @c
+ * "scheduler" or @c "io_uring") and a key name within that section.
+ */
+class config_service
+#if defined(GENERATING_DOCUMENTATION)
+  : public execution_context::service
+#else // defined(GENERATING_DOCUMENTATION)
+  : public detail::execution_context_service_base<config_service>
+#endif // defined(GENERATING_DOCUMENTATION)
+{
+public:
+#if defined(GENERATING_DOCUMENTATION)
+  typedef config_service key_type;
+#endif // defined(GENERATING_DOCUMENTATION)
+
+  /// Constructor.
+  ASIO_DECL explicit config_service(execution_context& ctx);
+
+  /// Implement execution_context::service::shutdown().
+  ASIO_DECL void shutdown();
+
+  /// Retrieve a configuration value.
+  /**
+   * @param section The name of the configuration section.
+   *
+   * @param key_name The name of the key within the section.
+   *
+   * @param value A buffer into which the value may be copied.
+   *
+   * @param value_len The length of the @c value buffer.
+   *
+   * @returns A pointer to a null-terminated value, or null if there is no
+   * value for the specified key. The returned pointer may refer to @c value
+   * or to storage owned by the service.
+   */
+  ASIO_DECL virtual const char* get_value(const char* section,
+      const char* key_name, char* value, std::size_t value_len) const;
+};
+
+/// Provides access to the configuration values associated with an execution
+/// context.
+class config
+{
+public:
+  /// Constructor.
+  /**
+   * Obtains the configuration service for the specified execution context,
+   * creating a default service if none is present.
+   */
+  explicit config(execution_context& context)
+    : service_(use_service<config_service>(context))
+  {
+  }
+
+  /// Copy constructor.
+  config(const config& other) ASIO_NOEXCEPT
+    : service_(other.service_)
+  {
+  }
+
+  /// Retrieve an integral or boolean configuration value.
+  /**
+   * @param section The name of the configuration section.
+   *
+   * @param key_name The name of the key within the section.
+   *
+   * @param default_value The value to return if the key is not present.
+   *
+   * @throws std::invalid_argument Thrown if the value is present but cannot
+   * be converted to @c T.
+   *
+   * @throws std::out_of_range Thrown if the value does not fit in @c T.
+   */
+  template <typename T>
+  T get(const char* section, const char* key_name, T default_value) const;
+
+private:
+  config_service& service_;
+};
+
+/// Configures an execution context based on a string.
+/**
+ * The string is a sequence of lines of the form:
+ * @code section.key = value @endcode
+ * Blank lines and lines starting with @c # are ignored. If a non-empty @c
+ * prefix is supplied, only keys of the form @c prefix.section.key are used.
+ *
+ * @par Example
+ * @code asio::io_context ctx(
+ *     asio::config_from_string(
+ *       "scheduler.concurrency_hint = 1\n"
+ *       "io_uring.ring_size = 4096\n")); @endcode
+ */
+class config_from_string : public execution_context::service_maker
+{
+public:
+  /// Construct with the configuration string to be used.
+  explicit config_from_string(std::string s)
+    : string_(ASIO_MOVE_CAST(std::string)(s))
+  {
+  }
+
+  /// Construct with the configuration string and prefix to be used.
+  config_from_string(std::string s, std::string prefix)
+    : string_(ASIO_MOVE_CAST(std::string)(s)),
+      prefix_(ASIO_MOVE_CAST(std::string)(prefix))
+  {
+  }
+
+  /// Add a concrete service to the specified execution context.
+  ASIO_DECL void make(execution_context& ctx) const;
+
+private:
+  std::string string_;
+  std::string prefix_;
+};
+
+/// Configures an execution context by reading environment variables.
+/**
+ * The environment variable for a given key is formed by joining the prefix,
+ * section and key with underscores, and converting the result to upper case.
+ * For example, with the default prefix @c "ASIO_CONFIG" the @c io_uring
+ * section's @c ring_size key is read from @c ASIO_CONFIG_IO_URING_RING_SIZE.
+ */
+class config_from_env : public execution_context::service_maker
+{
+public:
+  /// Construct with the default prefix @c "ASIO_CONFIG".
+  config_from_env()
+    : prefix_("ASIO_CONFIG")
+  {
+  }
+
+  /// Construct with the specified prefix.
+  explicit config_from_env(std::string prefix)
+    : prefix_(ASIO_MOVE_CAST(std::string)(prefix))
+  {
+  }
+
+  /// Add a concrete service to the specified execution context.
+  ASIO_DECL void make(execution_context& ctx) const;
+
+private:
+  std::string prefix_;
+};
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/config.hpp"
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/impl/config.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_CONFIG_HPP
@@ -0,0 +1,203 @@
+//
+// detail/adaptive_event.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_ADAPTIVE_EVENT_HPP
+#define ASIO_DETAIL_ADAPTIVE_EVENT_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/detail/conditionally_enabled_event.hpp"
+#include "asio/detail/conditionally_enabled_mutex.hpp"
+#include "asio/detail/noncopyable.hpp"
+
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+# include <atomic>
+# if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#  include <intrin.h>
+# endif // defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+# define ASIO_HAS_ADAPTIVE_EVENT_SPIN 1
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Event that spins for a while before blocking in wait(), and hands off
+// signals to spinning waiters without waking a blocked thread. The length of
+// the spin adapts to the observed gaps between a wait starting and a signal
+// arriving.
+class adaptive_event
+  : private noncopyable
+{
+public:
+  // Constructor. Spinning is disabled if max_spin is zero.
+  explicit adaptive_event(std::size_t max_spin = 0)
+    : max_spin_(max_spin),
+      spin_limit_(max_spin),
+      spinners_(0),
+      handoffs_(0)
+  {
+#if !defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+    max_spin_ = spin_limit_ = 0;
+#endif // !defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+  }
+
+  // Signal all waiters.
+  void signal_all(conditionally_enabled_mutex::scoped_lock& lock)
+  {
+    handoffs_ = spinners_;
+    event_.signal_all(lock);
+  }
+
+  // Unlock the mutex and signal one waiter.
+  void unlock_and_signal_one(
+      conditionally_enabled_mutex::scoped_lock& lock)
+  {
+    if (!maybe_handoff_and_unlock(lock))
+      event_.unlock_and_signal_one(lock);
+  }
+
+  // If there's a waiter, unlock the mutex and signal it.
+  bool maybe_unlock_and_signal_one(
+      conditionally_enabled_mutex::scoped_lock& lock)
+  {
+    if (maybe_handoff_and_unlock(lock))
+      return true;
+    return event_.maybe_unlock_and_signal_one(lock);
+  }
+
+  // Reset the event.
+  void clear(conditionally_enabled_mutex::scoped_lock& lock)
+  {
+    event_.clear(lock);
+  }
+
+  // Wait for the event to become signalled, spinning first if enabled.
+  void wait(conditionally_enabled_mutex::scoped_lock& lock)
+  {
+    if (spin_limit_ > 0 && lock.locked() && spin(lock))
+      return;
+    event_.wait(lock);
+  }
+
+  // Timed wait for the event to become signalled.
+  bool wait_for_usec(
+      conditionally_enabled_mutex::scoped_lock& lock, long usec)
+  {
+    return event_.wait_for_usec(lock, usec);
+  }
+
+private:
+  // Hand the signal to a spinning waiter that has not yet been signalled.
+  bool maybe_handoff_and_unlock(
+      conditionally_enabled_mutex::scoped_lock& lock)
+  {
+    if (spinners_ > handoffs_)
+    {
+      handoffs_ = handoffs_ + 1;
+      lock.unlock();
+      return true;
+    }
+    return false;
+  }
+
+  // Spin with the mutex unlocked until a signal is handed off or the spin
+  // limit is reached. Returns true if a signal was received.
+  bool spin(conditionally_enabled_mutex::scoped_lock& lock)
+  {
+#if defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+    std::size_t limit = spin_limit_;
+    ++spinners_;
+    lock.unlock();
+
+    std::size_t n = 0;
+    while (n < limit && handoffs_.load(std::memory_order_acquire) == 0)
+    {
+      pause();
+      ++n;
+    }
+
+    lock.lock();
+    --spinners_;
+    if (handoffs_ > 0)
+    {
+      // Aim to spin for about twice as long as it took for the signal to
+      // arrive.
+      handoffs_ = handoffs_ - 1;
+      std::size_t target = n * 2 < max_spin_ ? n * 2 : max_spin_;
+      spin_limit_ = (spin_limit_ * 7 + target) / 8;
+      if (spin_limit_ < min_spin())
+        spin_limit_ = min_spin();
+      return true;
+    }
+
+    // The signal did not arrive in time, so spin for less next time.
+    spin_limit_ -= spin_limit_ / 4;
+    if (spin_limit_ < min_spin())
+      spin_limit_ = min_spin();
+    return false;
+#else // defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+    (void)lock;
+    return false;
+#endif // defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+  }
+
+  // The limit below which spinning never adapts, so that shorter gaps can
+  // still be detected.
+  std::size_t min_spin() const
+  {
+    return max_spin_ / 64 > 0 ? max_spin_ / 64 : 1;
+  }
+
+#if defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+  // Hint to the processor that the thread is spinning.
+  static void pause()
+  {
+# if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+# elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+# elif defined(__GNUC__) && (defined(__aarch64__) || defined(__arm__))
+    __asm__ __volatile__ ("yield");
+# endif
+  }
+#endif // defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+
+  // The underlying event used for blocking waits.
+  conditionally_enabled_event event_;
+
+  // The maximum and current number of iterations to spin for. Protected by
+  // the mutex.
+  std::size_t max_spin_;
+  std::size_t spin_limit_;
+
+  // The number of threads spinning. Protected by the mutex.
+  std::size_t spinners_;
+
+  // The number of signals handed off to spinning threads. Only modified with
+  // the mutex locked, but read by spinning threads without it.
+#if defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+  std::atomic<std::size_t> handoffs_;
+#else // defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+  std::size_t handoffs_;
+#endif // defined(ASIO_HAS_ADAPTIVE_EVENT_SPIN)
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_ADAPTIVE_EVENT_HPP
@@ -32,6 +32,8 @@ namespace detail {
 typedef long atomic_count;
 inline void increment(atomic_count& a, long b) { a += b; }
 inline void decrement(atomic_count& a, long b) { a -= b; }
+inline void unsynchronised_increment(atomic_count& a, long b) { a += b; }
+inline void unsynchronised_decrement(atomic_count& a, long b) { a -= b; }
 inline void ref_count_up(atomic_count& a) { ++a; }
 inline bool ref_count_down(atomic_count& a) { return --a == 0; }
 #elif defined(ASIO_HAS_STD_ATOMIC)
@@ -39,6 +41,18 @@ typedef std::atomic<long> atomic_count;
 inline void increment(atomic_count& a, long b) { a += b; }
 inline void decrement(atomic_count& a, long b) { a -= b; }
 
+// Update a count that is only ever accessed by one thread at a time, without
+// the cost of an atomic read-modify-write.
+inline void unsynchronised_increment(atomic_count& a, long b)
+{
+  a.store(a.load(std::memory_order_relaxed) + b, std::memory_order_relaxed);
+}
+
+inline void unsynchronised_decrement(atomic_count& a, long b)
+{
+  a.store(a.load(std::memory_order_relaxed) - b, std::memory_order_relaxed);
+}
+
 inline void ref_count_up(atomic_count& a)
 {
   a.fetch_add(1, std::memory_order_relaxed);
@@ -57,6 +71,14 @@ inline bool ref_count_down(atomic_count& a)
 typedef boost::detail::atomic_count atomic_count;
 inline void increment(atomic_count& a, long b) { while (b > 0) ++a, --b; }
 inline void decrement(atomic_count& a, long b) { while (b > 0) --a, --b; }
+inline void unsynchronised_increment(atomic_count& a, long b)
+{
+  increment(a, b);
+}
+inline void unsynchronised_decrement(atomic_count& a, long b)
+{
+  decrement(a, b);
+}
 inline void ref_count_up(atomic_count& a) { ++a; }
 inline bool ref_count_down(atomic_count& a) { return --a == 0; }
 #endif // defined(ASIO_HAS_STD_ATOMIC)
@@ -0,0 +1,166 @@
+//
+// detail/blocking_offload_service.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_BLOCKING_OFFLOAD_SERVICE_HPP
+#define ASIO_DETAIL_BLOCKING_OFFLOAD_SERVICE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/execution_context.hpp"
+#include "asio/detail/cstdint.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/operation.hpp"
+#include "asio/detail/scoped_ptr.hpp"
+#include "asio/detail/thread_group.hpp"
+
+#if defined(ASIO_HAS_IOCP)
+# include "asio/detail/win_iocp_io_context.hpp"
+#else // defined(ASIO_HAS_IOCP)
+# include "asio/detail/scheduler.hpp"
+#endif // defined(ASIO_HAS_IOCP)
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Statistics describing the behaviour of a blocking_offload_service.
+struct blocking_offload_statistics
+{
+  blocking_offload_statistics()
+    : threads(0),
+      peak_threads(0),
+      queued(0),
+      peak_queued(0),
+      submitted(0),
+      completed(0),
+      rejected(0)
+  {
+  }
+
+  // The number of threads that have been started.
+  std::size_t threads;
+
+  // The largest number of threads, which is limited by the max_threads key.
+  std::size_t peak_threads;
+
+  // The number of operations waiting for a thread.
+  std::size_t queued;
+
+  // The largest number of operations that have waited for a thread.
+  std::size_t peak_queued;
+
+  // The number of operations that have been accepted.
+  uint64_t submitted;
+
+  // The number of operations whose blocking work has finished.
+  uint64_t completed;
+
+  // The number of operations that were rejected because the queue was full.
+  uint64_t rejected;
+};
+
+// A bounded pool of threads, shared by everything in an execution context that
+// needs to make blocking calls. Threads are started on demand, up to a limit
+// set in the configuration, and are kept until the service is shut down.
+class blocking_offload_service
+  : public execution_context_service_base<blocking_offload_service>
+{
+public:
+  // The scheduler implementation used to run the offloaded operations.
+#if defined(ASIO_HAS_IOCP)
+  typedef class win_iocp_io_context scheduler_impl;
+#else
+  typedef class scheduler scheduler_impl;
+#endif
+
+  // Constructor.
+  ASIO_DECL blocking_offload_service(execution_context& context);
+
+  // Destructor.
+  ASIO_DECL ~blocking_offload_service();
+
+  // Destroy all user-defined handler objects owned by the service.
+  ASIO_DECL void shutdown();
+
+  // Perform any fork-related housekeeping.
+  ASIO_DECL void notify_fork(execution_context::fork_event fork_ev);
+
+  // Determine whether operations may be started. The service's threads post
+  // completions to the context's scheduler, which is only safe if the
+  // scheduler uses locking.
+  bool is_supported() const
+  {
+    return supported_;
+  }
+
+  // Submit an operation to be run on one of the service's threads. The
+  // operation's completion function is called with the service's scheduler as
+  // its owner. Returns false, without taking ownership of the operation, if
+  // the queue is full.
+  ASIO_DECL bool start_op(operation* op);
+
+  // Obtain the service's statistics.
+  ASIO_DECL void get_statistics(blocking_offload_statistics& stats) const;
+
+private:
+  // Helper class to run the work scheduler in a thread.
+  class work_scheduler_runner;
+
+  // Run operations until the work scheduler is stopped.
+  ASIO_DECL void run_work_scheduler();
+
+  // Determine whether the context's scheduler, if any, uses locking.
+  ASIO_DECL static bool is_locking(execution_context& context);
+
+  // Whether operations may be started.
+  const bool supported_;
+
+  // Mutex to protect access to internal data.
+  mutable asio::detail::mutex mutex_;
+
+  // Private scheduler used to queue the operations.
+  asio::detail::scoped_ptr<scheduler_impl> work_scheduler_;
+
+  // Threads used for running the work scheduler's run loop.
+  asio::detail::thread_group threads_;
+
+  // The maximum number of threads.
+  std::size_t max_threads_;
+
+  // The maximum number of operations that may wait for a thread, or zero for
+  // no limit.
+  const std::size_t max_queued_;
+
+  // The number of threads that have been started.
+  std::size_t num_threads_;
+
+  // The number of operations that have been accepted but have not finished.
+  std::size_t outstanding_;
+
+  // The statistics, apart from the current numbers of threads and queued
+  // operations.
+  blocking_offload_statistics stats_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/detail/impl/blocking_offload_service.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_DETAIL_BLOCKING_OFFLOAD_SERVICE_HPP
@@ -0,0 +1,192 @@
+//
+// detail/buffer_search.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_BUFFER_SEARCH_HPP
+#define ASIO_DETAIL_BUFFER_SEARCH_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include "asio/buffer.hpp"
+
+#if !defined(ASIO_DISABLE_SSE2_BUFFER_SEARCH)
+# if defined(__SSE2__) || defined(_M_X64) \
+  || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  define ASIO_HAS_SSE2_BUFFER_SEARCH 1
+# endif // defined(__SSE2__) || defined(_M_X64) ...
+#endif // !defined(ASIO_DISABLE_SSE2_BUFFER_SEARCH)
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Find the first occurrence of a character in a contiguous range. Returns
+// last if there is no match. The C library's memchr is used, as it is
+// vectorised, and dispatched at runtime to the widest instructions that the
+// processor supports, on all of the main platforms.
+inline const char* find_char(const char* first, const char* last, char c)
+{
+  const void* p = std::memchr(first, static_cast<unsigned char>(c),
+      static_cast<std::size_t>(last - first));
+  return p ? static_cast<const char*>(p) : last;
+}
+
+// Find the first occurrence of a non-empty string that lies entirely within a
+// contiguous range. Returns last if there is no match. When SSE2 is available,
+// 16 candidate positions at a time are filtered by comparing both the first
+// and the last character of the string.
+ASIO_DECL const char* find_string(const char* first, const char* last,
+    const char* s, std::size_t length);
+
+// Find the first occurrence of a character in a sequence of buffers, starting
+// at the given offset. Returns the offset of the match, or the total size of
+// the buffers if there is no match.
+template <typename Iterator>
+std::size_t buffer_find(Iterator begin, Iterator end,
+    std::size_t start, char c)
+{
+  std::size_t offset = 0;
+  for (Iterator iter = begin; iter != end; ++iter)
+  {
+    const_buffer buffer(*iter);
+    const char* data = static_cast<const char*>(buffer.data());
+    std::size_t size = buffer.size();
+    if (offset + size > start)
+    {
+      const char* first = data + (start > offset ? start - offset : 0);
+      const char* p = find_char(first, data + size, c);
+      if (p != data + size)
+        return offset + (p - data);
+    }
+    offset += size;
+  }
+  return offset;
+}
+
+template <typename ConstBufferSequence>
+inline std::size_t buffer_find(const ConstBufferSequence& buffers,
+    std::size_t start, char c)
+{
+  return buffer_find(asio::buffer_sequence_begin(buffers),
+      asio::buffer_sequence_end(buffers), start, c);
+}
+
+// The result of comparing a string with the data that starts part of the way
+// through one buffer and may continue into the buffers that follow it.
+enum buffer_compare_result
+{
+  buffer_compare_mismatch,
+  buffer_compare_match,
+  buffer_compare_partial
+};
+
+template <typename Iterator>
+buffer_compare_result buffer_compare(Iterator iter, Iterator end,
+    const char* data, std::size_t size, const char* s, std::size_t length)
+{
+  std::size_t matched = 0;
+  for (;;)
+  {
+    std::size_t n = size < length - matched ? size : length - matched;
+    if (std::memcmp(data, s + matched, n) != 0)
+      return buffer_compare_mismatch;
+    matched += n;
+    if (matched == length)
+      return buffer_compare_match;
+
+    do
+    {
+      if (++iter == end)
+        return buffer_compare_partial;
+      const_buffer buffer(*iter);
+      data = static_cast<const char*>(buffer.data());
+      size = buffer.size();
+    } while (size == 0);
+  }
+}
+
+// Find the first occurrence of a string in a sequence of buffers, starting at
+// the given offset. Returns (offset,true) if a full match was found, in which
+// case the offset is that of the beginning of the match. Returns
+// (offset,false) if a partial match was found at the end of the data, in
+// which case the offset is that of the beginning of the partial match.
+// Returns (total size,false) if no full or partial match was found.
+template <typename Iterator>
+std::pair<std::size_t, bool> buffer_partial_search(Iterator begin,
+    Iterator end, std::size_t start, const char* s, std::size_t length)
+{
+  std::size_t offset = 0;
+  for (Iterator iter = begin; iter != end; ++iter)
+  {
+    const_buffer buffer(*iter);
+    const char* data = static_cast<const char*>(buffer.data());
+    std::size_t size = buffer.size();
+    if (offset + size > start)
+    {
+      std::size_t i = start > offset ? start - offset : 0;
+      if (length == 0)
+        return std::make_pair(offset + i, true);
+
+      // Look for a match that lies entirely within this buffer.
+      if (size - i >= length)
+      {
+        const char* p = find_string(data + i, data + size, s, length);
+        if (p != data + size)
+          return std::make_pair(offset + (p - data), true);
+        i = size - length + 1;
+      }
+
+      // Check the candidates that run past the end of this buffer.
+      for (; i < size; ++i)
+      {
+        if (data[i] == s[0])
+        {
+          switch (buffer_compare(iter, end, data + i, size - i, s, length))
+          {
+          case buffer_compare_match:
+            return std::make_pair(offset + i, true);
+          case buffer_compare_partial:
+            return std::make_pair(offset + i, false);
+          default:
+            break;
+          }
+        }
+      }
+    }
+    offset += size;
+  }
+  return std::make_pair(offset, false);
+}
+
+template <typename ConstBufferSequence>
+inline std::pair<std::size_t, bool> buffer_partial_search(
+    const ConstBufferSequence& buffers, std::size_t start,
+    const char* s, std::size_t length)
+{
+  return buffer_partial_search(asio::buffer_sequence_begin(buffers),
+      asio::buffer_sequence_end(buffers), start, s, length);
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/detail/impl/buffer_search.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_DETAIL_BUFFER_SEARCH_HPP
@@ -829,6 +829,35 @@ private:
 
 #endif // defined(ASIO_HAS_STD_ARRAY)
 
+// A buffer sequence that refers to a subrange of another sequence, so that
+// the buffers beyond the first max_buffers can be adapted without a copy.
+template <typename Iterator>
+class buffer_sequence_range
+{
+public:
+  typedef Iterator const_iterator;
+
+  buffer_sequence_range(Iterator begin, Iterator end)
+    : begin_(begin),
+      end_(end)
+  {
+  }
+
+  const_iterator begin() const
+  {
+    return begin_;
+  }
+
+  const_iterator end() const
+  {
+    return end_;
+  }
+
+private:
+  Iterator begin_;
+  Iterator end_;
+};
+
 } // namespace detail
 } // namespace asio
 
@@ -16,10 +16,12 @@
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
 #include "asio/detail/config.hpp"
-#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/atomic_count.hpp"
+#include "asio/detail/bulk_range.hpp"
 #include "asio/detail/fenced_block.hpp"
 #include "asio/detail/handler_alloc_helpers.hpp"
-#include "asio/detail/handler_invoke_helpers.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/noncopyable.hpp"
 #include "asio/detail/scheduler_operation.hpp"
 
 #include "asio/detail/push_options.hpp"
@@ -27,6 +29,89 @@
 namespace asio {
 namespace detail {
 
+// The state shared by the operations that together perform a bulk execution.
+// The function is invoked once for each index in the range, with the range
+// divided between the operations as they run. Each operation invokes its own
+// copy of the function.
+template <typename Handler, typename Alloc>
+class bulk_executor_state
+  : private noncopyable
+{
+public:
+  ASIO_DEFINE_HANDLER_ALLOCATOR_PTR(bulk_executor_state);
+
+  template <typename H>
+  bulk_executor_state(ASIO_MOVE_ARG(H) h, const Alloc& allocator,
+      std::size_t n, std::size_t workers)
+    : handler_(ASIO_MOVE_CAST(H)(h)),
+      allocator_(allocator),
+      range_(n, workers),
+      ref_count_(1)
+  {
+  }
+
+  // Add a reference to the state.
+  void add_ref()
+  {
+    ref_count_up(ref_count_);
+  }
+
+  // Remove a reference, destroying the state if it was the last one.
+  void release()
+  {
+    if (ref_count_down(ref_count_))
+    {
+      Alloc allocator(allocator_);
+      ptr p = { detail::addressof(allocator), this, this };
+    }
+  }
+
+  // Invoke the function for indices in the range until it is used up. If the
+  // function throws, the rest of the range is abandoned so that the other
+  // operations stop, and the exception propagates from this operation.
+  void run()
+  {
+    Handler handler(static_cast<const Handler&>(handler_));
+    std::size_t begin = 0, end = 0;
+#if !defined(ASIO_NO_EXCEPTIONS)
+    try
+    {
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+      while (range_.claim(begin, end))
+        for (; begin != end; ++begin)
+          handler(begin);
+#if !defined(ASIO_NO_EXCEPTIONS)
+    }
+    catch (...)
+    {
+      range_.cancel();
+      throw;
+    }
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+  }
+
+  // Helper class to release a reference on block exit.
+  struct releaser
+  {
+    bulk_executor_state* state_;
+
+    ~releaser()
+    {
+      if (state_)
+        state_->release();
+    }
+  };
+
+private:
+  Handler handler_;
+  Alloc allocator_;
+  bulk_range range_;
+  atomic_count ref_count_;
+};
+
+// An operation that runs the function for successive chunks of a bulk
+// execution's range. One operation is posted for each worker thread that is
+// to take part, rather than one for each index.
 template <typename Handler, typename Alloc,
     typename Operation = scheduler_operation>
 class bulk_executor_op : public Operation
@@ -34,34 +119,30 @@ class bulk_executor_op : public Operation
 public:
   ASIO_DEFINE_HANDLER_ALLOCATOR_PTR(bulk_executor_op);
 
-  template <typename H>
-  bulk_executor_op(ASIO_MOVE_ARG(H) h,
-      const Alloc& allocator, std::size_t i)
+  typedef bulk_executor_state<Handler, Alloc> state_type;
+
+  bulk_executor_op(state_type* state, const Alloc& allocator)
     : Operation(&bulk_executor_op::do_complete),
-      handler_(ASIO_MOVE_CAST(H)(h)),
-      allocator_(allocator),
-      index_(i)
+      state_(state),
+      allocator_(allocator)
   {
+    state_->add_ref();
   }
 
   static void do_complete(void* owner, Operation* base,
       const asio::error_code& /*ec*/,
       std::size_t /*bytes_transferred*/)
   {
-    // Take ownership of the handler object.
+    // Take ownership of the operation's reference to the shared state.
     bulk_executor_op* o(static_cast<bulk_executor_op*>(base));
     Alloc allocator(o->allocator_);
     ptr p = { detail::addressof(allocator), o, o };
 
     ASIO_HANDLER_COMPLETION((*o));
 
-    // Make a copy of the handler so that the memory can be deallocated before
-    // the upcall is made. Even if we're not about to make an upcall, a
-    // sub-object of the handler may be the true owner of the memory associated
-    // with the handler. Consequently, a local copy of the handler is required
-    // to ensure that any owning sub-object remains valid until after we have
-    // deallocated the memory here.
-    detail::binder1<Handler, std::size_t> handler(o->handler_, o->index_);
+    // The operation's memory can be deallocated before the upcall is made,
+    // as the function is owned by the shared state.
+    typename state_type::releaser state = { o->state_ };
     p.reset();
 
     // Make the upcall if required.
@@ -69,15 +150,14 @@ public:
     {
       fenced_block b(fenced_block::half);
       ASIO_HANDLER_INVOCATION_BEGIN(());
-      asio_handler_invoke_helpers::invoke(handler, handler.handler_);
+      state.state_->run();
       ASIO_HANDLER_INVOCATION_END;
     }
   }
 
 private:
-  Handler handler_;
+  state_type* state_;
   Alloc allocator_;
-  std::size_t index_;
 };
 
 } // namespace detail
@@ -0,0 +1,125 @@
+//
+// detail/bulk_range.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_BULK_RANGE_HPP
+#define ASIO_DETAIL_BULK_RANGE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/detail/noncopyable.hpp"
+
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+# include <atomic>
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+# include "asio/detail/mutex.hpp"
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A range of indices [0, size) that is divided between a number of workers.
+// Each worker repeatedly claims a chunk of the indices that remain, so that
+// workers that finish early take on more of the range. Chunks start large and
+// shrink as the range is used up, to balance the load near the end of the
+// range while keeping the number of claims small.
+class bulk_range
+  : private noncopyable
+{
+public:
+  // Constructor.
+  bulk_range(std::size_t size, std::size_t workers)
+    : size_(size),
+      divisor_(workers > 0 ? workers * 2 : 2),
+      next_(0)
+  {
+  }
+
+  // Get the number of indices in the range.
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  // Claim the next chunk of indices. Returns false if the range is used up.
+  bool claim(std::size_t& begin, std::size_t& end)
+  {
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    std::size_t next = next_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      if (next >= size_)
+        return false;
+      std::size_t n = chunk_size(size_ - next);
+      if (next_.compare_exchange_weak(next, next + n,
+            std::memory_order_relaxed))
+      {
+        begin = next;
+        end = next + n;
+        return true;
+      }
+    }
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    if (next_ >= size_)
+      return false;
+    begin = next_;
+    end = next_ = next_ + chunk_size(size_ - next_);
+    return true;
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+  // Mark the rest of the range as claimed, so that no further chunks are
+  // handed out.
+  void cancel()
+  {
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    next_.store(size_, std::memory_order_relaxed);
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    next_ = size_;
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+private:
+  // Determine the size of the next chunk, given the number of indices that
+  // remain.
+  std::size_t chunk_size(std::size_t remaining) const
+  {
+    std::size_t n = remaining / divisor_;
+    return n > 0 ? n : 1;
+  }
+
+  // The number of indices in the range.
+  const std::size_t size_;
+
+  // The fraction of the remaining indices taken by each claim.
+  const std::size_t divisor_;
+
+  // The first index that has not been claimed.
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  std::atomic<std::size_t> next_;
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  std::size_t next_;
+  mutex mutex_;
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_BULK_RANGE_HPP
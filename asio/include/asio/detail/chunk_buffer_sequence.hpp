@@ -0,0 +1,164 @@
+//
+// detail/chunk_buffer_sequence.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_CHUNK_BUFFER_SEQUENCE_HPP
+#define ASIO_DETAIL_CHUNK_BUFFER_SEQUENCE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <deque>
+#include <iterator>
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A range of bytes that starts part of the way through one fixed-size chunk
+// and continues through the chunks that follow it. Both the sequence and its
+// iterators compute each buffer on demand, so no memory is allocated to
+// represent the range however many chunks it spans.
+struct chunk_buffer_range
+{
+  std::deque<char*>::const_iterator chunks;
+  std::size_t offset;
+  std::size_t size;
+  std::size_t chunk_size;
+};
+
+template <typename Buffer>
+class chunk_buffer_iterator
+{
+public:
+  typedef std::ptrdiff_t difference_type;
+  typedef Buffer value_type;
+  typedef const Buffer* pointer;
+  typedef Buffer reference;
+  typedef std::bidirectional_iterator_tag iterator_category;
+
+  chunk_buffer_iterator()
+    : index_(0)
+  {
+    range_.offset = 0;
+    range_.size = 0;
+    range_.chunk_size = 0;
+  }
+
+  chunk_buffer_iterator(const chunk_buffer_range& range, std::size_t index)
+    : range_(range),
+      index_(index)
+  {
+  }
+
+  Buffer operator*() const
+  {
+    const std::size_t first_size = range_.chunk_size - range_.offset;
+    std::size_t begin = 0;
+    std::size_t offset = range_.offset;
+    if (index_ > 0)
+    {
+      begin = first_size + (index_ - 1) * range_.chunk_size;
+      offset = 0;
+    }
+    std::size_t length = range_.chunk_size - offset;
+    if (length > range_.size - begin)
+      length = range_.size - begin;
+    return Buffer(range_.chunks[index_] + offset, length);
+  }
+
+  chunk_buffer_iterator& operator++()
+  {
+    ++index_;
+    return *this;
+  }
+
+  chunk_buffer_iterator operator++(int)
+  {
+    chunk_buffer_iterator tmp(*this);
+    ++index_;
+    return tmp;
+  }
+
+  chunk_buffer_iterator& operator--()
+  {
+    --index_;
+    return *this;
+  }
+
+  chunk_buffer_iterator operator--(int)
+  {
+    chunk_buffer_iterator tmp(*this);
+    --index_;
+    return tmp;
+  }
+
+  friend bool operator==(const chunk_buffer_iterator& a,
+      const chunk_buffer_iterator& b)
+  {
+    return a.index_ == b.index_;
+  }
+
+  friend bool operator!=(const chunk_buffer_iterator& a,
+      const chunk_buffer_iterator& b)
+  {
+    return a.index_ != b.index_;
+  }
+
+private:
+  chunk_buffer_range range_;
+  std::size_t index_;
+};
+
+template <typename Buffer>
+class chunk_buffer_sequence
+{
+public:
+  typedef Buffer value_type;
+  typedef chunk_buffer_iterator<Buffer> const_iterator;
+
+  chunk_buffer_sequence()
+  {
+    range_.offset = 0;
+    range_.size = 0;
+    range_.chunk_size = 0;
+  }
+
+  explicit chunk_buffer_sequence(const chunk_buffer_range& range)
+    : range_(range)
+  {
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator(range_, 0);
+  }
+
+  const_iterator end() const
+  {
+    std::size_t count = range_.size == 0 ? 0
+      : (range_.offset + range_.size + range_.chunk_size - 1)
+        / range_.chunk_size;
+    return const_iterator(range_, count);
+  }
+
+private:
+  chunk_buffer_range range_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_CHUNK_BUFFER_SEQUENCE_HPP
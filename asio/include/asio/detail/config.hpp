@@ -655,6 +655,30 @@
 # define ASIO_DEFAULT_ALIGN 1
 #endif // defined(ASIO_HAS_ALIGNOF)
 
+// Support for aligning io_context objects to 16 bytes, so that an executor can
+// keep its priority in the low bits of its io_context pointer. This changes
+// the layout of io_context and its executors, so it must not depend on the
+// language standard. It is enabled only on 64-bit targets where operator new
+// always returns memory aligned to 16 bytes, and the alignment is given by a
+// compiler attribute rather than by alignas.
+#if !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+# if !defined(ASIO_DISABLE_ALIGNED_IO_CONTEXT)
+#  if defined(__GNUC__) || defined(ASIO_MSVC)
+#   if defined(__x86_64__) || defined(__aarch64__) \
+      || defined(_M_X64) || defined(_M_ARM64)
+#    define ASIO_HAS_ALIGNED_IO_CONTEXT 1
+#   endif // defined(__x86_64__) || ...
+#  endif // defined(__GNUC__) || defined(ASIO_MSVC)
+# endif // !defined(ASIO_DISABLE_ALIGNED_IO_CONTEXT)
+#endif // !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+#if defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+# if defined(ASIO_MSVC)
+#  define ASIO_ALIGNED_IO_CONTEXT __declspec(align(16))
+# else // defined(ASIO_MSVC)
+#  define ASIO_ALIGNED_IO_CONTEXT __attribute__((__aligned__(16)))
+# endif // defined(ASIO_MSVC)
+#endif // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+
 // Standard library support for aligned allocation.
 #if !defined(ASIO_HAS_STD_ALIGNED_ALLOC)
 # if !defined(ASIO_DISABLE_STD_ALIGNED_ALLOC)
@@ -1611,7 +1635,7 @@
 # include <unistd.h>
 #endif // defined(ASIO_HAS_UNISTD_H)
 
-// Linux: epoll, eventfd and timerfd.
+// Linux: epoll, eventfd, timerfd and splice.
 #if defined(__linux__)
 # include <linux/version.h>
 # if !defined(ASIO_HAS_EPOLL)
@@ -1635,6 +1659,13 @@
 #   endif // (__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 8)
 #  endif // defined(ASIO_HAS_EPOLL)
 # endif // !defined(ASIO_HAS_TIMERFD)
+# if !defined(ASIO_HAS_SPLICE)
+#  if !defined(ASIO_DISABLE_SPLICE)
+#   if (__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 5)
+#    define ASIO_HAS_SPLICE 1
+#   endif // (__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 5)
+#  endif // !defined(ASIO_DISABLE_SPLICE)
+# endif // !defined(ASIO_HAS_SPLICE)
 #endif // defined(__linux__)
 
 // Linux: io_uring is used instead of epoll.
@@ -1876,6 +1907,20 @@
 # endif // defined(ASIO_HAS_THREADS)
 #endif // !defined(ASIO_HAS_PTHREADS)
 
+// Support for binding threads to CPUs.
+#if !defined(ASIO_HAS_THREAD_AFFINITY)
+# if !defined(ASIO_DISABLE_THREAD_AFFINITY)
+#  if defined(ASIO_HAS_THREADS)
+#   if defined(__linux__) && defined(ASIO_HAS_PTHREADS)
+#    define ASIO_HAS_THREAD_AFFINITY 1
+#   elif defined(ASIO_WINDOWS) && !defined(ASIO_WINDOWS_APP) \
+      && !defined(UNDER_CE)
+#    define ASIO_HAS_THREAD_AFFINITY 1
+#   endif // defined(ASIO_WINDOWS) && !defined(ASIO_WINDOWS_APP) ...
+#  endif // defined(ASIO_HAS_THREADS)
+# endif // !defined(ASIO_DISABLE_THREAD_AFFINITY)
+#endif // !defined(ASIO_HAS_THREAD_AFFINITY)
+
 // Helper to prevent macro expansion.
 #define ASIO_PREVENT_MACRO_SUBSTITUTION
 
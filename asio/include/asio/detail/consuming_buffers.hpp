@@ -57,7 +57,9 @@ struct prepared_buffers
   typedef Buffer value_type;
   typedef const Buffer* const_iterator;
 
-  enum { max_buffers = MaxBuffers < 16 ? MaxBuffers : 16 };
+  // Allow as many buffers as an operation can pass to the system in one call.
+  enum { max_buffers = MaxBuffers < buffer_sequence_adapter_base::max_buffers
+    ? MaxBuffers : std::size_t(buffer_sequence_adapter_base::max_buffers) };
 
   prepared_buffers() : count(0) {}
   const_iterator begin() const { return elems; }
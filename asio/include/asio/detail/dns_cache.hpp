@@ -0,0 +1,136 @@
+//
+// detail/dns_cache.hpp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_DNS_CACHE_HPP
+#define ASIO_DETAIL_DNS_CACHE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CHRONO)
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "asio/detail/chrono.hpp"
+#include "asio/detail/cstdint.hpp"
+#include "asio/detail/dns_ops.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/error_code.hpp"
+#include "asio/execution_context.hpp"
+#include "asio/ip/address.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// The settings, hosts table and answer cache that are shared by all of an
+// execution context's DNS resolvers. Answers are kept for the time-to-live
+// given by the name server, and negative answers for the time given by the
+// zone's SOA record.
+class dns_cache
+  : private noncopyable
+{
+public:
+  // Constructor. The settings are read from the context's configuration.
+  ASIO_DECL explicit dns_cache(execution_context& context);
+
+  // Get the name servers and the timeouts to use when querying them.
+  const dns_ops::resolver_config& resolver_config() const
+  {
+    return resolver_config_;
+  }
+
+  // Try to resolve a host without sending any queries, using a numeric
+  // address, the hosts file or the cache. Returns true if the result is known.
+  // Otherwise, returns false and sets name to the canonical form of the host
+  // name, which must be looked up.
+  ASIO_DECL bool resolve_locally(const std::string& host,
+      bool want_v4, bool want_v6, std::string& name,
+      std::vector<asio::ip::address>& addresses, asio::error_code& ec);
+
+  // Add the addresses given for a name in the hosts file that match the query
+  // type. Returns true if any were found.
+  ASIO_DECL bool lookup_hosts(const std::string& name, int type,
+      std::vector<asio::ip::address>& addresses) const;
+
+  // Add the cached addresses for a name and query type. Returns true, and
+  // sets the response code, if an unexpired answer was found.
+  ASIO_DECL bool lookup(const std::string& name, int type, int& rcode,
+      std::vector<asio::ip::address>& addresses);
+
+  // Cache an answer for a name and query type. Answers with a time-to-live of
+  // zero are not stored.
+  ASIO_DECL void store(const std::string& name, int type, int rcode,
+      const std::vector<asio::ip::address>& addresses, uint32_t ttl);
+
+  // Generate an unpredictable identifier for a query message.
+  ASIO_DECL unsigned short next_query_id();
+
+private:
+  // Fill a buffer from the operating system's random number generator.
+  // Returns false if no such generator is available.
+  ASIO_DECL static bool fill_random(void* data, std::size_t size);
+
+  typedef chrono::steady_clock clock_type;
+
+  struct entry
+  {
+    int rcode;
+    std::vector<asio::ip::address> addresses;
+    clock_type::time_point expiry;
+  };
+
+  typedef std::map<std::pair<std::string, int>, entry> cache_type;
+
+  // Mutex to protect access to internal data.
+  mutable asio::detail::mutex mutex_;
+
+  // The name servers and timeouts.
+  dns_ops::resolver_config resolver_config_;
+
+  // The entries from the hosts file.
+  dns_ops::hosts_table hosts_;
+
+  // The maximum number of cached answers.
+  std::size_t max_entries_;
+
+  // The cached answers.
+  cache_type cache_;
+
+  // Identifiers taken from the operating system's generator, and the number
+  // of them that have been used.
+  enum { random_ids_size = 64 };
+  unsigned short random_ids_[random_ids_size];
+  std::size_t random_ids_used_;
+
+  // The state of the generator used if the operating system has none.
+  uint32_t random_state_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/detail/impl/dns_cache.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_CHRONO)
+
+#endif // ASIO_DETAIL_DNS_CACHE_HPP
@@ -0,0 +1,175 @@
+//
+// detail/dns_lookup.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_DNS_LOOKUP_HPP
+#define ASIO_DETAIL_DNS_LOOKUP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CHRONO)
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "asio/any_io_executor.hpp"
+#include "asio/detail/dns_cache.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/error_code.hpp"
+#include "asio/ip/address.hpp"
+#include "asio/ip/udp.hpp"
+#include "asio/steady_timer.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Queries the name servers for the addresses of a host, using a UDP socket
+// and a timer that run on the resolver's I/O executor. The A and AAAA queries
+// are sent together, and each name server is tried in turn until one gives
+// an answer or the configured number of attempts is used up. Answers are
+// stored in the cache.
+class dns_lookup
+  : private noncopyable
+{
+public:
+  // Constructor. The name must be in canonical form.
+  ASIO_DECL dns_lookup(const any_io_executor& ex,
+      dns_cache& cache, const std::string& name,
+      bool want_v4, bool want_v6);
+
+  // Destructor.
+  ASIO_DECL virtual ~dns_lookup();
+
+  // Send the first queries. The lookup is kept alive by the pending
+  // operations until it is complete.
+  ASIO_DECL static void start(const shared_ptr<dns_lookup>& self);
+
+  // Finish the lookup with asio::error::operation_aborted, unless it is
+  // already complete.
+  ASIO_DECL void cancel();
+
+protected:
+  // Called exactly once, without any lock held, when the lookup finishes.
+  virtual void complete(const asio::error_code& ec,
+      const std::vector<asio::ip::address>& addresses) = 0;
+
+private:
+  class receive_handler;
+  class timeout_handler;
+
+  // Open a socket to the current name server and send the unanswered queries.
+  ASIO_DECL void send_queries(const shared_ptr<dns_lookup>& self);
+
+  // Move on to the next name server, or finish if there are no attempts left.
+  ASIO_DECL void next_server(const shared_ptr<dns_lookup>& self);
+
+  // Start an asynchronous receive on the current socket.
+  ASIO_DECL void start_receive(const shared_ptr<dns_lookup>& self);
+
+  // Handle a received message.
+  ASIO_DECL void handle_receive(const shared_ptr<dns_lookup>& self,
+      std::size_t generation, const asio::error_code& ec,
+      std::size_t bytes_transferred);
+
+  // Handle the expiry of the timer for the current name server.
+  ASIO_DECL void handle_timeout(const shared_ptr<dns_lookup>& self,
+      std::size_t generation, const asio::error_code& ec);
+
+  // Process a response message.
+  ASIO_DECL void process_response(const shared_ptr<dns_lookup>& self,
+      std::size_t bytes_transferred);
+
+  // Mark the lookup as finished and cancel any pending operations.
+  ASIO_DECL void finish(const asio::error_code& ec);
+
+  // A query for one type of address.
+  struct question
+  {
+    int type;
+    unsigned short id;
+    bool answered;
+    std::vector<asio::ip::address> addresses;
+  };
+
+  // Mutex to protect access to internal data.
+  asio::detail::mutex mutex_;
+
+  // The cache, which also holds the resolver configuration.
+  dns_cache& cache_;
+
+  // The name being looked up.
+  std::string name_;
+
+  // The AAAA and A queries, in the order in which their answers are reported.
+  question questions_[2];
+  std::size_t num_questions_;
+
+  // The socket used to talk to the current name server.
+  asio::ip::udp::socket socket_;
+
+  // The timer for the current name server.
+  asio::steady_timer timer_;
+
+  // The buffer for received messages.
+  std::vector<unsigned char> buffer_;
+
+  // The index of the current name server, and the number of times the whole
+  // list has been tried.
+  std::size_t server_index_;
+  int attempt_;
+
+  // Incremented whenever the socket is reopened, so that handlers for the
+  // operations on a previous socket can be ignored.
+  std::size_t generation_;
+
+  // Whether the lookup has finished, and its result.
+  bool finished_;
+  asio::error_code ec_;
+  std::vector<asio::ip::address> addresses_;
+};
+
+// The lookups started by a resolver, so that they can be cancelled.
+class dns_lookup_set
+  : private noncopyable
+{
+public:
+  // Add a lookup to the set. Lookups that have finished are removed.
+  ASIO_DECL void add(const shared_ptr<dns_lookup>& lookup);
+
+  // Cancel all lookups in the set and clear it.
+  ASIO_DECL void cancel();
+
+private:
+  // Mutex to protect access to internal data.
+  asio::detail::mutex mutex_;
+
+  // The lookups, which are owned by their pending operations.
+  std::vector<weak_ptr<dns_lookup> > lookups_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/detail/impl/dns_lookup.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_CHRONO)
+
+#endif // ASIO_DETAIL_DNS_LOOKUP_HPP
@@ -0,0 +1,149 @@
+//
+// detail/dns_ops.hpp
+// ~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_DNS_OPS_HPP
+#define ASIO_DETAIL_DNS_OPS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "asio/detail/cstdint.hpp"
+#include "asio/error_code.hpp"
+#include "asio/ip/address.hpp"
+#include "asio/ip/udp.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+namespace dns_ops {
+
+// Resource record types and classes.
+enum
+{
+  type_a = 1,
+  type_ns = 2,
+  type_cname = 5,
+  type_soa = 6,
+  type_aaaa = 28,
+  class_in = 1
+};
+
+// Response codes.
+enum
+{
+  rcode_no_error = 0,
+  rcode_format_error = 1,
+  rcode_server_failure = 2,
+  rcode_name_error = 3,
+  rcode_not_implemented = 4,
+  rcode_refused = 5
+};
+
+// The information extracted from a response message.
+struct response
+{
+  // The message identifier.
+  unsigned short id;
+
+  // The response code.
+  int rcode;
+
+  // Whether the message was truncated.
+  bool truncated;
+
+  // The addresses of the requested type found in the answer section.
+  std::vector<asio::ip::address> addresses;
+
+  // The smallest time-to-live of the address records, in seconds.
+  uint32_t ttl;
+
+  // Whether the authority section holds an SOA record.
+  bool has_soa;
+
+  // The time for which a negative answer may be cached, in seconds. This is
+  // derived from the SOA record, as described in RFC 2308.
+  uint32_t negative_ttl;
+};
+
+// The resolver settings read from resolv.conf.
+struct resolver_config
+{
+  resolver_config()
+    : timeout_ms(5000),
+      attempts(2)
+  {
+  }
+
+  // The name servers, in the order they should be tried.
+  std::vector<asio::ip::udp::endpoint> nameservers;
+
+  // The time to wait for a name server to respond.
+  long timeout_ms;
+
+  // The number of times each name server is tried.
+  int attempts;
+};
+
+// The table of addresses read from a hosts file, keyed by the lower case name.
+typedef std::map<std::string, std::vector<asio::ip::address> > hosts_table;
+
+// Convert a host name to the canonical form used for queries and cache keys,
+// by folding to lower case and removing any trailing dot. Returns false if the
+// name is not a valid domain name.
+ASIO_DECL bool canonical_name(const std::string& host_name, std::string& out);
+
+// Build a query message for a name, which must be in canonical form.
+ASIO_DECL void encode_query(unsigned short id, const std::string& name,
+    int type, std::vector<unsigned char>& out);
+
+// Parse a response message to a query. Returns false if the message is
+// malformed or does not match the question.
+ASIO_DECL bool decode_response(const unsigned char* data, std::size_t size,
+    const std::string& name, int type, response& out);
+
+// Parse the contents of a resolv.conf file. Settings that are not present are
+// left unchanged.
+ASIO_DECL void parse_resolv_conf(const std::string& text,
+    resolver_config& config);
+
+// Parse a name server given as an address, optionally followed by a port. An
+// IPv6 address must be enclosed in brackets if a port is given.
+ASIO_DECL bool parse_nameserver(const std::string& text,
+    asio::ip::udp::endpoint& endpoint);
+
+// Parse the contents of a hosts file, adding its entries to the table.
+ASIO_DECL void parse_hosts(const std::string& text, hosts_table& table);
+
+// Obtain the port number for a service, which may be a name or a number. Only
+// the local services database is consulted.
+ASIO_DECL asio::error_code resolve_service(const std::string& service,
+    int socket_type, unsigned short& port, asio::error_code& ec);
+
+// Read the contents of a file. Returns false if the file cannot be opened.
+ASIO_DECL bool read_file(const char* path, std::string& out);
+
+} // namespace dns_ops
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/detail/impl/dns_ops.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_DETAIL_DNS_OPS_HPP
@@ -0,0 +1,108 @@
+//
+// detail/dns_resolve_op.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_DNS_RESOLVE_OP_HPP
+#define ASIO_DETAIL_DNS_RESOLVE_OP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CHRONO)
+
+#include <string>
+#include <vector>
+#include "asio/associated_executor.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/dns_lookup.hpp"
+#include "asio/execution/outstanding_work.hpp"
+#include "asio/ip/basic_resolver_results.hpp"
+#include "asio/post.hpp"
+#include "asio/prefer.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Deliver the result of a resolve operation to its handler.
+template <typename Executor, typename Handler, typename Results>
+void post_dns_resolve_result(const Executor& ex, Handler& handler,
+    const asio::error_code& ec, const Results& results)
+{
+#if defined(ASIO_HAS_MOVE)
+  asio::post(ex, detail::move_binder2<Handler, asio::error_code, Results>(
+        0, ASIO_MOVE_CAST(Handler)(handler), ec, Results(results)));
+#else // defined(ASIO_HAS_MOVE)
+  asio::post(ex, detail::bind_handler(handler, ec, results));
+#endif // defined(ASIO_HAS_MOVE)
+}
+
+template <typename Protocol, typename Handler, typename IoExecutor>
+class dns_resolve_op : public dns_lookup
+{
+public:
+  typedef asio::ip::basic_resolver_results<Protocol> results_type;
+
+  dns_resolve_op(const IoExecutor& io_ex, dns_cache& cache,
+      const std::string& name, bool want_v4, bool want_v6,
+      Handler& handler, const std::string& host_name,
+      const std::string& service_name, unsigned short port)
+    : dns_lookup(io_ex, cache, name, want_v4, want_v6),
+      handler_(ASIO_MOVE_CAST(Handler)(handler)),
+      executor_(asio::prefer(
+            (get_associated_executor)(handler_, io_ex),
+            execution::outstanding_work.tracked)),
+      host_name_(host_name),
+      service_name_(service_name),
+      port_(port)
+  {
+  }
+
+protected:
+  void complete(const asio::error_code& ec,
+      const std::vector<asio::ip::address>& addresses)
+  {
+    std::vector<typename Protocol::endpoint> endpoints;
+    endpoints.reserve(addresses.size());
+    for (std::size_t i = 0; i < addresses.size(); ++i)
+      endpoints.push_back(typename Protocol::endpoint(addresses[i], port_));
+
+    post_dns_resolve_result(executor_, handler_, ec,
+        results_type::create(endpoints.begin(), endpoints.end(),
+          host_name_, service_name_));
+  }
+
+private:
+  typedef typename associated_executor<Handler, IoExecutor>::type handler_ex_t;
+
+  typedef typename decay<
+      typename prefer_result<const handler_ex_t&,
+        execution::outstanding_work_t::tracked_t
+      >::type
+    >::type work_executor_type;
+
+  Handler handler_;
+  work_executor_type executor_;
+  std::string host_name_;
+  std::string service_name_;
+  unsigned short port_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_CHRONO)
+
+#endif // ASIO_DETAIL_DNS_RESOLVE_OP_HPP
@@ -0,0 +1,91 @@
+//
+// detail/dns_resolver_service.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_DNS_RESOLVER_SERVICE_HPP
+#define ASIO_DETAIL_DNS_RESOLVER_SERVICE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CHRONO)
+
+#include "asio/detail/dns_cache.hpp"
+#include "asio/detail/dns_lookup.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/execution_context.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// The service for DNS resolvers, which owns the cache that they share.
+class dns_resolver_service
+  : public execution_context_service_base<dns_resolver_service>
+{
+public:
+  // The implementation type of the resolver. It records the resolver's
+  // lookups so that they can be cancelled.
+  typedef shared_ptr<dns_lookup_set> implementation_type;
+
+  // Constructor.
+  ASIO_DECL dns_resolver_service(execution_context& context);
+
+  // Destroy all user-defined handler objects owned by the service.
+  ASIO_DECL void shutdown();
+
+  // Construct a new resolver implementation.
+  ASIO_DECL void construct(implementation_type& impl);
+
+  // Destroy a resolver implementation, cancelling its lookups.
+  ASIO_DECL void destroy(implementation_type& impl);
+
+  // Move-construct a new resolver implementation.
+  ASIO_DECL void move_construct(implementation_type& impl,
+      implementation_type& other_impl);
+
+  // Move-assign from another resolver implementation.
+  ASIO_DECL void move_assign(implementation_type& impl,
+      dns_resolver_service& other_service,
+      implementation_type& other_impl);
+
+  // Cancel the resolver's pending lookups.
+  ASIO_DECL void cancel(implementation_type& impl);
+
+  // Record a lookup against the resolver and send its first queries.
+  ASIO_DECL void start_lookup(implementation_type& impl,
+      const shared_ptr<dns_lookup>& lookup);
+
+  // Get the cache shared by the context's resolvers.
+  dns_cache& cache()
+  {
+    return cache_;
+  }
+
+private:
+  // The settings, hosts table and answer cache.
+  dns_cache cache_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/detail/impl/dns_resolver_service.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_CHRONO)
+
+#endif // ASIO_DETAIL_DNS_RESOLVER_SERVICE_HPP
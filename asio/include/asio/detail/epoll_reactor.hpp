@@ -21,6 +21,7 @@
 
 #include "asio/detail/atomic_count.hpp"
 #include "asio/detail/conditionally_enabled_mutex.hpp"
+#include "asio/detail/interrupt_coalescer.hpp"
 #include "asio/detail/limits.hpp"
 #include "asio/detail/object_pool.hpp"
 #include "asio/detail/op_queue.hpp"
@@ -50,6 +51,9 @@ private:
   // The mutex type used by this reactor.
   typedef conditionally_enabled_mutex mutex;
 
+  // Per-shard state for secondary epoll instances.
+  struct shard;
+
 public:
   enum op_types { read_op = 0, write_op = 1,
     connect_op = 1, except_op = 2, max_ops = 3 };
@@ -70,6 +74,9 @@ public:
     op_queue<reactor_op> op_queue_[max_ops];
     bool try_speculative_[max_ops];
     bool shutdown_;
+    shard* shard_;
+    uint32_t pending_events_;
+    bool queued_;
 
     ASIO_DECL descriptor_state(bool locking);
     void set_ready_events(uint32_t events) { task_result_ = events; }
@@ -194,6 +201,28 @@ public:
   // Interrupt the select loop.
   ASIO_DECL void interrupt();
 
+  // Get the number of interrupts sent and suppressed.
+  bool get_interrupt_counts(uint64_t& sent, uint64_t& suppressed) const
+  {
+    sent = interrupt_coalescer_.sent();
+    suppressed = interrupt_coalescer_.suppressed();
+    return true;
+  }
+
+  // Get the number of secondary epoll instances.
+  std::size_t shard_count() const
+  {
+    return shard_count_;
+  }
+
+  // Run a secondary epoll instance once until interrupted or events are ready
+  // to be dispatched.
+  ASIO_DECL void run_shard(std::size_t index,
+      long usec, op_queue<operation>& ops);
+
+  // Interrupt a thread waiting on a secondary epoll instance.
+  ASIO_DECL void interrupt_shard(std::size_t index);
+
 private:
   // The hint to pass to epoll_create to size its data structures.
   enum { epoll_size = 20000 };
@@ -202,9 +231,57 @@ private:
   // cannot be created.
   ASIO_DECL static int do_epoll_create();
 
+  // Create an epoll file descriptor. Does not throw.
+  ASIO_DECL static int do_epoll_create(asio::error_code& ec);
+
   // Create the timerfd file descriptor. Does not throw.
   ASIO_DECL static int do_timerfd_create();
 
+  // Get the number of secondary epoll instances to be created.
+  ASIO_DECL static std::size_t get_shard_count(
+      asio::execution_context& ctx, int concurrency_hint);
+
+  // Add the interrupter to a secondary epoll instance, and add the instance
+  // to the primary epoll set.
+  ASIO_DECL void register_shard(shard& s);
+
+  // Choose the shard with which a new descriptor will be registered. Returns
+  // null for the primary epoll instance.
+  ASIO_DECL shard* choose_shard(socket_type descriptor);
+
+  // Find the shard corresponding to an event's user data, if any.
+  shard* find_shard(void* ptr)
+  {
+    for (std::size_t i = 0; i < shard_count_; ++i)
+      if (ptr == &shards_[i])
+        return &shards_[i];
+    return 0;
+  }
+
+  // Get the epoll file descriptor with which a descriptor is registered.
+  int epoll_fd_for(descriptor_state* descriptor_data) const
+  {
+    return descriptor_data->shard_
+      ? descriptor_data->shard_->epoll_fd_ : epoll_fd_;
+  }
+
+  // Arm or disarm a shard's registration with the primary epoll instance.
+  ASIO_DECL void arm_shard(shard& s, bool armed);
+
+  // Arm the registrations of all shards on which no thread is waiting.
+  ASIO_DECL void arm_idle_shards();
+
+  // Collect the ready events of a shard on which no thread is waiting.
+  ASIO_DECL void poll_idle_shard(shard& s, op_queue<operation>& ops);
+
+  // Wait on a shard's epoll file descriptor and queue the ready descriptors.
+  // Returns true if the interrupter was signalled.
+  ASIO_DECL bool wait_shard(shard& s, int msec, op_queue<operation>& ops);
+
+  // Queue a ready descriptor when the reactor is sharded.
+  ASIO_DECL static void queue_descriptor(descriptor_state* descriptor_data,
+      uint32_t events, op_queue<operation>& ops);
+
   // Allocate a new descriptor state object.
   ASIO_DECL descriptor_state* allocate_descriptor_state();
 
@@ -240,6 +317,9 @@ private:
   // The interrupter is used to break a blocking epoll_wait call.
   select_interrupter interrupter_;
 
+  // Suppresses interrupts while an earlier one has not yet been observed.
+  interrupt_coalescer interrupt_coalescer_;
+
   // The epoll file descriptor.
   int epoll_fd_;
 
@@ -258,6 +338,38 @@ private:
   // Keep track of all registered descriptors.
   object_pool<descriptor_state> registered_descriptors_;
 
+  struct shard
+  {
+    // The epoll file descriptor.
+    int epoll_fd_;
+
+    // Whether the shard's registration with the primary epoll set is armed.
+    bool armed_;
+
+    // Whether a thread is waiting on the shard's epoll file descriptor.
+    bool waiting_;
+
+    // Whether an interrupt is pending for the shard.
+    bool interrupted_;
+  };
+
+  // The number of secondary epoll instances.
+  std::size_t shard_count_;
+
+  // Whether ready descriptors are queued using their queued flag, because a
+  // descriptor may become ready again while it is still queued.
+  bool queue_descriptors_;
+
+  // Whether new descriptors are registered with the shard owned by the
+  // registering thread, rather than a shard chosen by descriptor number.
+  bool shard_by_thread_;
+
+  // The secondary epoll instances.
+  shard* shards_;
+
+  // Mutex to protect access to the shards' state.
+  mutex shards_mutex_;
+
   // Helper class to do post-perform_io cleanup.
   struct perform_io_cleanup_on_block_exit;
   friend struct perform_io_cleanup_on_block_exit;
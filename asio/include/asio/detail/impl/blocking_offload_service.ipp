@@ -0,0 +1,173 @@
+//
+// detail/impl/blocking_offload_service.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_BLOCKING_OFFLOAD_SERVICE_IPP
+#define ASIO_DETAIL_IMPL_BLOCKING_OFFLOAD_SERVICE_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <exception>
+#include "asio/config.hpp"
+#include "asio/detail/blocking_offload_service.hpp"
+#include "asio/detail/concurrency_hint.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+class blocking_offload_service::work_scheduler_runner
+{
+public:
+  work_scheduler_runner(blocking_offload_service& service)
+    : service_(service)
+  {
+  }
+
+  void operator()()
+  {
+#if !defined(ASIO_NO_EXCEPTIONS)
+    try
+    {
+#endif// !defined(ASIO_NO_EXCEPTIONS)
+      service_.run_work_scheduler();
+#if !defined(ASIO_NO_EXCEPTIONS)
+    }
+    catch (...)
+    {
+      std::terminate();
+    }
+#endif// !defined(ASIO_NO_EXCEPTIONS)
+  }
+
+private:
+  blocking_offload_service& service_;
+};
+
+blocking_offload_service::blocking_offload_service(execution_context& context)
+  : execution_context_service_base<blocking_offload_service>(context),
+    supported_(is_locking(context)),
+    work_scheduler_(new scheduler_impl(context, -1, false)),
+    max_threads_(config(context).get("offload", "max_threads", 4u)),
+    max_queued_(config(context).get("offload", "max_queued", 0u)),
+    num_threads_(0),
+    outstanding_(0)
+{
+  if (max_threads_ == 0)
+    max_threads_ = 1;
+  work_scheduler_->work_started();
+}
+
+blocking_offload_service::~blocking_offload_service()
+{
+  shutdown();
+}
+
+void blocking_offload_service::shutdown()
+{
+  if (work_scheduler_.get())
+  {
+    work_scheduler_->work_finished();
+    work_scheduler_->stop();
+    threads_.join();
+    work_scheduler_.reset();
+  }
+}
+
+void blocking_offload_service::notify_fork(
+    execution_context::fork_event fork_ev)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  if (num_threads_ > 0)
+  {
+    if (fork_ev == execution_context::fork_prepare)
+    {
+      work_scheduler_->stop();
+      threads_.join();
+      num_threads_ = 0;
+    }
+  }
+  else if (fork_ev != execution_context::fork_prepare)
+  {
+    work_scheduler_->restart();
+  }
+}
+
+bool blocking_offload_service::start_op(operation* op)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+
+  // Start another thread if all of the existing threads are busy.
+  std::size_t threads = num_threads_;
+  if (outstanding_ >= threads && threads < max_threads_)
+    ++threads;
+
+  std::size_t queued = outstanding_ + 1 > threads
+    ? outstanding_ + 1 - threads : 0;
+  if (max_queued_ != 0 && queued > max_queued_)
+  {
+    ++stats_.rejected;
+    return false;
+  }
+
+  if (threads > num_threads_)
+  {
+    threads_.create_thread(work_scheduler_runner(*this));
+    num_threads_ = threads;
+    if (num_threads_ > stats_.peak_threads)
+      stats_.peak_threads = num_threads_;
+  }
+
+  ++outstanding_;
+  ++stats_.submitted;
+  if (queued > stats_.peak_queued)
+    stats_.peak_queued = queued;
+
+  work_scheduler_->post_immediate_completion(op, false);
+  return true;
+}
+
+void blocking_offload_service::get_statistics(
+    blocking_offload_statistics& stats) const
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  stats = stats_;
+  stats.threads = num_threads_;
+  stats.queued = outstanding_ > num_threads_ ? outstanding_ - num_threads_ : 0;
+}
+
+bool blocking_offload_service::is_locking(execution_context& context)
+{
+  if (!has_service<scheduler_impl>(context))
+    return true;
+  return ASIO_CONCURRENCY_HINT_IS_LOCKING(SCHEDULER,
+      use_service<scheduler_impl>(context).concurrency_hint());
+}
+
+void blocking_offload_service::run_work_scheduler()
+{
+  asio::error_code ec;
+  while (work_scheduler_->run_one(ec))
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    --outstanding_;
+    ++stats_.completed;
+  }
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_IMPL_BLOCKING_OFFLOAD_SERVICE_IPP
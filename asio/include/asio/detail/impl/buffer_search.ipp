@@ -0,0 +1,100 @@
+//
+// detail/impl/buffer_search.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_BUFFER_SEARCH_IPP
+#define ASIO_DETAIL_IMPL_BUFFER_SEARCH_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/detail/buffer_search.hpp"
+
+#if defined(ASIO_HAS_SSE2_BUFFER_SEARCH)
+# include <emmintrin.h>
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# endif // defined(_MSC_VER)
+#endif // defined(ASIO_HAS_SSE2_BUFFER_SEARCH)
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+#if defined(ASIO_HAS_SSE2_BUFFER_SEARCH)
+
+// Returns the index of the lowest set bit in a non-zero mask.
+inline unsigned int lowest_bit_index(unsigned int mask)
+{
+# if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned int>(index);
+# else // defined(_MSC_VER)
+  return static_cast<unsigned int>(__builtin_ctz(mask));
+# endif // defined(_MSC_VER)
+}
+
+#endif // defined(ASIO_HAS_SSE2_BUFFER_SEARCH)
+
+const char* find_string(const char* first, const char* last,
+    const char* s, std::size_t length)
+{
+  if (length == 1)
+    return find_char(first, last, s[0]);
+
+  const char* p = first;
+
+#if defined(ASIO_HAS_SSE2_BUFFER_SEARCH)
+  // Each block examines the 16 candidate positions starting at p, so the
+  // loads of the last character reach up to p + length + 14.
+  const __m128i head = _mm_set1_epi8(s[0]);
+  const __m128i tail = _mm_set1_epi8(s[length - 1]);
+  for (; static_cast<std::size_t>(last - p) >= length + 15; p += 16)
+  {
+    const __m128i block_head = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(p));
+    const __m128i block_tail = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(p + length - 1));
+    unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+          _mm_and_si128(_mm_cmpeq_epi8(block_head, head),
+            _mm_cmpeq_epi8(block_tail, tail))));
+    while (mask != 0)
+    {
+      const char* candidate = p + lowest_bit_index(mask);
+      if (std::memcmp(candidate + 1, s + 1, length - 2) == 0)
+        return candidate;
+      mask &= mask - 1;
+    }
+  }
+#endif // defined(ASIO_HAS_SSE2_BUFFER_SEARCH)
+
+  // Use memchr to skip to each occurrence of the first character.
+  for (;;)
+  {
+    if (static_cast<std::size_t>(last - p) < length)
+      return last;
+    p = find_char(p, last - length + 1, s[0]);
+    if (p == last - length + 1)
+      return last;
+    if (std::memcmp(p + 1, s + 1, length - 1) == 0)
+      return p;
+    ++p;
+  }
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_IMPL_BUFFER_SEARCH_IPP
@@ -0,0 +1,317 @@
+//
+// detail/impl/dns_cache.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_DNS_CACHE_IPP
+#define ASIO_DETAIL_IMPL_DNS_CACHE_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CHRONO)
+
+#include <cstdio>
+#include "asio/config.hpp"
+#include "asio/detail/dns_cache.hpp"
+#include "asio/error.hpp"
+
+#if defined(__linux__) && defined(__GLIBC__) \
+  && ((__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))
+# include <cerrno>
+# include <sys/random.h>
+# define ASIO_DNS_CACHE_USE_GETRANDOM 1
+#elif (defined(__MACH__) && defined(__APPLE__)) \
+  || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+# include <stdlib.h>
+# define ASIO_DNS_CACHE_USE_ARC4RANDOM 1
+#endif // (defined(__MACH__) && defined(__APPLE__))
+       //   || defined(__FreeBSD__) || defined(__NetBSD__)
+       //   || defined(__OpenBSD__)
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+dns_cache::dns_cache(execution_context& context)
+  : max_entries_(config(context).get("dns", "cache_size", 1024u)),
+    random_ids_used_(random_ids_size),
+    random_state_(0)
+{
+  const config_service& settings = use_service<config_service>(context);
+  char value[1024];
+  std::string text;
+
+  // Name servers given in the configuration replace those in resolv.conf.
+  const char* path = settings.get_value("dns",
+      "resolv_conf", value, sizeof(value));
+  if (dns_ops::read_file(path ? path : "/etc/resolv.conf", text))
+    dns_ops::parse_resolv_conf(text, resolver_config_);
+  if (const char* nameservers = settings.get_value("dns",
+        "nameservers", value, sizeof(value)))
+  {
+    resolver_config_.nameservers.clear();
+    std::string list(nameservers);
+    std::string::size_type pos = 0;
+    while (pos < list.size())
+    {
+      std::string::size_type end = list.find_first_of(", \t", pos);
+      if (end == std::string::npos)
+        end = list.size();
+      asio::ip::udp::endpoint endpoint;
+      if (end > pos && dns_ops::parse_nameserver(
+            list.substr(pos, end - pos), endpoint))
+        resolver_config_.nameservers.push_back(endpoint);
+      pos = end + 1;
+    }
+  }
+
+  // As for the system resolver, use the local host if no name server is given.
+  if (resolver_config_.nameservers.empty())
+  {
+    resolver_config_.nameservers.push_back(
+        asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 53));
+  }
+
+  resolver_config_.timeout_ms = config(context).get(
+      "dns", "timeout_ms", resolver_config_.timeout_ms);
+  if (resolver_config_.timeout_ms <= 0)
+    resolver_config_.timeout_ms = 1;
+  resolver_config_.attempts = config(context).get(
+      "dns", "attempts", resolver_config_.attempts);
+  if (resolver_config_.attempts <= 0)
+    resolver_config_.attempts = 1;
+
+  path = settings.get_value("dns", "hosts", value, sizeof(value));
+  if (dns_ops::read_file(path ? path : "/etc/hosts", text))
+    dns_ops::parse_hosts(text, hosts_);
+
+  // Seed the fallback generator from the clock and the service's address, so
+  // that its identifiers at least differ between contexts and between runs.
+  random_state_ = static_cast<uint32_t>(
+      clock_type::now().time_since_epoch().count());
+  random_state_ ^= static_cast<uint32_t>(
+      reinterpret_cast<std::size_t>(this) >> 4);
+  if (random_state_ == 0)
+    random_state_ = 0x9E3779B9;
+}
+
+bool dns_cache::resolve_locally(const std::string& host,
+    bool want_v4, bool want_v6, std::string& name,
+    std::vector<asio::ip::address>& addresses, asio::error_code& ec)
+{
+  addresses.clear();
+
+  asio::ip::address address = asio::ip::make_address(host, ec);
+  if (!ec)
+  {
+    if (address.is_v6() ? want_v6 : want_v4)
+      addresses.push_back(address);
+    else
+      ec = asio::error::host_not_found;
+    return true;
+  }
+
+  if (!dns_ops::canonical_name(host, name))
+  {
+    ec = asio::error::host_not_found;
+    return true;
+  }
+
+  ec = asio::error_code();
+  int types[2] = { 0, 0 };
+  std::size_t num_types = 0;
+  if (want_v6)
+    types[num_types++] = dns_ops::type_aaaa;
+  if (want_v4)
+    types[num_types++] = dns_ops::type_a;
+
+  // Names in the hosts file are not looked up using DNS.
+  bool found = false;
+  for (std::size_t i = 0; i < num_types; ++i)
+    found = lookup_hosts(name, types[i], addresses) || found;
+  if (found)
+    return true;
+
+  // A cached answer is only used if there is one for every type of address.
+  bool name_error = false;
+  for (std::size_t i = 0; i < num_types; ++i)
+  {
+    int rcode = dns_ops::rcode_no_error;
+    if (!lookup(name, types[i], rcode, addresses))
+    {
+      addresses.clear();
+      return false;
+    }
+    name_error = name_error || rcode == dns_ops::rcode_name_error;
+  }
+
+  if (name_error)
+  {
+    addresses.clear();
+    ec = asio::error::host_not_found;
+  }
+  else if (addresses.empty())
+  {
+    ec = asio::error::no_data;
+  }
+
+  return true;
+}
+
+bool dns_cache::lookup_hosts(const std::string& name, int type,
+    std::vector<asio::ip::address>& addresses) const
+{
+  dns_ops::hosts_table::const_iterator iter = hosts_.find(name);
+  if (iter == hosts_.end())
+    return false;
+
+  bool found = false;
+  for (std::size_t i = 0; i < iter->second.size(); ++i)
+  {
+    const asio::ip::address& address = iter->second[i];
+    if (address.is_v6() ? type == dns_ops::type_aaaa
+        : type == dns_ops::type_a)
+    {
+      addresses.push_back(address);
+      found = true;
+    }
+  }
+
+  return found;
+}
+
+bool dns_cache::lookup(const std::string& name, int type,
+    int& rcode, std::vector<asio::ip::address>& addresses)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+
+  cache_type::iterator iter = cache_.find(std::make_pair(name, type));
+  if (iter == cache_.end())
+    return false;
+
+  if (iter->second.expiry <= clock_type::now())
+  {
+    cache_.erase(iter);
+    return false;
+  }
+
+  rcode = iter->second.rcode;
+  addresses.insert(addresses.end(),
+      iter->second.addresses.begin(), iter->second.addresses.end());
+  return true;
+}
+
+void dns_cache::store(const std::string& name, int type, int rcode,
+    const std::vector<asio::ip::address>& addresses, uint32_t ttl)
+{
+  if (ttl == 0 || max_entries_ == 0)
+    return;
+
+  clock_type::time_point now = clock_type::now();
+
+  asio::detail::mutex::scoped_lock lock(mutex_);
+
+  std::pair<std::string, int> key(name, type);
+  if (cache_.size() >= max_entries_ && cache_.find(key) == cache_.end())
+  {
+    // Remove the expired answers and, if that does not make room, the answer
+    // that would expire soonest.
+    cache_type::iterator soonest = cache_.end();
+    for (cache_type::iterator iter = cache_.begin(); iter != cache_.end(); )
+    {
+      if (iter->second.expiry <= now)
+        cache_.erase(iter++);
+      else
+      {
+        if (soonest == cache_.end()
+            || iter->second.expiry < soonest->second.expiry)
+          soonest = iter;
+        ++iter;
+      }
+    }
+    if (cache_.size() >= max_entries_ && soonest != cache_.end())
+      cache_.erase(soonest);
+  }
+
+  entry& e = cache_[key];
+  e.rcode = rcode;
+  e.addresses = addresses;
+  e.expiry = now + chrono::seconds(ttl);
+}
+
+unsigned short dns_cache::next_query_id()
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+
+  // An off-path attacker forging answers must guess both the identifier and
+  // the source port. The port is chosen at random by the operating system, as
+  // the queries are sent from a new, unbound socket for each name server
+  // tried (see dns_lookup::send_queries). The identifiers are taken from the
+  // operating system's generator, a batch at a time, so that earlier
+  // identifiers reveal nothing about later ones.
+  if (random_ids_used_ == random_ids_size)
+  {
+    if (fill_random(random_ids_, sizeof(random_ids_)))
+      random_ids_used_ = 0;
+  }
+  if (random_ids_used_ < random_ids_size)
+    return random_ids_[random_ids_used_++];
+
+  // Xorshift generator, used only if the operating system has no generator.
+  random_state_ ^= random_state_ << 13;
+  random_state_ ^= random_state_ >> 17;
+  random_state_ ^= random_state_ << 5;
+  return static_cast<unsigned short>(
+      (random_state_ >> 16) ^ (random_state_ & 0xFFFF));
+}
+
+bool dns_cache::fill_random(void* data, std::size_t size)
+{
+#if defined(ASIO_DNS_CACHE_USE_GETRANDOM)
+  unsigned char* p = static_cast<unsigned char*>(data);
+  while (size > 0)
+  {
+    ssize_t n = ::getrandom(p, size, 0);
+    if (n < 0 && errno != EINTR)
+      return false;
+    if (n > 0)
+    {
+      p += n;
+      size -= static_cast<std::size_t>(n);
+    }
+  }
+  return true;
+#elif defined(ASIO_DNS_CACHE_USE_ARC4RANDOM)
+  ::arc4random_buf(data, size);
+  return true;
+#else // defined(ASIO_DNS_CACHE_USE_ARC4RANDOM)
+  std::FILE* file = std::fopen("/dev/urandom", "rb");
+  if (!file)
+    return false;
+  std::size_t length = std::fread(data, 1, size, file);
+  std::fclose(file);
+  return length == size;
+#endif // defined(ASIO_DNS_CACHE_USE_ARC4RANDOM)
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#undef ASIO_DNS_CACHE_USE_GETRANDOM
+#undef ASIO_DNS_CACHE_USE_ARC4RANDOM
+
+#endif // defined(ASIO_HAS_CHRONO)
+
+#endif // ASIO_DETAIL_IMPL_DNS_CACHE_IPP
@@ -0,0 +1,352 @@
+//
+// detail/impl/dns_lookup.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_DNS_LOOKUP_IPP
+#define ASIO_DETAIL_IMPL_DNS_LOOKUP_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CHRONO)
+
+#include "asio/buffer.hpp"
+#include "asio/detail/dns_lookup.hpp"
+#include "asio/error.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Large enough for any response sent over UDP with EDNS.
+const std::size_t dns_max_message_size = 4096;
+
+class dns_lookup::receive_handler
+{
+public:
+  receive_handler(const shared_ptr<dns_lookup>& self, std::size_t generation)
+    : self_(self),
+      generation_(generation)
+  {
+  }
+
+  void operator()(const asio::error_code& ec, std::size_t bytes_transferred)
+  {
+    self_->handle_receive(self_, generation_, ec, bytes_transferred);
+  }
+
+private:
+  shared_ptr<dns_lookup> self_;
+  std::size_t generation_;
+};
+
+class dns_lookup::timeout_handler
+{
+public:
+  timeout_handler(const shared_ptr<dns_lookup>& self, std::size_t generation)
+    : self_(self),
+      generation_(generation)
+  {
+  }
+
+  void operator()(const asio::error_code& ec)
+  {
+    self_->handle_timeout(self_, generation_, ec);
+  }
+
+private:
+  shared_ptr<dns_lookup> self_;
+  std::size_t generation_;
+};
+
+dns_lookup::dns_lookup(const any_io_executor& ex,
+    dns_cache& cache, const std::string& name,
+    bool want_v4, bool want_v6)
+  : cache_(cache),
+    name_(name),
+    num_questions_(0),
+    socket_(ex),
+    timer_(ex),
+    buffer_(dns_max_message_size),
+    server_index_(0),
+    attempt_(0),
+    generation_(0),
+    finished_(false)
+{
+  if (want_v6)
+  {
+    questions_[num_questions_].type = dns_ops::type_aaaa;
+    questions_[num_questions_].answered = false;
+    ++num_questions_;
+  }
+
+  if (want_v4)
+  {
+    questions_[num_questions_].type = dns_ops::type_a;
+    questions_[num_questions_].answered = false;
+    ++num_questions_;
+  }
+}
+
+dns_lookup::~dns_lookup()
+{
+}
+
+void dns_lookup::start(const shared_ptr<dns_lookup>& self)
+{
+  asio::detail::mutex::scoped_lock lock(self->mutex_);
+  self->send_queries(self);
+  if (self->finished_)
+  {
+    lock.unlock();
+    self->complete(self->ec_, self->addresses_);
+  }
+}
+
+void dns_lookup::cancel()
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  if (!finished_)
+  {
+    finish(asio::error::operation_aborted);
+    lock.unlock();
+    complete(ec_, addresses_);
+  }
+}
+
+void dns_lookup::send_queries(const shared_ptr<dns_lookup>& self)
+{
+  const dns_ops::resolver_config& config = cache_.resolver_config();
+  const asio::ip::udp::endpoint& server = config.nameservers[server_index_];
+
+  // Use a new socket, and so a new source port, for each name server. The
+  // socket is connected without being bound, so the operating system assigns
+  // it a randomised ephemeral port. Any operations on the previous socket
+  // complete with operation_aborted.
+  ++generation_;
+  asio::error_code ec;
+  socket_.close(ec);
+  socket_.open(server.protocol(), ec);
+  if (!ec)
+    socket_.connect(server, ec);
+
+  std::vector<unsigned char> query;
+  for (std::size_t i = 0; i < num_questions_ && !ec; ++i)
+  {
+    if (!questions_[i].answered)
+    {
+      questions_[i].id = cache_.next_query_id();
+      dns_ops::encode_query(questions_[i].id,
+          name_, questions_[i].type, query);
+      socket_.send(asio::buffer(query), 0, ec);
+    }
+  }
+
+  if (ec)
+  {
+    next_server(self);
+    return;
+  }
+
+  start_receive(self);
+  timer_.expires_after(chrono::milliseconds(config.timeout_ms));
+  timer_.async_wait(timeout_handler(self, generation_));
+}
+
+void dns_lookup::next_server(const shared_ptr<dns_lookup>& self)
+{
+  const dns_ops::resolver_config& config = cache_.resolver_config();
+  if (++server_index_ >= config.nameservers.size())
+  {
+    server_index_ = 0;
+    ++attempt_;
+  }
+
+  if (attempt_ >= config.attempts)
+    finish(asio::error::host_not_found_try_again);
+  else
+    send_queries(self);
+}
+
+void dns_lookup::start_receive(const shared_ptr<dns_lookup>& self)
+{
+  socket_.async_receive(asio::buffer(buffer_),
+      receive_handler(self, generation_));
+}
+
+void dns_lookup::handle_receive(const shared_ptr<dns_lookup>& self,
+    std::size_t generation, const asio::error_code& ec,
+    std::size_t bytes_transferred)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  if (finished_ || generation != generation_)
+    return;
+
+  // An error, such as the name server's port being unreachable, means that
+  // the next server should be tried without waiting for the timeout.
+  if (ec)
+    next_server(self);
+  else
+    process_response(self, bytes_transferred);
+
+  if (finished_)
+  {
+    lock.unlock();
+    complete(ec_, addresses_);
+  }
+}
+
+void dns_lookup::handle_timeout(const shared_ptr<dns_lookup>& self,
+    std::size_t generation, const asio::error_code& ec)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  if (finished_ || generation != generation_ || ec)
+    return;
+
+  next_server(self);
+
+  if (finished_)
+  {
+    lock.unlock();
+    complete(ec_, addresses_);
+  }
+}
+
+void dns_lookup::process_response(const shared_ptr<dns_lookup>& self,
+    std::size_t bytes_transferred)
+{
+  // Find the question that the message answers. Anything else is ignored.
+  dns_ops::response response;
+  question* q = 0;
+  for (std::size_t i = 0; i < num_questions_ && !q; ++i)
+  {
+    if (!questions_[i].answered
+        && dns_ops::decode_response(&buffer_[0], bytes_transferred,
+          name_, questions_[i].type, response)
+        && response.id == questions_[i].id)
+      q = &questions_[i];
+  }
+
+  if (!q)
+  {
+    start_receive(self);
+    return;
+  }
+
+  switch (response.rcode)
+  {
+  case dns_ops::rcode_no_error:
+    break;
+  case dns_ops::rcode_name_error:
+    // The name does not exist, so there are no addresses of any type.
+    if (response.has_soa)
+    {
+      for (std::size_t i = 0; i < num_questions_; ++i)
+      {
+        cache_.store(name_, questions_[i].type, response.rcode,
+            std::vector<asio::ip::address>(), response.negative_ttl);
+      }
+    }
+    finish(asio::error::host_not_found);
+    return;
+  default:
+    next_server(self);
+    return;
+  }
+
+  // Without a fallback to TCP, a truncated message is only useful if it holds
+  // some addresses.
+  if (response.truncated && response.addresses.empty())
+  {
+    next_server(self);
+    return;
+  }
+
+  q->answered = true;
+  q->addresses.swap(response.addresses);
+  if (!q->addresses.empty())
+  {
+    if (!response.truncated)
+      cache_.store(name_, q->type, response.rcode,
+          q->addresses, response.ttl);
+  }
+  else if (response.has_soa)
+  {
+    cache_.store(name_, q->type, response.rcode,
+        q->addresses, response.negative_ttl);
+  }
+
+  for (std::size_t i = 0; i < num_questions_; ++i)
+  {
+    if (!questions_[i].answered)
+    {
+      start_receive(self);
+      return;
+    }
+  }
+
+  for (std::size_t i = 0; i < num_questions_; ++i)
+  {
+    addresses_.insert(addresses_.end(),
+        questions_[i].addresses.begin(), questions_[i].addresses.end());
+  }
+
+  if (addresses_.empty())
+    finish(asio::error::no_data);
+  else
+    finish(asio::error_code());
+}
+
+void dns_lookup::finish(const asio::error_code& ec)
+{
+  finished_ = true;
+  ec_ = ec;
+  asio::error_code ignored;
+  socket_.close(ignored);
+  timer_.cancel();
+}
+
+void dns_lookup_set::add(const shared_ptr<dns_lookup>& lookup)
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+
+  std::size_t live = 0;
+  for (std::size_t i = 0; i < lookups_.size(); ++i)
+    if (!lookups_[i].expired())
+      lookups_[live++] = lookups_[i];
+  lookups_.resize(live);
+
+  lookups_.push_back(lookup);
+}
+
+void dns_lookup_set::cancel()
+{
+  std::vector<weak_ptr<dns_lookup> > lookups;
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    lookups.swap(lookups_);
+  }
+
+  for (std::size_t i = 0; i < lookups.size(); ++i)
+    if (shared_ptr<dns_lookup> lookup = lookups[i].lock())
+      lookup->cancel();
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_CHRONO)
+
+#endif // ASIO_DETAIL_IMPL_DNS_LOOKUP_IPP
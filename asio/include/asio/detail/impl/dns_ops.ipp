@@ -0,0 +1,529 @@
+//
+// detail/impl/dns_ops.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_DNS_OPS_IPP
+#define ASIO_DETAIL_IMPL_DNS_OPS_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include "asio/detail/dns_ops.hpp"
+#include "asio/detail/socket_ops.hpp"
+#include "asio/detail/socket_types.hpp"
+#include "asio/error.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+namespace dns_ops {
+
+// The largest number of name servers used from resolv.conf, as for the
+// system resolver.
+const std::size_t max_nameservers = 3;
+
+// The size of a message header.
+const std::size_t header_size = 12;
+
+// The longest chain of compression pointers that is followed in a name.
+const int max_name_pointers = 32;
+
+inline char to_lower(char c)
+{
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+inline bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline uint16_t read_uint16(const unsigned char* p)
+{
+  return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t read_uint32(const unsigned char* p)
+{
+  return (static_cast<uint32_t>(p[0]) << 24)
+    | (static_cast<uint32_t>(p[1]) << 16)
+    | (static_cast<uint32_t>(p[2]) << 8)
+    | static_cast<uint32_t>(p[3]);
+}
+
+inline void write_uint16(std::vector<unsigned char>& out, uint16_t value)
+{
+  out.push_back(static_cast<unsigned char>(value >> 8));
+  out.push_back(static_cast<unsigned char>(value & 0xFF));
+}
+
+// Read a possibly compressed name that starts at pos. On success, pos is
+// advanced past the name's encoding in the record and the name is stored in
+// canonical form.
+inline bool read_name(const unsigned char* data, std::size_t size,
+    std::size_t& pos, std::string& name)
+{
+  name.clear();
+  std::size_t p = pos;
+  std::size_t end = 0;
+  int pointers = 0;
+  for (;;)
+  {
+    if (p >= size)
+      return false;
+    unsigned int length = data[p];
+    if ((length & 0xC0) == 0xC0)
+    {
+      if (p + 1 >= size || ++pointers > max_name_pointers)
+        return false;
+      if (end == 0)
+        end = p + 2;
+      p = ((length & 0x3F) << 8) | data[p + 1];
+    }
+    else if ((length & 0xC0) != 0)
+    {
+      return false;
+    }
+    else if (length == 0)
+    {
+      pos = end ? end : p + 1;
+      return true;
+    }
+    else
+    {
+      if (p + 1 + length > size || name.size() + length + 1 > 255)
+        return false;
+      if (!name.empty())
+        name += '.';
+      for (std::size_t i = 0; i < length; ++i)
+        name += to_lower(static_cast<char>(data[p + 1 + i]));
+      p += 1 + length;
+    }
+  }
+}
+
+// Split a line into whitespace-separated tokens, ignoring any comment.
+inline void split_line(const std::string& line, const char* comment_chars,
+    std::vector<std::string>& tokens)
+{
+  tokens.clear();
+  std::string::size_type end = line.find_first_of(comment_chars);
+  if (end == std::string::npos)
+    end = line.size();
+  std::string::size_type pos = 0;
+  while (pos < end)
+  {
+    while (pos < end && is_space(line[pos]))
+      ++pos;
+    std::string::size_type start = pos;
+    while (pos < end && !is_space(line[pos]))
+      ++pos;
+    if (pos > start)
+      tokens.push_back(line.substr(start, pos - start));
+  }
+}
+
+// Call a function for each line of some text.
+template <typename Function>
+inline void for_each_line(const std::string& text, Function f)
+{
+  std::string::size_type pos = 0;
+  while (pos < text.size())
+  {
+    std::string::size_type end = text.find('\n', pos);
+    if (end == std::string::npos)
+      end = text.size();
+    f(text.substr(pos, end - pos));
+    pos = end + 1;
+  }
+}
+
+// Parse a decimal number, returning -1 if the text is not a number.
+inline long parse_number(const std::string& text)
+{
+  if (text.empty() || text.size() > 9)
+    return -1;
+  long value = 0;
+  for (std::size_t i = 0; i < text.size(); ++i)
+  {
+    if (text[i] < '0' || text[i] > '9')
+      return -1;
+    value = value * 10 + (text[i] - '0');
+  }
+  return value;
+}
+
+struct resolv_conf_line
+{
+  resolver_config* config_;
+  bool* have_nameservers_;
+
+  void operator()(const std::string& line) const
+  {
+    std::vector<std::string> tokens;
+    split_line(line, "#;", tokens);
+    if (tokens.size() >= 2 && tokens[0] == "nameserver")
+    {
+      // Name servers in the file replace any that were previously set.
+      if (!*have_nameservers_)
+      {
+        config_->nameservers.clear();
+        *have_nameservers_ = true;
+      }
+      asio::ip::udp::endpoint endpoint;
+      if (config_->nameservers.size() < max_nameservers
+          && parse_nameserver(tokens[1], endpoint))
+        config_->nameservers.push_back(endpoint);
+    }
+    else if (!tokens.empty() && tokens[0] == "options")
+    {
+      for (std::size_t i = 1; i < tokens.size(); ++i)
+      {
+        if (tokens[i].compare(0, 8, "timeout:") == 0)
+        {
+          long value = parse_number(tokens[i].substr(8));
+          if (value > 0)
+            config_->timeout_ms = value * 1000;
+        }
+        else if (tokens[i].compare(0, 9, "attempts:") == 0)
+        {
+          long value = parse_number(tokens[i].substr(9));
+          if (value > 0)
+            config_->attempts = static_cast<int>(value);
+        }
+      }
+    }
+  }
+};
+
+struct hosts_line
+{
+  hosts_table* table_;
+
+  void operator()(const std::string& line) const
+  {
+    std::vector<std::string> tokens;
+    split_line(line, "#", tokens);
+    if (tokens.size() < 2)
+      return;
+
+    asio::error_code ec;
+    asio::ip::address address = asio::ip::make_address(tokens[0], ec);
+    if (ec)
+      return;
+
+    for (std::size_t i = 1; i < tokens.size(); ++i)
+    {
+      std::string name;
+      if (canonical_name(tokens[i], name))
+      {
+        std::vector<asio::ip::address>& addresses = (*table_)[name];
+        if (std::find(addresses.begin(), addresses.end(), address)
+            == addresses.end())
+          addresses.push_back(address);
+      }
+    }
+  }
+};
+
+bool canonical_name(const std::string& host_name, std::string& out)
+{
+  std::string::size_type length = host_name.size();
+  if (length > 1 && host_name[length - 1] == '.')
+    --length;
+  if (length == 0 || length > 253)
+    return false;
+
+  out.resize(length);
+  std::size_t label_length = 0;
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    char c = host_name[i];
+    if (c == '.')
+    {
+      if (label_length == 0)
+        return false;
+      label_length = 0;
+    }
+    else if (c <= ' ' || c > '~' || ++label_length > 63)
+    {
+      return false;
+    }
+    out[i] = to_lower(c);
+  }
+
+  return label_length != 0;
+}
+
+void encode_query(unsigned short id, const std::string& name,
+    int type, std::vector<unsigned char>& out)
+{
+  out.clear();
+  out.reserve(header_size + name.size() + 6);
+
+  // Header, with only the recursion desired flag set.
+  write_uint16(out, id);
+  write_uint16(out, 0x0100);
+  write_uint16(out, 1);
+  write_uint16(out, 0);
+  write_uint16(out, 0);
+  write_uint16(out, 0);
+
+  // Question.
+  std::string::size_type pos = 0;
+  while (pos < name.size())
+  {
+    std::string::size_type end = name.find('.', pos);
+    if (end == std::string::npos)
+      end = name.size();
+    out.push_back(static_cast<unsigned char>(end - pos));
+    out.insert(out.end(), name.begin() + pos, name.begin() + end);
+    pos = end + 1;
+  }
+  out.push_back(0);
+  write_uint16(out, static_cast<uint16_t>(type));
+  write_uint16(out, class_in);
+}
+
+bool decode_response(const unsigned char* data, std::size_t size,
+    const std::string& name, int type, response& out)
+{
+  if (size < header_size)
+    return false;
+
+  uint16_t flags = read_uint16(data + 2);
+  if ((flags & 0x8000) == 0)
+    return false;
+
+  out.id = read_uint16(data);
+  out.rcode = flags & 0x000F;
+  out.truncated = (flags & 0x0200) != 0;
+  out.addresses.clear();
+  out.ttl = 0;
+  out.has_soa = false;
+  out.negative_ttl = 0;
+
+  std::size_t question_count = read_uint16(data + 4);
+  std::size_t answer_count = read_uint16(data + 6);
+  std::size_t authority_count = read_uint16(data + 8);
+
+  // The response must repeat the question.
+  std::size_t pos = header_size;
+  std::string record_name;
+  if (question_count != 1
+      || !read_name(data, size, pos, record_name)
+      || pos + 4 > size
+      || record_name != name
+      || read_uint16(data + pos) != type
+      || read_uint16(data + pos + 2) != class_in)
+    return false;
+  pos += 4;
+
+  // Follow any chain of aliases from the name in the question.
+  std::vector<std::string> names(1, name);
+  bool have_ttl = false;
+
+  for (std::size_t i = 0; i < answer_count + authority_count; ++i)
+  {
+    if (!read_name(data, size, pos, record_name) || pos + 10 > size)
+      return false;
+    int record_type = read_uint16(data + pos);
+    int record_class = read_uint16(data + pos + 2);
+    uint32_t ttl = read_uint32(data + pos + 4) & 0x7FFFFFFF;
+    std::size_t data_length = read_uint16(data + pos + 8);
+    pos += 10;
+    if (pos + data_length > size)
+      return false;
+    std::size_t data_pos = pos;
+    pos += data_length;
+
+    if (record_class != class_in)
+      continue;
+
+    if (i >= answer_count)
+    {
+      // Authority section.
+      if (record_type == type_soa)
+      {
+        std::string ignored;
+        if (!read_name(data, size, data_pos, ignored)
+            || !read_name(data, size, data_pos, ignored)
+            || data_pos + 20 > pos)
+          return false;
+        uint32_t minimum = read_uint32(data + data_pos + 16);
+        out.has_soa = true;
+        out.negative_ttl = (std::min)(ttl, minimum);
+      }
+      continue;
+    }
+
+    if (std::find(names.begin(), names.end(), record_name) == names.end())
+      continue;
+
+    if (record_type == type_cname)
+    {
+      std::string target;
+      if (!read_name(data, size, data_pos, target))
+        return false;
+      names.push_back(target);
+    }
+    else if (record_type == type && type == type_a && data_length == 4)
+    {
+      asio::ip::address_v4::bytes_type bytes;
+      std::copy(data + data_pos, data + data_pos + 4, bytes.begin());
+      out.addresses.push_back(asio::ip::address_v4(bytes));
+    }
+    else if (record_type == type && type == type_aaaa && data_length == 16)
+    {
+      asio::ip::address_v6::bytes_type bytes;
+      std::copy(data + data_pos, data + data_pos + 16, bytes.begin());
+      out.addresses.push_back(asio::ip::address_v6(bytes));
+    }
+    else
+    {
+      continue;
+    }
+
+    out.ttl = have_ttl ? (std::min)(out.ttl, ttl) : ttl;
+    have_ttl = true;
+  }
+
+  return true;
+}
+
+void parse_resolv_conf(const std::string& text, resolver_config& config)
+{
+  bool have_nameservers = false;
+  resolv_conf_line f = { &config, &have_nameservers };
+  for_each_line(text, f);
+}
+
+bool parse_nameserver(const std::string& text,
+    asio::ip::udp::endpoint& endpoint)
+{
+  std::string address_text = text;
+  std::string port_text;
+  if (!text.empty() && text[0] == '[')
+  {
+    std::string::size_type end = text.find(']');
+    if (end == std::string::npos)
+      return false;
+    address_text = text.substr(1, end - 1);
+    if (end + 1 < text.size())
+    {
+      if (text[end + 1] != ':')
+        return false;
+      port_text = text.substr(end + 2);
+    }
+  }
+  else if (std::count(text.begin(), text.end(), ':') == 1)
+  {
+    std::string::size_type colon = text.find(':');
+    address_text = text.substr(0, colon);
+    port_text = text.substr(colon + 1);
+  }
+
+  asio::error_code ec;
+  asio::ip::address address = asio::ip::make_address(address_text, ec);
+  if (ec)
+    return false;
+
+  long port = 53;
+  if (!port_text.empty())
+  {
+    port = parse_number(port_text);
+    if (port <= 0 || port > 65535)
+      return false;
+  }
+
+  endpoint = asio::ip::udp::endpoint(address,
+      static_cast<unsigned short>(port));
+  return true;
+}
+
+void parse_hosts(const std::string& text, hosts_table& table)
+{
+  hosts_line f = { &table };
+  for_each_line(text, f);
+}
+
+asio::error_code resolve_service(const std::string& service,
+    int socket_type, unsigned short& port, asio::error_code& ec)
+{
+  long number = parse_number(service);
+  if (number >= 0 && number <= 65535)
+  {
+    port = static_cast<unsigned short>(number);
+    ec.assign(0, ec.category());
+    return ec;
+  }
+
+#if defined(ASIO_WINDOWS_RUNTIME)
+  (void)socket_type;
+  ec = asio::error::service_not_found;
+  return ec;
+#else // defined(ASIO_WINDOWS_RUNTIME)
+  addrinfo_type hints = addrinfo_type();
+  hints.ai_flags = ASIO_OS_DEF(AI_PASSIVE);
+  hints.ai_family = ASIO_OS_DEF(AF_UNSPEC);
+  hints.ai_socktype = socket_type;
+  addrinfo_type* result = 0;
+  socket_ops::getaddrinfo(0, service.c_str(), hints, &result, ec);
+  if (ec)
+    return ec;
+
+  if (result && result->ai_family == ASIO_OS_DEF(AF_INET))
+  {
+    port = socket_ops::network_to_host_short(
+        reinterpret_cast<sockaddr_in4_type*>(result->ai_addr)->sin_port);
+  }
+  else if (result && result->ai_family == ASIO_OS_DEF(AF_INET6))
+  {
+    port = socket_ops::network_to_host_short(
+        reinterpret_cast<sockaddr_in6_type*>(result->ai_addr)->sin6_port);
+  }
+  else
+  {
+    ec = asio::error::service_not_found;
+  }
+
+  socket_ops::freeaddrinfo(result);
+  return ec;
+#endif // defined(ASIO_WINDOWS_RUNTIME)
+}
+
+bool read_file(const char* path, std::string& out)
+{
+  out.clear();
+  std::FILE* file = std::fopen(path, "rb");
+  if (!file)
+    return false;
+
+  char buffer[4096];
+  std::size_t length;
+  while ((length = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    out.append(buffer, length);
+
+  std::fclose(file);
+  return true;
+}
+
+} // namespace dns_ops
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_IMPL_DNS_OPS_IPP
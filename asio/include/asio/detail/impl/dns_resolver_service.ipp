@@ -0,0 +1,86 @@
+//
+// detail/impl/dns_resolver_service.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_DNS_RESOLVER_SERVICE_IPP
+#define ASIO_DETAIL_IMPL_DNS_RESOLVER_SERVICE_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CHRONO)
+
+#include "asio/detail/dns_lookup.hpp"
+#include "asio/detail/dns_resolver_service.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+dns_resolver_service::dns_resolver_service(execution_context& context)
+  : execution_context_service_base<dns_resolver_service>(context),
+    cache_(context)
+{
+}
+
+void dns_resolver_service::shutdown()
+{
+}
+
+void dns_resolver_service::construct(implementation_type& impl)
+{
+  impl.reset(new dns_lookup_set);
+}
+
+void dns_resolver_service::destroy(implementation_type& impl)
+{
+  if (impl)
+    impl->cancel();
+  impl.reset();
+}
+
+void dns_resolver_service::move_construct(implementation_type& impl,
+    implementation_type& other_impl)
+{
+  impl = other_impl;
+  other_impl.reset(new dns_lookup_set);
+}
+
+void dns_resolver_service::move_assign(implementation_type& impl,
+    dns_resolver_service& /*other_service*/,
+    implementation_type& other_impl)
+{
+  destroy(impl);
+  move_construct(impl, other_impl);
+}
+
+void dns_resolver_service::cancel(implementation_type& impl)
+{
+  impl->cancel();
+}
+
+void dns_resolver_service::start_lookup(implementation_type& impl,
+    const shared_ptr<dns_lookup>& lookup)
+{
+  impl->add(lookup);
+  dns_lookup::start(lookup);
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_CHRONO)
+
+#endif // ASIO_DETAIL_IMPL_DNS_RESOLVER_SERVICE_IPP
@@ -21,6 +21,8 @@
 
 #include <cstddef>
 #include <sys/epoll.h>
+#include "asio/config.hpp"
+#include "asio/detail/concurrency_hint.hpp"
 #include "asio/detail/epoll_reactor.hpp"
 #include "asio/detail/scheduler.hpp"
 #include "asio/detail/throw_error.hpp"
@@ -44,7 +46,12 @@ epoll_reactor::epoll_reactor(asio::execution_context& ctx)
     epoll_fd_(do_epoll_create()),
     timer_fd_(do_timerfd_create()),
     shutdown_(false),
-    registered_descriptors_mutex_(mutex_.enabled())
+    registered_descriptors_mutex_(mutex_.enabled()),
+    shard_count_(get_shard_count(ctx, scheduler_.concurrency_hint())),
+    queue_descriptors_(shard_count_ > 0 || scheduler_.may_force_task_poll()),
+    shard_by_thread_(config(ctx).get("reactor", "shard_by_thread", false)),
+    shards_(shard_count_ ? new shard[shard_count_] : 0),
+    shards_mutex_(shard_count_ > 0)
 {
   // Add the interrupter's descriptor to epoll.
   epoll_event ev = { 0, { 0 } };
@@ -60,6 +67,20 @@ epoll_reactor::epoll_reactor(asio::execution_context& ctx)
     ev.data.ptr = &timer_fd_;
     epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &ev);
   }
+
+  // Create the secondary epoll instances. If an instance cannot be created
+  // then the reactor continues with fewer shards.
+  for (std::size_t i = 0; i < shard_count_; ++i)
+  {
+    asio::error_code ec;
+    shards_[i].epoll_fd_ = do_epoll_create(ec);
+    if (ec)
+    {
+      shard_count_ = i;
+      break;
+    }
+    register_shard(shards_[i]);
+  }
 }
 
 epoll_reactor::~epoll_reactor()
@@ -68,6 +89,10 @@ epoll_reactor::~epoll_reactor()
     close(epoll_fd_);
   if (timer_fd_ != -1)
     close(timer_fd_);
+  for (std::size_t i = 0; i < shard_count_; ++i)
+    if (shards_[i].epoll_fd_ != -1)
+      close(shards_[i].epoll_fd_);
+  delete[] shards_;
 }
 
 void epoll_reactor::shutdown()
@@ -123,6 +148,16 @@ void epoll_reactor::notify_fork(
       epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &ev);
     }
 
+    // Recreate the secondary epoll instances.
+    for (std::size_t i = 0; i < shard_count_; ++i)
+    {
+      if (shards_[i].epoll_fd_ != -1)
+        ::close(shards_[i].epoll_fd_);
+      shards_[i].epoll_fd_ = -1;
+      shards_[i].epoll_fd_ = do_epoll_create();
+      register_shard(shards_[i]);
+    }
+
     update_timeout();
 
     // Re-register all descriptors with epoll.
@@ -132,7 +167,8 @@ void epoll_reactor::notify_fork(
     {
       ev.events = state->registered_events_;
       ev.data.ptr = state;
-      int result = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, state->descriptor_, &ev);
+      int result = epoll_ctl(epoll_fd_for(state),
+          EPOLL_CTL_ADD, state->descriptor_, &ev);
       if (result != 0)
       {
         asio::error_code ec(errno,
@@ -163,6 +199,9 @@ int epoll_reactor::register_descriptor(socket_type descriptor,
     descriptor_data->reactor_ = this;
     descriptor_data->descriptor_ = descriptor;
     descriptor_data->shutdown_ = false;
+    descriptor_data->pending_events_ = 0;
+    descriptor_data->queued_ = false;
+    descriptor_data->shard_ = choose_shard(descriptor);
     for (int i = 0; i < max_ops; ++i)
       descriptor_data->try_speculative_[i] = true;
   }
@@ -171,7 +210,8 @@ int epoll_reactor::register_descriptor(socket_type descriptor,
   ev.events = EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLPRI | EPOLLET;
   descriptor_data->registered_events_ = ev.events;
   ev.data.ptr = descriptor_data;
-  int result = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, descriptor, &ev);
+  int result = epoll_ctl(epoll_fd_for(descriptor_data),
+      EPOLL_CTL_ADD, descriptor, &ev);
   if (result != 0)
   {
     if (errno == EPERM)
@@ -205,6 +245,9 @@ int epoll_reactor::register_internal_descriptor(
     descriptor_data->reactor_ = this;
     descriptor_data->descriptor_ = descriptor;
     descriptor_data->shutdown_ = false;
+    descriptor_data->pending_events_ = 0;
+    descriptor_data->queued_ = false;
+    descriptor_data->shard_ = 0;
     descriptor_data->op_queue_[op_type].push(op);
     for (int i = 0; i < max_ops; ++i)
       descriptor_data->try_speculative_[i] = true;
@@ -281,7 +324,8 @@ void epoll_reactor::start_op(int op_type, socket_type descriptor,
           epoll_event ev = { 0, { 0 } };
           ev.events = descriptor_data->registered_events_ | EPOLLOUT;
           ev.data.ptr = descriptor_data;
-          if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, descriptor, &ev) == 0)
+          if (epoll_ctl(epoll_fd_for(descriptor_data),
+                EPOLL_CTL_MOD, descriptor, &ev) == 0)
           {
             descriptor_data->registered_events_ |= ev.events;
           }
@@ -311,7 +355,8 @@ void epoll_reactor::start_op(int op_type, socket_type descriptor,
       epoll_event ev = { 0, { 0 } };
       ev.events = descriptor_data->registered_events_;
       ev.data.ptr = descriptor_data;
-      epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, descriptor, &ev);
+      epoll_ctl(epoll_fd_for(descriptor_data),
+          EPOLL_CTL_MOD, descriptor, &ev);
     }
   }
 
@@ -390,7 +435,8 @@ void epoll_reactor::deregister_descriptor(socket_type descriptor,
     else if (descriptor_data->registered_events_ != 0)
     {
       epoll_event ev = { 0, { 0 } };
-      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, descriptor, &ev);
+      epoll_ctl(epoll_fd_for(descriptor_data),
+          EPOLL_CTL_DEL, descriptor, &ev);
     }
 
     op_queue<operation> ops;
@@ -481,6 +527,10 @@ void epoll_reactor::run(long usec, op_queue<operation>& ops)
   // operations have already been dequeued. Therefore it is now safe for us to
   // reuse and return them for the scheduler to queue again.
 
+  // Interrupts requested from this point on must wake the epoll_wait call
+  // below. Any earlier interrupt has already been delivered to the epoll set.
+  interrupt_coalescer_.reset();
+
   // Calculate timeout. Check the timer queues only if timerfd is not in use.
   int timeout;
   if (usec == 0)
@@ -495,6 +545,11 @@ void epoll_reactor::run(long usec, op_queue<operation>& ops)
     }
   }
 
+  // Make sure that we are woken by events on any secondary epoll instance
+  // that has no waiting thread.
+  if (shard_count_ > 0)
+    arm_idle_shards();
+
   // Block on the epoll descriptor.
   epoll_event events[128];
   int num_events = epoll_wait(epoll_fd_, events, 128, timeout);
@@ -514,6 +569,10 @@ void epoll_reactor::run(long usec, op_queue<operation>& ops)
       // Ignore.
     }
 # endif // defined(ASIO_HAS_TIMERFD)
+    else if (find_shard(ptr))
+    {
+      // Ignore.
+    }
     else
     {
       unsigned event_mask = 0;
@@ -559,6 +618,15 @@ void epoll_reactor::run(long usec, op_queue<operation>& ops)
       check_timers = true;
     }
 #endif // defined(ASIO_HAS_TIMERFD)
+    else if (shard* s = find_shard(ptr))
+    {
+      poll_idle_shard(*s, ops);
+    }
+    else if (queue_descriptors_)
+    {
+      queue_descriptor(static_cast<descriptor_state*>(ptr),
+          events[i].events, ops);
+    }
     else
     {
       // The descriptor operation doesn't count as work in and of itself, so we
@@ -596,13 +664,70 @@ void epoll_reactor::run(long usec, op_queue<operation>& ops)
 
 void epoll_reactor::interrupt()
 {
+  if (!interrupt_coalescer_.begin_interrupt())
+    return;
+
   epoll_event ev = { 0, { 0 } };
   ev.events = EPOLLIN | EPOLLERR | EPOLLET;
   ev.data.ptr = &interrupter_;
   epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, interrupter_.read_descriptor(), &ev);
 }
 
+void epoll_reactor::run_shard(std::size_t index,
+    long usec, op_queue<operation>& ops)
+{
+  shard& s = shards_[index];
+
+  mutex::scoped_lock lock(shards_mutex_);
+  if (s.interrupted_)
+  {
+    s.interrupted_ = false;
+    return;
+  }
+  s.waiting_ = true;
+  if (s.armed_)
+    arm_shard(s, false);
+  lock.unlock();
+
+  int timeout;
+  if (usec == 0)
+    timeout = 0;
+  else
+    timeout = (usec < 0) ? -1 : ((usec - 1) / 1000 + 1);
+  wait_shard(s, timeout, ops);
+
+  // The waiting thread is about to process the ready operations, so let the
+  // primary epoll instance watch the shard until it returns.
+  lock.lock();
+  s.waiting_ = false;
+  s.interrupted_ = false;
+  arm_shard(s, true);
+}
+
+void epoll_reactor::interrupt_shard(std::size_t index)
+{
+  shard& s = shards_[index];
+
+  mutex::scoped_lock lock(shards_mutex_);
+  s.interrupted_ = true;
+  if (s.waiting_)
+  {
+    epoll_event ev = { 0, { 0 } };
+    ev.events = EPOLLIN | EPOLLERR | EPOLLET;
+    ev.data.ptr = &interrupter_;
+    epoll_ctl(s.epoll_fd_, EPOLL_CTL_MOD, interrupter_.read_descriptor(), &ev);
+  }
+}
+
 int epoll_reactor::do_epoll_create()
+{
+  asio::error_code ec;
+  int fd = do_epoll_create(ec);
+  asio::detail::throw_error(ec, "epoll");
+  return fd;
+}
+
+int epoll_reactor::do_epoll_create(asio::error_code& ec)
 {
 #if defined(EPOLL_CLOEXEC)
   int fd = epoll_create1(EPOLL_CLOEXEC);
@@ -620,10 +745,11 @@ int epoll_reactor::do_epoll_create()
 
   if (fd == -1)
   {
-    asio::error_code ec(errno,
+    ec = asio::error_code(errno,
         asio::error::get_system_category());
-    asio::detail::throw_error(ec, "epoll");
   }
+  else
+    ec = asio::error_code();
 
   return fd;
 }
@@ -651,6 +777,150 @@ int epoll_reactor::do_timerfd_create()
 #endif // defined(ASIO_HAS_TIMERFD)
 }
 
+std::size_t epoll_reactor::get_shard_count(
+    asio::execution_context& ctx, int concurrency_hint)
+{
+  // Secondary instances are only useful when multiple threads may run the
+  // scheduler.
+  unsigned shards = config(ctx).get("reactor", "shards", 1u);
+  if (shards <= 1 || concurrency_hint == 1
+      || !ASIO_CONCURRENCY_HINT_IS_LOCKING(SCHEDULER, concurrency_hint)
+      || !ASIO_CONCURRENCY_HINT_IS_LOCKING(REACTOR_IO, concurrency_hint))
+    return 0;
+  return shards - 1;
+}
+
+void epoll_reactor::register_shard(epoll_reactor::shard& s)
+{
+  s.armed_ = true;
+  s.waiting_ = false;
+  s.interrupted_ = false;
+
+  // Add the interrupter's descriptor to the shard's epoll set.
+  epoll_event ev = { 0, { 0 } };
+  ev.events = EPOLLIN | EPOLLERR | EPOLLET;
+  ev.data.ptr = &interrupter_;
+  epoll_ctl(s.epoll_fd_, EPOLL_CTL_ADD, interrupter_.read_descriptor(), &ev);
+
+  // Add the shard's descriptor to the primary epoll set. The registration is
+  // disabled after each notification, and re-armed only while no thread is
+  // waiting on the shard.
+  ev.events = EPOLLIN | EPOLLONESHOT;
+  ev.data.ptr = &s;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, s.epoll_fd_, &ev);
+}
+
+epoll_reactor::shard* epoll_reactor::choose_shard(socket_type descriptor)
+{
+  if (shard_count_ == 0)
+    return 0;
+
+  if (shard_by_thread_)
+    if (std::size_t index = scheduler_.current_task_shard())
+      return &shards_[index - 1];
+
+  std::size_t index = static_cast<std::size_t>(descriptor) % (shard_count_ + 1);
+  return index == 0 ? 0 : &shards_[index - 1];
+}
+
+void epoll_reactor::arm_shard(epoll_reactor::shard& s, bool armed)
+{
+  epoll_event ev = { 0, { 0 } };
+  ev.events = armed ? (EPOLLIN | EPOLLONESHOT) : 0;
+  ev.data.ptr = &s;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, s.epoll_fd_, &ev);
+  s.armed_ = armed;
+}
+
+void epoll_reactor::arm_idle_shards()
+{
+  mutex::scoped_lock lock(shards_mutex_);
+  for (std::size_t i = 0; i < shard_count_; ++i)
+    if (!shards_[i].waiting_ && !shards_[i].armed_)
+      arm_shard(shards_[i], true);
+}
+
+void epoll_reactor::poll_idle_shard(epoll_reactor::shard& s,
+    op_queue<operation>& ops)
+{
+  mutex::scoped_lock lock(shards_mutex_);
+  s.armed_ = false;
+  if (s.waiting_)
+    return;
+  lock.unlock();
+
+  // A thread may begin waiting on the shard while we are polling it. If we
+  // consume an interrupt intended for that thread, pass it on.
+  if (wait_shard(s, 0, ops))
+  {
+    lock.lock();
+    if (s.waiting_)
+    {
+      epoll_event ev = { 0, { 0 } };
+      ev.events = EPOLLIN | EPOLLERR | EPOLLET;
+      ev.data.ptr = &interrupter_;
+      epoll_ctl(s.epoll_fd_, EPOLL_CTL_MOD,
+          interrupter_.read_descriptor(), &ev);
+    }
+  }
+}
+
+bool epoll_reactor::wait_shard(epoll_reactor::shard& s,
+    int msec, op_queue<operation>& ops)
+{
+  epoll_event events[128];
+  int num_events = epoll_wait(s.epoll_fd_, events, 128, msec);
+
+  bool interrupted = false;
+  for (int i = 0; i < num_events; ++i)
+  {
+    void* ptr = events[i].data.ptr;
+    if (ptr == &interrupter_)
+    {
+      interrupted = true;
+    }
+    else
+    {
+#if defined(ASIO_ENABLE_HANDLER_TRACKING)
+      unsigned event_mask = 0;
+      if ((events[i].events & EPOLLIN) != 0)
+        event_mask |= ASIO_HANDLER_REACTOR_READ_EVENT;
+      if ((events[i].events & EPOLLOUT))
+        event_mask |= ASIO_HANDLER_REACTOR_WRITE_EVENT;
+      if ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0)
+        event_mask |= ASIO_HANDLER_REACTOR_ERROR_EVENT;
+      ASIO_HANDLER_REACTOR_EVENTS((context(),
+            reinterpret_cast<uintmax_t>(ptr), event_mask));
+#endif // defined(ASIO_ENABLE_HANDLER_TRACKING)
+
+      queue_descriptor(static_cast<descriptor_state*>(ptr),
+          events[i].events, ops);
+    }
+  }
+
+  return interrupted;
+}
+
+void epoll_reactor::queue_descriptor(descriptor_state* descriptor_data,
+    uint32_t events, op_queue<operation>& ops)
+{
+  // When the reactor is sharded, or the scheduler polls it between handlers, a
+  // descriptor may become ready again while it is still queued from an earlier
+  // wait. The descriptor's mutex protects the queued flag, and any events that
+  // arrive while it is set are picked up by perform_io.
+  mutex::scoped_lock descriptor_lock(descriptor_data->mutex_);
+  if (descriptor_data->queued_)
+  {
+    descriptor_data->pending_events_ |= events;
+  }
+  else
+  {
+    descriptor_data->queued_ = true;
+    descriptor_data->set_ready_events(events);
+    ops.push(descriptor_data);
+  }
+}
+
 epoll_reactor::descriptor_state* epoll_reactor::allocate_descriptor_state()
 {
   mutex::scoped_lock descriptors_lock(registered_descriptors_mutex_);
@@ -749,7 +1019,10 @@ struct epoll_reactor::perform_io_cleanup_on_block_exit
 
 epoll_reactor::descriptor_state::descriptor_state(bool locking)
   : operation(&epoll_reactor::descriptor_state::do_complete),
-    mutex_(locking)
+    mutex_(locking),
+    shard_(0),
+    pending_events_(0),
+    queued_(false)
 {
 }
 
@@ -759,6 +1032,14 @@ operation* epoll_reactor::descriptor_state::perform_io(uint32_t events)
   perform_io_cleanup_on_block_exit io_cleanup(reactor_);
   mutex::scoped_lock descriptor_lock(mutex_, mutex::scoped_lock::adopt_lock);
 
+  // Add any events that arrived while queued by a sharded reactor.
+  if (queued_)
+  {
+    events |= pending_events_;
+    pending_events_ = 0;
+    queued_ = false;
+  }
+
   // Exception operations must be processed first to ensure that any
   // out-of-band data is read before normal data.
   static const int flag[max_ops] = { EPOLLIN, EPOLLOUT, EPOLLPRI };
@@ -30,6 +30,17 @@ inline void io_uring_service::post_immediate_completion(
   scheduler_.post_immediate_completion(op, is_continuation);
 }
 
+inline void io_uring_service::prepare_sqe(io_object* io_obj,
+    io_uring_operation* op, ::io_uring_sqe* sqe)
+{
+  op->prepare(sqe);
+  if (io_obj->registered_file_ >= 0 && sqe->fd == io_obj->descriptor_)
+  {
+    sqe->fd = io_obj->registered_file_;
+    sqe->flags |= IOSQE_FIXED_FILE;
+  }
+}
+
 template <typename Time_Traits>
 void io_uring_service::add_timer_queue(timer_queue<Time_Traits>& queue)
 {
@@ -20,10 +20,15 @@
 #if defined(ASIO_HAS_IO_URING)
 
 #include <cstddef>
+#include <cstring>
 #include <sys/eventfd.h>
+#include "asio/detail/concurrency_hint.hpp"
 #include "asio/detail/io_uring_service.hpp"
 #include "asio/detail/reactor_op.hpp"
 #include "asio/detail/scheduler.hpp"
+#include "asio/detail/scheduler_thread_info.hpp"
+#include "asio/detail/static_mutex.hpp"
+#include "asio/detail/thread_context.hpp"
 #include "asio/detail/throw_error.hpp"
 #include "asio/error.hpp"
 
@@ -37,6 +42,21 @@ io_uring_service::io_uring_service(asio::execution_context& ctx)
     scheduler_(use_service<scheduler>(ctx)),
     mutex_(ASIO_CONCURRENCY_HINT_IS_LOCKING(
           REACTOR_REGISTRATION, scheduler_.concurrency_hint())),
+    ring_size_(config(ctx).get("io_uring", "ring_size",
+          static_cast<unsigned>(default_ring_size))),
+    submit_batch_size_(config(ctx).get("io_uring", "submit_batch_size",
+          static_cast<int>(default_submit_batch_size))),
+    complete_batch_size_(config(ctx).get("io_uring", "complete_batch_size",
+          static_cast<int>(default_complete_batch_size))),
+    ring_flags_(get_ring_flags(config(ctx))),
+    sqpoll_idle_ms_(config(ctx).get("io_uring", "sqpoll_idle_ms", 0u)),
+    sqpoll_cpu_(config(ctx).get("io_uring", "sqpoll_cpu", -1)),
+    msg_ring_wakeups_(config(ctx).get("io_uring", "msg_ring_wakeups", true)),
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+    wakeup_id_(0),
+    wakeup_next_(0),
+    wakeup_prev_(0),
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
     outstanding_work_(0),
     submit_sqes_op_(this),
     pending_sqes_(0),
@@ -44,17 +64,28 @@ io_uring_service::io_uring_service(asio::execution_context& ctx)
     shutdown_(false),
     timeout_(),
     registration_mutex_(mutex_.enabled()),
+    registered_files_(config(ctx).get("io_uring", "registered_files",
+          static_cast<unsigned>(default_registered_files))),
+    free_registered_files_head_(0),
+    free_registered_files_count_(0),
     reactor_(use_service<reactor>(ctx)),
     reactor_data_(),
     event_fd_(-1)
 {
   reactor_.init_task();
   init_ring();
+  init_registered_files();
   register_with_reactor();
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+  init_wakeup_messages();
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
 }
 
 io_uring_service::~io_uring_service()
 {
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+  shutdown_wakeup_messages();
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
   if (ring_.ring_fd != -1)
     ::io_uring_queue_exit(&ring_);
   if (event_fd_ != -1)
@@ -98,6 +129,15 @@ void io_uring_service::shutdown()
       break;
   }
 
+  // Release the ring's references to registered files, so that descriptors
+  // closed after shutdown are closed immediately.
+  if (registered_files_ > 0)
+  {
+    ::io_uring_unregister_files(&ring_);
+    registered_files_ = 0;
+    free_registered_files_count_ = 0;
+  }
+
   timer_queues_.get_all_timers(ops);
 
   scheduler_.abandon_operations(ops);
@@ -149,7 +189,9 @@ void io_uring_service::notify_fork(
           break;
         if (void* ptr = ::io_uring_cqe_get_data(cqe))
         {
-          if (ptr != this && ptr != &timer_queues_ && ptr != &timeout_)
+          if (ptr != this && ptr != &timer_queues_ && ptr != &timeout_
+              && ptr != &ring_
+              && (reinterpret_cast<std::size_t>(ptr) & 1) == 0)
           {
             io_queue* io_q = static_cast<io_queue*>(ptr);
             io_q->set_result(cqe->res);
@@ -172,9 +214,19 @@ void io_uring_service::notify_fork(
 
   case asio::execution_context::fork_child:
     {
-      // The child process gets a new io_uring instance.
+      // The child process gets a new io_uring instance, with a new registered
+      // file table containing the existing I/O objects' descriptors.
       ::io_uring_queue_exit(&ring_);
       init_ring();
+      init_registered_files();
+      mutex::scoped_lock registration_lock(registration_mutex_);
+      for (io_object* io_obj = registered_io_objects_.first();
+          io_obj != 0; io_obj = io_obj->next_)
+      {
+        io_obj->registered_file_ = -1;
+        register_file(io_obj);
+      }
+      registration_lock.unlock();
       register_with_reactor();
     }
     break;
@@ -189,7 +241,7 @@ void io_uring_service::init_task()
 }
 
 void io_uring_service::register_io_object(
-    io_uring_service::per_io_object_data& io_obj)
+    io_uring_service::per_io_object_data& io_obj, int descriptor)
 {
   io_obj = allocate_io_object();
 
@@ -197,11 +249,16 @@ void io_uring_service::register_io_object(
 
   io_obj->service_ = this;
   io_obj->shutdown_ = false;
+  io_obj->descriptor_ = descriptor;
+  io_obj->registered_file_ = -1;
   for (int i = 0; i < max_ops; ++i)
   {
     io_obj->queues_[i].io_object_ = io_obj;
     io_obj->queues_[i].cancel_requested_ = false;
   }
+
+  mutex::scoped_lock registration_lock(registration_mutex_);
+  register_file(io_obj);
 }
 
 void io_uring_service::register_internal_io_object(
@@ -214,6 +271,8 @@ void io_uring_service::register_internal_io_object(
 
   io_obj->service_ = this;
   io_obj->shutdown_ = false;
+  io_obj->descriptor_ = -1;
+  io_obj->registered_file_ = -1;
   for (int i = 0; i < max_ops; ++i)
   {
     io_obj->queues_[i].io_object_ = io_obj;
@@ -225,7 +284,7 @@ void io_uring_service::register_internal_io_object(
   mutex::scoped_lock lock(mutex_);
   if (::io_uring_sqe* sqe = get_sqe())
   {
-    op->prepare(sqe);
+    prepare_sqe(io_obj, op, sqe);
     ::io_uring_sqe_set_data(sqe, &io_obj->queues_[op_type]);
     post_submit_sqes_op(lock);
   }
@@ -287,7 +346,7 @@ void io_uring_service::start_op(int op_type,
       mutex::scoped_lock lock(mutex_);
       if (::io_uring_sqe* sqe = get_sqe())
       {
-        op->prepare(sqe);
+        prepare_sqe(io_obj, op, sqe);
         ::io_uring_sqe_set_data(sqe, &io_obj->queues_[op_type]);
         scheduler_.work_started();
         post_submit_sqes_op(lock);
@@ -379,6 +438,13 @@ void io_uring_service::deregister_io_object(
     op_queue<operation> ops;
     do_cancel_ops(io_obj, ops);
     io_obj->shutdown_ = true;
+    if (io_obj->registered_file_ >= 0)
+    {
+      // The registered file must be released before the caller closes the
+      // descriptor, as the ring otherwise keeps the file open.
+      mutex::scoped_lock registration_lock(registration_mutex_);
+      unregister_file(io_obj);
+    }
     io_object_lock.unlock();
     scheduler_.post_deferred_completions(ops);
 
@@ -407,6 +473,21 @@ void io_uring_service::run(long usec, op_queue<operation>& ops)
 {
   __kernel_timespec ts;
   int local_ops = 0;
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+  void* wakeup_message_tag = &get_wakeup_registry();
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
+
+  // Interrupts requested from this point on must wake the wait below. Any
+  // earlier interrupt is already on its way to the ring.
+  interrupt_coalescer_.reset();
+
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+  // Record this service as the owner of the calling thread's ring, so that
+  // wakeups for other services can be sent from it.
+  if (thread_info_base* this_thread =
+      thread_context::top_of_thread_call_stack())
+    static_cast<scheduler_thread_info*>(this_thread)->last_task = this;
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
 
   if (usec > 0)
   {
@@ -422,6 +503,13 @@ void io_uring_service::run(long usec, op_queue<operation>& ops)
     }
   }
 
+#if defined(IORING_SETUP_DEFER_TASKRUN)
+  // Deferred task work must be run explicitly before completions can be
+  // observed without waiting.
+  if (usec == 0 && (ring_flags_ & IORING_SETUP_DEFER_TASKRUN) != 0)
+    ::io_uring_get_events(&ring_);
+#endif // defined(IORING_SETUP_DEFER_TASKRUN)
+
   ::io_uring_cqe* cqe = 0;
   int result = (usec == 0)
     ? ::io_uring_peek_cqe(&ring_, &cqe)
@@ -441,43 +529,73 @@ void io_uring_service::run(long usec, op_queue<operation>& ops)
     }
   }
 
+  // Harvest all available completions in chunks, marking each chunk as seen
+  // with a single update of the completion queue head. Keep going past the
+  // batch limit if the local timeout is still outstanding, as it refers to
+  // storage on this stack frame.
   bool check_timers = false;
   int count = 0;
+  int message_count = 0;
   while (result == 0)
   {
-    if (void* ptr = ::io_uring_cqe_get_data(cqe))
+    unsigned max_cqes = complete_chunk_size;
+    if (local_ops == 0 && complete_batch_size_ - count < complete_chunk_size)
+      max_cqes = complete_batch_size_ > count
+        ? static_cast<unsigned>(complete_batch_size_ - count) : 1;
+
+    ::io_uring_cqe* cqes[complete_chunk_size];
+    unsigned num_cqes = ::io_uring_peek_batch_cqe(&ring_, cqes, max_cqes);
+    for (unsigned i = 0; i < num_cqes; ++i)
     {
-      if (ptr == this)
-      {
-        // The io_uring service was interrupted.
-      }
-      else if (ptr == &timer_queues_)
+      if (void* ptr = ::io_uring_cqe_get_data(cqes[i]))
       {
-        check_timers = true;
-      }
-      else if (ptr == &timeout_)
-      {
-        check_timers = true;
-        timeout_.tv_sec = 0;
-        timeout_.tv_nsec = 0;
-      }
-      else if (ptr == &ts)
-      {
-        --local_ops;
-      }
-      else
-      {
-        io_queue* io_q = static_cast<io_queue*>(ptr);
-        io_q->set_result(cqe->res);
-        ops.push(io_q);
+        if (ptr == this)
+        {
+          // The io_uring service was interrupted.
+        }
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+        else if (ptr == wakeup_message_tag)
+        {
+          // The io_uring service was interrupted by a message from another
+          // ring. This is not counted as outstanding work as the message was
+          // not submitted to this ring.
+          ++message_count;
+        }
+        else if ((reinterpret_cast<std::size_t>(ptr) & 1) != 0)
+        {
+          wakeup_message_sent(ptr, cqes[i]->res);
+        }
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
+        else if (ptr == &timer_queues_)
+        {
+          check_timers = true;
+        }
+        else if (ptr == &timeout_)
+        {
+          check_timers = true;
+          timeout_.tv_sec = 0;
+          timeout_.tv_nsec = 0;
+        }
+        else if (ptr == &ts)
+        {
+          --local_ops;
+        }
+        else
+        {
+          io_queue* io_q = static_cast<io_queue*>(ptr);
+          io_q->set_result(cqes[i]->res);
+          ops.push(io_q);
+        }
       }
     }
-    ::io_uring_cqe_seen(&ring_, cqe);
-    result = (++count < complete_batch_size || local_ops > 0)
-      ? ::io_uring_peek_cqe(&ring_, &cqe) : -EAGAIN;
+    ::io_uring_cq_advance(&ring_, num_cqes);
+    count += static_cast<int>(num_cqes);
+
+    result = (num_cqes > 0 && (count < complete_batch_size_ || local_ops > 0))
+      ? 0 : -EAGAIN;
   }
 
-  decrement(outstanding_work_, count);
+  decrement(outstanding_work_, count - message_count);
 
   if (check_timers)
   {
@@ -497,6 +615,20 @@ void io_uring_service::run(long usec, op_queue<operation>& ops)
 }
 
 void io_uring_service::interrupt()
+{
+  if (!interrupt_coalescer_.begin_interrupt())
+    return;
+
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+  if (io_uring_service* source = thread_ring_service())
+    if (source != this && source->send_wakeup_message(this))
+      return;
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
+
+  do_interrupt();
+}
+
+void io_uring_service::do_interrupt()
 {
   mutex::scoped_lock lock(mutex_);
   if (::io_uring_sqe* sqe = get_sqe())
@@ -507,9 +639,67 @@ void io_uring_service::interrupt()
   submit_sqes();
 }
 
+unsigned io_uring_service::get_ring_flags(const config& cfg)
+{
+  unsigned flags = 0;
+
+  if (cfg.get("io_uring", "sqpoll", false))
+    flags |= IORING_SETUP_SQPOLL;
+
+  // The kernel binds a single-issuer ring to the thread that creates it, and
+  // fails submissions from any other thread. Even a non-locking concurrency
+  // hint allows the io_context to be run by a thread other than the one that
+  // created it, so this flag, and those that depend on it, are opt-in.
+#if defined(IORING_SETUP_SINGLE_ISSUER)
+  if (cfg.get("io_uring", "single_issuer", false))
+    flags |= IORING_SETUP_SINGLE_ISSUER;
+#endif // defined(IORING_SETUP_SINGLE_ISSUER)
+
+  // Task work is only run when the issuing thread enters the kernel to wait
+  // on the ring, so the following flags cannot be used when completions are
+  // being signalled via an eventfd to some other reactor.
+#if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+# if defined(IORING_SETUP_COOP_TASKRUN)
+  if (cfg.get("io_uring", "coop_taskrun", false))
+    flags |= IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG;
+# endif // defined(IORING_SETUP_COOP_TASKRUN)
+# if defined(IORING_SETUP_DEFER_TASKRUN)
+  if ((flags & IORING_SETUP_SINGLE_ISSUER) != 0
+      && cfg.get("io_uring", "defer_taskrun", false))
+    flags |= IORING_SETUP_DEFER_TASKRUN;
+# endif // defined(IORING_SETUP_DEFER_TASKRUN)
+#endif // defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+
+  return flags;
+}
+
 void io_uring_service::init_ring()
 {
-  int result = ::io_uring_queue_init(ring_size, &ring_, 0);
+  ::io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  params.flags = ring_flags_;
+  if ((ring_flags_ & IORING_SETUP_SQPOLL) != 0)
+  {
+    params.sq_thread_idle = sqpoll_idle_ms_;
+    if (sqpoll_cpu_ >= 0)
+    {
+      params.flags |= IORING_SETUP_SQ_AFF;
+      params.sq_thread_cpu = static_cast<unsigned>(sqpoll_cpu_);
+    }
+  }
+
+  int result = ::io_uring_queue_init_params(ring_size_, &ring_, &params);
+
+  // Older kernels reject the optional single-threaded optimisations. Fall
+  // back to a ring without them, rather than failing.
+  const unsigned optional_flags = ring_flags_ & ~IORING_SETUP_SQPOLL;
+  if (result == -EINVAL && optional_flags != 0)
+  {
+    ring_flags_ &= ~optional_flags;
+    params.flags &= ~optional_flags;
+    result = ::io_uring_queue_init_params(ring_size_, &ring_, &params);
+  }
+
   if (result < 0)
   {
     ring_.ring_fd = -1;
@@ -540,6 +730,125 @@ void io_uring_service::init_ring()
 #endif // !defined(ASIO_HAS_IO_URING_AS_DEFAULT)
 }
 
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+struct io_uring_service::wakeup_registry
+{
+  // Mutex used for protecting the registry.
+  static_mutex mutex_;
+
+  // The registered services.
+  io_uring_service* first_;
+
+  // The identifier to be given to the next registered service.
+  std::size_t next_id_;
+};
+
+io_uring_service::wakeup_registry& io_uring_service::get_wakeup_registry()
+{
+  static wakeup_registry registry = { ASIO_STATIC_MUTEX_INIT, 0, 1 };
+  return registry;
+}
+
+void io_uring_service::init_wakeup_messages()
+{
+  // Messages are sent only if the kernel supports them, and only from rings
+  // without an SQPOLL thread. Otherwise the message may be issued after this
+  // call returns, when the target's ring may already have been closed.
+  if (msg_ring_wakeups_)
+  {
+    msg_ring_wakeups_ = false;
+    if ((ring_flags_ & IORING_SETUP_SQPOLL) == 0)
+    {
+      if (::io_uring_probe* probe = ::io_uring_get_probe_ring(&ring_))
+      {
+        msg_ring_wakeups_ =
+          ::io_uring_opcode_supported(probe, IORING_OP_MSG_RING) != 0;
+        ::io_uring_free_probe(probe);
+      }
+    }
+  }
+
+  wakeup_registry& registry = get_wakeup_registry();
+  registry.mutex_.init();
+  static_mutex::scoped_lock lock(registry.mutex_);
+  wakeup_id_ = registry.next_id_++;
+  wakeup_next_ = registry.first_;
+  wakeup_prev_ = 0;
+  if (registry.first_)
+    registry.first_->wakeup_prev_ = this;
+  registry.first_ = this;
+}
+
+void io_uring_service::shutdown_wakeup_messages()
+{
+  wakeup_registry& registry = get_wakeup_registry();
+  static_mutex::scoped_lock lock(registry.mutex_);
+  if (registry.first_ == this)
+    registry.first_ = wakeup_next_;
+  if (wakeup_prev_)
+    wakeup_prev_->wakeup_next_ = wakeup_next_;
+  if (wakeup_next_)
+    wakeup_next_->wakeup_prev_ = wakeup_prev_;
+  wakeup_next_ = 0;
+  wakeup_prev_ = 0;
+}
+
+io_uring_service* io_uring_service::thread_ring_service()
+{
+  // When io_uring is the default backend, every scheduler task is an
+  // io_uring_service.
+  if (thread_info_base* this_thread =
+      thread_context::top_of_thread_call_stack())
+    return static_cast<io_uring_service*>(
+        static_cast<scheduler_thread_info*>(this_thread)->last_task);
+  return 0;
+}
+
+bool io_uring_service::send_wakeup_message(io_uring_service* target)
+{
+  mutex::scoped_lock lock(mutex_);
+  if (!msg_ring_wakeups_ || shutdown_)
+    return false;
+
+  if (::io_uring_sqe* sqe = get_sqe())
+  {
+    // The target sees the message as a completion tagged with the address of
+    // the registry. The completion on this ring is tagged with the target's
+    // registry identifier, shifted and with the low bit set, so that failures
+    // can be handled. The message is issued by the submission below, while
+    // the caller keeps the target, and so its ring, alive.
+    ::io_uring_prep_msg_ring(sqe, target->ring_.ring_fd, 0,
+        reinterpret_cast<__u64>(&get_wakeup_registry()), 0);
+    ::io_uring_sqe_set_data(sqe,
+        reinterpret_cast<void*>((target->wakeup_id_ << 1) | 1));
+    submit_sqes();
+    return true;
+  }
+
+  return false;
+}
+
+void io_uring_service::wakeup_message_sent(void* ptr, int result)
+{
+  if (result < 0)
+  {
+    // Fall back to a no-op interrupt, if the target still exists. The
+    // registry's lock keeps the target from being destroyed meanwhile.
+    std::size_t id = reinterpret_cast<std::size_t>(ptr) >> 1;
+    wakeup_registry& registry = get_wakeup_registry();
+    static_mutex::scoped_lock lock(registry.mutex_);
+    for (io_uring_service* s = registry.first_; s; s = s->wakeup_next_)
+    {
+      if (s->wakeup_id_ == id)
+      {
+        s->do_interrupt();
+        break;
+      }
+    }
+  }
+}
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
+
 #if !defined(ASIO_HAS_IO_URING_AS_DEFAULT)
 class io_uring_service::event_fd_read_op :
   public reactor_op
@@ -596,6 +905,72 @@ void io_uring_service::register_with_reactor()
 #endif // !defined(ASIO_HAS_IO_URING_AS_DEFAULT)
 }
 
+void io_uring_service::init_registered_files()
+{
+  free_registered_files_.clear();
+  free_registered_files_head_ = 0;
+  free_registered_files_count_ = 0;
+
+#if defined(IORING_RSRC_REGISTER_SPARSE)
+  if (registered_files_ > 0)
+  {
+    if (::io_uring_register_files_sparse(&ring_, registered_files_) == 0)
+    {
+      free_registered_files_.resize(registered_files_);
+      for (unsigned i = 0; i < registered_files_; ++i)
+        free_registered_files_[i] = static_cast<int>(i);
+      free_registered_files_count_ = registered_files_;
+    }
+    else
+    {
+      // Not supported by the kernel, or the table exceeds the process's
+      // descriptor limit. Fall back to using plain descriptors.
+      registered_files_ = 0;
+    }
+  }
+#else // defined(IORING_RSRC_REGISTER_SPARSE)
+  registered_files_ = 0;
+#endif // defined(IORING_RSRC_REGISTER_SPARSE)
+}
+
+void io_uring_service::register_file(io_object* io_obj)
+{
+  if (io_obj->descriptor_ < 0 || free_registered_files_count_ == 0)
+    return;
+
+  int slot = free_registered_files_[free_registered_files_head_];
+  int result = ::io_uring_register_files_update(&ring_,
+      static_cast<unsigned>(slot), &io_obj->descriptor_, 1);
+  if (result == 1)
+  {
+    free_registered_files_head_ =
+      (free_registered_files_head_ + 1) % free_registered_files_.size();
+    --free_registered_files_count_;
+    io_obj->registered_file_ = slot;
+  }
+}
+
+void io_uring_service::unregister_file(io_object* io_obj)
+{
+  // Flush any pending submission queue entries that refer to the slot, so
+  // that they are resolved against this I/O object's file.
+  {
+    mutex::scoped_lock lock(mutex_);
+    submit_sqes();
+  }
+
+  int slot = io_obj->registered_file_;
+  int no_file = -1;
+  ::io_uring_register_files_update(&ring_,
+      static_cast<unsigned>(slot), &no_file, 1);
+  io_obj->registered_file_ = -1;
+
+  std::size_t tail = (free_registered_files_head_
+      + free_registered_files_count_) % free_registered_files_.size();
+  free_registered_files_[tail] = slot;
+  ++free_registered_files_count_;
+}
+
 io_uring_service::io_object* io_uring_service::allocate_io_object()
 {
   mutex::scoped_lock registration_lock(registration_mutex_);
@@ -706,7 +1081,7 @@ void io_uring_service::submit_sqes()
 
 void io_uring_service::post_submit_sqes_op(mutex::scoped_lock& lock)
 {
-  if (pending_sqes_ >= submit_batch_size)
+  if (pending_sqes_ >= submit_batch_size_)
   {
     submit_sqes();
   }
@@ -828,7 +1203,7 @@ operation* io_uring_service::io_queue::perform_io(int result)
     mutex::scoped_lock lock(service->mutex_);
     if (::io_uring_sqe* sqe = service->get_sqe())
     {
-      op_queue_.front()->prepare(sqe);
+      prepare_sqe(io_object_, op_queue_.front(), sqe);
       ::io_uring_sqe_set_data(sqe, this);
       service->post_submit_sqes_op(lock);
     }
@@ -173,7 +173,7 @@ asio::error_code io_uring_socket_service_base::do_open(
   if (sock.get() == invalid_socket)
     return ec;
 
-  io_uring_service_.register_io_object(impl.io_object_data_);
+  io_uring_service_.register_io_object(impl.io_object_data_, sock.get());
 
   impl.socket_ = sock.release();
   switch (type)
@@ -197,7 +197,7 @@ asio::error_code io_uring_socket_service_base::do_assign(
     return ec;
   }
 
-  io_uring_service_.register_io_object(impl.io_object_data_);
+  io_uring_service_.register_io_object(impl.io_object_data_, native_socket);
 
   impl.socket_ = native_socket;
   switch (type)
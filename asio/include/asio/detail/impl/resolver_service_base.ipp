@@ -23,30 +23,10 @@
 namespace asio {
 namespace detail {
 
-class resolver_service_base::work_scheduler_runner
-{
-public:
-  work_scheduler_runner(scheduler_impl& work_scheduler)
-    : work_scheduler_(work_scheduler)
-  {
-  }
-
-  void operator()()
-  {
-    asio::error_code ec;
-    work_scheduler_.run(ec);
-  }
-
-private:
-  scheduler_impl& work_scheduler_;
-};
-
 resolver_service_base::resolver_service_base(execution_context& context)
   : scheduler_(asio::use_service<scheduler_impl>(context)),
-    work_scheduler_(new scheduler_impl(context, -1, false)),
-    work_thread_(0)
+    offload_service_(asio::use_service<blocking_offload_service>(context))
 {
-  work_scheduler_->work_started();
 }
 
 resolver_service_base::~resolver_service_base()
@@ -56,35 +36,12 @@ resolver_service_base::~resolver_service_base()
 
 void resolver_service_base::base_shutdown()
 {
-  if (work_scheduler_.get())
-  {
-    work_scheduler_->work_finished();
-    work_scheduler_->stop();
-    if (work_thread_.get())
-    {
-      work_thread_->join();
-      work_thread_.reset();
-    }
-    work_scheduler_.reset();
-  }
+  // Operations that have not been run are destroyed by the offload service.
 }
 
-void resolver_service_base::base_notify_fork(
-    execution_context::fork_event fork_ev)
+void resolver_service_base::base_notify_fork(execution_context::fork_event)
 {
-  if (work_thread_.get())
-  {
-    if (fork_ev == execution_context::fork_prepare)
-    {
-      work_scheduler_->stop();
-      work_thread_->join();
-      work_thread_.reset();
-    }
-  }
-  else if (fork_ev != execution_context::fork_prepare)
-  {
-    work_scheduler_->restart();
-  }
+  // Threads are stopped and restarted by the offload service.
 }
 
 void resolver_service_base::construct(
@@ -129,9 +86,12 @@ void resolver_service_base::start_resolve_op(resolve_op* op)
   if (ASIO_CONCURRENCY_HINT_IS_LOCKING(SCHEDULER,
         scheduler_.concurrency_hint()))
   {
-    start_work_thread();
     scheduler_.work_started();
-    work_scheduler_->post_immediate_completion(op, false);
+    if (!offload_service_.start_op(op))
+    {
+      op->ec_ = asio::error::host_not_found_try_again;
+      scheduler_.post_deferred_completion(op);
+    }
   }
   else
   {
@@ -140,16 +100,6 @@ void resolver_service_base::start_resolve_op(resolve_op* op)
   }
 }
 
-void resolver_service_base::start_work_thread()
-{
-  asio::detail::mutex::scoped_lock lock(mutex_);
-  if (!work_thread_.get())
-  {
-    work_thread_.reset(new asio::detail::thread(
-          work_scheduler_runner(*work_scheduler_)));
-  }
-}
-
 } // namespace detail
 } // namespace asio
 
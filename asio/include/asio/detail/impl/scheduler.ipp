@@ -17,6 +17,8 @@
 
 #include "asio/detail/config.hpp"
 
+#include "asio/config.hpp"
+#include "asio/detail/chrono.hpp"
 #include "asio/detail/concurrency_hint.hpp"
 #include "asio/detail/event.hpp"
 #include "asio/detail/limits.hpp"
@@ -53,21 +55,46 @@ private:
   scheduler* this_;
 };
 
+struct scheduler::single_thread_context
+{
+#if defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+  single_thread_context(scheduler* s, thread_info& this_thread)
+    : scheduler_(s),
+      next_(s->single_thread_info_)
+  {
+    if (scheduler_->single_threaded_)
+      scheduler_->single_thread_info_ = &this_thread;
+  }
+
+  ~single_thread_context()
+  {
+    if (scheduler_->single_threaded_)
+      scheduler_->single_thread_info_ = next_;
+  }
+
+  scheduler* scheduler_;
+  thread_info_base* next_;
+#else // defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+  single_thread_context(scheduler*, thread_info&)
+  {
+  }
+#endif // defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+};
+
 struct scheduler::task_cleanup
 {
   ~task_cleanup()
   {
     if (this_thread_->private_outstanding_work > 0)
     {
-      asio::detail::increment(
-          scheduler_->outstanding_work_,
-          this_thread_->private_outstanding_work);
+      scheduler_->increment_work(this_thread_->private_outstanding_work);
     }
     this_thread_->private_outstanding_work = 0;
 
     // Enqueue the completed operations and reinsert the task at the end of
     // the operation queue.
     lock_->lock();
+    scheduler_->task_poll_finished();
     scheduler_->task_interrupted_ = true;
     scheduler_->op_queue_.push(this_thread_->private_op_queue);
     scheduler_->op_queue_.push(&scheduler_->task_operation_);
@@ -84,9 +111,7 @@ struct scheduler::work_cleanup
   {
     if (this_thread_->private_outstanding_work > 1)
     {
-      asio::detail::increment(
-          scheduler_->outstanding_work_,
-          this_thread_->private_outstanding_work - 1);
+      scheduler_->increment_work(this_thread_->private_outstanding_work - 1);
     }
     else if (this_thread_->private_outstanding_work < 1)
     {
@@ -108,6 +133,127 @@ struct scheduler::work_cleanup
   thread_info* this_thread_;
 };
 
+struct scheduler::task_poll_cleanup
+{
+  ~task_poll_cleanup()
+  {
+    if (this_thread_->private_outstanding_work > 0)
+    {
+      scheduler_->increment_work(this_thread_->private_outstanding_work);
+    }
+    this_thread_->private_outstanding_work = 0;
+
+    // Enqueue the completed operations. If another thread dequeued the task
+    // operation while the task was being polled, reinsert it at the end of
+    // the operation queue.
+    lock_->lock();
+    scheduler_->task_poll_finished();
+    scheduler_->task_polling_ = false;
+    scheduler_->op_queue_.push(this_thread_->private_op_queue);
+    if (scheduler_->task_deferred_)
+    {
+      scheduler_->task_deferred_ = false;
+      scheduler_->op_queue_.push(&scheduler_->task_operation_);
+      if (!scheduler_->one_thread_)
+        if (scheduler_->wakeup_event_.maybe_unlock_and_signal_one(*lock_))
+          lock_->lock();
+    }
+  }
+
+  scheduler* scheduler_;
+  mutex::scoped_lock* lock_;
+  thread_info* this_thread_;
+};
+
+struct scheduler::batch_cleanup
+{
+  ~batch_cleanup()
+  {
+    // Each handler that was started has consumed one unit of work.
+    long work = this_thread_->private_outstanding_work
+      - static_cast<long>(next_);
+    this_thread_->private_outstanding_work = 0;
+    if (work > 0)
+    {
+      scheduler_->increment_work(work);
+    }
+    else if (work < 0)
+    {
+      scheduler_->decrement_work(-work - 1);
+      scheduler_->work_finished();
+    }
+
+    // If a handler exited via an exception, return the handlers that have not
+    // been started to the front of the queue.
+    if (next_ < count_)
+    {
+      op_queue<operation> ops;
+      while (next_ < count_)
+        ops.push(ops_[next_++]);
+      lock_->lock();
+      ops.push(scheduler_->op_queue_);
+      scheduler_->op_queue_.push(ops);
+      scheduler_->op_queue_.push(this_thread_->private_op_queue);
+      scheduler_->wake_one_thread_and_unlock(*lock_);
+      return;
+    }
+
+#if defined(ASIO_HAS_THREADS)
+    if (!this_thread_->private_op_queue.empty())
+    {
+      lock_->lock();
+      scheduler_->op_queue_.push(this_thread_->private_op_queue);
+    }
+#endif // defined(ASIO_HAS_THREADS)
+  }
+
+  scheduler* scheduler_;
+  mutex::scoped_lock* lock_;
+  thread_info* this_thread_;
+  operation** ops_;
+  std::size_t count_;
+  std::size_t next_;
+};
+
+struct scheduler::task_shard_cleanup
+{
+  ~task_shard_cleanup()
+  {
+    if (this_thread_->private_outstanding_work > 0)
+    {
+      scheduler_->increment_work(this_thread_->private_outstanding_work);
+    }
+    this_thread_->private_outstanding_work = 0;
+
+    // Enqueue the completed operations.
+    lock_->lock();
+    scheduler_->task_shards_[shard_].waiting = false;
+    scheduler_->op_queue_.push(this_thread_->private_op_queue);
+  }
+
+  scheduler* scheduler_;
+  mutex::scoped_lock* lock_;
+  thread_info* this_thread_;
+  std::size_t shard_;
+};
+
+struct scheduler::task_shard_release
+{
+  ~task_shard_release()
+  {
+    if (this_thread_->task_shard != 0)
+    {
+      lock_->lock();
+      scheduler_->task_shards_[this_thread_->task_shard - 1].owned = false;
+      this_thread_->task_shard = 0;
+    }
+  }
+
+  scheduler* scheduler_;
+  mutex::scoped_lock* lock_;
+  thread_info* this_thread_;
+};
+
 scheduler::scheduler(asio::execution_context& ctx,
     int concurrency_hint, bool own_thread, get_task_func_type get_task)
   : asio::detail::execution_context_service_base<scheduler>(ctx),
@@ -116,15 +262,41 @@ scheduler::scheduler(asio::execution_context& ctx,
           SCHEDULER, concurrency_hint)
         || !ASIO_CONCURRENCY_HINT_IS_LOCKING(
           REACTOR_IO, concurrency_hint)),
+#if defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+    single_threaded_(!own_thread
+        && !ASIO_CONCURRENCY_HINT_IS_LOCKING(
+          SCHEDULER, concurrency_hint)),
+    single_thread_info_(0),
+#endif // defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
     mutex_(ASIO_CONCURRENCY_HINT_IS_LOCKING(
           SCHEDULER, concurrency_hint)),
+    wakeup_event_(get_max_spin(ctx, concurrency_hint)),
     task_(0),
     get_task_(get_task),
     task_interrupted_(true),
+    task_shard_count_(0),
+    task_shards_(0),
     outstanding_work_(0),
+    priority_ops_(0),
+    priority_aging_(config(ctx).get("scheduler", "priority_aging", 0u)),
+    priority_run_(0),
     stopped_(false),
     shutdown_(false),
     concurrency_hint_(concurrency_hint),
+    batch_size_(get_batch_size(ctx)),
+    handler_budget_(config(ctx).get("scheduler", "handler_budget", 0u)),
+    handler_budget_usec_(
+        config(ctx).get("scheduler", "handler_budget_usec", 0u)),
+    timing_(handler_budget_usec_ != 0
+        || config(ctx).get("scheduler", "statistics", false)),
+    task_polling_(false),
+    task_deferred_(false),
+    handlers_since_task_poll_(0),
+    task_poll_end_usec_(timing_ ? now_usec() : 0),
+    task_polls_(0),
+    forced_task_polls_(0),
+    task_interrupts_(0),
+    task_interrupts_coalesced_(0),
     thread_(0)
 {
   ASIO_HANDLER_TRACKING_INIT;
@@ -148,6 +320,8 @@ scheduler::~scheduler()
     thread_->join();
     delete thread_;
   }
+
+  delete[] task_shards_;
 }
 
 void scheduler::shutdown()
@@ -167,6 +341,9 @@ void scheduler::shutdown()
   }
 
   // Destroy handler objects.
+  for (std::size_t i = 0; i < max_priority; ++i)
+    op_queue_.push(priority_queues_[i]);
+  priority_ops_ = 0;
   while (!op_queue_.empty())
   {
     operation* o = op_queue_.front();
@@ -177,6 +354,7 @@ void scheduler::shutdown()
 
   // Reset to initial state.
   task_ = 0;
+  task_shard_count_ = 0;
 }
 
 void scheduler::init_task()
@@ -185,6 +363,16 @@ void scheduler::init_task()
   if (!shutdown_ && !task_)
   {
     task_ = get_task_(this->context());
+    task_shard_count_ = one_thread_ ? 0 : task_->shard_count();
+    if (task_shard_count_ > 0)
+    {
+      task_shards_ = new task_shard[task_shard_count_];
+      for (std::size_t i = 0; i < task_shard_count_; ++i)
+      {
+        task_shards_[i].owned = false;
+        task_shards_[i].waiting = false;
+      }
+    }
     op_queue_.push(&task_operation_);
     wake_one_thread_and_unlock(lock);
   }
@@ -202,13 +390,21 @@ std::size_t scheduler::run(asio::error_code& ec)
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
   thread_call_stack::context ctx(this, this_thread);
+  single_thread_context single_ctx(this, this_thread);
 
   mutex::scoped_lock lock(mutex_);
+  task_shard_release release = { this, &lock, &this_thread };
+  (void)release;
 
   std::size_t n = 0;
-  for (; do_run_one(lock, this_thread, ec); lock.lock())
-    if (n != (std::numeric_limits<std::size_t>::max)())
-      ++n;
+  for (std::size_t r; (r = do_run_one(lock, this_thread, batch_size_, ec));
+      lock.lock())
+  {
+    if (r > (std::numeric_limits<std::size_t>::max)() - n)
+      n = (std::numeric_limits<std::size_t>::max)();
+    else
+      n += r;
+  }
   return n;
 }
 
@@ -224,10 +420,13 @@ std::size_t scheduler::run_one(asio::error_code& ec)
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
   thread_call_stack::context ctx(this, this_thread);
+  single_thread_context single_ctx(this, this_thread);
 
   mutex::scoped_lock lock(mutex_);
+  task_shard_release release = { this, &lock, &this_thread };
+  (void)release;
 
-  return do_run_one(lock, this_thread, ec);
+  return do_run_one(lock, this_thread, 1, ec);
 }
 
 std::size_t scheduler::wait_one(long usec, asio::error_code& ec)
@@ -242,12 +441,71 @@ std::size_t scheduler::wait_one(long usec, asio::error_code& ec)
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
   thread_call_stack::context ctx(this, this_thread);
+  single_thread_context single_ctx(this, this_thread);
 
   mutex::scoped_lock lock(mutex_);
 
   return do_wait_one(lock, this_thread, usec, ec);
 }
 
+std::size_t scheduler::run_until_idle(long usec, asio::error_code& ec)
+{
+  ec = asio::error_code();
+  if (outstanding_work_ == 0)
+  {
+    stop();
+    return 0;
+  }
+
+  thread_info this_thread;
+  this_thread.private_outstanding_work = 0;
+  thread_call_stack::context ctx(this, this_thread);
+  single_thread_context single_ctx(this, this_thread);
+
+  mutex::scoped_lock lock(mutex_);
+  task_shard_release release = { this, &lock, &this_thread };
+  (void)release;
+
+  std::size_t n = 0;
+  uint64_t idle_start = now_usec();
+  long remaining = usec;
+  for (;;)
+  {
+    if (do_wait_one(lock, this_thread, remaining, ec))
+    {
+      if (n != (std::numeric_limits<std::size_t>::max)())
+        ++n;
+      idle_start = now_usec();
+      remaining = usec;
+      lock.lock();
+    }
+    else
+    {
+      lock.lock();
+      if (stopped_)
+        return n;
+
+      // A wait may end early when another thread takes the operation that
+      // caused the wakeup, so only return once the full time has elapsed.
+      uint64_t idle = now_usec() - idle_start;
+      if (idle >= static_cast<uint64_t>(usec))
+        return n;
+      remaining = usec - static_cast<long>(idle);
+    }
+  }
+}
+
+bool scheduler::has_ready_handlers()
+{
+  mutex::scoped_lock lock(mutex_);
+  if (priority_ops_ != 0)
+    return true;
+  operation* o = op_queue_.front();
+  if (o == &task_operation_)
+    o = op_queue_access::next(o);
+  return o != 0;
+}
+
 std::size_t scheduler::poll(asio::error_code& ec)
 {
   ec = asio::error_code();
@@ -260,6 +518,7 @@ std::size_t scheduler::poll(asio::error_code& ec)
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
   thread_call_stack::context ctx(this, this_thread);
+  single_thread_context single_ctx(this, this_thread);
 
   mutex::scoped_lock lock(mutex_);
 
@@ -291,6 +550,7 @@ std::size_t scheduler::poll_one(asio::error_code& ec)
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
   thread_call_stack::context ctx(this, this_thread);
+  single_thread_context single_ctx(this, this_thread);
 
   mutex::scoped_lock lock(mutex_);
 
@@ -324,20 +584,51 @@ void scheduler::restart()
   stopped_ = false;
 }
 
+void scheduler::get_statistics(scheduler_statistics& stats) const
+{
+  mutex::scoped_lock lock(mutex_);
+  stats.task_polls = task_polls_;
+  stats.forced_task_polls = forced_task_polls_;
+  stats.task_poll_intervals = task_poll_intervals_.count();
+  stats.task_poll_interval_p50_usec = task_poll_intervals_.percentile(50);
+  stats.task_poll_interval_p99_usec = task_poll_intervals_.percentile(99);
+  stats.task_poll_interval_max_usec = task_poll_intervals_.max();
+
+  // Prefer the task's own counts, as it may suppress interrupts itself.
+  uint64_t sent = 0, suppressed = 0;
+  if (task_ && task_->get_interrupt_counts(sent, suppressed))
+  {
+    stats.task_interrupts_sent = sent;
+    stats.task_interrupts_suppressed = suppressed + task_interrupts_coalesced_;
+  }
+  else
+  {
+    stats.task_interrupts_sent = task_interrupts_;
+    stats.task_interrupts_suppressed = task_interrupts_coalesced_;
+  }
+}
+
 void scheduler::compensating_work_started()
 {
-  thread_info_base* this_thread = thread_call_stack::contains(this);
+  thread_info_base* this_thread = this_thread_info();
   ++static_cast<thread_info*>(this_thread)->private_outstanding_work;
 }
 
 bool scheduler::can_dispatch()
 {
-  return thread_call_stack::contains(this) != 0;
+  return this_thread_info() != 0;
+}
+
+std::size_t scheduler::current_task_shard()
+{
+  if (thread_info_base* this_thread = this_thread_info())
+    return static_cast<thread_info*>(this_thread)->task_shard;
+  return 0;
 }
 
 void scheduler::capture_current_exception()
 {
-  if (thread_info_base* this_thread = thread_call_stack::contains(this))
+  if (thread_info_base* this_thread = this_thread_info())
     this_thread->capture_current_exception();
 }
 
@@ -347,7 +638,7 @@ void scheduler::post_immediate_completion(
 #if defined(ASIO_HAS_THREADS)
   if (one_thread_ || is_continuation)
   {
-    if (thread_info_base* this_thread = thread_call_stack::contains(this))
+    if (thread_info_base* this_thread = this_thread_info())
     {
       ++static_cast<thread_info*>(this_thread)->private_outstanding_work;
       static_cast<thread_info*>(this_thread)->private_op_queue.push(op);
@@ -370,7 +661,7 @@ void scheduler::post_immediate_completions(std::size_t n,
 #if defined(ASIO_HAS_THREADS)
   if (one_thread_ || is_continuation)
   {
-    if (thread_info_base* this_thread = thread_call_stack::contains(this))
+    if (thread_info_base* this_thread = this_thread_info())
     {
       static_cast<thread_info*>(this_thread)->private_outstanding_work
         += static_cast<long>(n);
@@ -382,18 +673,37 @@ void scheduler::post_immediate_completions(std::size_t n,
   (void)is_continuation;
 #endif // defined(ASIO_HAS_THREADS)
 
-  increment(outstanding_work_, static_cast<long>(n));
+  increment_work(static_cast<long>(n));
   mutex::scoped_lock lock(mutex_);
   op_queue_.push(ops);
   wake_one_thread_and_unlock(lock);
 }
 
+void scheduler::post_priority_completion(
+    scheduler::operation* op, unsigned int priority)
+{
+  if (priority == 0)
+  {
+    post_immediate_completion(op, false);
+    return;
+  }
+
+  if (priority > max_priority)
+    priority = max_priority;
+
+  work_started();
+  mutex::scoped_lock lock(mutex_);
+  priority_queues_[priority - 1].push(op);
+  ++priority_ops_;
+  wake_one_thread_and_unlock(lock);
+}
+
 void scheduler::post_deferred_completion(scheduler::operation* op)
 {
 #if defined(ASIO_HAS_THREADS)
   if (one_thread_)
   {
-    if (thread_info_base* this_thread = thread_call_stack::contains(this))
+    if (thread_info_base* this_thread = this_thread_info())
     {
       static_cast<thread_info*>(this_thread)->private_op_queue.push(op);
       return;
@@ -414,7 +724,7 @@ void scheduler::post_deferred_completions(
 #if defined(ASIO_HAS_THREADS)
     if (one_thread_)
     {
-      if (thread_info_base* this_thread = thread_call_stack::contains(this))
+      if (thread_info_base* this_thread = this_thread_info())
       {
         static_cast<thread_info*>(this_thread)->private_op_queue.push(ops);
         return;
@@ -445,21 +755,34 @@ void scheduler::abandon_operations(
 }
 
 std::size_t scheduler::do_run_one(mutex::scoped_lock& lock,
-    scheduler::thread_info& this_thread,
+    scheduler::thread_info& this_thread, std::size_t max_handlers,
     const asio::error_code& ec)
 {
   while (!stopped_)
   {
-    if (!op_queue_.empty())
+    if (more_handlers())
     {
+      if (maybe_force_task_poll(lock, this_thread))
+        continue;
+
       // Prepare to execute first handler from queue.
+      promote_priority_op();
       operation* o = op_queue_.front();
       op_queue_.pop();
-      bool more_handlers = (!op_queue_.empty());
+      bool more_handlers = this->more_handlers();
 
       if (o == &task_operation_)
       {
+        if (task_polling_)
+        {
+          // Another thread is polling the task, and will requeue the task
+          // operation when it has finished.
+          task_deferred_ = true;
+          continue;
+        }
+
         task_interrupted_ = more_handlers;
+        task_poll_starting(false);
 
         if (more_handlers && !one_thread_)
           wakeup_event_.unlock_and_signal_one(lock);
@@ -477,6 +800,13 @@ std::size_t scheduler::do_run_one(mutex::scoped_lock& lock,
       else
       {
         std::size_t task_result = o->task_result_;
+        ++handlers_since_task_poll_;
+
+        if (more_handlers && max_handlers > 1)
+        {
+          return do_run_batch(lock, this_thread,
+              o, task_result, max_handlers, ec);
+        }
 
         if (more_handlers && !one_thread_)
           wake_one_thread_and_unlock(lock);
@@ -494,6 +824,18 @@ std::size_t scheduler::do_run_one(mutex::scoped_lock& lock,
         return 1;
       }
     }
+    else if (this_thread.task_shard != 0 || acquire_task_shard(this_thread))
+    {
+      std::size_t shard = this_thread.task_shard - 1;
+      task_shards_[shard].waiting = true;
+      lock.unlock();
+
+      task_shard_cleanup on_exit = { this, &lock, &this_thread, shard };
+      (void)on_exit;
+
+      // Wait on the thread's own shard of the task. May throw an exception.
+      task_->run_shard(shard, -1, this_thread.private_op_queue);
+    }
     else
     {
       wakeup_event_.clear(lock);
@@ -504,6 +846,52 @@ std::size_t scheduler::do_run_one(mutex::scoped_lock& lock,
   return 0;
 }
 
+std::size_t scheduler::do_run_batch(mutex::scoped_lock& lock,
+    scheduler::thread_info& this_thread, operation* o,
+    std::size_t task_result, std::size_t max_handlers,
+    const asio::error_code& ec)
+{
+  operation* ops[max_batch_size];
+  ops[0] = o;
+  std::size_t count = 1;
+
+  // Take further handlers from the front of the queue, stopping at the task
+  // so that it gets its turn. An operation carrying a task result may be
+  // requeued by the task as soon as it has been dequeued, so such operations
+  // are only ever dequeued one at a time.
+  while (count < max_handlers)
+  {
+    operation* next = op_queue_.front();
+    if (next == 0 || next == &task_operation_ || next->task_result_ != 0
+        || priority_ops_ != 0)
+      break;
+    op_queue_.pop();
+    ops[count++] = next;
+  }
+  handlers_since_task_poll_ += count - 1;
+
+  if (more_handlers() && !one_thread_)
+    wake_one_thread_and_unlock(lock);
+  else
+    lock.unlock();
+
+  // Ensure the count of outstanding work is adjusted, and any handlers that
+  // were not run are requeued, on block exit.
+  batch_cleanup on_exit = { this, &lock, &this_thread, ops, count, 1 };
+
+  // Complete the operations. May throw an exception. Deletes the objects.
+  o->complete(this, ec, task_result);
+  this_thread.rethrow_pending_exception();
+  while (on_exit.next_ < count)
+  {
+    o = ops[on_exit.next_++];
+    o->complete(this, ec, 0);
+    this_thread.rethrow_pending_exception();
+  }
+
+  return count;
+}
+
 std::size_t scheduler::do_wait_one(mutex::scoped_lock& lock,
     scheduler::thread_info& this_thread, long usec,
     const asio::error_code& ec)
@@ -511,21 +899,36 @@ std::size_t scheduler::do_wait_one(mutex::scoped_lock& lock,
   if (stopped_)
     return 0;
 
+  if (maybe_force_task_poll(lock, this_thread) && stopped_)
+    return 0;
+
+  promote_priority_op();
   operation* o = op_queue_.front();
   if (o == 0)
   {
     wakeup_event_.clear(lock);
     wakeup_event_.wait_for_usec(lock, usec);
     usec = 0; // Wait at most once.
+    promote_priority_op();
+    o = op_queue_.front();
+  }
+
+  if (o == &task_operation_ && task_polling_)
+  {
+    // Another thread is polling the task, and will requeue the task operation
+    // when it has finished.
+    op_queue_.pop();
+    task_deferred_ = true;
     o = op_queue_.front();
   }
 
   if (o == &task_operation_)
   {
     op_queue_.pop();
-    bool more_handlers = (!op_queue_.empty());
+    bool more_handlers = this->more_handlers();
 
     task_interrupted_ = more_handlers;
+    task_poll_starting(false);
 
     if (more_handlers && !one_thread_)
       wakeup_event_.unlock_and_signal_one(lock);
@@ -542,6 +945,7 @@ std::size_t scheduler::do_wait_one(mutex::scoped_lock& lock,
       task_->run(more_handlers ? 0 : usec, this_thread.private_op_queue);
     }
 
+    promote_priority_op();
     o = op_queue_.front();
     if (o == &task_operation_)
     {
@@ -555,9 +959,10 @@ std::size_t scheduler::do_wait_one(mutex::scoped_lock& lock,
     return 0;
 
   op_queue_.pop();
-  bool more_handlers = (!op_queue_.empty());
+  bool more_handlers = this->more_handlers();
 
   std::size_t task_result = o->task_result_;
+  ++handlers_since_task_poll_;
 
   if (more_handlers && !one_thread_)
     wake_one_thread_and_unlock(lock);
@@ -582,10 +987,24 @@ std::size_t scheduler::do_poll_one(mutex::scoped_lock& lock,
   if (stopped_)
     return 0;
 
+  if (maybe_force_task_poll(lock, this_thread) && stopped_)
+    return 0;
+
+  promote_priority_op();
   operation* o = op_queue_.front();
+  if (o == &task_operation_ && task_polling_)
+  {
+    // Another thread is polling the task, and will requeue the task operation
+    // when it has finished.
+    op_queue_.pop();
+    task_deferred_ = true;
+    o = op_queue_.front();
+  }
+
   if (o == &task_operation_)
   {
     op_queue_.pop();
+    task_poll_starting(false);
     lock.unlock();
 
     {
@@ -598,6 +1017,7 @@ std::size_t scheduler::do_poll_one(mutex::scoped_lock& lock,
       task_->run(0, this_thread.private_op_queue);
     }
 
+    promote_priority_op();
     o = op_queue_.front();
     if (o == &task_operation_)
     {
@@ -610,9 +1030,10 @@ std::size_t scheduler::do_poll_one(mutex::scoped_lock& lock,
     return 0;
 
   op_queue_.pop();
-  bool more_handlers = (!op_queue_.empty());
+  bool more_handlers = this->more_handlers();
 
   std::size_t task_result = o->task_result_;
+  ++handlers_since_task_poll_;
 
   if (more_handlers && !one_thread_)
     wake_one_thread_and_unlock(lock);
@@ -630,6 +1051,41 @@ std::size_t scheduler::do_poll_one(mutex::scoped_lock& lock,
   return 1;
 }
 
+void scheduler::do_promote_priority_op()
+{
+  // Find the highest priority with a queued operation, and whether any
+  // operations of lower priority are waiting.
+  std::size_t lane = max_priority;
+  while (priority_queues_[lane - 1].empty())
+    --lane;
+  std::size_t lowest = op_queue_.empty() ? lane : 0;
+  for (std::size_t i = 1; i < lane && lowest == lane; ++i)
+    if (!priority_queues_[i - 1].empty())
+      lowest = i;
+
+  if (lowest == lane)
+  {
+    priority_run_ = 0;
+  }
+  else if (priority_aging_ != 0 && ++priority_run_ > priority_aging_)
+  {
+    // Let the longest-starved operations have a turn.
+    priority_run_ = 0;
+    if (lowest == 0)
+      return;
+    lane = lowest;
+  }
+
+  operation* o = priority_queues_[lane - 1].front();
+  priority_queues_[lane - 1].pop();
+  --priority_ops_;
+
+  op_queue<operation> ops;
+  ops.push(o);
+  ops.push(op_queue_);
+  op_queue_.push(ops);
+}
+
 void scheduler::stop_all_threads(
     mutex::scoped_lock& lock)
 {
@@ -639,8 +1095,11 @@ void scheduler::stop_all_threads(
   if (!task_interrupted_ && task_)
   {
     task_interrupted_ = true;
+    ++task_interrupts_;
     task_->interrupt();
   }
+
+  interrupt_task_shards(true);
 }
 
 void scheduler::wake_one_thread_and_unlock(
@@ -651,12 +1110,47 @@ void scheduler::wake_one_thread_and_unlock(
     if (!task_interrupted_ && task_)
     {
       task_interrupted_ = true;
+      ++task_interrupts_;
       task_->interrupt();
     }
+    else
+    {
+      if (task_)
+        ++task_interrupts_coalesced_;
+      interrupt_task_shards(false);
+    }
     lock.unlock();
   }
 }
 
+bool scheduler::acquire_task_shard(scheduler::thread_info& this_thread)
+{
+  for (std::size_t i = 0; i < task_shard_count_; ++i)
+  {
+    if (!task_shards_[i].owned)
+    {
+      task_shards_[i].owned = true;
+      this_thread.task_shard = i + 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+void scheduler::interrupt_task_shards(bool all)
+{
+  for (std::size_t i = 0; i < task_shard_count_; ++i)
+  {
+    if (task_shards_[i].waiting)
+    {
+      task_shards_[i].waiting = false;
+      task_->interrupt_shard(i);
+      if (!all)
+        return;
+    }
+  }
+}
+
 scheduler_task* scheduler::get_default_task(asio::execution_context& ctx)
 {
 #if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
@@ -666,6 +1160,102 @@ scheduler_task* scheduler::get_default_task(asio::execution_context& ctx)
 #endif // defined(ASIO_HAS_IO_URING_AS_DEFAULT)
 }
 
+uint64_t scheduler::now_usec()
+{
+#if defined(ASIO_HAS_CHRONO)
+  return static_cast<uint64_t>(
+      chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+#else // defined(ASIO_HAS_CHRONO)
+  return 0;
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+bool scheduler::task_poll_due()
+{
+  // The task can only be polled if its operation is waiting in the queue
+  // behind other handlers.
+  if (task_polling_ || !task_
+      || (op_queue_.front() == &task_operation_ && priority_ops_ == 0)
+      || !op_queue_.is_enqueued(&task_operation_))
+    return false;
+
+  if (handler_budget_ != 0 && handlers_since_task_poll_ >= handler_budget_)
+    return true;
+
+  if (handler_budget_usec_ != 0)
+  {
+    uint64_t now = now_usec();
+    if (now - task_poll_end_usec_ >= handler_budget_usec_)
+      return true;
+  }
+
+  return false;
+}
+
+bool scheduler::maybe_force_task_poll(mutex::scoped_lock& lock,
+    scheduler::thread_info& this_thread)
+{
+  if (!may_force_task_poll() || !task_poll_due())
+    return false;
+
+  task_polling_ = true;
+  task_poll_starting(true);
+  lock.unlock();
+
+  task_poll_cleanup on_exit = { this, &lock, &this_thread };
+  (void)on_exit;
+
+  // The handler budget has been used up, so poll the task without waiting
+  // for its operation to reach the front of the queue. May throw an
+  // exception.
+  task_->run(0, this_thread.private_op_queue);
+  return true;
+}
+
+void scheduler::task_poll_starting(bool forced)
+{
+  handlers_since_task_poll_ = 0;
+  ++task_polls_;
+  if (forced)
+    ++forced_task_polls_;
+  if (timing_)
+  {
+    uint64_t now = now_usec();
+    task_poll_intervals_.record(now > task_poll_end_usec_
+        ? now - task_poll_end_usec_ : 0);
+  }
+}
+
+void scheduler::task_poll_finished()
+{
+  if (timing_)
+    task_poll_end_usec_ = now_usec();
+}
+
+std::size_t scheduler::get_max_spin(
+    asio::execution_context& ctx, int concurrency_hint)
+{
+  // Spinning is only useful if another thread can signal the spinning thread
+  // while it runs.
+  unsigned max_spin = config(ctx).get("scheduler", "max_spin", 0u);
+  if (max_spin == 0 || concurrency_hint == 1
+      || !ASIO_CONCURRENCY_HINT_IS_LOCKING(SCHEDULER, concurrency_hint)
+      || thread::hardware_concurrency() == 1)
+    return 0;
+  return max_spin;
+}
+
+std::size_t scheduler::get_batch_size(asio::execution_context& ctx)
+{
+  unsigned batch_size = config(ctx).get("scheduler", "batch_size", 1u);
+  if (batch_size < 1)
+    return 1;
+  if (batch_size > max_batch_size)
+    return max_batch_size;
+  return batch_size;
+}
+
 } // namespace detail
 } // namespace asio
 
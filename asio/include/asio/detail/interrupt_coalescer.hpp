@@ -0,0 +1,100 @@
+//
+// detail/interrupt_coalescer.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_INTERRUPT_COALESCER_HPP
+#define ASIO_DETAIL_INTERRUPT_COALESCER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/detail/atomic_count.hpp"
+#include "asio/detail/cstdint.hpp"
+#include "asio/detail/noncopyable.hpp"
+
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+# include <atomic>
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Tracks whether an interrupt has been sent to a task but not yet observed,
+// so that further interrupts can be suppressed until the task next waits.
+class interrupt_coalescer
+  : private noncopyable
+{
+public:
+  // Constructor.
+  interrupt_coalescer()
+    : pending_(false),
+      sent_(0),
+      suppressed_(0)
+  {
+  }
+
+  // Determine whether an interrupt must be sent. Returns false if one has
+  // already been sent since the task last called reset().
+  bool begin_interrupt()
+  {
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    if (pending_.exchange(true))
+    {
+      ++suppressed_;
+      return false;
+    }
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    ++sent_;
+    return true;
+  }
+
+  // Called by the task before it waits. Any interrupt requested after this
+  // point will be sent.
+  void reset()
+  {
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    pending_.store(false);
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+  // Get the number of interrupts that have been sent.
+  uint64_t sent() const
+  {
+    return static_cast<uint64_t>(static_cast<long>(sent_));
+  }
+
+  // Get the number of interrupts that have been suppressed.
+  uint64_t suppressed() const
+  {
+    return static_cast<uint64_t>(static_cast<long>(suppressed_));
+  }
+
+private:
+  // Whether an interrupt has been sent since the last reset.
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  std::atomic<bool> pending_;
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  bool pending_;
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
+  // The number of interrupts that have been sent and suppressed.
+  atomic_count sent_;
+  atomic_count suppressed_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_INTERRUPT_COALESCER_HPP
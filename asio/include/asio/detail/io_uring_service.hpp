@@ -20,9 +20,12 @@
 #if defined(ASIO_HAS_IO_URING)
 
 #include <liburing.h>
+#include <vector>
+#include "asio/config.hpp"
 #include "asio/detail/atomic_count.hpp"
 #include "asio/detail/buffer_sequence_adapter.hpp"
 #include "asio/detail/conditionally_enabled_mutex.hpp"
+#include "asio/detail/interrupt_coalescer.hpp"
 #include "asio/detail/io_uring_operation.hpp"
 #include "asio/detail/limits.hpp"
 #include "asio/detail/object_pool.hpp"
@@ -34,6 +37,18 @@
 #include "asio/detail/wait_op.hpp"
 #include "asio/execution_context.hpp"
 
+// IORING_OP_MSG_RING is supported by liburing 2.2 and later, which is also
+// the first version to define IORING_SETUP_COOP_TASKRUN.
+#if !defined(ASIO_HAS_IO_URING_MSG_RING)
+# if !defined(ASIO_DISABLE_IO_URING_MSG_RING)
+#  if defined(ASIO_HAS_IO_URING_AS_DEFAULT) \
+    && defined(IORING_SETUP_COOP_TASKRUN)
+#   define ASIO_HAS_IO_URING_MSG_RING 1
+#  endif // defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+         //   && defined(IORING_SETUP_COOP_TASKRUN)
+# endif // !defined(ASIO_DISABLE_IO_URING_MSG_RING)
+#endif // !defined(ASIO_HAS_IO_URING_MSG_RING)
+
 #include "asio/detail/push_options.hpp"
 
 namespace asio {
@@ -82,6 +97,13 @@ public:
     io_queue queues_[max_ops];
     bool shutdown_;
 
+    // The native descriptor, or -1 for internal I/O objects.
+    int descriptor_;
+
+    // The index of the descriptor in the registered file table, or -1 if the
+    // descriptor is not registered.
+    int registered_file_;
+
     ASIO_DECL io_object(bool locking);
   };
 
@@ -104,8 +126,9 @@ public:
   // Initialise the task.
   ASIO_DECL void init_task();
 
-  // Register an I/O object with io_uring.
-  ASIO_DECL void register_io_object(io_object*& io_obj);
+  // Register an I/O object with io_uring. If possible, the descriptor is
+  // also added to the ring's registered file table.
+  ASIO_DECL void register_io_object(io_object*& io_obj, int descriptor);
 
   // Register an internal I/O object with io_uring.
   ASIO_DECL void register_internal_io_object(
@@ -183,28 +206,99 @@ public:
   // dispatched.
   ASIO_DECL void run(long usec, op_queue<operation>& ops);
 
-  // Interrupt the io_uring wait.
+  // Interrupt the io_uring wait. When called from a thread that is running
+  // another io_uring-based context, the wakeup is sent from that context's
+  // ring using IORING_OP_MSG_RING, so that no submission is made to this
+  // service's ring.
   ASIO_DECL void interrupt();
 
+  // Get the number of interrupts sent and suppressed.
+  bool get_interrupt_counts(uint64_t& sent, uint64_t& suppressed) const
+  {
+    sent = interrupt_coalescer_.sent();
+    suppressed = interrupt_coalescer_.suppressed();
+    return true;
+  }
+
 private:
-  // The hint to pass to io_uring_queue_init to size its data structures.
-  enum { ring_size = 16384 };
+  // The default hint to pass to io_uring_queue_init to size its data
+  // structures. May be overridden using the io_uring.ring_size config key.
+  enum { default_ring_size = 16384 };
 
-  // The number of operations to submit in a batch.
-  enum { submit_batch_size = 128 };
+  // The default number of operations to submit in a batch. May be overridden
+  // using the io_uring.submit_batch_size config key.
+  enum { default_submit_batch_size = 128 };
 
-  // The number of operations to complete in a batch.
-  enum { complete_batch_size = 128 };
+  // The default size of the sparse registered file table. May be overridden
+  // using the io_uring.registered_files config key. Zero disables the use of
+  // registered files.
+  enum { default_registered_files = 1024 };
+
+  // The default maximum number of completions to process in a single call to
+  // run(). May be overridden using the io_uring.complete_batch_size config
+  // key. Limiting the batch size keeps handlers from other sources flowing.
+  enum { default_complete_batch_size = 128 };
+
+  // The number of completion queue entries harvested from the ring at once.
+  enum { complete_chunk_size = 64 };
 
   // The type used for processing eventfd readiness notifications.
   class event_fd_read_op;
 
+  // Determine the io_uring setup flags to use, based on the configuration.
+  ASIO_DECL static unsigned get_ring_flags(const config& cfg);
+
   // Initialise the ring.
   ASIO_DECL void init_ring();
 
+  // Interrupt the io_uring wait by submitting a no-op to the ring.
+  ASIO_DECL void do_interrupt();
+
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+  // The process-wide registry of services that may receive wakeup messages.
+  struct wakeup_registry;
+
+  // Get the registry. Its address is also the tag carried by every wakeup
+  // message, so that a message is recognised by any ring that receives it.
+  ASIO_DECL static wakeup_registry& get_wakeup_registry();
+
+  // Determine whether wakeup messages may be sent from this service's ring,
+  // and add the service to the registry.
+  ASIO_DECL void init_wakeup_messages();
+
+  // Remove the service from the registry.
+  ASIO_DECL void shutdown_wakeup_messages();
+
+  // Get the service whose ring is owned by the calling thread, if any.
+  ASIO_DECL static io_uring_service* thread_ring_service();
+
+  // Send a wakeup message from this service's ring to the target's ring.
+  // Returns false if a message could not be sent.
+  ASIO_DECL bool send_wakeup_message(io_uring_service* target);
+
+  // Handle the completion of a wakeup message sent by this service. The
+  // target is identified by its registry identifier, rather than by its
+  // address, as it may have been destroyed since the message was sent.
+  ASIO_DECL static void wakeup_message_sent(void* ptr, int result);
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
+
   // Register the eventfd descriptor for readiness notifications.
   ASIO_DECL void register_with_reactor();
 
+  // Create the sparse registered file table.
+  ASIO_DECL void init_registered_files();
+
+  // Add an I/O object's descriptor to the registered file table.
+  ASIO_DECL void register_file(io_object* io_obj);
+
+  // Remove an I/O object's descriptor from the registered file table.
+  ASIO_DECL void unregister_file(io_object* io_obj);
+
+  // Prepare a submission queue entry for the given operation, substituting
+  // the I/O object's registered file for its descriptor where possible.
+  static void prepare_sqe(io_object* io_obj,
+      io_uring_operation* op, ::io_uring_sqe* sqe);
+
   // Allocate a new I/O object.
   ASIO_DECL io_object* allocate_io_object();
 
@@ -258,9 +352,42 @@ private:
   // Mutex to protect access to internal data.
   mutex mutex_;
 
+  // Suppresses interrupts while an earlier one has not yet been observed.
+  interrupt_coalescer interrupt_coalescer_;
+
   // The ring.
   ::io_uring ring_;
 
+  // The number of entries requested for the ring.
+  const unsigned ring_size_;
+
+  // The number of pending entries at which submission happens immediately.
+  const int submit_batch_size_;
+
+  // The maximum number of completions processed in a single call to run().
+  const int complete_batch_size_;
+
+  // The setup flags to use when initialising the ring.
+  unsigned ring_flags_;
+
+  // The idle time, in milliseconds, before the SQPOLL thread sleeps.
+  const unsigned sqpoll_idle_ms_;
+
+  // The CPU to which the SQPOLL thread is bound, or -1 for no affinity.
+  const int sqpoll_cpu_;
+
+  // Whether wakeups may be sent to other rings using IORING_OP_MSG_RING.
+  bool msg_ring_wakeups_;
+
+#if defined(ASIO_HAS_IO_URING_MSG_RING)
+  // The identifier of this service in the wakeup registry.
+  std::size_t wakeup_id_;
+
+  // The neighbouring services in the wakeup registry.
+  io_uring_service* wakeup_next_;
+  io_uring_service* wakeup_prev_;
+#endif // defined(ASIO_HAS_IO_URING_MSG_RING)
+
   // The count of unfinished work.
   atomic_count outstanding_work_;
 
@@ -289,6 +416,19 @@ private:
   // Keep track of all registered I/O objects.
   object_pool<io_object> registered_io_objects_;
 
+  // The size of the registered file table, or zero if it is not in use.
+  unsigned registered_files_;
+
+  // The free slots in the registered file table. Slots are reused in FIFO
+  // order to maximise the time before a released slot is handed out again.
+  std::vector<int> free_registered_files_;
+
+  // The index of the first free slot in free_registered_files_.
+  std::size_t free_registered_files_head_;
+
+  // The number of free slots in free_registered_files_.
+  std::size_t free_registered_files_count_;
+
   // Helper class to do post-perform_io cleanup.
   struct perform_io_cleanup_on_block_exit;
   friend struct perform_io_cleanup_on_block_exit;
@@ -0,0 +1,264 @@
+//
+// detail/offload_op.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_OFFLOAD_OP_HPP
+#define ASIO_DETAIL_OFFLOAD_OP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/associated_allocator.hpp"
+#include "asio/associated_executor.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/exception.hpp"
+#include "asio/detail/handler_alloc_helpers.hpp"
+#include "asio/detail/handler_tracking.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/operation.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/error.hpp"
+#include "asio/execution/allocator.hpp"
+#include "asio/execution/blocking.hpp"
+#include "asio/execution/execute.hpp"
+#include "asio/execution/outstanding_work.hpp"
+#include "asio/prefer.hpp"
+#include "asio/system_error.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// The type of the value produced by an offloaded function.
+template <typename Function>
+struct offload_result
+{
+  typedef typename decay<
+      typename result_of<typename decay<Function>::type()>::type
+    >::type type;
+};
+
+// The completion signature of an offload operation.
+template <typename Function,
+    typename Result = typename offload_result<Function>::type>
+struct offload_signature
+{
+  typedef void type(asio::error_code, Result);
+};
+
+template <typename Function>
+struct offload_signature<Function, void>
+{
+  typedef void type(asio::error_code);
+};
+
+#if defined(ASIO_HAS_STD_EXCEPTION_PTR) \
+  && !defined(ASIO_NO_EXCEPTIONS)
+
+// Rethrows an exception from an offloaded function, in place of calling the
+// completion handler.
+template <typename Handler>
+class offload_rethrower
+{
+public:
+  offload_rethrower(Handler& handler, const std::exception_ptr& e)
+    : handler_(ASIO_MOVE_CAST(Handler)(handler)),
+      exception_(e)
+  {
+  }
+
+  void operator()()
+  {
+    std::rethrow_exception(exception_);
+  }
+
+//private:
+  Handler handler_;
+  std::exception_ptr exception_;
+};
+
+#endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+       //   && !defined(ASIO_NO_EXCEPTIONS)
+
+template <typename Function, typename Handler, typename IoExecutor>
+class offload_op : public operation
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(offload_op);
+
+  typedef typename offload_result<Function>::type result_type;
+
+  template <typename F>
+  offload_op(ASIO_MOVE_ARG(F) f, Handler& handler, const IoExecutor& io_ex)
+    : operation(&offload_op::do_complete),
+      function_(ASIO_MOVE_CAST(F)(f)),
+      handler_(ASIO_MOVE_CAST(Handler)(handler)),
+      executor_(asio::prefer(
+            (get_associated_executor)(handler_, io_ex),
+            execution::outstanding_work.tracked))
+  {
+  }
+
+  Handler& handler()
+  {
+    return handler_;
+  }
+
+  static void do_complete(void* owner, operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the operation object.
+    offload_op* o(static_cast<offload_op*>(base));
+    ptr p = { asio::detail::addressof(o->handler_), o, o };
+
+    // The operation is destroyed without being run if the offload service is
+    // shut down.
+    if (!owner)
+      return;
+
+    ASIO_HANDLER_COMPLETION((*o));
+
+    // Take ownership of the outstanding work on the handler's executor.
+    work_executor_type executor(
+        ASIO_MOVE_CAST(work_executor_type)(o->executor_));
+
+    // Call the function on the offload thread, and then submit the completion
+    // handler for execution on its associated executor.
+    complete(o, p, executor, is_void<result_type>());
+  }
+
+private:
+  typedef typename associated_executor<Handler, IoExecutor>::type handler_ex_t;
+
+  typedef typename decay<
+      typename prefer_result<const handler_ex_t&,
+        execution::outstanding_work_t::tracked_t
+      >::type
+    >::type work_executor_type;
+
+  static void complete(offload_op* o, ptr& p,
+      const work_executor_type& executor, false_type)
+  {
+    result_type result = result_type();
+    asio::error_code ec;
+#if !defined(ASIO_NO_EXCEPTIONS)
+    try
+    {
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+      result = o->function_();
+#if !defined(ASIO_NO_EXCEPTIONS)
+    }
+    catch (const asio::system_error& e)
+    {
+      ec = e.code();
+    }
+# if defined(ASIO_HAS_STD_EXCEPTION_PTR)
+    catch (...)
+    {
+      fail(o, p, executor);
+      return;
+    }
+# endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made. The result is passed to the handler as an rvalue.
+#if defined(ASIO_HAS_MOVE)
+    detail::move_binder2<Handler, asio::error_code, result_type>
+      handler(0, ASIO_MOVE_CAST(Handler)(o->handler_),
+          ec, ASIO_MOVE_CAST(result_type)(result));
+#else // defined(ASIO_HAS_MOVE)
+    detail::binder2<Handler, asio::error_code, result_type>
+      handler(o->handler_, ec, result);
+#endif // defined(ASIO_HAS_MOVE)
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    submit(executor, handler);
+  }
+
+  static void complete(offload_op* o, ptr& p,
+      const work_executor_type& executor, true_type)
+  {
+    asio::error_code ec;
+#if !defined(ASIO_NO_EXCEPTIONS)
+    try
+    {
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+      o->function_();
+#if !defined(ASIO_NO_EXCEPTIONS)
+    }
+    catch (const asio::system_error& e)
+    {
+      ec = e.code();
+    }
+# if defined(ASIO_HAS_STD_EXCEPTION_PTR)
+    catch (...)
+    {
+      fail(o, p, executor);
+      return;
+    }
+# endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made.
+    detail::binder1<Handler, asio::error_code>
+      handler(o->handler_, ec);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    submit(executor, handler);
+  }
+
+#if defined(ASIO_HAS_STD_EXCEPTION_PTR) \
+  && !defined(ASIO_NO_EXCEPTIONS)
+  static void fail(offload_op* o, ptr& p,
+      const work_executor_type& executor)
+  {
+    // The function threw an exception that is not a system_error. Rather than
+    // letting it escape the offload thread, submit a function that rethrows
+    // it on the handler's executor, as if the handler had thrown it. The
+    // handler is destroyed without being called.
+    offload_rethrower<Handler> handler(o->handler_, std::current_exception());
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    submit(executor, handler);
+  }
+#endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+       //   && !defined(ASIO_NO_EXCEPTIONS)
+
+  template <typename Binder>
+  static void submit(const work_executor_type& executor, Binder& handler)
+  {
+    typename associated_allocator<Handler>::type alloc(
+        (get_associated_allocator)(handler.handler_));
+    execution::execute(
+        asio::prefer(executor,
+          execution::blocking.possibly,
+          execution::allocator(alloc)),
+        ASIO_MOVE_CAST(Binder)(handler));
+  }
+
+  Function function_;
+  Handler handler_;
+  work_executor_type executor_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_OFFLOAD_OP_HPP
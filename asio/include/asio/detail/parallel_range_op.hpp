@@ -0,0 +1,317 @@
+//
+// detail/parallel_range_op.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_PARALLEL_RANGE_OP_HPP
+#define ASIO_DETAIL_PARALLEL_RANGE_OP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/associated_allocator.hpp"
+#include "asio/associated_executor.hpp"
+#include "asio/detail/atomic_count.hpp"
+#include "asio/detail/bulk_range.hpp"
+#include "asio/detail/exception.hpp"
+#include "asio/detail/handler_alloc_helpers.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/non_const_lvalue.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/execution/allocator.hpp"
+#include "asio/execution/blocking.hpp"
+#include "asio/execution/execute.hpp"
+#include "asio/execution/occupancy.hpp"
+#include "asio/execution/outstanding_work.hpp"
+#include "asio/execution/relationship.hpp"
+#include "asio/prefer.hpp"
+#include "asio/query.hpp"
+#include "asio/require.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Determine the number of workers to use for a range of the given size. This
+// is the executor's occupancy, if it can be queried, limited to the size of
+// the range.
+template <typename Executor>
+inline std::size_t parallel_range_workers(const Executor& ex, std::size_t n,
+    typename enable_if<
+      can_query<const Executor&, execution::occupancy_t>::value
+    >::type* = 0)
+{
+  std::size_t workers = asio::query(ex, execution::occupancy);
+  return workers == 0 ? 1 : (workers > n && n > 0 ? n : workers);
+}
+
+template <typename Executor>
+inline std::size_t parallel_range_workers(const Executor&, std::size_t,
+    typename enable_if<
+      !can_query<const Executor&, execution::occupancy_t>::value
+    >::type* = 0)
+{
+  return 1;
+}
+
+#if defined(ASIO_HAS_STD_EXCEPTION_PTR) \
+  && !defined(ASIO_NO_EXCEPTIONS)
+
+// Rethrows an exception from a parallel operation's body, in place of calling
+// the completion handler.
+template <typename Handler>
+class parallel_range_rethrower
+{
+public:
+  parallel_range_rethrower(Handler& handler, const std::exception_ptr& e)
+    : handler_(ASIO_MOVE_CAST(Handler)(handler)),
+      exception_(e)
+  {
+  }
+
+  void operator()()
+  {
+    std::rethrow_exception(exception_);
+  }
+
+private:
+  Handler handler_;
+  std::exception_ptr exception_;
+};
+
+#endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+       //   && !defined(ASIO_NO_EXCEPTIONS)
+
+// The state shared by the workers of a parallel operation over a range of
+// indices. The Body is invoked for the chunks of the range claimed by each
+// worker. When the last reference to the state is released, the completion
+// handler is invoked if every worker ran to the end of the range. If the Body
+// throws, the rest of the range is abandoned, and the first exception is
+// rethrown on the handler's executor in place of calling the handler.
+template <typename Body, typename Handler, typename Executor>
+class parallel_range_state
+  : private noncopyable
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(parallel_range_state);
+
+  template <typename B, typename H>
+  parallel_range_state(ASIO_MOVE_ARG(B) body, ASIO_MOVE_ARG(H) handler,
+      const Executor& ex, std::size_t n, std::size_t workers)
+    : body_(ASIO_MOVE_CAST(B)(body)),
+      handler_(ASIO_MOVE_CAST(H)(handler)),
+      executor_(asio::prefer(
+            (get_associated_executor)(handler_, ex),
+            execution::outstanding_work.tracked)),
+      range_(n, workers),
+      workers_(static_cast<long>(workers)),
+      finished_(0),
+      ref_count_(0)
+  {
+  }
+
+  // Add a reference to the state. The state is created without references,
+  // and is owned by the workers that are submitted to the executor.
+  void add_ref()
+  {
+    ref_count_up(ref_count_);
+  }
+
+  // Remove a reference. The last reference destroys the state and, if the
+  // range was finished, delivers the result to the completion handler.
+  void release()
+  {
+    if (ref_count_down(ref_count_))
+    {
+      bool complete = static_cast<long>(finished_) == workers_;
+
+      // Make a copy of the handler so that the memory can be deallocated
+      // before the upcall is made.
+      Handler handler(ASIO_MOVE_CAST(Handler)(handler_));
+      work_executor_type executor(
+          ASIO_MOVE_CAST(work_executor_type)(executor_));
+      Body body(ASIO_MOVE_CAST(Body)(body_));
+#if defined(ASIO_HAS_STD_EXCEPTION_PTR) \
+  && !defined(ASIO_NO_EXCEPTIONS)
+      std::exception_ptr e(exception_);
+#endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+       //   && !defined(ASIO_NO_EXCEPTIONS)
+      ptr p = { detail::addressof(handler), this, this };
+      p.reset();
+
+      if (complete)
+      {
+#if defined(ASIO_HAS_STD_EXCEPTION_PTR) \
+  && !defined(ASIO_NO_EXCEPTIONS)
+        if (e)
+        {
+          typename associated_allocator<Handler>::type alloc(
+              (get_associated_allocator)(handler));
+          execution::execute(
+              asio::prefer(executor,
+                execution::blocking.possibly,
+                execution::allocator(alloc)),
+              parallel_range_rethrower<Handler>(handler, e));
+          return;
+        }
+#endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+       //   && !defined(ASIO_NO_EXCEPTIONS)
+        body.complete(handler, executor);
+      }
+    }
+  }
+
+  // Run the body for chunks of the range until it is used up.
+  void run()
+  {
+#if !defined(ASIO_NO_EXCEPTIONS)
+    try
+    {
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+      std::size_t begin = 0, end = 0;
+      while (range_.claim(begin, end))
+        body_.run(begin, end);
+#if !defined(ASIO_NO_EXCEPTIONS)
+    }
+    catch (...)
+    {
+      range_.cancel();
+# if defined(ASIO_HAS_STD_EXCEPTION_PTR)
+      mutex::scoped_lock lock(mutex_);
+      if (!exception_)
+        exception_ = std::current_exception();
+# else // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+      throw;
+# endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+    }
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+    ++finished_;
+  }
+
+private:
+  typedef typename associated_executor<Handler, Executor>::type handler_ex_t;
+
+  typedef typename decay<
+      typename prefer_result<const handler_ex_t&,
+        execution::outstanding_work_t::tracked_t
+      >::type
+    >::type work_executor_type;
+
+  Body body_;
+  Handler handler_;
+  work_executor_type executor_;
+  bulk_range range_;
+  const long workers_;
+  atomic_count finished_;
+  atomic_count ref_count_;
+#if defined(ASIO_HAS_STD_EXCEPTION_PTR) \
+  && !defined(ASIO_NO_EXCEPTIONS)
+  mutex mutex_;
+  std::exception_ptr exception_;
+#endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+       //   && !defined(ASIO_NO_EXCEPTIONS)
+};
+
+// A function object that is submitted to the executor once for each worker.
+template <typename State>
+class parallel_range_worker
+{
+public:
+  explicit parallel_range_worker(State* state)
+    : state_(state)
+  {
+    state_->add_ref();
+  }
+
+  parallel_range_worker(const parallel_range_worker& other)
+    : state_(other.state_)
+  {
+    state_->add_ref();
+  }
+
+#if defined(ASIO_HAS_MOVE)
+  parallel_range_worker(parallel_range_worker&& other)
+    : state_(other.state_)
+  {
+    other.state_ = 0;
+  }
+#endif // defined(ASIO_HAS_MOVE)
+
+  ~parallel_range_worker()
+  {
+    if (state_)
+      state_->release();
+  }
+
+  // The worker releases its reference once it has run, rather than on
+  // destruction, so that the completion is not made from a destructor.
+  void operator()()
+  {
+    state_->run();
+    State* state = state_;
+    state_ = 0;
+    state->release();
+  }
+
+private:
+  // Disallow assignment.
+  parallel_range_worker& operator=(const parallel_range_worker&);
+
+  State* state_;
+};
+
+// Start a parallel operation over a range by submitting its workers to the
+// executor. The completion handler is not invoked from within this function.
+template <typename Body, typename Executor, typename Handler>
+void start_parallel_range_op(ASIO_MOVE_ARG(Body) body,
+    ASIO_MOVE_ARG(Handler) handler, const Executor& ex, std::size_t n)
+{
+  typedef typename decay<Body>::type body_type;
+  typedef typename decay<Handler>::type handler_type;
+  typedef parallel_range_state<body_type, handler_type, Executor> state_type;
+
+  // At least one worker is submitted, even for an empty range, so that the
+  // completion handler is always invoked through the executor.
+  std::size_t workers = parallel_range_workers(ex, n);
+
+  // Obtain a non-const instance of the handler.
+  non_const_lvalue<Handler> handler2(handler);
+
+  typename associated_allocator<handler_type>::type alloc(
+      (get_associated_allocator)(handler2.value));
+
+  typename state_type::ptr p = { detail::addressof(handler2.value),
+    state_type::ptr::allocate(handler2.value), 0 };
+  p.p = new (p.v) state_type(ASIO_MOVE_CAST(Body)(body),
+      ASIO_MOVE_CAST(handler_type)(handler2.value), ex, n, workers);
+  parallel_range_worker<state_type> initiator(p.p);
+  p.v = p.p = 0;
+
+  for (std::size_t i = 0; i < workers; ++i)
+  {
+    execution::execute(
+        asio::prefer(
+          asio::require(ex, execution::blocking.never),
+          execution::relationship.fork,
+          execution::allocator(alloc)),
+        parallel_range_worker<state_type>(initiator));
+  }
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_PARALLEL_RANGE_OP_HPP
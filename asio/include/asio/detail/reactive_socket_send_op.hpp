@@ -77,9 +77,18 @@ public:
             o->ec_, o->bytes_transferred_) ? done : not_done;
 
       if (result == done)
+      {
         if ((o->state_ & socket_ops::stream_oriented) != 0)
+        {
           if (o->bytes_transferred_ < bufs.total_size())
             result = done_and_exhausted;
+          else if (!o->ec_ && bufs.count()
+              == buffer_sequence_adapter_base::max_buffers)
+            result = o->send_remaining(
+                asio::buffer_sequence_begin(o->buffers_),
+                asio::buffer_sequence_end(o->buffers_));
+        }
+      }
     }
 
     ASIO_HANDLER_REACTOR_OPERATION((*o, "non_blocking_send",
@@ -89,6 +98,42 @@ public:
   }
 
 private:
+  // Send the buffers that follow the first max_buffers, one batch at a time,
+  // for as long as each batch is accepted in full. Any bytes already sent are
+  // reported as the result, even if a subsequent batch would block or fail.
+  template <typename Iterator>
+  status send_remaining(Iterator begin, Iterator end)
+  {
+    typedef buffer_sequence_range<Iterator> range_type;
+    typedef buffer_sequence_adapter<asio::const_buffer,
+        range_type> bufs_type;
+    const std::size_t max_buffers = buffer_sequence_adapter_base::max_buffers;
+
+    for (;;)
+    {
+      for (std::size_t i = 0; i < max_buffers && begin != end; ++i)
+        ++begin;
+      if (begin == end)
+        return done;
+
+      range_type range(begin, end);
+      bufs_type bufs(range);
+      asio::error_code ec;
+      std::size_t bytes_transferred = 0;
+      if (!socket_ops::non_blocking_send(socket_, bufs.buffers(),
+            bufs.count(), flags_, ec, bytes_transferred))
+        return done_and_exhausted;
+      if (ec)
+        return done;
+
+      bytes_transferred_ += bytes_transferred;
+      if (bytes_transferred < bufs.total_size())
+        return done_and_exhausted;
+      if (bufs.count() < max_buffers)
+        return done;
+    }
+  }
+
   socket_type socket_;
   socket_ops::state_type state_;
   ConstBufferSequence buffers_;
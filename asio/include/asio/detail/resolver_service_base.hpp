@@ -18,13 +18,11 @@
 #include "asio/detail/config.hpp"
 #include "asio/error.hpp"
 #include "asio/execution_context.hpp"
-#include "asio/detail/mutex.hpp"
+#include "asio/detail/blocking_offload_service.hpp"
 #include "asio/detail/noncopyable.hpp"
 #include "asio/detail/resolve_op.hpp"
 #include "asio/detail/socket_ops.hpp"
 #include "asio/detail/socket_types.hpp"
-#include "asio/detail/scoped_ptr.hpp"
-#include "asio/detail/thread.hpp"
 
 #if defined(ASIO_HAS_IOCP)
 # include "asio/detail/win_iocp_io_context.hpp"
@@ -121,12 +119,6 @@ protected:
   };
 #endif // !defined(ASIO_WINDOWS_RUNTIME)
 
-  // Helper class to run the work scheduler in a thread.
-  class work_scheduler_runner;
-
-  // Start the work scheduler if it's not already running.
-  ASIO_DECL void start_work_thread();
-
   // The scheduler implementation used to post completions.
 #if defined(ASIO_HAS_IOCP)
   typedef class win_iocp_io_context scheduler_impl;
@@ -136,14 +128,8 @@ protected:
   scheduler_impl& scheduler_;
 
 private:
-  // Mutex to protect access to internal data.
-  asio::detail::mutex mutex_;
-
-  // Private scheduler used for performing asynchronous host resolution.
-  asio::detail::scoped_ptr<scheduler_impl> work_scheduler_;
-
-  // Thread used for running the work io_context's run loop.
-  asio::detail::scoped_ptr<asio::detail::thread> work_thread_;
+  // The shared pool of threads used for performing host resolution.
+  blocking_offload_service& offload_service_;
 };
 
 } // namespace detail
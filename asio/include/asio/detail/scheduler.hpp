@@ -20,10 +20,11 @@
 #include "asio/error_code.hpp"
 #include "asio/execution_context.hpp"
 #include "asio/detail/atomic_count.hpp"
-#include "asio/detail/conditionally_enabled_event.hpp"
+#include "asio/detail/adaptive_event.hpp"
 #include "asio/detail/conditionally_enabled_mutex.hpp"
 #include "asio/detail/op_queue.hpp"
 #include "asio/detail/scheduler_operation.hpp"
+#include "asio/detail/scheduler_statistics.hpp"
 #include "asio/detail/scheduler_task.hpp"
 #include "asio/detail/thread.hpp"
 #include "asio/detail/thread_context.hpp"
@@ -71,6 +72,14 @@ public:
   ASIO_DECL std::size_t wait_one(
       long usec, asio::error_code& ec);
 
+  // Run the event loop until interrupted, no more work, or no operation has
+  // been performed for the specified time. Requires a steady clock.
+  ASIO_DECL std::size_t run_until_idle(
+      long usec, asio::error_code& ec);
+
+  // Determine whether any handlers are queued and waiting for a thread.
+  ASIO_DECL bool has_ready_handlers();
+
   // Poll for operations without blocking.
   ASIO_DECL std::size_t poll(asio::error_code& ec);
 
@@ -86,9 +95,19 @@ public:
   // Restart in preparation for a subsequent run invocation.
   ASIO_DECL void restart();
 
+  // Obtain the scheduler's statistics.
+  ASIO_DECL void get_statistics(scheduler_statistics& stats) const;
+
   // Notify that some work has started.
   void work_started()
   {
+#if defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+    if (single_threaded_)
+    {
+      unsynchronised_increment(outstanding_work_, 1);
+      return;
+    }
+#endif // defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
     ++outstanding_work_;
   }
 
@@ -99,6 +118,15 @@ public:
   // Notify that some work has finished.
   void work_finished()
   {
+#if defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+    if (single_threaded_)
+    {
+      unsynchronised_decrement(outstanding_work_, 1);
+      if (outstanding_work_ == 0)
+        stop();
+      return;
+    }
+#endif // defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
     if (--outstanding_work_ == 0)
       stop();
   }
@@ -119,6 +147,12 @@ public:
   ASIO_DECL void post_immediate_completions(std::size_t n,
       op_queue<operation>& ops, bool is_continuation);
 
+  // Request invocation of the given operation ahead of operations with a lower
+  // priority, and return immediately. Assumes that work_started() has not yet
+  // been called for the operation.
+  ASIO_DECL void post_priority_completion(
+      operation* op, unsigned int priority);
+
   // Request invocation of the given operation and return immediately. Assumes
   // that work_started() was previously called for the operation.
   ASIO_DECL void post_deferred_completion(operation* op);
@@ -135,25 +169,51 @@ public:
   // work_started() was previously called for the operations.
   ASIO_DECL void abandon_operations(op_queue<operation>& ops);
 
+  // Get the secondary task shard owned by the calling thread, plus one, or
+  // zero if the thread does not own a shard.
+  ASIO_DECL std::size_t current_task_shard();
+
   // Get the concurrency hint that was used to initialise the scheduler.
   int concurrency_hint() const
   {
     return concurrency_hint_;
   }
 
+  // Whether the task may be polled while the results of an earlier poll are
+  // still waiting in the operation queue.
+  bool may_force_task_poll() const
+  {
+    return handler_budget_ != 0 || handler_budget_usec_ != 0;
+  }
+
 private:
   // The mutex type used by this scheduler.
   typedef conditionally_enabled_mutex mutex;
 
   // The event type used by this scheduler.
-  typedef conditionally_enabled_event event;
+  typedef adaptive_event event;
 
   // Structure containing thread-specific data.
   typedef scheduler_thread_info thread_info;
 
-  // Run at most one operation. May block.
+  // The maximum number of handlers that may be dequeued together.
+  enum { max_batch_size = 64 };
+
+  // The highest supported priority. Each priority above zero has its own
+  // queue, while priority zero uses the main queue.
+  enum { max_priority = 3 };
+
+  // Run at most one operation, or a batch of up to max_handlers operations
+  // dequeued under a single lock acquisition. May block.
   ASIO_DECL std::size_t do_run_one(mutex::scoped_lock& lock,
-      thread_info& this_thread, const asio::error_code& ec);
+      thread_info& this_thread, std::size_t max_handlers,
+      const asio::error_code& ec);
+
+  // Dequeue further handlers to run with the operation o, and then run them
+  // all. The mutex must be locked on entry.
+  ASIO_DECL std::size_t do_run_batch(mutex::scoped_lock& lock,
+      thread_info& this_thread, operation* o, std::size_t task_result,
+      std::size_t max_handlers, const asio::error_code& ec);
 
   // Run at most one operation with a timeout. May block.
   ASIO_DECL std::size_t do_wait_one(mutex::scoped_lock& lock,
@@ -163,6 +223,59 @@ private:
   ASIO_DECL std::size_t do_poll_one(mutex::scoped_lock& lock,
       thread_info& this_thread, const asio::error_code& ec);
 
+  // Get the calling thread's information if it is running the scheduler.
+  thread_info_base* this_thread_info()
+  {
+#if defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+    // A single-threaded scheduler is only used by one thread at a time, so
+    // any caller is the thread that is running it, if it is running.
+    if (single_threaded_)
+      return single_thread_info_;
+#endif // defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+    return thread_call_stack::contains(this);
+  }
+
+  // Add n to, or subtract n from, the count of unfinished work.
+  void increment_work(long n)
+  {
+#if defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+    if (single_threaded_)
+    {
+      unsynchronised_increment(outstanding_work_, n);
+      return;
+    }
+#endif // defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+    increment(outstanding_work_, n);
+  }
+
+  void decrement_work(long n)
+  {
+#if defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+    if (single_threaded_)
+    {
+      unsynchronised_decrement(outstanding_work_, n);
+      return;
+    }
+#endif // defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+    decrement(outstanding_work_, n);
+  }
+
+  // Move the next prioritised operation, if any, to the front of the main
+  // queue.
+  void promote_priority_op()
+  {
+    if (priority_ops_ != 0)
+      do_promote_priority_op();
+  }
+
+  ASIO_DECL void do_promote_priority_op();
+
+  // Whether there are handlers queued in addition to any that are dequeued.
+  bool more_handlers() const
+  {
+    return !op_queue_.empty() || priority_ops_ != 0;
+  }
+
   // Stop the task and all idle threads.
   ASIO_DECL void stop_all_threads(mutex::scoped_lock& lock);
 
@@ -170,14 +283,55 @@ private:
   ASIO_DECL void wake_one_thread_and_unlock(
       mutex::scoped_lock& lock);
 
+  // Take ownership of a secondary task shard for the calling thread. Returns
+  // false if all shards are owned by other threads.
+  ASIO_DECL bool acquire_task_shard(thread_info& this_thread);
+
+  // Interrupt one thread waiting on a secondary task shard, or all of them.
+  ASIO_DECL void interrupt_task_shards(bool all);
+
   // Get the default task.
   ASIO_DECL static scheduler_task* get_default_task(
       asio::execution_context& ctx);
 
+  // Get the current time in microseconds, or zero if there is no clock.
+  ASIO_DECL static uint64_t now_usec();
+
+  // Determine whether the handler budget requires the task to be polled. The
+  // mutex must be locked.
+  ASIO_DECL bool task_poll_due();
+
+  // Poll the task without waiting for its operation to reach the front of the
+  // queue, if the handler budget has been used up. Returns true if the task
+  // was polled. The mutex must be locked, and is locked again on return.
+  ASIO_DECL bool maybe_force_task_poll(mutex::scoped_lock& lock,
+      thread_info& this_thread);
+
+  // Update the statistics when the task is about to run. The mutex must be
+  // locked.
+  ASIO_DECL void task_poll_starting(bool forced);
+
+  // Update the statistics when the task has finished running. The mutex must
+  // be locked.
+  ASIO_DECL void task_poll_finished();
+
+  // Get the configured maximum number of iterations for which idle threads
+  // spin before blocking.
+  ASIO_DECL static std::size_t get_max_spin(
+      asio::execution_context& ctx, int concurrency_hint);
+
+  // Get the configured number of handlers dequeued per lock acquisition.
+  ASIO_DECL static std::size_t get_batch_size(
+      asio::execution_context& ctx);
+
   // Helper class to run the scheduler in its own thread.
   class thread_function;
   friend class thread_function;
 
+  // Helper class to record the thread running a single-threaded scheduler.
+  struct single_thread_context;
+  friend struct single_thread_context;
+
   // Helper class to perform task-related operations on block exit.
   struct task_cleanup;
   friend struct task_cleanup;
@@ -186,9 +340,35 @@ private:
   struct work_cleanup;
   friend struct work_cleanup;
 
+  // Helper class to finish a forced poll of the task on block exit.
+  struct task_poll_cleanup;
+  friend struct task_poll_cleanup;
+
+  // Helper class to account for a batch of handlers on block exit.
+  struct batch_cleanup;
+  friend struct batch_cleanup;
+
+  // Helper class to perform task shard-related operations on block exit.
+  struct task_shard_cleanup;
+  friend struct task_shard_cleanup;
+
+  // Helper class to release a thread's task shard on block exit.
+  struct task_shard_release;
+  friend struct task_shard_release;
+
   // Whether to optimise for single-threaded use cases.
   const bool one_thread_;
 
+#if defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+  // Whether the scheduler performs no locking, and so may only be used by one
+  // thread at a time. Work is then counted without atomic read-modify-write
+  // operations, and the running thread is found without thread-local lookups.
+  const bool single_threaded_;
+
+  // The innermost thread running a single-threaded scheduler.
+  thread_info_base* single_thread_info_;
+#endif // defined(ASIO_ENABLE_SINGLE_THREADED_SCHEDULER)
+
   // Mutex to protect access to internal data.
   mutable mutex mutex_;
 
@@ -210,12 +390,42 @@ private:
   // Whether the task has been interrupted.
   bool task_interrupted_;
 
+  // The state of a secondary task shard.
+  struct task_shard
+  {
+    // Whether the shard is owned by a thread.
+    bool owned;
+
+    // Whether a thread is waiting on the shard and has not been interrupted.
+    bool waiting;
+  };
+
+  // The number of secondary task shards.
+  std::size_t task_shard_count_;
+
+  // The secondary task shards.
+  task_shard* task_shards_;
+
   // The count of unfinished work.
   atomic_count outstanding_work_;
 
   // The queue of handlers that are ready to be delivered.
   op_queue<operation> op_queue_;
 
+  // The queues of prioritised handlers, for priorities 1 to max_priority.
+  op_queue<operation> priority_queues_[max_priority];
+
+  // The number of operations in the priority queues.
+  std::size_t priority_ops_;
+
+  // The number of consecutive prioritised handlers after which a handler of
+  // lower priority is allowed to run, or zero for strict priority.
+  const std::size_t priority_aging_;
+
+  // The number of consecutive prioritised handlers that have been promoted
+  // while handlers of lower priority were waiting.
+  std::size_t priority_run_;
+
   // Flag to indicate that the dispatcher has been stopped.
   bool stopped_;
 
@@ -225,6 +435,44 @@ private:
   // The concurrency hint used to initialise the scheduler.
   const int concurrency_hint_;
 
+  // The maximum number of handlers run() dequeues per lock acquisition.
+  const std::size_t batch_size_;
+
+  // The number of handlers that may run before the task is polled, or zero
+  // for no limit.
+  const std::size_t handler_budget_;
+
+  // The time in microseconds for which handlers may run before the task is
+  // polled, or zero for no limit.
+  const uint64_t handler_budget_usec_;
+
+  // Whether the intervals between runs of the task are measured.
+  const bool timing_;
+
+  // Whether the task is being polled while its operation remains queued.
+  bool task_polling_;
+
+  // Whether the task operation was dequeued during a forced poll.
+  bool task_deferred_;
+
+  // The number of handlers dequeued since the task was last run.
+  std::size_t handlers_since_task_poll_;
+
+  // The time at which the task last finished running.
+  uint64_t task_poll_end_usec_;
+
+  // The number of times the task has been run, and how many were forced.
+  uint64_t task_polls_;
+  uint64_t forced_task_polls_;
+
+  // The intervals between runs of the task.
+  scheduler_interval_histogram task_poll_intervals_;
+
+  // The number of calls to interrupt the task, and the number of wakeups that
+  // did not need one because the task was already interrupted.
+  uint64_t task_interrupts_;
+  uint64_t task_interrupts_coalesced_;
+
   // The thread that is running the scheduler.
   asio::detail::thread* thread_;
 };
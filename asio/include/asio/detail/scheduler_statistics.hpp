@@ -0,0 +1,157 @@
+//
+// detail/scheduler_statistics.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_SCHEDULER_STATISTICS_HPP
+#define ASIO_DETAIL_SCHEDULER_STATISTICS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/detail/cstdint.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Statistics describing the behaviour of a scheduler.
+struct scheduler_statistics
+{
+  scheduler_statistics()
+    : task_polls(0),
+      forced_task_polls(0),
+      task_poll_intervals(0),
+      task_poll_interval_p50_usec(0),
+      task_poll_interval_p99_usec(0),
+      task_poll_interval_max_usec(0),
+      task_interrupts_sent(0),
+      task_interrupts_suppressed(0)
+  {
+  }
+
+  // The number of times the task (i.e. the reactor) has been run.
+  uint64_t task_polls;
+
+  // The number of those runs that were non-blocking polls forced by the
+  // handler budget.
+  uint64_t forced_task_polls;
+
+  // The number of intervals between runs of the task that have been measured.
+  // Intervals are only measured when statistics are enabled in the
+  // configuration, or a time-based handler budget is in use.
+  uint64_t task_poll_intervals;
+
+  // The median interval between the end of one run of the task and the start
+  // of the next, in microseconds. Accurate to within a quarter.
+  uint64_t task_poll_interval_p50_usec;
+
+  // The 99th percentile of the interval, in microseconds.
+  uint64_t task_poll_interval_p99_usec;
+
+  // The longest interval, in microseconds.
+  uint64_t task_poll_interval_max_usec;
+
+  // The number of interrupts sent to wake the task.
+  uint64_t task_interrupts_sent;
+
+  // The number of times the task would have been interrupted, but an earlier
+  // interrupt had not yet been observed or the task was not waiting.
+  uint64_t task_interrupts_suppressed;
+};
+
+// A histogram of intervals, with each power of two divided into four buckets.
+class scheduler_interval_histogram
+{
+public:
+  scheduler_interval_histogram()
+    : count_(0),
+      max_(0)
+  {
+    for (std::size_t i = 0; i < num_buckets; ++i)
+      buckets_[i] = 0;
+  }
+
+  // Record an interval.
+  void record(uint64_t usec)
+  {
+    ++buckets_[bucket_index(usec)];
+    ++count_;
+    if (usec > max_)
+      max_ = usec;
+  }
+
+  // The number of recorded intervals.
+  uint64_t count() const
+  {
+    return count_;
+  }
+
+  // The largest recorded interval.
+  uint64_t max() const
+  {
+    return max_;
+  }
+
+  // The upper bound of the bucket containing the given percentile.
+  uint64_t percentile(unsigned p) const
+  {
+    if (count_ == 0)
+      return 0;
+    uint64_t target = (count_ * p + 99) / 100;
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < num_buckets; ++i)
+    {
+      seen += buckets_[i];
+      if (seen >= target)
+        return bucket_limit(i) < max_ ? bucket_limit(i) : max_;
+    }
+    return max_;
+  }
+
+private:
+  enum { sub_buckets = 4, octaves = 30 };
+  enum { num_buckets = sub_buckets + octaves * sub_buckets };
+
+  static std::size_t bucket_index(uint64_t usec)
+  {
+    if (usec < sub_buckets)
+      return static_cast<std::size_t>(usec);
+    std::size_t octave = 0;
+    while ((usec >> octave) >= 2 * sub_buckets)
+      ++octave;
+    if (octave >= octaves)
+      return num_buckets - 1;
+    return sub_buckets + octave * sub_buckets
+      + static_cast<std::size_t>(usec >> octave) - sub_buckets;
+  }
+
+  static uint64_t bucket_limit(std::size_t index)
+  {
+    if (index < sub_buckets)
+      return index;
+    std::size_t octave = (index - sub_buckets) / sub_buckets;
+    uint64_t sub = (index - sub_buckets) % sub_buckets;
+    return ((sub_buckets + sub + 1) << octave) - 1;
+  }
+
+  uint64_t buckets_[num_buckets];
+  uint64_t count_;
+  uint64_t max_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_SCHEDULER_STATISTICS_HPP
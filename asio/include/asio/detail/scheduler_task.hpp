@@ -15,6 +15,9 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/detail/cstdint.hpp"
 #include "asio/detail/op_queue.hpp"
 
 #include "asio/detail/push_options.hpp"
@@ -34,6 +37,32 @@ public:
   // Interrupt the task.
   virtual void interrupt() = 0;
 
+  // Get the number of interrupts sent to the task, and the number of calls to
+  // interrupt() that were suppressed because an earlier interrupt had not yet
+  // been observed. Returns false if the task does not count interrupts.
+  virtual bool get_interrupt_counts(uint64_t&, uint64_t&) const
+  {
+    return false;
+  }
+
+  // Get the number of secondary shards into which the task is divided. Each
+  // secondary shard may be run by a different thread, concurrently with run().
+  virtual std::size_t shard_count() const
+  {
+    return 0;
+  }
+
+  // Run a secondary shard once until interrupted or events are ready to be
+  // dispatched.
+  virtual void run_shard(std::size_t, long, op_queue<scheduler_operation>&)
+  {
+  }
+
+  // Interrupt a secondary shard.
+  virtual void interrupt_shard(std::size_t)
+  {
+  }
+
 protected:
   // Prevent deletion through this type.
   ~scheduler_task()
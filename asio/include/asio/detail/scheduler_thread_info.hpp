@@ -25,11 +25,25 @@ namespace detail {
 
 class scheduler;
 class scheduler_operation;
+class scheduler_task;
 
 struct scheduler_thread_info : public thread_info_base
 {
+  scheduler_thread_info()
+    : last_task(0),
+      task_shard(0)
+  {
+  }
+
   op_queue<scheduler_operation> private_op_queue;
   long private_outstanding_work;
+
+  // The task most recently run on this thread, if it has recorded itself.
+  scheduler_task* last_task;
+
+  // The secondary task shard owned by this thread, plus one, or zero if the
+  // thread does not own a shard.
+  std::size_t task_shard;
 };
 
 } // namespace detail
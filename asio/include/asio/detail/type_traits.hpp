@@ -40,6 +40,7 @@
 # include <boost/type_traits/is_object.hpp>
 # include <boost/type_traits/is_pointer.hpp>
 # include <boost/type_traits/is_same.hpp>
+# include <boost/type_traits/is_void.hpp>
 # include <boost/type_traits/remove_cv.hpp>
 # include <boost/type_traits/remove_pointer.hpp>
 # include <boost/type_traits/remove_reference.hpp>
@@ -82,6 +83,7 @@ using std::is_pointer;
 using std::is_reference;
 using std::is_same;
 using std::is_scalar;
+using std::is_void;
 using std::remove_cv;
 template <typename T>
 struct remove_cvref : remove_cv<typename std::remove_reference<T>::type> {};
@@ -131,6 +133,7 @@ using boost::is_pointer;
 using boost::is_reference;
 using boost::is_same;
 using boost::is_scalar;
+using boost::is_void;
 using boost::remove_cv;
 template <typename T>
 struct remove_cvref : remove_cv<typename boost::remove_reference<T>::type> {};
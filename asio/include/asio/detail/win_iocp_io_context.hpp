@@ -122,6 +122,14 @@ public:
     post_deferred_completion(op);
   }
 
+  // Request invocation of the given operation with a priority and return
+  // immediately. Priorities are not supported by the completion port, so the
+  // operation is queued as normal.
+  void post_priority_completion(win_iocp_operation* op, unsigned int)
+  {
+    post_immediate_completion(op, false);
+  }
+
   // Request invocation of the given operation and return immediately. Assumes
   // that work_started() was previously called for the operation.
   ASIO_DECL void post_deferred_completion(win_iocp_operation* op);
@@ -0,0 +1,189 @@
+//
+// dfa_matcher.hpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DFA_MATCHER_HPP
+#define ASIO_DFA_MATCHER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "asio/detail/memory.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/read_until.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+/// A match condition that finds one or more patterns incrementally.
+/**
+ * The dfa_matcher class is a match condition for use with
+ * asio::read_until and asio::async_read_until. Its patterns are compiled
+ * into a deterministic finite automaton when it is constructed. The state of
+ * the automaton is kept between calls, so each byte of the data is examined
+ * exactly once no matter how many reads are needed to complete the match.
+ * By contrast, a regular expression search is repeated from the start of
+ * any partial match whenever more data arrives.
+ *
+ * A match is reported at the first position where any of the patterns ends.
+ * The patterns are unanchored, and a pattern may not match the empty string.
+ *
+ * Patterns are either literal strings or regular expressions with the
+ * following syntax:
+ *
+ * @li Ordinary characters match themselves.
+ *
+ * @li @c . matches any character except newline.
+ *
+ * @li <tt>[...]</tt> and <tt>[^...]</tt> match any character in, or not in,
+ * a set of characters and ranges such as <tt>a-z</tt>.
+ *
+ * @li @c \\d, @c \\s, @c \\w and their negations @c \\D, @c \\S, @c \\W match
+ * digits, whitespace and word characters.
+ *
+ * @li @c \\n, @c \\r, @c \\t, @c \\f, @c \\v, @c \\0 and @c \\xHH match control
+ * characters, and a backslash before any other punctuation character matches
+ * that character.
+ *
+ * @li <tt>(...)</tt> groups, @c | separates alternatives, and @c *, @c +, @c ?,
+ * <tt>{n}</tt>, <tt>{n,}</tt> and <tt>{n,m}</tt> repeat the preceding item.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ *
+ * Copies share the compiled automaton, which is immutable, and each copy has
+ * its own state. The read_until and async_read_until functions make a copy
+ * of the match condition, so the same object may be passed to each call.
+ *
+ * @par Example
+ * To read an HTTP header that is terminated by either CRLFCRLF or LFLF:
+ * @code std::vector<std::string> terminators;
+ * terminators.push_back("\r\n\r\n");
+ * terminators.push_back("\n\n");
+ * asio::dfa_matcher end_of_header(terminators, asio::dfa_matcher::literal);
+ * ...
+ * std::size_t n = asio::read_until(s, buffer, end_of_header); @endcode
+ */
+class dfa_matcher
+{
+public:
+  /// The syntax of the patterns.
+  enum syntax_type
+  {
+    /// The patterns are regular expressions.
+    regular_expression,
+
+    /// The patterns are literal strings.
+    literal
+  };
+
+  /// The maximum number of states in the automaton.
+  static const std::size_t max_states = 4096;
+
+  /// Construct a matcher for a single pattern.
+  /**
+   * @throws std::invalid_argument Thrown if the pattern is not valid or can
+   * match the empty string.
+   *
+   * @throws std::length_error Thrown if the automaton would need more than
+   * @c max_states states.
+   */
+  ASIO_DECL explicit dfa_matcher(const std::string& pattern,
+      syntax_type syntax = regular_expression);
+
+  /// Construct a matcher that finds whichever of several patterns ends first.
+  /**
+   * @throws std::invalid_argument Thrown if there are no patterns, or if any
+   * pattern is not valid or can match the empty string.
+   *
+   * @throws std::length_error Thrown if the automaton would need more than
+   * @c max_states states.
+   */
+  ASIO_DECL explicit dfa_matcher(const std::vector<std::string>& patterns,
+      syntax_type syntax = regular_expression);
+
+  /// Continue the search with the data in the range [begin, end).
+  /**
+   * @returns If a match ends within the range, a pair containing an iterator
+   * to the character following the match and @c true. The matcher is then
+   * reset. Otherwise, a pair containing @c end and @c false, in which case
+   * the next call is assumed to continue from @c end.
+   */
+  template <typename Iterator>
+  std::pair<Iterator, bool> operator()(Iterator begin, Iterator end)
+  {
+    const automaton& a = *automaton_;
+    for (Iterator iter = begin; iter != end;)
+    {
+      state_ = a.transitions[state_ * 256
+        + static_cast<unsigned char>(*iter++)];
+      if (a.accepting[state_])
+      {
+        state_ = 0;
+        return std::make_pair(iter, true);
+      }
+    }
+    return std::make_pair(end, false);
+  }
+
+  /// Discard any partial match, so that the next search starts afresh.
+  void reset()
+  {
+    state_ = 0;
+  }
+
+  /// Get the number of states in the automaton.
+  std::size_t state_count() const
+  {
+    return automaton_->accepting.size();
+  }
+
+private:
+  // The compiled patterns. State 0 is the initial state.
+  struct automaton
+  {
+    std::vector<unsigned int> transitions;
+    std::vector<unsigned char> accepting;
+  };
+
+  // Compile the patterns into an automaton.
+  ASIO_DECL static asio::detail::shared_ptr<automaton> compile(
+      const std::vector<std::string>& patterns, syntax_type syntax);
+
+  asio::detail::shared_ptr<const automaton> automaton_;
+  unsigned int state_;
+};
+
+#if !defined(GENERATING_DOCUMENTATION)
+
+template <>
+struct is_match_condition<dfa_matcher>
+  : true_type
+{
+};
+
+#endif // !defined(GENERATING_DOCUMENTATION)
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/impl/dfa_matcher.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_DFA_MATCHER_HPP
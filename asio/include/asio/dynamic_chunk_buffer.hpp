@@ -0,0 +1,465 @@
+//
+// dynamic_chunk_buffer.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DYNAMIC_CHUNK_BUFFER_HPP
+#define ASIO_DYNAMIC_CHUNK_BUFFER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include "asio/buffer.hpp"
+#include "asio/detail/chunk_buffer_sequence.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/throw_exception.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+class chunk_buffer;
+
+/// A pool of fixed-size chunks of memory shared by chunk_buffer objects.
+/**
+ * The chunk_pool class allocates memory in chunks of a fixed size. Chunks that
+ * are returned to the pool are kept for reuse, up to a specified limit, so
+ * that buffers that repeatedly grow and shrink do not repeatedly allocate and
+ * free memory.
+ *
+ * The pool must outlive all chunk_buffer objects that use it.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ */
+class chunk_pool
+  : private noncopyable
+{
+public:
+  /// Construct a pool.
+  /**
+   * @param chunk_size The size of each chunk, in bytes. Values smaller than
+   * the size of a pointer are rounded up.
+   *
+   * @param max_cached_chunks The maximum number of unused chunks that the
+   * pool keeps for reuse. Chunks returned beyond this limit are freed.
+   */
+  ASIO_DECL explicit chunk_pool(std::size_t chunk_size = 4096,
+      std::size_t max_cached_chunks =
+        (std::numeric_limits<std::size_t>::max)());
+
+  /// Destructor frees all unused chunks.
+  ASIO_DECL ~chunk_pool();
+
+  /// Get the size of each chunk, in bytes.
+  std::size_t chunk_size() const ASIO_NOEXCEPT
+  {
+    return chunk_size_;
+  }
+
+  /// Get the number of unused chunks that are kept for reuse.
+  ASIO_DECL std::size_t cached_chunks() const;
+
+private:
+  friend class chunk_buffer;
+
+  // Obtain a chunk, reusing an unused one if available. Returns 0 if memory
+  // could not be allocated.
+  ASIO_DECL char* allocate() ASIO_NOEXCEPT;
+
+  // Return a chunk to the pool.
+  ASIO_DECL void deallocate(char* chunk) ASIO_NOEXCEPT;
+
+  // The unused chunks are linked through their first bytes.
+  struct chunk_link
+  {
+    chunk_link* next_;
+  };
+
+  mutable asio::detail::mutex mutex_;
+  const std::size_t chunk_size_;
+  const std::size_t max_cached_chunks_;
+  chunk_link* cached_;
+  std::size_t cached_count_;
+};
+
+/// Segmented storage, made of chunks from a chunk_pool, for use with
+/// dynamic_chunk_buffer.
+/**
+ * The chunk_buffer class holds data in a chain of fixed-size chunks obtained
+ * from a chunk_pool. Growing the buffer adds chunks to the end of the chain,
+ * so existing data is never copied. Removing data from either end returns the
+ * chunks that become empty to the pool.
+ *
+ * The chunk_buffer is accessed using a dynamic_chunk_buffer object, which is
+ * obtained by calling asio::dynamic_buffer.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class chunk_buffer
+  : private noncopyable
+{
+public:
+  /// Construct an empty buffer that obtains its chunks from the given pool.
+  /**
+   * @param pool The pool that supplies the chunks. The object stores a
+   * reference to the pool and the user is responsible for ensuring that the
+   * pool remains valid while the chunk_buffer object is in use.
+   *
+   * @param maximum_size Specifies a maximum size for the buffer, in bytes.
+   */
+  explicit chunk_buffer(chunk_pool& pool,
+      std::size_t maximum_size =
+        (std::numeric_limits<std::size_t>::max)()) ASIO_NOEXCEPT
+    : pool_(pool),
+      start_(0),
+      size_(0),
+      max_size_(maximum_size)
+  {
+  }
+
+  /// Destructor returns all chunks to the pool.
+  ~chunk_buffer()
+  {
+    clear();
+  }
+
+  /// Get the number of bytes held by the buffer.
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// Get the maximum size of the buffer, in bytes.
+  std::size_t max_size() const ASIO_NOEXCEPT
+  {
+    return max_size_;
+  }
+
+  /// Get the number of bytes that the buffer can hold without obtaining more
+  /// chunks from the pool.
+  std::size_t capacity() const ASIO_NOEXCEPT
+  {
+    return chunks_.size() * pool_.chunk_size() - start_;
+  }
+
+  /// Get the number of chunks held by the buffer.
+  std::size_t chunk_count() const ASIO_NOEXCEPT
+  {
+    return chunks_.size();
+  }
+
+  /// Discard all data and return all chunks to the pool.
+  ASIO_DECL void clear() ASIO_NOEXCEPT;
+
+private:
+  friend class dynamic_chunk_buffer;
+
+  // Ensure that the buffer can hold n more bytes after the current data.
+  ASIO_DECL void reserve(std::size_t n);
+
+  // Remove n bytes from the end of the data.
+  ASIO_DECL void shrink(std::size_t n) ASIO_NOEXCEPT;
+
+  // Remove n bytes from the beginning of the data.
+  ASIO_DECL void consume(std::size_t n) ASIO_NOEXCEPT;
+
+  // Get the buffers that represent n bytes starting at offset pos from the
+  // beginning of the data.
+  template <typename Buffers>
+  Buffers buffers(std::size_t pos, std::size_t n) const ASIO_NOEXCEPT
+  {
+    const std::size_t chunk_size = pool_.chunk_size();
+    if (n == 0)
+      pos = 0;
+    detail::chunk_buffer_range range;
+    range.chunks = chunks_.begin() + (start_ + pos) / chunk_size;
+    range.offset = (start_ + pos) % chunk_size;
+    range.size = n;
+    range.chunk_size = chunk_size;
+    return Buffers(range);
+  }
+
+  chunk_pool& pool_;
+  std::deque<char*> chunks_;
+  std::size_t start_;
+  std::size_t size_;
+  const std::size_t max_size_;
+};
+
+/// Adapt a chunk_buffer to the DynamicBuffer requirements.
+/**
+ * The dynamic_chunk_buffer class satisfies both the DynamicBuffer_v1 and
+ * DynamicBuffer_v2 requirements. Unlike the dynamic buffers that adapt a
+ * string or vector, growing the buffer never reallocates or copies the
+ * existing data. This makes it suitable for large message bodies, where a
+ * contiguous buffer would be copied each time it grows and would briefly need
+ * twice the memory.
+ *
+ * The buffer sequences that represent the data contain one buffer per chunk.
+ * They are computed on demand, and can be passed directly to scatter-gather
+ * operations such as asio::write.
+ *
+ * @par Example
+ * @code asio::chunk_pool pool(16 * 1024);
+ * ...
+ * asio::chunk_buffer body(pool);
+ * asio::read(sock, asio::dynamic_buffer(body),
+ *     asio::transfer_exactly(content_length));
+ * asio::write(upstream, asio::dynamic_buffer(body)); @endcode
+ */
+class dynamic_chunk_buffer
+{
+public:
+#if defined(GENERATING_DOCUMENTATION)
+  /// The type used to represent a sequence of constant buffers that refers to
+  /// the underlying memory.
+  typedef implementation_defined const_buffers_type;
+
+  /// The type used to represent a sequence of mutable buffers that refers to
+  /// the underlying memory.
+  typedef implementation_defined mutable_buffers_type;
+#else // defined(GENERATING_DOCUMENTATION)
+  typedef detail::chunk_buffer_sequence<const_buffer> const_buffers_type;
+  typedef detail::chunk_buffer_sequence<mutable_buffer> mutable_buffers_type;
+#endif // defined(GENERATING_DOCUMENTATION)
+
+  /// Construct a dynamic buffer from a chunk buffer.
+  /**
+   * @param b The chunk buffer to be used as backing storage for the dynamic
+   * buffer. The object stores a reference to the chunk buffer and the user is
+   * responsible for ensuring that the chunk buffer object remains valid while
+   * the dynamic_chunk_buffer object, and copies of the object, are in use.
+   */
+  explicit dynamic_chunk_buffer(chunk_buffer& b) ASIO_NOEXCEPT
+    : buffer_(b)
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+      , prepared_(0)
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  {
+  }
+
+  /// @b DynamicBuffer_v2: Copy construct a dynamic buffer.
+  dynamic_chunk_buffer(const dynamic_chunk_buffer& other) ASIO_NOEXCEPT
+    : buffer_(other.buffer_)
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+      , prepared_(other.prepared_)
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  {
+  }
+
+  /// @b DynamicBuffer_v1: Get the size of the input sequence.
+  /// @b DynamicBuffer_v2: Get the current size of the underlying memory.
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return buffer_.size_;
+  }
+
+  /// Get the maximum size of the dynamic buffer.
+  /**
+   * @returns The allowed maximum size of the underlying chunk buffer.
+   */
+  std::size_t max_size() const ASIO_NOEXCEPT
+  {
+    return buffer_.max_size_;
+  }
+
+  /// Get the maximum size that the buffer may grow to without obtaining more
+  /// chunks from the pool.
+  /**
+   * @returns The capacity of the chunks already held by the chunk buffer if
+   * less than max_size(). Otherwise returns max_size().
+   */
+  std::size_t capacity() const ASIO_NOEXCEPT
+  {
+    return (std::min)(buffer_.capacity(), max_size());
+  }
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  /// @b DynamicBuffer_v1: Get a list of buffers that represents the input
+  /// sequence.
+  /**
+   * @returns An object of type @c const_buffers_type that satisfies
+   * ConstBufferSequence requirements, representing the chunks in the input
+   * sequence.
+   *
+   * @note The returned object is invalidated by any @c dynamic_chunk_buffer
+   * member function that modifies the input sequence or output sequence.
+   */
+  const_buffers_type data() const ASIO_NOEXCEPT
+  {
+    return buffer_.buffers<const_buffers_type>(0, buffer_.size_);
+  }
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  /// @b DynamicBuffer_v2: Get a sequence of buffers that represents the
+  /// underlying memory.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence
+   *
+   * @param n The number of bytes to return in the buffer sequence. If the
+   * underlying memory is shorter, the buffer sequence represents as many bytes
+   * as are available.
+   *
+   * @returns An object of type @c mutable_buffers_type that satisfies
+   * MutableBufferSequence requirements, representing the chunks.
+   *
+   * @note The returned object is invalidated by any @c dynamic_chunk_buffer
+   * member function that modifies the underlying memory.
+   */
+  mutable_buffers_type data(std::size_t pos, std::size_t n) ASIO_NOEXCEPT
+  {
+    return buffer_.buffers<mutable_buffers_type>(pos, clamp(pos, n));
+  }
+
+  /// @b DynamicBuffer_v2: Get a sequence of buffers that represents the
+  /// underlying memory.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence
+   *
+   * @param n The number of bytes to return in the buffer sequence. If the
+   * underlying memory is shorter, the buffer sequence represents as many bytes
+   * as are available.
+   *
+   * @note The returned object is invalidated by any @c dynamic_chunk_buffer
+   * member function that modifies the underlying memory.
+   */
+  const_buffers_type data(std::size_t pos,
+      std::size_t n) const ASIO_NOEXCEPT
+  {
+    return buffer_.buffers<const_buffers_type>(pos, clamp(pos, n));
+  }
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  /// @b DynamicBuffer_v1: Get a list of buffers that represents the output
+  /// sequence, with the given size.
+  /**
+   * Ensures that the output sequence can accommodate @c n bytes, obtaining
+   * chunks from the pool as necessary.
+   *
+   * @returns An object of type @c mutable_buffers_type that satisfies
+   * MutableBufferSequence requirements, representing the chunks at the start
+   * of the output sequence of size @c n.
+   *
+   * @throws std::length_error If <tt>size() + n > max_size()</tt>.
+   *
+   * @note The returned object is invalidated by any @c dynamic_chunk_buffer
+   * member function that modifies the input sequence or output sequence.
+   */
+  mutable_buffers_type prepare(std::size_t n)
+  {
+    buffer_.reserve(n);
+    prepared_ = n;
+    return buffer_.buffers<mutable_buffers_type>(buffer_.size_, n);
+  }
+
+  /// @b DynamicBuffer_v1: Move bytes from the output sequence to the input
+  /// sequence.
+  /**
+   * @param n The number of bytes to append from the start of the output
+   * sequence to the end of the input sequence. The remainder of the output
+   * sequence is discarded, and chunks that hold none of the input sequence are
+   * returned to the pool.
+   *
+   * Requires a preceding call <tt>prepare(x)</tt> where <tt>x >= n</tt>, and
+   * no intervening operations that modify the input or output sequence.
+   *
+   * @note If @c n is greater than the size of the output sequence, the entire
+   * output sequence is moved to the input sequence and no error is issued.
+   */
+  void commit(std::size_t n)
+  {
+    buffer_.size_ += (std::min)(n, prepared_);
+    prepared_ = 0;
+    buffer_.shrink(0); // Return any chunks left unused.
+  }
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  /// @b DynamicBuffer_v2: Grow the underlying memory by the specified number of
+  /// bytes.
+  /**
+   * Appends @c n bytes, with unspecified contents, to the end of the data,
+   * obtaining chunks from the pool as necessary.
+   *
+   * @throws std::length_error If <tt>size() + n > max_size()</tt>.
+   */
+  void grow(std::size_t n)
+  {
+    buffer_.reserve(n);
+    buffer_.size_ += n;
+  }
+
+  /// @b DynamicBuffer_v2: Shrink the underlying memory by the specified number
+  /// of bytes.
+  /**
+   * Removes @c n bytes from the end of the data, and returns the chunks that
+   * no longer hold any data to the pool. If @c n is greater than the current
+   * size of the data, the buffer is emptied.
+   */
+  void shrink(std::size_t n)
+  {
+    buffer_.shrink(n);
+  }
+
+  /// @b DynamicBuffer_v1: Remove characters from the input sequence.
+  /// @b DynamicBuffer_v2: Consume the specified number of bytes from the
+  /// beginning of the underlying memory.
+  /**
+   * Removes @c n bytes from the beginning of the data, and returns the chunks
+   * that no longer hold any data to the pool. If @c n is greater than the
+   * current size of the data, the buffer is emptied, all of its chunks are
+   * returned, and no error is issued.
+   */
+  void consume(std::size_t n)
+  {
+    buffer_.consume(n);
+  }
+
+private:
+  // Limit a request for n bytes at offset pos to the data that is available.
+  std::size_t clamp(std::size_t pos, std::size_t n) const ASIO_NOEXCEPT
+  {
+    std::size_t size = buffer_.size_;
+    return pos >= size ? 0 : (n < size - pos ? n : size - pos);
+  }
+
+  chunk_buffer& buffer_;
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  std::size_t prepared_;
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+};
+
+/// Create a new dynamic buffer that represents the given chunk buffer.
+/**
+ * @returns <tt>dynamic_chunk_buffer(data)</tt>.
+ */
+ASIO_NODISCARD inline dynamic_chunk_buffer dynamic_buffer(
+    chunk_buffer& data) ASIO_NOEXCEPT
+{
+  return dynamic_chunk_buffer(data);
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/impl/dynamic_chunk_buffer.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_DYNAMIC_CHUNK_BUFFER_HPP
@@ -0,0 +1,382 @@
+//
+// dynamic_ring_buffer.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DYNAMIC_RING_BUFFER_HPP
+#define ASIO_DYNAMIC_RING_BUFFER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "asio/buffer.hpp"
+#include "asio/detail/consuming_buffers.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/throw_exception.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+class dynamic_ring_buffer;
+
+/// Fixed-capacity circular storage for use with dynamic_ring_buffer.
+/**
+ * The ring_buffer class owns a block of memory of a fixed size, together with
+ * the position and length of the data that it holds. Data is appended at the
+ * end and consumed from the beginning, wrapping around at the end of the
+ * memory, so that consuming data never moves the bytes that remain.
+ *
+ * The ring_buffer is accessed using a dynamic_ring_buffer object, which is
+ * obtained by calling asio::dynamic_buffer.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class ring_buffer
+  : private noncopyable
+{
+public:
+  /// Construct a ring buffer with the specified capacity, in bytes.
+  explicit ring_buffer(std::size_t capacity)
+    : storage_(capacity),
+      start_(0),
+      size_(0)
+  {
+  }
+
+  /// Get the number of bytes held by the ring buffer.
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// Get the fixed capacity of the ring buffer, in bytes.
+  std::size_t capacity() const ASIO_NOEXCEPT
+  {
+    return storage_.size();
+  }
+
+  /// Discard all data held by the ring buffer.
+  void clear() ASIO_NOEXCEPT
+  {
+    start_ = 0;
+    size_ = 0;
+  }
+
+private:
+  friend class dynamic_ring_buffer;
+
+  // Get the buffers that represent n bytes starting at offset pos from the
+  // beginning of the data. The bytes may wrap around the end of the storage,
+  // in which case two buffers are needed.
+  template <typename Buffers>
+  Buffers buffers(std::size_t pos, std::size_t n) const ASIO_NOEXCEPT
+  {
+    Buffers result;
+    std::size_t capacity = storage_.size();
+    if (capacity == 0)
+    {
+      result.count = 1;
+      return result;
+    }
+
+    std::size_t first = (start_ + pos) % capacity;
+    std::size_t first_size = capacity - first < n ? capacity - first : n;
+    char* data = const_cast<char*>(&storage_[0]);
+    result.elems[0] = mutable_buffer(data + first, first_size);
+    result.count = 1;
+    if (first_size < n)
+    {
+      result.elems[1] = mutable_buffer(data, n - first_size);
+      result.count = 2;
+    }
+    return result;
+  }
+
+  std::vector<char> storage_;
+  std::size_t start_;
+  std::size_t size_;
+};
+
+/// Adapt a ring_buffer to the DynamicBuffer requirements.
+/**
+ * The dynamic_ring_buffer class satisfies both the DynamicBuffer_v1 and
+ * DynamicBuffer_v2 requirements. Its maximum size is the capacity of the
+ * underlying ring_buffer, which never reallocates. Unlike the dynamic buffers
+ * that adapt a string or vector, consuming data from the beginning of the
+ * buffer does not move the data that follows it. This makes it suitable for
+ * long-lived streaming connections where data is consumed a frame at a time.
+ *
+ * Because the data may wrap around the end of the underlying memory, the
+ * buffer sequences that represent it contain at most two buffers.
+ *
+ * @par Example
+ * @code asio::ring_buffer storage(64 * 1024);
+ * for (;;)
+ * {
+ *   std::size_t n = asio::read_until(sock,
+ *       asio::dynamic_buffer(storage), '\n');
+ *   ...
+ *   asio::dynamic_buffer(storage).consume(n);
+ * } @endcode
+ */
+class dynamic_ring_buffer
+{
+public:
+#if defined(GENERATING_DOCUMENTATION)
+  /// The type used to represent a sequence of constant buffers that refers to
+  /// the underlying memory. The sequence contains at most two buffers.
+  typedef implementation_defined const_buffers_type;
+
+  /// The type used to represent a sequence of mutable buffers that refers to
+  /// the underlying memory. The sequence contains at most two buffers.
+  typedef implementation_defined mutable_buffers_type;
+#else // defined(GENERATING_DOCUMENTATION)
+  typedef detail::prepared_buffers<const_buffer, 2> const_buffers_type;
+  typedef detail::prepared_buffers<mutable_buffer, 2> mutable_buffers_type;
+#endif // defined(GENERATING_DOCUMENTATION)
+
+  /// Construct a dynamic buffer from a ring buffer.
+  /**
+   * @param r The ring buffer to be used as backing storage for the dynamic
+   * buffer. The object stores a reference to the ring buffer and the user is
+   * responsible for ensuring that the ring buffer object remains valid while
+   * the dynamic_ring_buffer object, and copies of the object, are in use.
+   */
+  explicit dynamic_ring_buffer(ring_buffer& r) ASIO_NOEXCEPT
+    : ring_(r)
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+      , prepared_(0)
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  {
+  }
+
+  /// @b DynamicBuffer_v2: Copy construct a dynamic buffer.
+  dynamic_ring_buffer(const dynamic_ring_buffer& other) ASIO_NOEXCEPT
+    : ring_(other.ring_)
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+      , prepared_(other.prepared_)
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  {
+  }
+
+  /// @b DynamicBuffer_v1: Get the size of the input sequence.
+  /// @b DynamicBuffer_v2: Get the current size of the underlying memory.
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return ring_.size_;
+  }
+
+  /// Get the maximum size of the dynamic buffer.
+  /**
+   * @returns The capacity of the underlying ring buffer.
+   */
+  std::size_t max_size() const ASIO_NOEXCEPT
+  {
+    return ring_.storage_.size();
+  }
+
+  /// Get the maximum size that the buffer may grow to without triggering
+  /// reallocation.
+  /**
+   * @returns The capacity of the underlying ring buffer.
+   */
+  std::size_t capacity() const ASIO_NOEXCEPT
+  {
+    return ring_.storage_.size();
+  }
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  /// @b DynamicBuffer_v1: Get a list of buffers that represents the input
+  /// sequence.
+  /**
+   * @returns An object of type @c const_buffers_type that satisfies
+   * ConstBufferSequence requirements, representing the ring buffer memory in
+   * the input sequence.
+   *
+   * @note The returned object is invalidated by any @c dynamic_ring_buffer
+   * member function that modifies the input sequence or output sequence.
+   */
+  const_buffers_type data() const ASIO_NOEXCEPT
+  {
+    return ring_.buffers<const_buffers_type>(0, ring_.size_);
+  }
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  /// @b DynamicBuffer_v2: Get a sequence of buffers that represents the
+  /// underlying memory.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence
+   *
+   * @param n The number of bytes to return in the buffer sequence. If the
+   * underlying memory is shorter, the buffer sequence represents as many bytes
+   * as are available.
+   *
+   * @returns An object of type @c mutable_buffers_type that satisfies
+   * MutableBufferSequence requirements, representing the ring buffer memory.
+   *
+   * @note The returned object is invalidated by any @c dynamic_ring_buffer
+   * member function that modifies the underlying memory.
+   */
+  mutable_buffers_type data(std::size_t pos, std::size_t n) ASIO_NOEXCEPT
+  {
+    return ring_.buffers<mutable_buffers_type>(pos, clamp(pos, n));
+  }
+
+  /// @b DynamicBuffer_v2: Get a sequence of buffers that represents the
+  /// underlying memory.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence
+   *
+   * @param n The number of bytes to return in the buffer sequence. If the
+   * underlying memory is shorter, the buffer sequence represents as many bytes
+   * as are available.
+   *
+   * @note The returned object is invalidated by any @c dynamic_ring_buffer
+   * member function that modifies the underlying memory.
+   */
+  const_buffers_type data(std::size_t pos,
+      std::size_t n) const ASIO_NOEXCEPT
+  {
+    return ring_.buffers<const_buffers_type>(pos, clamp(pos, n));
+  }
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  /// @b DynamicBuffer_v1: Get a list of buffers that represents the output
+  /// sequence, with the given size.
+  /**
+   * @returns An object of type @c mutable_buffers_type that satisfies
+   * MutableBufferSequence requirements, representing ring buffer memory
+   * at the start of the output sequence of size @c n.
+   *
+   * @throws std::length_error If <tt>size() + n > max_size()</tt>.
+   *
+   * @note The returned object is invalidated by any @c dynamic_ring_buffer
+   * member function that modifies the input sequence or output sequence.
+   */
+  mutable_buffers_type prepare(std::size_t n)
+  {
+    if (max_size() - size() < n)
+    {
+      std::length_error ex("dynamic_ring_buffer too long");
+      asio::detail::throw_exception(ex);
+    }
+
+    prepared_ = n;
+    return ring_.buffers<mutable_buffers_type>(ring_.size_, n);
+  }
+
+  /// @b DynamicBuffer_v1: Move bytes from the output sequence to the input
+  /// sequence.
+  /**
+   * @param n The number of bytes to append from the start of the output
+   * sequence to the end of the input sequence. The remainder of the output
+   * sequence is discarded.
+   *
+   * Requires a preceding call <tt>prepare(x)</tt> where <tt>x >= n</tt>, and
+   * no intervening operations that modify the input or output sequence.
+   *
+   * @note If @c n is greater than the size of the output sequence, the entire
+   * output sequence is moved to the input sequence and no error is issued.
+   */
+  void commit(std::size_t n)
+  {
+    ring_.size_ += (std::min)(n, prepared_);
+    prepared_ = 0;
+  }
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  /// @b DynamicBuffer_v2: Grow the underlying memory by the specified number of
+  /// bytes.
+  /**
+   * Appends @c n bytes, with unspecified contents, to the end of the data.
+   *
+   * @throws std::length_error If <tt>size() + n > max_size()</tt>.
+   */
+  void grow(std::size_t n)
+  {
+    if (max_size() - size() < n)
+    {
+      std::length_error ex("dynamic_ring_buffer too long");
+      asio::detail::throw_exception(ex);
+    }
+
+    ring_.size_ += n;
+  }
+
+  /// @b DynamicBuffer_v2: Shrink the underlying memory by the specified number
+  /// of bytes.
+  /**
+   * Removes @c n bytes from the end of the data. If @c n is greater than the
+   * current size of the data, the ring buffer is emptied.
+   */
+  void shrink(std::size_t n)
+  {
+    ring_.size_ -= (std::min)(n, ring_.size_);
+    if (ring_.size_ == 0)
+      ring_.start_ = 0;
+  }
+
+  /// @b DynamicBuffer_v1: Remove characters from the input sequence.
+  /// @b DynamicBuffer_v2: Consume the specified number of bytes from the
+  /// beginning of the underlying memory.
+  /**
+   * Removes @c n bytes from the beginning of the data without moving the
+   * remaining bytes. If @c n is greater than the current size of the data, the
+   * ring buffer is emptied and no error is issued.
+   *
+   * When the ring buffer becomes empty, the next byte to be added is placed at
+   * the beginning of the underlying memory, so that short messages do not
+   * wrap.
+   */
+  void consume(std::size_t n)
+  {
+    std::size_t consume_length = (std::min)(n, ring_.size_);
+    ring_.size_ -= consume_length;
+    if (ring_.size_ == 0)
+      ring_.start_ = 0;
+    else
+      ring_.start_ = (ring_.start_ + consume_length) % max_size();
+  }
+
+private:
+  // Limit a request for n bytes at offset pos to the data that is available.
+  std::size_t clamp(std::size_t pos, std::size_t n) const ASIO_NOEXCEPT
+  {
+    std::size_t size = ring_.size_;
+    return pos >= size ? 0 : (n < size - pos ? n : size - pos);
+  }
+
+  ring_buffer& ring_;
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  std::size_t prepared_;
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+};
+
+/// Create a new dynamic buffer that represents the given ring buffer.
+/**
+ * @returns <tt>dynamic_ring_buffer(data)</tt>.
+ */
+ASIO_NODISCARD inline dynamic_ring_buffer dynamic_buffer(
+    ring_buffer& data) ASIO_NOEXCEPT
+{
+  return dynamic_ring_buffer(data);
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_DYNAMIC_RING_BUFFER_HPP
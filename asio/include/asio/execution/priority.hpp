@@ -0,0 +1,172 @@
+//
+// execution/priority.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_EXECUTION_PRIORITY_HPP
+#define ASIO_EXECUTION_PRIORITY_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/execution/executor.hpp"
+#include "asio/execution/scheduler.hpp"
+#include "asio/execution/sender.hpp"
+#include "asio/is_applicable_property.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+#if defined(GENERATING_DOCUMENTATION)
+
+namespace execution {
+
+/// A property to describe the priority with which an executor submits
+/// function objects to its execution context.
+/**
+ * Larger values are more urgent. The default priority is zero. An execution
+ * context that does not support priorities ignores the property when it is
+ * preferred.
+ */
+struct priority_t
+{
+  /// The priority_t property applies to executors, senders, and schedulers.
+  template <typename T>
+  static constexpr bool is_applicable_property_v =
+    is_executor_v<T> || is_sender_v<T> || is_scheduler_v<T>;
+
+  /// The priority_t property can be required.
+  static constexpr bool is_requirable = true;
+
+  /// The priority_t property can be preferred.
+  static constexpr bool is_preferable = true;
+
+  /// The type returned by queries against an @c any_executor.
+  typedef unsigned int polymorphic_query_result_type;
+
+  /// Default constructor. Specifies the default priority.
+  constexpr priority_t();
+
+  /// Obtain the priority stored in the priority_t property object.
+  constexpr unsigned int value() const;
+
+  /// Create a priority_t object with the specified priority.
+  constexpr priority_t operator()(unsigned int p) const;
+};
+
+/// A special value used for accessing the priority_t property.
+constexpr priority_t priority;
+
+} // namespace execution
+
+#else // defined(GENERATING_DOCUMENTATION)
+
+namespace execution {
+namespace detail {
+
+template <int I = 0>
+struct priority_t
+{
+#if defined(ASIO_HAS_VARIABLE_TEMPLATES)
+  template <typename T>
+  ASIO_STATIC_CONSTEXPR(bool,
+    is_applicable_property_v = (
+      is_executor<T>::value
+        || conditional<
+            is_executor<T>::value,
+            false_type,
+            is_sender<T>
+          >::type::value
+        || conditional<
+            is_executor<T>::value,
+            false_type,
+            is_scheduler<T>
+          >::type::value));
+#endif // defined(ASIO_HAS_VARIABLE_TEMPLATES)
+
+  ASIO_STATIC_CONSTEXPR(bool, is_requirable = true);
+  ASIO_STATIC_CONSTEXPR(bool, is_preferable = true);
+  typedef unsigned int polymorphic_query_result_type;
+
+  ASIO_CONSTEXPR priority_t()
+    : value_(0)
+  {
+  }
+
+  ASIO_CONSTEXPR unsigned int value() const
+  {
+    return value_;
+  }
+
+  ASIO_CONSTEXPR priority_t operator()(unsigned int p) const
+  {
+    return priority_t(p);
+  }
+
+#if !defined(ASIO_HAS_CONSTEXPR)
+  static const priority_t instance;
+#endif // !defined(ASIO_HAS_CONSTEXPR)
+
+private:
+  explicit ASIO_CONSTEXPR priority_t(unsigned int p)
+    : value_(p)
+  {
+  }
+
+  unsigned int value_;
+};
+
+#if !defined(ASIO_HAS_CONSTEXPR)
+template <int I>
+const priority_t<I> priority_t<I>::instance;
+#endif
+
+} // namespace detail
+
+typedef detail::priority_t<> priority_t;
+
+#if defined(ASIO_HAS_CONSTEXPR) || defined(GENERATING_DOCUMENTATION)
+constexpr priority_t priority;
+#else // defined(ASIO_HAS_CONSTEXPR) || defined(GENERATING_DOCUMENTATION)
+namespace { static const priority_t& priority = priority_t::instance; }
+#endif
+
+} // namespace execution
+
+#if !defined(ASIO_HAS_VARIABLE_TEMPLATES)
+
+template <typename T>
+struct is_applicable_property<T, execution::priority_t>
+  : integral_constant<bool,
+      execution::is_executor<T>::value
+        || conditional<
+            execution::is_executor<T>::value,
+            false_type,
+            execution::is_sender<T>
+          >::type::value
+        || conditional<
+            execution::is_executor<T>::value,
+            false_type,
+            execution::is_scheduler<T>
+          >::type::value>
+{
+};
+
+#endif // !defined(ASIO_HAS_VARIABLE_TEMPLATES)
+
+#endif // defined(GENERATING_DOCUMENTATION)
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_EXECUTION_PRIORITY_HPP
@@ -108,11 +108,23 @@ class execution_context
 public:
   class id;
   class service;
+  class service_maker;
 
 public:
   /// Constructor.
   ASIO_DECL execution_context();
 
+  /// Constructor.
+  /**
+   * Construct the execution context and add an initial set of services to it.
+   *
+   * @param initial_services Used to create the initial services. The @c make
+   * function will be called exactly once, before any other service is added
+   * to the context.
+   */
+  ASIO_DECL explicit execution_context(
+      const service_maker& initial_services);
+
   /// Destructor.
   ASIO_DECL ~execution_context();
 
@@ -354,6 +366,24 @@ private:
   service* next_;
 };
 
+/// Base class for all execution context service makers.
+/**
+ * A service maker is used to add an initial set of services to an execution
+ * context when the context is constructed. This allows services that are
+ * consulted by the context's constructor, such as a config_service, to be
+ * in place before any other service is created.
+ */
+class execution_context::service_maker
+{
+public:
+  /// Make services to be added to the execution context.
+  virtual void make(execution_context& context) const = 0;
+
+protected:
+  /// Protected destructor to prevent deletion through this type.
+  ASIO_DECL virtual ~service_maker();
+};
+
 /// Exception thrown when trying to add a duplicate service to an
 /// execution_context.
 class service_already_exists
@@ -0,0 +1,409 @@
+//
+// impl/broadcast.hpp
+// ~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_BROADCAST_HPP
+#define ASIO_IMPL_BROADCAST_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "asio/associated_cancellation_slot.hpp"
+#include "asio/associated_executor.hpp"
+#include "asio/basic_waitable_timer.hpp"
+#include "asio/cancellation_signal.hpp"
+#include "asio/cancellation_type.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/non_const_lvalue.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/execution/outstanding_work.hpp"
+#include "asio/post.hpp"
+#include "asio/prefer.hpp"
+#include "asio/write.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Get the stream to which an iterator in the destination range refers.
+template <typename Stream>
+inline Stream& broadcast_target(Stream& s)
+{
+  return s;
+}
+
+template <typename Stream>
+inline Stream& broadcast_target(Stream* s)
+{
+  return *s;
+}
+
+// The state shared by the writes, the timeout timer and the cancellation
+// handler. The state is kept alive by the pending operations until every
+// write has completed.
+template <typename Iterator, typename DestinationHandler, typename Handler>
+class broadcast_op
+  : private noncopyable
+{
+public:
+  typedef typename remove_pointer<
+      typename std::iterator_traits<Iterator>::value_type>::type stream_type;
+
+  typedef typename stream_type::executor_type executor_type;
+
+  broadcast_op(Iterator begin, std::size_t count,
+      const shared_const_buffer& message,
+      const chrono::steady_clock::duration& timeout,
+      DestinationHandler& destination_handler, Handler& handler)
+    : message_(message),
+      destinations_(count),
+      pending_(count),
+      delivered_(0),
+      cancelled_(false),
+      timer_(broadcast_target(*begin).get_executor()),
+      timeout_(timeout),
+      destination_handler_(
+          ASIO_MOVE_CAST(DestinationHandler)(destination_handler)),
+      handler_(ASIO_MOVE_CAST(Handler)(handler)),
+      executor_(asio::prefer(
+            (get_associated_executor)(handler_,
+              broadcast_target(*begin).get_executor()),
+            execution::outstanding_work.tracked))
+  {
+    for (std::size_t i = 0; i < count; ++i, ++begin)
+      destinations_[i].iterator_ = begin;
+  }
+
+  static void start(const shared_ptr<broadcast_op>& self)
+  {
+    typename associated_cancellation_slot<Handler>::type slot
+      = (get_associated_cancellation_slot)(self->handler_);
+    if (slot.is_connected())
+      slot.template emplace<cancel_handler>(self);
+
+    asio::detail::mutex::scoped_lock lock(self->mutex_);
+    if (self->timeout_ > chrono::steady_clock::duration::zero())
+    {
+      self->timer_.expires_after(self->timeout_);
+      self->timer_.async_wait(timer_handler(self));
+    }
+
+    for (std::size_t i = 0; i < self->destinations_.size(); ++i)
+    {
+      asio::async_write(
+          broadcast_target(*self->destinations_[i].iterator_),
+          self->message_, write_handler(self, i));
+    }
+  }
+
+private:
+  struct destination
+  {
+    destination()
+      : done_(false),
+        evicted_(false)
+    {
+    }
+
+    Iterator iterator_;
+    cancellation_signal signal_;
+    bool done_;
+    bool evicted_;
+  };
+
+  class write_handler
+  {
+  public:
+    typedef cancellation_slot cancellation_slot_type;
+
+    write_handler(const shared_ptr<broadcast_op>& self, std::size_t index)
+      : self_(self),
+        index_(index)
+    {
+    }
+
+    cancellation_slot_type get_cancellation_slot() const ASIO_NOEXCEPT
+    {
+      return self_->destinations_[index_].signal_.slot();
+    }
+
+    void operator()(const asio::error_code& ec, std::size_t n)
+    {
+      self_->handle_write(index_, ec, n);
+    }
+
+  private:
+    shared_ptr<broadcast_op> self_;
+    std::size_t index_;
+  };
+
+  class timer_handler
+  {
+  public:
+    explicit timer_handler(const shared_ptr<broadcast_op>& self)
+      : self_(self)
+    {
+    }
+
+    void operator()(const asio::error_code& ec)
+    {
+      if (!ec)
+        self_->cancel_writes(self_, cancellation_type::terminal, true);
+    }
+
+  private:
+    shared_ptr<broadcast_op> self_;
+  };
+
+  class cancel_handler
+  {
+  public:
+    explicit cancel_handler(const shared_ptr<broadcast_op>& self)
+      : self_(self)
+    {
+    }
+
+    void operator()(cancellation_type_t type)
+    {
+      if (type != cancellation_type::none)
+        if (shared_ptr<broadcast_op> self = self_.lock())
+          self->cancel_writes(self, type, false);
+    }
+
+  private:
+    // Does not keep the operation alive, as the handler is only destroyed
+    // when the slot is cleared.
+    weak_ptr<broadcast_op> self_;
+  };
+
+  // Emits a cancellation signal using the executor of the write's stream, as
+  // a signal must not be emitted concurrently with the operation it cancels.
+  class emit_handler
+  {
+  public:
+    emit_handler(const shared_ptr<broadcast_op>& self,
+        std::size_t index, cancellation_type_t type)
+      : self_(self),
+        index_(index),
+        type_(type)
+    {
+    }
+
+    void operator()()
+    {
+      self_->destinations_[index_].signal_.emit(type_);
+    }
+
+  private:
+    shared_ptr<broadcast_op> self_;
+    std::size_t index_;
+    cancellation_type_t type_;
+  };
+
+  void handle_write(std::size_t index,
+      const asio::error_code& ec, std::size_t n)
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    destinations_[index].done_ = true;
+    bool evicted = destinations_[index].evicted_;
+    lock.unlock();
+
+    destination_handler_(
+        evicted && ec == asio::error::operation_aborted
+          ? asio::error_code(asio::error::timed_out) : ec,
+        n, destinations_[index].iterator_);
+
+    // The operation completes only once every destination handler has
+    // returned.
+    lock.lock();
+    if (!ec)
+      ++delivered_;
+    if (--pending_ == 0)
+    {
+      timer_.cancel();
+      lock.unlock();
+      complete();
+    }
+  }
+
+  // Cancel the writes that have not yet completed.
+  void cancel_writes(const shared_ptr<broadcast_op>& self,
+      cancellation_type_t type, bool evict)
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    if (pending_ == 0)
+      return;
+
+    if (!evict)
+    {
+      cancelled_ = true;
+      timer_.cancel();
+    }
+
+    for (std::size_t i = 0; i < destinations_.size(); ++i)
+    {
+      if (!destinations_[i].done_)
+      {
+        destinations_[i].evicted_ = destinations_[i].evicted_ || evict;
+        asio::post(broadcast_target(*destinations_[i].iterator_)
+            .get_executor(), emit_handler(self, i, type));
+      }
+    }
+  }
+
+  // Called exactly once, without the lock held, to deliver the result.
+  void complete()
+  {
+    typename associated_cancellation_slot<Handler>::type slot
+      = (get_associated_cancellation_slot)(handler_);
+    if (slot.is_connected())
+      slot.clear();
+
+    asio::post(executor_,
+        detail::move_binder2<Handler, asio::error_code, std::size_t>(0,
+          ASIO_MOVE_CAST(Handler)(handler_),
+          cancelled_ ? asio::error::operation_aborted : asio::error_code(),
+          std::size_t(delivered_)));
+  }
+
+  typedef typename associated_executor<
+      Handler, executor_type>::type handler_ex_t;
+
+  typedef typename decay<
+      typename prefer_result<const handler_ex_t&,
+        execution::outstanding_work_t::tracked_t
+      >::type
+    >::type work_executor_type;
+
+  // Mutex to protect access to internal data.
+  asio::detail::mutex mutex_;
+
+  // The data written to every stream.
+  shared_const_buffer message_;
+
+  // The streams, with the cancellation signal for the write to each one.
+  std::vector<destination> destinations_;
+
+  // The number of writes that have not yet completed, and the number that
+  // wrote the whole message.
+  std::size_t pending_;
+  std::size_t delivered_;
+
+  // Whether the operation as a whole has been cancelled.
+  bool cancelled_;
+
+  // The timer that evicts the streams that are too slow.
+  basic_waitable_timer<chrono::steady_clock,
+    wait_traits<chrono::steady_clock>, executor_type> timer_;
+  chrono::steady_clock::duration timeout_;
+
+  DestinationHandler destination_handler_;
+  Handler handler_;
+  work_executor_type executor_;
+};
+
+class initiate_async_broadcast
+{
+public:
+  template <typename BroadcastHandler, typename ForwardIterator,
+      typename DestinationHandler>
+  void operator()(ASIO_MOVE_ARG(BroadcastHandler) handler,
+      ForwardIterator begin, ForwardIterator end,
+      const shared_const_buffer& message,
+      const chrono::steady_clock::duration& timeout,
+      ASIO_MOVE_ARG(DestinationHandler) destination_handler) const
+  {
+    typedef broadcast_op<ForwardIterator,
+      typename decay<DestinationHandler>::type,
+      typename decay<BroadcastHandler>::type> op;
+
+    non_const_lvalue<BroadcastHandler> handler2(handler);
+    std::size_t count = static_cast<std::size_t>(std::distance(begin, end));
+    if (count == 0)
+    {
+      asio::post(detail::bind_handler(
+            ASIO_MOVE_CAST(typename decay<BroadcastHandler>::type)(
+              handler2.value), asio::error_code(), std::size_t(0)));
+      return;
+    }
+
+    non_const_lvalue<DestinationHandler> destination_handler2(
+        destination_handler);
+    op::start(shared_ptr<op>(new op(begin, count, message, timeout,
+            destination_handler2.value, handler2.value)));
+  }
+};
+
+} // namespace detail
+
+template <typename ForwardIterator, typename DestinationHandler,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      std::size_t)) BroadcastToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(BroadcastToken,
+    void (asio::error_code, std::size_t))
+async_broadcast(ForwardIterator begin, ForwardIterator end,
+    const shared_const_buffer& message,
+    const chrono::steady_clock::duration& timeout,
+    ASIO_MOVE_ARG(DestinationHandler) destination_handler,
+    ASIO_MOVE_ARG(BroadcastToken) token)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<BroadcastToken,
+      void (asio::error_code, std::size_t)>(
+        declval<detail::initiate_async_broadcast>(), token, begin, end,
+        message, timeout,
+        ASIO_MOVE_CAST(DestinationHandler)(destination_handler))))
+{
+  return async_initiate<BroadcastToken,
+    void (asio::error_code, std::size_t)>(
+      detail::initiate_async_broadcast(), token, begin, end,
+      message, timeout,
+      ASIO_MOVE_CAST(DestinationHandler)(destination_handler));
+}
+
+template <typename ForwardIterator, typename DestinationHandler,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      std::size_t)) BroadcastToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(BroadcastToken,
+    void (asio::error_code, std::size_t))
+async_broadcast(ForwardIterator begin, ForwardIterator end,
+    const shared_const_buffer& message,
+    ASIO_MOVE_ARG(DestinationHandler) destination_handler,
+    ASIO_MOVE_ARG(BroadcastToken) token)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<BroadcastToken,
+      void (asio::error_code, std::size_t)>(
+        declval<detail::initiate_async_broadcast>(), token, begin, end,
+        message, declval<chrono::steady_clock::duration>(),
+        ASIO_MOVE_CAST(DestinationHandler)(destination_handler))))
+{
+  return async_initiate<BroadcastToken,
+    void (asio::error_code, std::size_t)>(
+      detail::initiate_async_broadcast(), token, begin, end,
+      message, chrono::steady_clock::duration::zero(),
+      ASIO_MOVE_CAST(DestinationHandler)(destination_handler));
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
+
+#endif // ASIO_IMPL_BROADCAST_HPP
@@ -0,0 +1,76 @@
+//
+// impl/config.hpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_CONFIG_HPP
+#define ASIO_IMPL_CONFIG_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/limits.hpp"
+#include "asio/detail/type_traits.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Parse a boolean value, throwing std::invalid_argument on failure.
+ASIO_DECL bool config_parse_bool(const char* value);
+
+// Parse a signed integer value, throwing std::invalid_argument or
+// std::out_of_range on failure.
+ASIO_DECL long config_parse_signed(const char* value,
+    long min_value, long max_value);
+
+// Parse an unsigned integer value, throwing std::invalid_argument or
+// std::out_of_range on failure.
+ASIO_DECL unsigned long config_parse_unsigned(const char* value,
+    unsigned long max_value);
+
+} // namespace detail
+
+template <typename T>
+T config::get(const char* section, const char* key_name, T default_value) const
+{
+  char buffer[64];
+  const char* value = service_.get_value(
+      section, key_name, buffer, sizeof(buffer));
+  if (!value)
+    return default_value;
+
+  if (is_same<T, bool>::value)
+    return static_cast<T>(detail::config_parse_bool(value));
+
+  if (std::numeric_limits<T>::is_signed)
+  {
+    long min_value = (std::numeric_limits<long>::min)();
+    long max_value = (std::numeric_limits<long>::max)();
+    if (sizeof(T) < sizeof(long))
+    {
+      min_value = static_cast<long>((std::numeric_limits<T>::min)());
+      max_value = static_cast<long>((std::numeric_limits<T>::max)());
+    }
+    return static_cast<T>(
+        detail::config_parse_signed(value, min_value, max_value));
+  }
+
+  unsigned long max_value = (std::numeric_limits<unsigned long>::max)();
+  if (sizeof(T) < sizeof(unsigned long))
+    max_value = static_cast<unsigned long>((std::numeric_limits<T>::max)());
+  return static_cast<T>(detail::config_parse_unsigned(value, max_value));
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_CONFIG_HPP
@@ -0,0 +1,229 @@
+//
+// impl/config.ipp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_CONFIG_IPP
+#define ASIO_IMPL_CONFIG_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "asio/config.hpp"
+#include "asio/detail/scoped_ptr.hpp"
+#include "asio/detail/throw_exception.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+config_service::config_service(execution_context& ctx)
+  : detail::execution_context_service_base<config_service>(ctx)
+{
+}
+
+void config_service::shutdown()
+{
+}
+
+const char* config_service::get_value(const char* /*section*/,
+    const char* /*key_name*/, char* /*value*/,
+    std::size_t /*value_len*/) const
+{
+  return 0;
+}
+
+namespace detail {
+
+class config_from_string_service : public config_service
+{
+public:
+  config_from_string_service(execution_context& ctx,
+      const std::string& s, const std::string& prefix)
+    : config_service(ctx)
+  {
+    std::string::size_type line_start = 0;
+    while (line_start < s.size())
+    {
+      std::string::size_type line_end = s.find('\n', line_start);
+      if (line_end == std::string::npos)
+        line_end = s.size();
+      std::string line = trim(s.substr(line_start, line_end - line_start));
+      line_start = line_end + 1;
+
+      if (line.empty() || line[0] == '#')
+        continue;
+
+      std::string::size_type equals = line.find('=');
+      if (equals == std::string::npos)
+      {
+        std::invalid_argument ex("config_from_string: missing '='");
+        asio::detail::throw_exception(ex);
+      }
+
+      std::string key = trim(line.substr(0, equals));
+      std::string value = trim(line.substr(equals + 1));
+      if (!prefix.empty())
+      {
+        if (key.compare(0, prefix.size(), prefix) != 0
+            || key.size() <= prefix.size() || key[prefix.size()] != '.')
+          continue;
+        key.erase(0, prefix.size() + 1);
+      }
+
+      values_.push_back(std::make_pair(key, value));
+    }
+  }
+
+  const char* get_value(const char* section, const char* key_name,
+      char* /*value*/, std::size_t /*value_len*/) const
+  {
+    std::string key(section);
+    key += '.';
+    key += key_name;
+
+    // Later entries override earlier ones.
+    for (std::size_t i = values_.size(); i > 0; --i)
+      if (values_[i - 1].first == key)
+        return values_[i - 1].second.c_str();
+    return 0;
+  }
+
+private:
+  static std::string trim(const std::string& s)
+  {
+    std::string::size_type first = 0;
+    while (first < s.size() && is_space(s[first]))
+      ++first;
+    std::string::size_type last = s.size();
+    while (last > first && is_space(s[last - 1]))
+      --last;
+    return s.substr(first, last - first);
+  }
+
+  static bool is_space(char c)
+  {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+  }
+
+  std::vector<std::pair<std::string, std::string> > values_;
+};
+
+class config_from_env_service : public config_service
+{
+public:
+  config_from_env_service(execution_context& ctx, const std::string& prefix)
+    : config_service(ctx),
+      prefix_(prefix)
+  {
+  }
+
+  const char* get_value(const char* section, const char* key_name,
+      char* /*value*/, std::size_t /*value_len*/) const
+  {
+    std::string name(prefix_);
+    if (!name.empty())
+      name += '_';
+    name += section;
+    name += '_';
+    name += key_name;
+    for (std::size_t i = 0; i < name.size(); ++i)
+    {
+      if (std::isalnum(static_cast<unsigned char>(name[i])))
+        name[i] = static_cast<char>(
+            std::toupper(static_cast<unsigned char>(name[i])));
+      else
+        name[i] = '_';
+    }
+    return std::getenv(name.c_str());
+  }
+
+private:
+  std::string prefix_;
+};
+
+bool config_parse_bool(const char* value)
+{
+  if (std::strcmp(value, "1") == 0 || std::strcmp(value, "true") == 0)
+    return true;
+  if (std::strcmp(value, "0") == 0 || std::strcmp(value, "false") == 0)
+    return false;
+  std::invalid_argument ex("config: invalid boolean value");
+  asio::detail::throw_exception(ex);
+  return false;
+}
+
+long config_parse_signed(const char* value, long min_value, long max_value)
+{
+  char* end = 0;
+  errno = 0;
+  long result = std::strtol(value, &end, 0);
+  if (end == value || *end != 0)
+  {
+    std::invalid_argument ex("config: invalid integer value");
+    asio::detail::throw_exception(ex);
+  }
+  if (errno == ERANGE || result < min_value || result > max_value)
+  {
+    std::out_of_range ex("config: integer value out of range");
+    asio::detail::throw_exception(ex);
+  }
+  return result;
+}
+
+unsigned long config_parse_unsigned(const char* value,
+    unsigned long max_value)
+{
+  char* end = 0;
+  errno = 0;
+  unsigned long result = std::strtoul(value, &end, 0);
+  if (end == value || *end != 0 || std::strchr(value, '-') != 0)
+  {
+    std::invalid_argument ex("config: invalid unsigned integer value");
+    asio::detail::throw_exception(ex);
+  }
+  if (errno == ERANGE || result > max_value)
+  {
+    std::out_of_range ex("config: integer value out of range");
+    asio::detail::throw_exception(ex);
+  }
+  return result;
+}
+
+} // namespace detail
+
+void config_from_string::make(execution_context& ctx) const
+{
+  detail::scoped_ptr<config_service> svc(
+      new detail::config_from_string_service(ctx, string_, prefix_));
+  add_service<config_service>(ctx, svc.get());
+  svc.release();
+}
+
+void config_from_env::make(execution_context& ctx) const
+{
+  detail::scoped_ptr<config_service> svc(
+      new detail::config_from_env_service(ctx, prefix_));
+  add_service<config_service>(ctx, svc.get());
+  svc.release();
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_CONFIG_IPP
@@ -0,0 +1,672 @@
+//
+// impl/dfa_matcher.ipp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_DFA_MATCHER_IPP
+#define ASIO_IMPL_DFA_MATCHER_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <algorithm>
+#include <bitset>
+#include <map>
+#include <stdexcept>
+#include "asio/detail/throw_exception.hpp"
+#include "asio/dfa_matcher.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+const std::size_t dfa_npos = static_cast<std::size_t>(-1);
+
+// The largest count that may be given in a bounded repetition.
+const std::size_t dfa_max_repeat = 1000;
+
+// A node in the syntax tree of a pattern.
+struct dfa_node
+{
+  enum kind_type { chars, sequence, alternation, repetition };
+
+  explicit dfa_node(kind_type k)
+    : kind(k),
+      min(0),
+      max(0)
+  {
+  }
+
+  kind_type kind;
+  std::bitset<256> set;
+  std::vector<std::size_t> children;
+  std::size_t min;
+  std::size_t max; // dfa_npos if unbounded.
+};
+
+inline void dfa_throw_invalid(const char* what)
+{
+  std::invalid_argument ex(what);
+  asio::detail::throw_exception(ex);
+}
+
+// Parses a pattern into a syntax tree.
+class dfa_parser
+{
+public:
+  dfa_parser(const std::string& pattern, std::vector<dfa_node>& nodes)
+    : pattern_(pattern),
+      pos_(0),
+      nodes_(nodes)
+  {
+  }
+
+  // Parse a regular expression, returning the index of its root node.
+  std::size_t parse_regex()
+  {
+    std::size_t root = parse_alternation();
+    if (pos_ != pattern_.size())
+      dfa_throw_invalid("dfa_matcher: unmatched ')'");
+    return root;
+  }
+
+  // Parse a literal string, returning the index of its root node.
+  std::size_t parse_literal()
+  {
+    std::size_t root = add(dfa_node::sequence);
+    for (std::size_t i = 0; i < pattern_.size(); ++i)
+    {
+      std::size_t c = add(dfa_node::chars);
+      nodes_[c].set.set(static_cast<unsigned char>(pattern_[i]));
+      nodes_[root].children.push_back(c);
+    }
+    return root;
+  }
+
+private:
+  std::size_t add(dfa_node::kind_type kind)
+  {
+    nodes_.push_back(dfa_node(kind));
+    return nodes_.size() - 1;
+  }
+
+  bool at_end() const
+  {
+    return pos_ == pattern_.size();
+  }
+
+  char peek() const
+  {
+    return pattern_[pos_];
+  }
+
+  std::size_t parse_alternation()
+  {
+    std::size_t first = parse_sequence();
+    if (at_end() || peek() != '|')
+      return first;
+
+    std::size_t node = add(dfa_node::alternation);
+    nodes_[node].children.push_back(first);
+    while (!at_end() && peek() == '|')
+    {
+      ++pos_;
+      std::size_t next = parse_sequence();
+      nodes_[node].children.push_back(next);
+    }
+    return node;
+  }
+
+  std::size_t parse_sequence()
+  {
+    std::size_t node = add(dfa_node::sequence);
+    while (!at_end() && peek() != '|' && peek() != ')')
+    {
+      std::size_t item = parse_repetition();
+      nodes_[node].children.push_back(item);
+    }
+    return node;
+  }
+
+  std::size_t parse_repetition()
+  {
+    std::size_t item = parse_atom();
+    while (!at_end())
+    {
+      std::size_t min = 0, max = dfa_npos;
+      switch (peek())
+      {
+      case '*':
+        ++pos_;
+        break;
+      case '+':
+        ++pos_;
+        min = 1;
+        break;
+      case '?':
+        ++pos_;
+        max = 1;
+        break;
+      case '{':
+        ++pos_;
+        parse_bounds(min, max);
+        break;
+      default:
+        return item;
+      }
+
+      std::size_t node = add(dfa_node::repetition);
+      nodes_[node].children.push_back(item);
+      nodes_[node].min = min;
+      nodes_[node].max = max;
+      item = node;
+    }
+    return item;
+  }
+
+  void parse_bounds(std::size_t& min, std::size_t& max)
+  {
+    min = parse_count();
+    max = min;
+    if (!at_end() && peek() == ',')
+    {
+      ++pos_;
+      max = (!at_end() && peek() == '}') ? dfa_npos : parse_count();
+    }
+    if (at_end() || peek() != '}')
+      dfa_throw_invalid("dfa_matcher: invalid repetition");
+    ++pos_;
+    if (max < min)
+      dfa_throw_invalid("dfa_matcher: invalid repetition");
+  }
+
+  std::size_t parse_count()
+  {
+    std::size_t count = 0;
+    std::size_t start = pos_;
+    while (!at_end() && peek() >= '0' && peek() <= '9')
+    {
+      count = count * 10 + (peek() - '0');
+      if (count > dfa_max_repeat)
+        dfa_throw_invalid("dfa_matcher: repetition count too large");
+      ++pos_;
+    }
+    if (pos_ == start)
+      dfa_throw_invalid("dfa_matcher: invalid repetition");
+    return count;
+  }
+
+  std::size_t parse_atom()
+  {
+    char c = pattern_[pos_++];
+    switch (c)
+    {
+    case '(':
+      {
+        std::size_t node = parse_alternation();
+        if (at_end() || peek() != ')')
+          dfa_throw_invalid("dfa_matcher: unmatched '('");
+        ++pos_;
+        return node;
+      }
+    case '[':
+      return parse_class();
+    case '.':
+      {
+        std::size_t node = add(dfa_node::chars);
+        nodes_[node].set.set();
+        nodes_[node].set.reset('\n');
+        return node;
+      }
+    case '\\':
+      {
+        std::size_t node = add(dfa_node::chars);
+        parse_escape(nodes_[node].set);
+        return node;
+      }
+    case '*': case '+': case '?': case '{':
+      dfa_throw_invalid("dfa_matcher: nothing to repeat");
+      break;
+    case '^': case '$':
+      dfa_throw_invalid("dfa_matcher: anchors are not supported");
+      break;
+    default:
+      break;
+    }
+
+    std::size_t node = add(dfa_node::chars);
+    nodes_[node].set.set(static_cast<unsigned char>(c));
+    return node;
+  }
+
+  std::size_t parse_class()
+  {
+    std::size_t node = add(dfa_node::chars);
+    std::bitset<256> set;
+    bool negate = !at_end() && peek() == '^';
+    if (negate)
+      ++pos_;
+
+    bool first = true;
+    for (;;)
+    {
+      if (at_end())
+        dfa_throw_invalid("dfa_matcher: unmatched '['");
+      char c = pattern_[pos_++];
+      if (c == ']' && !first)
+        break;
+      first = false;
+
+      if (c == '\\')
+      {
+        std::bitset<256> escaped;
+        parse_escape(escaped);
+        if (escaped.count() != 1 || at_end() || peek() != '-')
+        {
+          set |= escaped;
+          continue;
+        }
+        for (std::size_t i = 0; i < 256; ++i)
+          if (escaped.test(i))
+            c = static_cast<char>(i);
+      }
+
+      // A range, unless the '-' is the last character in the class.
+      if (pos_ + 1 < pattern_.size() && peek() == '-'
+          && pattern_[pos_ + 1] != ']')
+      {
+        ++pos_;
+        char last = pattern_[pos_++];
+        if (last == '\\')
+        {
+          std::bitset<256> escaped;
+          parse_escape(escaped);
+          if (escaped.count() != 1)
+            dfa_throw_invalid("dfa_matcher: invalid range");
+          for (std::size_t i = 0; i < 256; ++i)
+            if (escaped.test(i))
+              last = static_cast<char>(i);
+        }
+        unsigned char from = static_cast<unsigned char>(c);
+        unsigned char to = static_cast<unsigned char>(last);
+        if (to < from)
+          dfa_throw_invalid("dfa_matcher: invalid range");
+        for (std::size_t i = from; i <= to; ++i)
+          set.set(i);
+      }
+      else
+      {
+        set.set(static_cast<unsigned char>(c));
+      }
+    }
+
+    nodes_[node].set = negate ? ~set : set;
+    return node;
+  }
+
+  // Parse the character after a backslash.
+  void parse_escape(std::bitset<256>& set)
+  {
+    if (at_end())
+      dfa_throw_invalid("dfa_matcher: trailing backslash");
+
+    char c = pattern_[pos_++];
+    bool negate = false;
+    switch (c)
+    {
+    case 'n': set.set('\n'); return;
+    case 'r': set.set('\r'); return;
+    case 't': set.set('\t'); return;
+    case 'f': set.set('\f'); return;
+    case 'v': set.set('\v'); return;
+    case '0': set.set(0); return;
+    case 'x':
+      {
+        std::size_t value = 0;
+        for (int i = 0; i < 2; ++i)
+        {
+          int digit = at_end() ? -1 : hex_digit(peek());
+          if (digit < 0)
+            dfa_throw_invalid("dfa_matcher: invalid escape");
+          value = value * 16 + digit;
+          ++pos_;
+        }
+        set.set(value);
+        return;
+      }
+    case 'D': negate = true; // Fall through.
+    case 'd':
+      for (char d = '0'; d <= '9'; ++d)
+        set.set(static_cast<unsigned char>(d));
+      break;
+    case 'S': negate = true; // Fall through.
+    case 's':
+      set.set(' ');
+      for (char s = '\t'; s <= '\r'; ++s)
+        set.set(static_cast<unsigned char>(s));
+      break;
+    case 'W': negate = true; // Fall through.
+    case 'w':
+      for (std::size_t i = 0; i < 128; ++i)
+        if ((i >= '0' && i <= '9') || (i >= 'a' && i <= 'z')
+            || (i >= 'A' && i <= 'Z') || i == '_')
+          set.set(i);
+      break;
+    default:
+      if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+          || (c >= 'A' && c <= 'Z'))
+        dfa_throw_invalid("dfa_matcher: invalid escape");
+      set.set(static_cast<unsigned char>(c));
+      return;
+    }
+
+    if (negate)
+      set.flip();
+  }
+
+  static int hex_digit(char c)
+  {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  const std::string& pattern_;
+  std::size_t pos_;
+  std::vector<dfa_node>& nodes_;
+};
+
+// A state of the nondeterministic automaton. A state either consumes a
+// character in its set and moves to the next state, or has only epsilon
+// transitions.
+struct dfa_nfa_state
+{
+  dfa_nfa_state()
+    : next(dfa_npos),
+      accepting(false)
+  {
+  }
+
+  std::bitset<256> set;
+  std::size_t next;
+  std::vector<std::size_t> epsilon;
+  bool accepting;
+};
+
+// Builds the nondeterministic automaton for a syntax tree.
+class dfa_nfa_builder
+{
+public:
+  dfa_nfa_builder(const std::vector<dfa_node>& nodes,
+      std::vector<dfa_nfa_state>& states)
+    : nodes_(nodes),
+      states_(states)
+  {
+  }
+
+  // Add the states for a node. Returns the start and end states.
+  std::pair<std::size_t, std::size_t> build(std::size_t index)
+  {
+    const dfa_node& node = nodes_[index];
+    std::size_t start = add_state();
+    std::size_t end = add_state();
+    switch (node.kind)
+    {
+    case dfa_node::chars:
+      states_[start].set = node.set;
+      states_[start].next = end;
+      break;
+    case dfa_node::sequence:
+      {
+        std::size_t last = start;
+        for (std::size_t i = 0; i < node.children.size(); ++i)
+        {
+          std::pair<std::size_t, std::size_t> child = build(node.children[i]);
+          states_[last].epsilon.push_back(child.first);
+          last = child.second;
+        }
+        states_[last].epsilon.push_back(end);
+      }
+      break;
+    case dfa_node::alternation:
+      for (std::size_t i = 0; i < node.children.size(); ++i)
+      {
+        std::pair<std::size_t, std::size_t> child = build(node.children[i]);
+        states_[start].epsilon.push_back(child.first);
+        states_[child.second].epsilon.push_back(end);
+      }
+      break;
+    case dfa_node::repetition:
+      {
+        std::size_t last = start;
+        for (std::size_t i = 0; i < node.min; ++i)
+        {
+          std::pair<std::size_t, std::size_t> child = build(node.children[0]);
+          states_[last].epsilon.push_back(child.first);
+          last = child.second;
+        }
+        if (node.max == dfa_npos)
+        {
+          std::pair<std::size_t, std::size_t> child = build(node.children[0]);
+          states_[last].epsilon.push_back(child.first);
+          states_[child.second].epsilon.push_back(child.first);
+          states_[child.second].epsilon.push_back(end);
+        }
+        else
+        {
+          for (std::size_t i = node.min; i < node.max; ++i)
+          {
+            std::pair<std::size_t, std::size_t> child =
+              build(node.children[0]);
+            states_[last].epsilon.push_back(child.first);
+            states_[last].epsilon.push_back(end);
+            last = child.second;
+          }
+        }
+        states_[last].epsilon.push_back(end);
+      }
+      break;
+    }
+    return std::make_pair(start, end);
+  }
+
+  // Determine whether a node can match the empty string.
+  bool nullable(std::size_t index) const
+  {
+    const dfa_node& node = nodes_[index];
+    switch (node.kind)
+    {
+    case dfa_node::chars:
+      return false;
+    case dfa_node::sequence:
+      for (std::size_t i = 0; i < node.children.size(); ++i)
+        if (!nullable(node.children[i]))
+          return false;
+      return true;
+    case dfa_node::alternation:
+      for (std::size_t i = 0; i < node.children.size(); ++i)
+        if (nullable(node.children[i]))
+          return true;
+      return false;
+    case dfa_node::repetition:
+    default:
+      return node.min == 0 || nullable(node.children[0]);
+    }
+  }
+
+private:
+  std::size_t add_state()
+  {
+    states_.push_back(dfa_nfa_state());
+    return states_.size() - 1;
+  }
+
+  const std::vector<dfa_node>& nodes_;
+  std::vector<dfa_nfa_state>& states_;
+};
+
+// Add the epsilon closure of a set of states to the set. The result is
+// sorted, so that it can be used to identify a deterministic state. The seen
+// flags must all be clear, and are cleared again on return.
+inline void dfa_closure(const std::vector<dfa_nfa_state>& states,
+    std::vector<std::size_t>& set, std::vector<unsigned char>& seen)
+{
+  std::vector<std::size_t> stack(set);
+  set.clear();
+  while (!stack.empty())
+  {
+    std::size_t s = stack.back();
+    stack.pop_back();
+    if (seen[s])
+      continue;
+    seen[s] = 1;
+    set.push_back(s);
+    for (std::size_t i = 0; i < states[s].epsilon.size(); ++i)
+      if (!seen[states[s].epsilon[i]])
+        stack.push_back(states[s].epsilon[i]);
+  }
+  for (std::size_t i = 0; i < set.size(); ++i)
+    seen[set[i]] = 0;
+  std::sort(set.begin(), set.end());
+}
+
+} // namespace detail
+
+dfa_matcher::dfa_matcher(const std::string& pattern, syntax_type syntax)
+  : automaton_(compile(std::vector<std::string>(1, pattern), syntax)),
+    state_(0)
+{
+}
+
+dfa_matcher::dfa_matcher(const std::vector<std::string>& patterns,
+    syntax_type syntax)
+  : automaton_(compile(patterns, syntax)),
+    state_(0)
+{
+}
+
+asio::detail::shared_ptr<dfa_matcher::automaton> dfa_matcher::compile(
+    const std::vector<std::string>& patterns, syntax_type syntax)
+{
+  using namespace asio::detail;
+
+  if (patterns.empty())
+    dfa_throw_invalid("dfa_matcher: no patterns");
+
+  // Build a nondeterministic automaton whose start state leads to each of
+  // the patterns.
+  std::vector<dfa_nfa_state> states(1);
+  for (std::size_t i = 0; i < patterns.size(); ++i)
+  {
+    std::vector<dfa_node> nodes;
+    dfa_parser parser(patterns[i], nodes);
+    std::size_t root = (syntax == literal)
+      ? parser.parse_literal() : parser.parse_regex();
+
+    dfa_nfa_builder builder(nodes, states);
+    if (builder.nullable(root))
+      dfa_throw_invalid("dfa_matcher: pattern matches the empty string");
+
+    std::pair<std::size_t, std::size_t> fragment = builder.build(root);
+    states[0].epsilon.push_back(fragment.first);
+    states[fragment.second].accepting = true;
+  }
+
+  // Characters that are in exactly the same sets always lead to the same
+  // state, so only one character from each such class needs to be examined.
+  std::vector<std::size_t> byte_class(256);
+  std::vector<std::size_t> representatives;
+  {
+    std::map<std::vector<bool>, std::size_t> classes;
+    for (std::size_t c = 0; c < 256; ++c)
+    {
+      std::vector<bool> key;
+      for (std::size_t i = 0; i < states.size(); ++i)
+        if (states[i].next != dfa_npos)
+          key.push_back(states[i].set.test(c));
+
+      std::map<std::vector<bool>, std::size_t>::iterator iter =
+        classes.find(key);
+      if (iter == classes.end())
+      {
+        iter = classes.insert(
+            std::make_pair(key, representatives.size())).first;
+        representatives.push_back(c);
+      }
+      byte_class[c] = iter->second;
+    }
+  }
+
+  // Convert it to a deterministic automaton using the subset construction.
+  // The search is unanchored, so every state also includes the closure of
+  // the start state.
+  std::vector<unsigned char> seen(states.size());
+  std::vector<std::size_t> initial(1, 0);
+  dfa_closure(states, initial, seen);
+
+  shared_ptr<automaton> result(new automaton);
+  std::map<std::vector<std::size_t>, unsigned int> ids;
+  std::vector<std::vector<std::size_t> > subsets;
+  ids[initial] = 0;
+  subsets.push_back(initial);
+
+  std::vector<unsigned int> class_targets(representatives.size());
+  for (std::size_t current = 0; current < subsets.size(); ++current)
+  {
+    bool accepting = false;
+    for (std::size_t i = 0; i < subsets[current].size(); ++i)
+      if (states[subsets[current][i]].accepting)
+        accepting = true;
+    result->accepting.push_back(accepting ? 1 : 0);
+
+    for (std::size_t k = 0; k < representatives.size(); ++k)
+    {
+      std::vector<std::size_t> target(1, 0);
+      for (std::size_t i = 0; i < subsets[current].size(); ++i)
+      {
+        const dfa_nfa_state& s = states[subsets[current][i]];
+        if (s.next != dfa_npos && s.set.test(representatives[k]))
+          target.push_back(s.next);
+      }
+      dfa_closure(states, target, seen);
+
+      std::map<std::vector<std::size_t>, unsigned int>::iterator iter =
+        ids.find(target);
+      if (iter == ids.end())
+      {
+        if (subsets.size() == max_states)
+        {
+          std::length_error ex("dfa_matcher: too many states");
+          asio::detail::throw_exception(ex);
+        }
+        unsigned int id = static_cast<unsigned int>(subsets.size());
+        iter = ids.insert(std::make_pair(target, id)).first;
+        subsets.push_back(target);
+      }
+      class_targets[k] = iter->second;
+    }
+
+    for (std::size_t c = 0; c < 256; ++c)
+      result->transitions.push_back(class_targets[byte_class[c]]);
+  }
+
+  return result;
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_DFA_MATCHER_IPP
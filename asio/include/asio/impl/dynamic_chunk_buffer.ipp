@@ -0,0 +1,159 @@
+//
+// impl/dynamic_chunk_buffer.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_DYNAMIC_CHUNK_BUFFER_IPP
+#define ASIO_IMPL_DYNAMIC_CHUNK_BUFFER_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <new>
+#include "asio/dynamic_chunk_buffer.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+chunk_pool::chunk_pool(std::size_t chunk_size, std::size_t max_cached_chunks)
+  : chunk_size_(chunk_size < sizeof(chunk_link)
+      ? sizeof(chunk_link) : chunk_size),
+    max_cached_chunks_(max_cached_chunks),
+    cached_(0),
+    cached_count_(0)
+{
+}
+
+chunk_pool::~chunk_pool()
+{
+  while (cached_)
+  {
+    chunk_link* link = cached_;
+    cached_ = link->next_;
+    ::operator delete(link);
+  }
+}
+
+std::size_t chunk_pool::cached_chunks() const
+{
+  asio::detail::mutex::scoped_lock lock(mutex_);
+  return cached_count_;
+}
+
+char* chunk_pool::allocate() ASIO_NOEXCEPT
+{
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    if (chunk_link* link = cached_)
+    {
+      cached_ = link->next_;
+      --cached_count_;
+      return reinterpret_cast<char*>(link);
+    }
+  }
+
+  return static_cast<char*>(::operator new(chunk_size_, std::nothrow));
+}
+
+void chunk_pool::deallocate(char* chunk) ASIO_NOEXCEPT
+{
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    if (cached_count_ < max_cached_chunks_)
+    {
+      chunk_link* link = new (chunk) chunk_link;
+      link->next_ = cached_;
+      cached_ = link;
+      ++cached_count_;
+      return;
+    }
+  }
+
+  ::operator delete(chunk);
+}
+
+void chunk_buffer::clear() ASIO_NOEXCEPT
+{
+  while (!chunks_.empty())
+  {
+    pool_.deallocate(chunks_.back());
+    chunks_.pop_back();
+  }
+  start_ = 0;
+  size_ = 0;
+}
+
+void chunk_buffer::reserve(std::size_t n)
+{
+  if (size_ > max_size_ || max_size_ - size_ < n)
+  {
+    std::length_error ex("dynamic_chunk_buffer too long");
+    asio::detail::throw_exception(ex);
+  }
+
+  const std::size_t chunk_size = pool_.chunk_size();
+  std::size_t available = chunks_.size() * chunk_size - start_ - size_;
+  while (available < n)
+  {
+    chunks_.push_back(0);
+    chunks_.back() = pool_.allocate();
+    if (chunks_.back() == 0)
+    {
+      chunks_.pop_back();
+      std::bad_alloc ex;
+      asio::detail::throw_exception(ex);
+    }
+    available += chunk_size;
+  }
+}
+
+void chunk_buffer::shrink(std::size_t n) ASIO_NOEXCEPT
+{
+  if (n >= size_)
+  {
+    clear();
+    return;
+  }
+
+  // Return the chunks that lie entirely beyond the end of the data.
+  const std::size_t chunk_size = pool_.chunk_size();
+  size_ -= n;
+  while ((chunks_.size() - 1) * chunk_size >= start_ + size_)
+  {
+    pool_.deallocate(chunks_.back());
+    chunks_.pop_back();
+  }
+}
+
+void chunk_buffer::consume(std::size_t n) ASIO_NOEXCEPT
+{
+  if (n >= size_)
+  {
+    clear();
+    return;
+  }
+
+  const std::size_t chunk_size = pool_.chunk_size();
+  size_ -= n;
+  start_ += n;
+  while (start_ >= chunk_size)
+  {
+    pool_.deallocate(chunks_.front());
+    chunks_.pop_front();
+    start_ -= chunk_size;
+  }
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_DYNAMIC_CHUNK_BUFFER_IPP
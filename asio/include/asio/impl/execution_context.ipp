@@ -28,6 +28,27 @@ execution_context::execution_context()
 {
 }
 
+execution_context::execution_context(
+    const execution_context::service_maker& initial_services)
+  : service_registry_(new asio::detail::service_registry(*this))
+{
+#if !defined(ASIO_NO_EXCEPTIONS)
+  try
+  {
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+    initial_services.make(*this);
+#if !defined(ASIO_NO_EXCEPTIONS)
+  }
+  catch (...)
+  {
+    shutdown();
+    destroy();
+    delete service_registry_;
+    throw;
+  }
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+}
+
 execution_context::~execution_context()
 {
   shutdown();
@@ -65,6 +86,10 @@ void execution_context::service::notify_fork(execution_context::fork_event)
 {
 }
 
+execution_context::service_maker::~service_maker()
+{
+}
+
 service_already_exists::service_already_exists()
   : std::logic_error("Service already exists.")
 {
@@ -229,6 +229,9 @@ io_context::basic_executor_type<Allocator, Bits>::operator=(
     static_cast<Allocator&>(*this) = static_cast<const Allocator&>(other);
     io_context* old_io_context = context_ptr();
     target_ = other.target_;
+#if !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+    priority_ = other.priority_;
+#endif // !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
     if (Bits & outstanding_work_tracked)
     {
       if (context_ptr())
@@ -251,6 +254,9 @@ io_context::basic_executor_type<Allocator, Bits>::operator=(
     static_cast<Allocator&>(*this) = static_cast<Allocator&&>(other);
     io_context* old_io_context = context_ptr();
     target_ = other.target_;
+#if !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+    priority_ = other.priority_;
+#endif // !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
     if (Bits & outstanding_work_tracked)
     {
       other.target_ = 0;
@@ -315,8 +321,15 @@ void io_context::basic_executor_type<Allocator, Bits>::execute(
   ASIO_HANDLER_CREATION((*context_ptr(), *p.p,
         "io_context", context_ptr(), 0, "execute"));
 
-  context_ptr()->impl_.post_immediate_completion(p.p,
-      (bits() & relationship_continuation) != 0);
+  if (unsigned int level = priority())
+  {
+    context_ptr()->impl_.post_priority_completion(p.p, level);
+  }
+  else
+  {
+    context_ptr()->impl_.post_immediate_completion(p.p,
+        (bits() & relationship_continuation) != 0);
+  }
   p.v = p.p = 0;
 }
 
@@ -369,7 +382,10 @@ void io_context::basic_executor_type<Allocator, Bits>::dispatch(
   ASIO_HANDLER_CREATION((*context_ptr(), *p.p,
         "io_context", context_ptr(), 0, "dispatch"));
 
-  context_ptr()->impl_.post_immediate_completion(p.p, false);
+  if (unsigned int level = priority())
+    context_ptr()->impl_.post_priority_completion(p.p, level);
+  else
+    context_ptr()->impl_.post_immediate_completion(p.p, false);
   p.v = p.p = 0;
 }
 
@@ -389,7 +405,10 @@ void io_context::basic_executor_type<Allocator, Bits>::post(
   ASIO_HANDLER_CREATION((*context_ptr(), *p.p,
         "io_context", context_ptr(), 0, "post"));
 
-  context_ptr()->impl_.post_immediate_completion(p.p, false);
+  if (unsigned int level = priority())
+    context_ptr()->impl_.post_priority_completion(p.p, level);
+  else
+    context_ptr()->impl_.post_immediate_completion(p.p, false);
   p.v = p.p = 0;
 }
 
@@ -409,7 +428,10 @@ void io_context::basic_executor_type<Allocator, Bits>::defer(
   ASIO_HANDLER_CREATION((*context_ptr(), *p.p,
         "io_context", context_ptr(), 0, "defer"));
 
-  context_ptr()->impl_.post_immediate_completion(p.p, true);
+  if (unsigned int level = priority())
+    context_ptr()->impl_.post_priority_completion(p.p, level);
+  else
+    context_ptr()->impl_.post_immediate_completion(p.p, true);
   p.v = p.p = 0;
 }
 #endif // !defined(ASIO_NO_TS_EXECUTORS)
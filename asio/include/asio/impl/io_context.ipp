@@ -17,6 +17,7 @@
 
 #include "asio/detail/config.hpp"
 #include "asio/io_context.hpp"
+#include "asio/config.hpp"
 #include "asio/detail/concurrency_hint.hpp"
 #include "asio/detail/limits.hpp"
 #include "asio/detail/scoped_ptr.hpp"
@@ -45,6 +46,21 @@ io_context::io_context(int concurrency_hint)
 {
 }
 
+io_context::io_context(
+    const execution_context::service_maker& initial_services)
+  : execution_context(initial_services),
+    impl_(add_impl(new impl_type(*this,
+          configured_concurrency_hint(*this), false)))
+{
+}
+
+int io_context::configured_concurrency_hint(execution_context& ctx)
+{
+  int concurrency_hint = config(ctx).get("scheduler",
+      "concurrency_hint", static_cast<int>(ASIO_CONCURRENCY_HINT_DEFAULT));
+  return concurrency_hint == 1 ? ASIO_CONCURRENCY_HINT_1 : concurrency_hint;
+}
+
 io_context::impl_type& io_context::add_impl(io_context::impl_type* impl)
 {
   asio::detail::scoped_ptr<impl_type> scoped_impl(impl);
@@ -131,6 +147,15 @@ void io_context::restart()
   impl_.restart();
 }
 
+io_context::statistics io_context::get_statistics() const
+{
+  statistics stats;
+#if !defined(ASIO_HAS_IOCP)
+  impl_.get_statistics(stats);
+#endif // !defined(ASIO_HAS_IOCP)
+  return stats;
+}
+
 io_context::service::service(asio::io_context& owner)
   : execution_context::service(owner)
 {
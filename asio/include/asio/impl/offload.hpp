@@ -0,0 +1,170 @@
+//
+// impl/offload.hpp
+// ~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_OFFLOAD_HPP
+#define ASIO_IMPL_OFFLOAD_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/handler_tracking.hpp"
+#include "asio/detail/non_const_lvalue.hpp"
+#include "asio/error.hpp"
+#include "asio/execution/context.hpp"
+#include "asio/post.hpp"
+#include "asio/query.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename Executor>
+class initiate_offload
+{
+public:
+  typedef Executor executor_type;
+
+  explicit initiate_offload(const Executor& ex)
+    : ex_(ex)
+  {
+  }
+
+  executor_type get_executor() const ASIO_NOEXCEPT
+  {
+    return ex_;
+  }
+
+  template <typename Handler, typename Function>
+  void operator()(ASIO_MOVE_ARG(Handler) handler,
+      ASIO_MOVE_ARG(Function) f) const
+  {
+    typedef typename decay<Handler>::type handler_type;
+    typedef typename decay<Function>::type function_type;
+    typedef offload_op<function_type, handler_type, Executor> op;
+
+    execution_context& ctx = asio::query(ex_, execution::context);
+    blocking_offload_service& service =
+      asio::use_service<blocking_offload_service>(ctx);
+
+    // Obtain a non-const instance of the handler.
+    non_const_lvalue<Handler> handler2(handler);
+
+    // The function cannot be run if the completion cannot be posted safely
+    // from another thread.
+    if (!service.is_supported())
+    {
+      reject<typename op::result_type>(handler2.value,
+          asio::error::operation_not_supported,
+          is_void<typename op::result_type>());
+      return;
+    }
+
+    typename op::ptr p = { asio::detail::addressof(handler2.value),
+      op::ptr::allocate(handler2.value), 0 };
+    p.p = new (p.v) op(ASIO_MOVE_CAST(Function)(f), handler2.value, ex_);
+
+    ASIO_HANDLER_CREATION((ctx, *p.p, "offload", &service, 0, "offload"));
+
+    if (service.start_op(p.p))
+    {
+      p.v = p.p = 0;
+      return;
+    }
+
+    // The queue is full, so the function is not run.
+    handler_type handler3(ASIO_MOVE_CAST(handler_type)(p.p->handler()));
+    p.h = asio::detail::addressof(handler3);
+    p.reset();
+    reject<typename op::result_type>(handler3, asio::error::try_again,
+        is_void<typename op::result_type>());
+  }
+
+private:
+  template <typename Result, typename Handler>
+  void reject(Handler& handler,
+      const asio::error_code& ec, false_type) const
+  {
+#if defined(ASIO_HAS_MOVE)
+    asio::post(ex_,
+        detail::move_binder2<Handler, asio::error_code, Result>(0,
+          ASIO_MOVE_CAST(Handler)(handler), ec, Result()));
+#else // defined(ASIO_HAS_MOVE)
+    asio::post(ex_, detail::bind_handler(handler, ec, Result()));
+#endif // defined(ASIO_HAS_MOVE)
+  }
+
+  template <typename Result, typename Handler>
+  void reject(Handler& handler,
+      const asio::error_code& ec, true_type) const
+  {
+    asio::post(ex_,
+        detail::bind_handler(ASIO_MOVE_CAST(Handler)(handler), ec));
+  }
+
+  Executor ex_;
+};
+
+} // namespace detail
+
+template <typename Executor, typename Function,
+    ASIO_COMPLETION_TOKEN_FOR(
+      typename detail::offload_signature<Function>::type) CompletionToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(CompletionToken,
+    typename detail::offload_signature<Function>::type) offload(
+    const Executor& ex, ASIO_MOVE_ARG(Function) f,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename constraint<
+      execution::is_executor<Executor>::value
+    >::type)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<CompletionToken,
+      typename detail::offload_signature<Function>::type>(
+        declval<detail::initiate_offload<Executor> >(),
+        token, ASIO_MOVE_CAST(Function)(f))))
+{
+  return async_initiate<CompletionToken,
+    typename detail::offload_signature<Function>::type>(
+      detail::initiate_offload<Executor>(ex),
+      token, ASIO_MOVE_CAST(Function)(f));
+}
+
+template <typename ExecutionContext, typename Function,
+    ASIO_COMPLETION_TOKEN_FOR(
+      typename detail::offload_signature<Function>::type) CompletionToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(CompletionToken,
+    typename detail::offload_signature<Function>::type) offload(
+    ExecutionContext& ctx, ASIO_MOVE_ARG(Function) f,
+    ASIO_MOVE_ARG(CompletionToken) token,
+    typename constraint<is_convertible<
+      ExecutionContext&, execution_context&>::value>::type)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<CompletionToken,
+      typename detail::offload_signature<Function>::type>(
+        declval<detail::initiate_offload<
+          typename ExecutionContext::executor_type> >(),
+        token, ASIO_MOVE_CAST(Function)(f))))
+{
+  return async_initiate<CompletionToken,
+    typename detail::offload_signature<Function>::type>(
+      detail::initiate_offload<
+        typename ExecutionContext::executor_type>(
+          ctx.get_executor()),
+      token, ASIO_MOVE_CAST(Function)(f));
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_OFFLOAD_HPP
@@ -0,0 +1,37 @@
+//
+// impl/offload.ipp
+// ~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_OFFLOAD_IPP
+#define ASIO_IMPL_OFFLOAD_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/offload.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+offload_statistics get_offload_statistics(execution_context& ctx)
+{
+  offload_statistics stats;
+  asio::use_service<detail::blocking_offload_service>(ctx).get_statistics(
+      stats);
+  return stats;
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_OFFLOAD_IPP
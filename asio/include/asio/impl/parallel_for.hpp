@@ -0,0 +1,154 @@
+//
+// impl/parallel_for.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_PARALLEL_FOR_HPP
+#define ASIO_IMPL_PARALLEL_FOR_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/associated_allocator.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/parallel_range_op.hpp"
+#include "asio/execution/allocator.hpp"
+#include "asio/execution/blocking.hpp"
+#include "asio/execution/execute.hpp"
+#include "asio/prefer.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename Function>
+class parallel_for_body
+{
+public:
+  template <typename F>
+  explicit parallel_for_body(ASIO_MOVE_ARG(F) f)
+    : function_(ASIO_MOVE_CAST(F)(f))
+  {
+  }
+
+#if defined(ASIO_HAS_MOVE)
+  parallel_for_body(const parallel_for_body& other)
+    : function_(other.function_)
+  {
+  }
+
+  parallel_for_body(parallel_for_body&& other)
+    : function_(ASIO_MOVE_CAST(Function)(other.function_))
+  {
+  }
+#endif // defined(ASIO_HAS_MOVE)
+
+  // The function is shared by the workers, and is called through a const
+  // reference.
+  void run(std::size_t begin, std::size_t end)
+  {
+    const Function& function = function_;
+    for (; begin != end; ++begin)
+      function(begin);
+  }
+
+  template <typename Handler, typename Executor>
+  void complete(Handler& handler, const Executor& ex)
+  {
+    typename associated_allocator<Handler>::type alloc(
+        (get_associated_allocator)(handler));
+    execution::execute(
+        asio::prefer(ex,
+          execution::blocking.possibly,
+          execution::allocator(alloc)),
+        asio::detail::bind_handler(
+          ASIO_MOVE_CAST(Handler)(handler)));
+  }
+
+private:
+  Function function_;
+};
+
+template <typename Executor>
+class initiate_parallel_for
+{
+public:
+  typedef Executor executor_type;
+
+  explicit initiate_parallel_for(const Executor& ex)
+    : ex_(ex)
+  {
+  }
+
+  executor_type get_executor() const ASIO_NOEXCEPT
+  {
+    return ex_;
+  }
+
+  template <typename NullaryHandler, typename Function>
+  void operator()(ASIO_MOVE_ARG(NullaryHandler) handler,
+      std::size_t n, ASIO_MOVE_ARG(Function) f) const
+  {
+    detail::start_parallel_range_op(
+        parallel_for_body<typename decay<Function>::type>(
+          ASIO_MOVE_CAST(Function)(f)),
+        ASIO_MOVE_CAST(NullaryHandler)(handler), ex_, n);
+  }
+
+private:
+  Executor ex_;
+};
+
+} // namespace detail
+
+template <typename Executor, typename Function,
+    ASIO_COMPLETION_TOKEN_FOR(void()) NullaryToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(NullaryToken, void()) parallel_for(
+    const Executor& ex, std::size_t n, ASIO_MOVE_ARG(Function) f,
+    ASIO_MOVE_ARG(NullaryToken) token,
+    typename constraint<
+      execution::is_executor<Executor>::value
+    >::type)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<NullaryToken, void()>(
+        declval<detail::initiate_parallel_for<Executor> >(),
+        token, n, ASIO_MOVE_CAST(Function)(f))))
+{
+  return async_initiate<NullaryToken, void()>(
+      detail::initiate_parallel_for<Executor>(ex),
+      token, n, ASIO_MOVE_CAST(Function)(f));
+}
+
+template <typename ExecutionContext, typename Function,
+    ASIO_COMPLETION_TOKEN_FOR(void()) NullaryToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(NullaryToken, void()) parallel_for(
+    ExecutionContext& ctx, std::size_t n, ASIO_MOVE_ARG(Function) f,
+    ASIO_MOVE_ARG(NullaryToken) token,
+    typename constraint<is_convertible<
+      ExecutionContext&, execution_context&>::value>::type)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<NullaryToken, void()>(
+        declval<detail::initiate_parallel_for<
+          typename ExecutionContext::executor_type> >(),
+        token, n, ASIO_MOVE_CAST(Function)(f))))
+{
+  return async_initiate<NullaryToken, void()>(
+      detail::initiate_parallel_for<
+        typename ExecutionContext::executor_type>(
+          ctx.get_executor()),
+      token, n, ASIO_MOVE_CAST(Function)(f));
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_PARALLEL_FOR_HPP
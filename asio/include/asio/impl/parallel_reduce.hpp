@@ -0,0 +1,190 @@
+//
+// impl/parallel_reduce.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_PARALLEL_REDUCE_HPP
+#define ASIO_IMPL_PARALLEL_REDUCE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/associated_allocator.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/parallel_range_op.hpp"
+#include "asio/execution/allocator.hpp"
+#include "asio/execution/blocking.hpp"
+#include "asio/execution/execute.hpp"
+#include "asio/prefer.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename T, typename MapFunction, typename ReduceFunction>
+class parallel_reduce_body
+{
+public:
+  template <typename M, typename R>
+  parallel_reduce_body(const T& init,
+      ASIO_MOVE_ARG(M) map, ASIO_MOVE_ARG(R) reduce)
+    : result_(init),
+      map_(ASIO_MOVE_CAST(M)(map)),
+      reduce_(ASIO_MOVE_CAST(R)(reduce))
+  {
+  }
+
+  // The mutex is not copied. Copies are made only before the workers start or
+  // after they have finished.
+  parallel_reduce_body(const parallel_reduce_body& other)
+    : result_(other.result_),
+      map_(other.map_),
+      reduce_(other.reduce_)
+  {
+  }
+
+#if defined(ASIO_HAS_MOVE)
+  parallel_reduce_body(parallel_reduce_body&& other)
+    : result_(ASIO_MOVE_CAST(T)(other.result_)),
+      map_(ASIO_MOVE_CAST(MapFunction)(other.map_)),
+      reduce_(ASIO_MOVE_CAST(ReduceFunction)(other.reduce_))
+  {
+  }
+#endif // defined(ASIO_HAS_MOVE)
+
+  // The functions are shared by the workers, and are called through const
+  // references.
+  void run(std::size_t begin, std::size_t end)
+  {
+    const MapFunction& map = map_;
+    const ReduceFunction& reduce = reduce_;
+
+    // Combine the values for the chunk without holding the lock.
+    T value(map(begin));
+    while (++begin != end)
+      value = reduce(value, map(begin));
+
+    mutex::scoped_lock lock(mutex_);
+    result_ = reduce(result_, value);
+  }
+
+  template <typename Handler, typename Executor>
+  void complete(Handler& handler, const Executor& ex)
+  {
+    typename associated_allocator<Handler>::type alloc(
+        (get_associated_allocator)(handler));
+    execution::execute(
+        asio::prefer(ex,
+          execution::blocking.possibly,
+          execution::allocator(alloc)),
+        asio::detail::bind_handler(
+          ASIO_MOVE_CAST(Handler)(handler),
+          ASIO_MOVE_CAST(T)(result_)));
+  }
+
+private:
+  // Disallow assignment.
+  parallel_reduce_body& operator=(const parallel_reduce_body&);
+
+  T result_;
+  MapFunction map_;
+  ReduceFunction reduce_;
+  mutex mutex_;
+};
+
+template <typename Executor>
+class initiate_parallel_reduce
+{
+public:
+  typedef Executor executor_type;
+
+  explicit initiate_parallel_reduce(const Executor& ex)
+    : ex_(ex)
+  {
+  }
+
+  executor_type get_executor() const ASIO_NOEXCEPT
+  {
+    return ex_;
+  }
+
+  template <typename ReduceHandler, typename T,
+      typename MapFunction, typename ReduceFunction>
+  void operator()(ASIO_MOVE_ARG(ReduceHandler) handler,
+      std::size_t n, const T& init, ASIO_MOVE_ARG(MapFunction) map,
+      ASIO_MOVE_ARG(ReduceFunction) reduce) const
+  {
+    detail::start_parallel_range_op(
+        parallel_reduce_body<T, typename decay<MapFunction>::type,
+          typename decay<ReduceFunction>::type>(init,
+            ASIO_MOVE_CAST(MapFunction)(map),
+            ASIO_MOVE_CAST(ReduceFunction)(reduce)),
+        ASIO_MOVE_CAST(ReduceHandler)(handler), ex_, n);
+  }
+
+private:
+  Executor ex_;
+};
+
+} // namespace detail
+
+template <typename Executor, typename T,
+    typename MapFunction, typename ReduceFunction,
+    ASIO_COMPLETION_TOKEN_FOR(void(T)) ReduceToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(ReduceToken, void(T))
+parallel_reduce(const Executor& ex, std::size_t n, T init,
+    ASIO_MOVE_ARG(MapFunction) map, ASIO_MOVE_ARG(ReduceFunction) reduce,
+    ASIO_MOVE_ARG(ReduceToken) token,
+    typename constraint<
+      execution::is_executor<Executor>::value
+    >::type)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<ReduceToken, void(T)>(
+        declval<detail::initiate_parallel_reduce<Executor> >(),
+        token, n, init, ASIO_MOVE_CAST(MapFunction)(map),
+        ASIO_MOVE_CAST(ReduceFunction)(reduce))))
+{
+  return async_initiate<ReduceToken, void(T)>(
+      detail::initiate_parallel_reduce<Executor>(ex),
+      token, n, init, ASIO_MOVE_CAST(MapFunction)(map),
+      ASIO_MOVE_CAST(ReduceFunction)(reduce));
+}
+
+template <typename ExecutionContext, typename T,
+    typename MapFunction, typename ReduceFunction,
+    ASIO_COMPLETION_TOKEN_FOR(void(T)) ReduceToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(ReduceToken, void(T))
+parallel_reduce(ExecutionContext& ctx, std::size_t n, T init,
+    ASIO_MOVE_ARG(MapFunction) map, ASIO_MOVE_ARG(ReduceFunction) reduce,
+    ASIO_MOVE_ARG(ReduceToken) token,
+    typename constraint<is_convertible<
+      ExecutionContext&, execution_context&>::value>::type)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<ReduceToken, void(T)>(
+        declval<detail::initiate_parallel_reduce<
+          typename ExecutionContext::executor_type> >(),
+        token, n, init, ASIO_MOVE_CAST(MapFunction)(map),
+        ASIO_MOVE_CAST(ReduceFunction)(reduce))))
+{
+  return async_initiate<ReduceToken, void(T)>(
+      detail::initiate_parallel_reduce<
+        typename ExecutionContext::executor_type>(
+          ctx.get_executor()),
+      token, n, init, ASIO_MOVE_CAST(MapFunction)(map),
+      ASIO_MOVE_CAST(ReduceFunction)(reduce));
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_PARALLEL_REDUCE_HPP
@@ -0,0 +1,468 @@
+//
+// impl/race_connect.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_RACE_CONNECT_HPP
+#define ASIO_IMPL_RACE_CONNECT_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
+
+#include <cstddef>
+#include <vector>
+#include "asio/associated_cancellation_slot.hpp"
+#include "asio/associated_executor.hpp"
+#include "asio/basic_waitable_timer.hpp"
+#include "asio/cancellation_type.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/handler_type_requirements.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/non_const_lvalue.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/execution/outstanding_work.hpp"
+#include "asio/post.hpp"
+#include "asio/prefer.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Reorder endpoints so that their address families alternate, starting with
+// the family of the first endpoint. The order within each family is kept.
+template <typename Endpoint>
+void interleave_address_families(std::vector<Endpoint>& endpoints)
+{
+  if (endpoints.empty())
+    return;
+
+  std::vector<Endpoint> first, second;
+  const int family = endpoints[0].protocol().family();
+  for (std::size_t i = 0; i < endpoints.size(); ++i)
+  {
+    if (endpoints[i].protocol().family() == family)
+      first.push_back(endpoints[i]);
+    else
+      second.push_back(endpoints[i]);
+  }
+
+  endpoints.clear();
+  for (std::size_t i = 0; i < first.size() || i < second.size(); ++i)
+  {
+    if (i < first.size())
+      endpoints.push_back(first[i]);
+    if (i < second.size())
+      endpoints.push_back(second[i]);
+  }
+}
+
+// The socket used for a single connection attempt. The destructor of
+// basic_socket is protected, so the attempts need a concrete type.
+template <typename Protocol, typename Executor>
+class race_connect_socket
+  : public basic_socket<Protocol, Executor>
+{
+public:
+  explicit race_connect_socket(const Executor& ex)
+    : basic_socket<Protocol, Executor>(ex)
+  {
+  }
+
+  race_connect_socket(race_connect_socket&& other)
+    : basic_socket<Protocol, Executor>(std::move(other))
+  {
+  }
+};
+
+// The state shared by the connection attempts, the attempt delay timer and
+// the cancellation handler. Every attempt runs on its own socket. The state
+// is kept alive by the pending operations until one of them finishes the
+// race.
+template <typename Protocol, typename Executor, typename Handler>
+class race_connect_op
+  : private noncopyable
+{
+public:
+  typedef typename Protocol::endpoint endpoint_type;
+
+  race_connect_op(basic_socket<Protocol, Executor>& s,
+      std::vector<endpoint_type>& endpoints,
+      const chrono::steady_clock::duration& attempt_delay,
+      Handler& handler)
+    : socket_(s),
+      timer_(s.get_executor()),
+      attempt_delay_(attempt_delay),
+      next_(0),
+      pending_(0),
+      cancelled_(false),
+      finished_(false),
+      handler_(ASIO_MOVE_CAST(Handler)(handler)),
+      executor_(asio::prefer(
+            (get_associated_executor)(handler_, s.get_executor()),
+            execution::outstanding_work.tracked))
+  {
+    endpoints_.swap(endpoints);
+    interleave_address_families(endpoints_);
+    attempts_.reserve(endpoints_.size());
+  }
+
+  static void start(const shared_ptr<race_connect_op>& self)
+  {
+    typename associated_cancellation_slot<Handler>::type slot
+      = (get_associated_cancellation_slot)(self->handler_);
+    if (slot.is_connected())
+      slot.template emplace<cancel_handler>(self);
+
+    asio::detail::mutex::scoped_lock lock(self->mutex_);
+    if (self->endpoints_.empty())
+      self->finish(asio::error::not_found);
+    else
+      self->start_next(self);
+
+    if (self->finished_)
+    {
+      lock.unlock();
+      self->complete();
+    }
+  }
+
+private:
+  class connect_handler
+  {
+  public:
+    connect_handler(const shared_ptr<race_connect_op>& self,
+        std::size_t index)
+      : self_(self),
+        index_(index)
+    {
+    }
+
+    void operator()(const asio::error_code& ec)
+    {
+      self_->handle_connect(self_, index_, ec);
+    }
+
+  private:
+    shared_ptr<race_connect_op> self_;
+    std::size_t index_;
+  };
+
+  class timer_handler
+  {
+  public:
+    timer_handler(const shared_ptr<race_connect_op>& self,
+        std::size_t index)
+      : self_(self),
+        index_(index)
+    {
+    }
+
+    void operator()(const asio::error_code& ec)
+    {
+      self_->handle_timer(self_, index_, ec);
+    }
+
+  private:
+    shared_ptr<race_connect_op> self_;
+    std::size_t index_;
+  };
+
+  class cancel_handler
+  {
+  public:
+    explicit cancel_handler(const shared_ptr<race_connect_op>& self)
+      : self_(self)
+    {
+    }
+
+    void operator()(cancellation_type_t type)
+    {
+      if (type != cancellation_type::none)
+        if (shared_ptr<race_connect_op> self = self_.lock())
+          self->cancel();
+    }
+
+  private:
+    // Does not keep the operation alive, as the handler is only destroyed
+    // when the slot is cleared.
+    weak_ptr<race_connect_op> self_;
+  };
+
+  // Start an attempt for the next endpoint, skipping any whose socket cannot
+  // be opened, and restart the attempt delay timer.
+  void start_next(const shared_ptr<race_connect_op>& self)
+  {
+    while (next_ < endpoints_.size())
+    {
+      std::size_t index = next_++;
+      attempts_.push_back(
+          race_connect_socket<Protocol, Executor>(socket_.get_executor()));
+
+      asio::error_code ec;
+      attempts_[index].open(endpoints_[index].protocol(), ec);
+      if (ec)
+      {
+        last_ec_ = ec;
+        continue;
+      }
+
+      attempts_[index].async_connect(endpoints_[index],
+          connect_handler(self, index));
+      ++pending_;
+
+      if (next_ < endpoints_.size())
+      {
+        timer_.expires_after(attempt_delay_);
+        timer_.async_wait(timer_handler(self, index));
+      }
+      return;
+    }
+
+    if (pending_ == 0)
+      finish(last_ec_);
+  }
+
+  void handle_connect(const shared_ptr<race_connect_op>& self,
+      std::size_t index, const asio::error_code& ec)
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    if (finished_)
+      return;
+
+    --pending_;
+    if (!ec && !cancelled_)
+    {
+      socket_ = std::move(attempts_[index]);
+      endpoint_ = endpoints_[index];
+      finish(asio::error_code());
+    }
+    else if (cancelled_)
+    {
+      if (pending_ == 0)
+        finish(asio::error::operation_aborted);
+    }
+    else
+    {
+      // A failed attempt starts the next one without waiting for the delay.
+      last_ec_ = ec;
+      asio::error_code ignored;
+      attempts_[index].close(ignored);
+      start_next(self);
+    }
+
+    if (finished_)
+    {
+      lock.unlock();
+      complete();
+    }
+  }
+
+  void handle_timer(const shared_ptr<race_connect_op>& self,
+      std::size_t index, const asio::error_code& ec)
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    if (finished_ || cancelled_ || ec || index + 1 != next_)
+      return;
+
+    start_next(self);
+
+    if (finished_)
+    {
+      lock.unlock();
+      complete();
+    }
+  }
+
+  // Abandon the attempts in progress. Their handlers finish the operation.
+  void cancel()
+  {
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    if (finished_ || cancelled_)
+      return;
+
+    cancelled_ = true;
+    close_attempts();
+  }
+
+  // Mark the operation as finished and close the losing attempts.
+  void finish(const asio::error_code& ec)
+  {
+    finished_ = true;
+    ec_ = ec;
+    close_attempts();
+  }
+
+  void close_attempts()
+  {
+    asio::error_code ignored;
+    for (std::size_t i = 0; i < attempts_.size(); ++i)
+      attempts_[i].close(ignored);
+    timer_.cancel();
+  }
+
+  // Called exactly once, without the lock held, to deliver the result.
+  void complete()
+  {
+    typename associated_cancellation_slot<Handler>::type slot
+      = (get_associated_cancellation_slot)(handler_);
+    if (slot.is_connected())
+      slot.clear();
+
+    asio::post(executor_,
+        detail::move_binder2<Handler, asio::error_code, endpoint_type>(0,
+          ASIO_MOVE_CAST(Handler)(handler_), ec_, endpoint_type(endpoint_)));
+  }
+
+  typedef typename associated_executor<Handler, Executor>::type handler_ex_t;
+
+  typedef typename decay<
+      typename prefer_result<const handler_ex_t&,
+        execution::outstanding_work_t::tracked_t
+      >::type
+    >::type work_executor_type;
+
+  // Mutex to protect access to internal data.
+  asio::detail::mutex mutex_;
+
+  // The socket that receives the winning connection.
+  basic_socket<Protocol, Executor>& socket_;
+
+  // The endpoints, in the order in which they are tried.
+  std::vector<endpoint_type> endpoints_;
+
+  // The sockets for the attempts that have been started, one per endpoint.
+  std::vector<race_connect_socket<Protocol, Executor> > attempts_;
+
+  // The timer that starts the next attempt.
+  basic_waitable_timer<chrono::steady_clock,
+    wait_traits<chrono::steady_clock>, Executor> timer_;
+  chrono::steady_clock::duration attempt_delay_;
+
+  // The index of the next endpoint to try, and the number of attempts that
+  // have been started and not yet completed.
+  std::size_t next_;
+  std::size_t pending_;
+
+  // Whether the operation has been cancelled or has finished, and its result.
+  bool cancelled_;
+  bool finished_;
+  asio::error_code ec_;
+  asio::error_code last_ec_;
+  endpoint_type endpoint_;
+
+  Handler handler_;
+  work_executor_type executor_;
+};
+
+template <typename Protocol, typename Executor>
+class initiate_async_race_connect
+{
+public:
+  typedef Executor executor_type;
+
+  explicit initiate_async_race_connect(basic_socket<Protocol, Executor>& s)
+    : socket_(s)
+  {
+  }
+
+  executor_type get_executor() const ASIO_NOEXCEPT
+  {
+    return socket_.get_executor();
+  }
+
+  template <typename RangeConnectHandler, typename EndpointSequence>
+  void operator()(ASIO_MOVE_ARG(RangeConnectHandler) handler,
+      const EndpointSequence& endpoints,
+      const chrono::steady_clock::duration& attempt_delay) const
+  {
+    // If you get an error on the following line it means that your
+    // handler does not meet the documented type requirements for an
+    // RangeConnectHandler.
+    ASIO_RANGE_CONNECT_HANDLER_CHECK(RangeConnectHandler,
+        handler, typename Protocol::endpoint) type_check;
+
+    typedef race_connect_op<Protocol, Executor,
+      typename decay<RangeConnectHandler>::type> op;
+
+    std::vector<typename Protocol::endpoint> endpoint_vector;
+    typename EndpointSequence::const_iterator iter = endpoints.begin();
+    typename EndpointSequence::const_iterator end = endpoints.end();
+    for (; iter != end; ++iter)
+      endpoint_vector.push_back(*iter);
+
+    non_const_lvalue<RangeConnectHandler> handler2(handler);
+    op::start(shared_ptr<op>(new op(socket_,
+            endpoint_vector, attempt_delay, handler2.value)));
+  }
+
+private:
+  basic_socket<Protocol, Executor>& socket_;
+};
+
+} // namespace detail
+
+template <typename Protocol, typename Executor, typename EndpointSequence,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      typename Protocol::endpoint)) RangeConnectToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(RangeConnectToken,
+    void (asio::error_code, typename Protocol::endpoint))
+async_race_connect(basic_socket<Protocol, Executor>& s,
+    const EndpointSequence& endpoints,
+    const chrono::steady_clock::duration& attempt_delay,
+    ASIO_MOVE_ARG(RangeConnectToken) token,
+    typename constraint<is_endpoint_sequence<
+        EndpointSequence>::value>::type)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<RangeConnectToken,
+      void (asio::error_code, typename Protocol::endpoint)>(
+        declval<detail::initiate_async_race_connect<Protocol, Executor> >(),
+        token, endpoints, attempt_delay)))
+{
+  return async_initiate<RangeConnectToken,
+    void (asio::error_code, typename Protocol::endpoint)>(
+      detail::initiate_async_race_connect<Protocol, Executor>(s),
+      token, endpoints, attempt_delay);
+}
+
+template <typename Protocol, typename Executor, typename EndpointSequence,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      typename Protocol::endpoint)) RangeConnectToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(RangeConnectToken,
+    void (asio::error_code, typename Protocol::endpoint))
+async_race_connect(basic_socket<Protocol, Executor>& s,
+    const EndpointSequence& endpoints,
+    ASIO_MOVE_ARG(RangeConnectToken) token,
+    typename constraint<is_endpoint_sequence<
+        EndpointSequence>::value>::type)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<RangeConnectToken,
+      void (asio::error_code, typename Protocol::endpoint)>(
+        declval<detail::initiate_async_race_connect<Protocol, Executor> >(),
+        token, endpoints, declval<chrono::steady_clock::duration>())))
+{
+  return async_initiate<RangeConnectToken,
+    void (asio::error_code, typename Protocol::endpoint)>(
+      detail::initiate_async_race_connect<Protocol, Executor>(s),
+      token, endpoints, chrono::steady_clock::duration(
+        chrono::milliseconds(250)));
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
+
+#endif // ASIO_IMPL_RACE_CONNECT_HPP
@@ -0,0 +1,688 @@
+//
+// impl/relay.hpp
+// ~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_RELAY_HPP
+#define ASIO_IMPL_RELAY_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_MOVE)
+
+#include <cstddef>
+#include "asio/associated_cancellation_slot.hpp"
+#include "asio/associated_executor.hpp"
+#include "asio/basic_stream_socket.hpp"
+#include "asio/cancellation_signal.hpp"
+#include "asio/cancellation_type.hpp"
+#include "asio/detail/bind_handler.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/non_const_lvalue.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/scoped_ptr.hpp"
+#include "asio/execution/outstanding_work.hpp"
+#include "asio/post.hpp"
+#include "asio/prefer.hpp"
+#include "asio/socket_base.hpp"
+#include "asio/write.hpp"
+
+#if defined(ASIO_HAS_SPLICE)
+# include <cerrno>
+# include <fcntl.h>
+# include <sys/types.h>
+# include <unistd.h>
+#endif // defined(ASIO_HAS_SPLICE)
+
+#include "asio/detail/push_options.hpp"
+
+#if defined(ASIO_HAS_SPLICE)
+
+// The C library declares splice only when _GNU_SOURCE is defined. It is
+// declared here, exactly as in the C library, so that the choice of pump does
+// not depend on the feature macros of each translation unit.
+extern "C" __ssize_t splice(int, __off64_t*, int, __off64_t*,
+    size_t, unsigned int);
+
+#endif // defined(ASIO_HAS_SPLICE)
+
+namespace asio {
+namespace detail {
+
+// Tell the peer that no more data will be sent, if the stream supports it.
+template <typename Stream>
+inline void relay_shutdown_send(Stream&)
+{
+}
+
+template <typename Protocol, typename Executor>
+inline void relay_shutdown_send(basic_stream_socket<Protocol, Executor>& s)
+{
+  asio::error_code ec;
+  s.shutdown(socket_base::shutdown_send, ec);
+}
+
+// Copies the data in one direction by reading into a chunk buffer and then
+// writing it out. The chunks are returned to the pool after each write, so an
+// idle relay holds at most the chunk for its pending read.
+template <typename From, typename To>
+class relay_copy_pump
+{
+public:
+  typedef typename From::executor_type executor_type;
+
+  relay_copy_pump(From& from, To& to, chunk_pool& pool)
+    : from_(from),
+      to_(to),
+      buffer_(pool),
+      dynamic_buffer_(buffer_),
+      chunk_size_(pool.chunk_size()),
+      writing_(false),
+      bytes_(0)
+  {
+  }
+
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return from_.get_executor();
+  }
+
+  const asio::error_code& error() const
+  {
+    return ec_;
+  }
+
+  asio::uint64_t bytes() const
+  {
+    return bytes_;
+  }
+
+  template <typename Handler>
+  void start(const Handler& handler)
+  {
+    read(handler);
+  }
+
+  // Called once both directions have finished.
+  void finish()
+  {
+  }
+
+  // Continue after the read or write has completed. Returns true when this
+  // direction has finished.
+  template <typename Handler>
+  bool resume(const asio::error_code& ec,
+      std::size_t n, const Handler& handler)
+  {
+    if (writing_)
+    {
+      writing_ = false;
+      dynamic_buffer_.consume(n);
+      bytes_ += n;
+      if (ec)
+      {
+        ec_ = ec;
+        return true;
+      }
+      read(handler);
+    }
+    else
+    {
+      dynamic_buffer_.commit(n);
+      if (ec)
+      {
+        if (ec == asio::error::eof)
+          relay_shutdown_send(to_);
+        else
+          ec_ = ec;
+        return true;
+      }
+      writing_ = true;
+      asio::async_write(to_, dynamic_buffer_.data(), handler);
+    }
+    return false;
+  }
+
+private:
+  template <typename Handler>
+  void read(const Handler& handler)
+  {
+    from_.async_read_some(dynamic_buffer_.prepare(chunk_size_), handler);
+  }
+
+  From& from_;
+  To& to_;
+  chunk_buffer buffer_;
+  dynamic_chunk_buffer dynamic_buffer_;
+  std::size_t chunk_size_;
+  bool writing_;
+  asio::uint64_t bytes_;
+  asio::error_code ec_;
+};
+
+#if defined(ASIO_HAS_SPLICE)
+
+// Moves the data in one direction between two sockets through a pipe, so that
+// it is not copied into user space. Falls back to copying if the pipe cannot
+// be created. The source socket's non-blocking mode is restored when the
+// relay finishes.
+template <typename From, typename To>
+class relay_splice_pump
+{
+public:
+  typedef typename From::executor_type executor_type;
+
+  relay_splice_pump(From& from, To& to, chunk_pool& pool)
+    : copy_(from, to, pool),
+      from_(from),
+      to_(to),
+      from_non_blocking_(from.native_non_blocking()),
+      use_splice_(false),
+      in_pipe_(0),
+      bytes_(0)
+  {
+    pipe_[0] = pipe_[1] = -1;
+  }
+
+  ~relay_splice_pump()
+  {
+    if (pipe_[0] != -1)
+      ::close(pipe_[0]);
+    if (pipe_[1] != -1)
+      ::close(pipe_[1]);
+  }
+
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return from_.get_executor();
+  }
+
+  const asio::error_code& error() const
+  {
+    return use_splice_ ? ec_ : copy_.error();
+  }
+
+  asio::uint64_t bytes() const
+  {
+    return use_splice_ ? bytes_ : copy_.bytes();
+  }
+
+  template <typename Handler>
+  void start(const Handler& handler)
+  {
+    if (open_pipe())
+    {
+      // Readiness is reported by the reactor, but the system calls are made
+      // here, so both sockets must be in non-blocking mode.
+      asio::error_code ec;
+      from_.native_non_blocking(true, ec);
+      if (!ec)
+        to_.native_non_blocking(true, ec);
+      use_splice_ = !ec;
+    }
+
+    if (use_splice_)
+      from_.async_wait(socket_base::wait_read, handler);
+    else
+      copy_.start(handler);
+  }
+
+  // Called once both directions have finished. The other direction may also
+  // have changed the mode of this direction's source socket.
+  void finish()
+  {
+    asio::error_code ec;
+    if (from_.is_open() && from_.native_non_blocking() != from_non_blocking_)
+      from_.native_non_blocking(from_non_blocking_, ec);
+  }
+
+  // Continue after the wait has completed. Returns true when this direction
+  // has finished.
+  template <typename Handler>
+  bool resume(const asio::error_code& ec,
+      std::size_t n, const Handler& handler)
+  {
+    if (!use_splice_)
+      return copy_.resume(ec, n, handler);
+
+    if (ec)
+    {
+      ec_ = ec;
+      return true;
+    }
+
+    // Limit the work done in one go so that a fast sender cannot starve the
+    // other handlers.
+    for (int rounds = 0; ; )
+    {
+      if (in_pipe_ == 0)
+      {
+        if (++rounds > max_rounds)
+        {
+          from_.async_wait(socket_base::wait_read, handler);
+          return false;
+        }
+
+        ssize_t result = ::splice(from_.native_handle(), 0, pipe_[1], 0,
+            max_splice_size, splice_move | splice_nonblock);
+        if (result > 0)
+          in_pipe_ = static_cast<std::size_t>(result);
+        else if (result == 0)
+        {
+          relay_shutdown_send(to_);
+          return true;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+          from_.async_wait(socket_base::wait_read, handler);
+          return false;
+        }
+        else if (errno != EINTR)
+        {
+          ec_ = asio::error_code(errno, asio::error::get_system_category());
+          return true;
+        }
+      }
+      else
+      {
+        ssize_t result = ::splice(pipe_[0], 0, to_.native_handle(), 0,
+            in_pipe_, splice_move | splice_nonblock);
+        if (result > 0)
+        {
+          in_pipe_ -= static_cast<std::size_t>(result);
+          bytes_ += static_cast<std::size_t>(result);
+        }
+        else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+          to_.async_wait(socket_base::wait_write, handler);
+          return false;
+        }
+        else if (result == 0 || errno != EINTR)
+        {
+          ec_ = result == 0 ? asio::error_code(asio::error::broken_pipe)
+            : asio::error_code(errno, asio::error::get_system_category());
+          return true;
+        }
+      }
+    }
+  }
+
+private:
+  // Create the pipe, with both ends non-blocking and closed on exec.
+  bool open_pipe()
+  {
+    if (::pipe(pipe_) != 0)
+      return false;
+
+    for (int i = 0; i < 2; ++i)
+    {
+      if (::fcntl(pipe_[i], F_SETFD, FD_CLOEXEC) != 0
+          || ::fcntl(pipe_[i], F_SETFL, O_NONBLOCK) != 0)
+      {
+        ::close(pipe_[0]);
+        ::close(pipe_[1]);
+        pipe_[0] = pipe_[1] = -1;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // The values of SPLICE_F_MOVE and SPLICE_F_NONBLOCK.
+  enum { splice_move = 1, splice_nonblock = 2 };
+
+  // The default capacity of a pipe.
+  enum { max_splice_size = 65536 };
+
+  // The number of reads performed before yielding to other handlers.
+  enum { max_rounds = 16 };
+
+  relay_copy_pump<From, To> copy_;
+  From& from_;
+  To& to_;
+  bool from_non_blocking_;
+  bool use_splice_;
+  int pipe_[2];
+  std::size_t in_pipe_;
+  asio::uint64_t bytes_;
+  asio::error_code ec_;
+};
+
+#endif // defined(ASIO_HAS_SPLICE)
+
+// Selects the pump used to relay data between two stream types.
+template <typename From, typename To>
+struct relay_pump
+{
+  typedef relay_copy_pump<From, To> type;
+};
+
+#if defined(ASIO_HAS_SPLICE)
+
+template <typename Protocol1, typename Executor1,
+    typename Protocol2, typename Executor2>
+struct relay_pump<basic_stream_socket<Protocol1, Executor1>,
+    basic_stream_socket<Protocol2, Executor2> >
+{
+  typedef relay_splice_pump<basic_stream_socket<Protocol1, Executor1>,
+    basic_stream_socket<Protocol2, Executor2> > type;
+};
+
+#endif // defined(ASIO_HAS_SPLICE)
+
+// The state shared by the two directions of the relay. The state is kept
+// alive by the pending operations until both directions have finished.
+template <typename StreamA, typename StreamB, typename Handler>
+class relay_op
+  : private noncopyable
+{
+public:
+  typedef typename StreamA::executor_type executor_type;
+
+  // The size of each buffer when no pool is supplied.
+  enum { default_chunk_size = 16384 };
+
+  relay_op(StreamA& a, StreamB& b, chunk_pool* pool, Handler& handler)
+    : own_pool_(pool ? 0 : new chunk_pool(default_chunk_size, 2)),
+      a_to_b_(a, b, pool ? *pool : *own_pool_),
+      b_to_a_(b, a, pool ? *pool : *own_pool_),
+      pending_(2),
+      handler_(ASIO_MOVE_CAST(Handler)(handler)),
+      executor_(asio::prefer(
+            (get_associated_executor)(handler_, a.get_executor()),
+            execution::outstanding_work.tracked))
+  {
+  }
+
+  static void start(const shared_ptr<relay_op>& self)
+  {
+    typename associated_cancellation_slot<Handler>::type slot
+      = (get_associated_cancellation_slot)(self->handler_);
+    if (slot.is_connected())
+      slot.template emplace<cancel_handler>(self);
+
+    self->a_to_b_.pump_.start(
+        pump_handler<a_to_b_type>(self, self->a_to_b_));
+    self->b_to_a_.pump_.start(
+        pump_handler<b_to_a_type>(self, self->b_to_a_));
+  }
+
+private:
+  typedef typename relay_pump<StreamA, StreamB>::type a_to_b_type;
+  typedef typename relay_pump<StreamB, StreamA>::type b_to_a_type;
+
+  template <typename Pump>
+  struct direction
+  {
+    template <typename From, typename To>
+    direction(From& from, To& to, chunk_pool& pool)
+      : pump_(from, to, pool),
+        cancelled_(false),
+        done_(false)
+    {
+    }
+
+    Pump pump_;
+    cancellation_signal signal_;
+    bool cancelled_;
+    bool done_;
+  };
+
+  template <typename Pump>
+  class pump_handler
+  {
+  public:
+    typedef cancellation_slot cancellation_slot_type;
+
+    pump_handler(const shared_ptr<relay_op>& self, direction<Pump>& dir)
+      : self_(self),
+        dir_(&dir)
+    {
+    }
+
+    cancellation_slot_type get_cancellation_slot() const ASIO_NOEXCEPT
+    {
+      return dir_->signal_.slot();
+    }
+
+    void operator()(const asio::error_code& ec)
+    {
+      self_->resume(self_, *dir_, ec, 0, *this);
+    }
+
+    void operator()(const asio::error_code& ec, std::size_t n)
+    {
+      self_->resume(self_, *dir_, ec, n, *this);
+    }
+
+  private:
+    shared_ptr<relay_op> self_;
+    direction<Pump>* dir_;
+  };
+
+  class cancel_handler
+  {
+  public:
+    explicit cancel_handler(const shared_ptr<relay_op>& self)
+      : self_(self)
+    {
+    }
+
+    void operator()(cancellation_type_t type)
+    {
+      if (type != cancellation_type::none)
+      {
+        if (shared_ptr<relay_op> self = self_.lock())
+        {
+          asio::detail::mutex::scoped_lock lock(self->mutex_);
+          self->cancel_directions(self, type);
+        }
+      }
+    }
+
+  private:
+    // Does not keep the operation alive, as the handler is only destroyed
+    // when the slot is cleared.
+    weak_ptr<relay_op> self_;
+  };
+
+  // Emits a cancellation signal using the executor of the direction's source
+  // stream, as a signal must not be emitted concurrently with the operation
+  // it cancels.
+  template <typename Pump>
+  class emit_handler
+  {
+  public:
+    emit_handler(const shared_ptr<relay_op>& self,
+        direction<Pump>& dir, cancellation_type_t type)
+      : self_(self),
+        dir_(&dir),
+        type_(type)
+    {
+    }
+
+    void operator()()
+    {
+      asio::detail::mutex::scoped_lock lock(self_->mutex_);
+      if (dir_->done_)
+        return;
+
+      // The flag stops the direction if its operation has already completed
+      // and the signal does not reach the next one.
+      dir_->cancelled_ = true;
+      lock.unlock();
+      dir_->signal_.emit(type_);
+    }
+
+  private:
+    shared_ptr<relay_op> self_;
+    direction<Pump>* dir_;
+    cancellation_type_t type_;
+  };
+
+  template <typename Pump>
+  void resume(const shared_ptr<relay_op>& self, direction<Pump>& dir,
+      const asio::error_code& ec, std::size_t n,
+      const pump_handler<Pump>& handler)
+  {
+    asio::error_code ec2 = ec;
+    if (!ec2)
+    {
+      asio::detail::mutex::scoped_lock lock(mutex_);
+      if (dir.cancelled_)
+        ec2 = asio::error::operation_aborted;
+    }
+
+    if (!dir.pump_.resume(ec2, n, handler))
+      return;
+
+    asio::detail::mutex::scoped_lock lock(mutex_);
+    dir.done_ = true;
+    if (dir.pump_.error() && !ec_)
+    {
+      // The first error stops the relay.
+      ec_ = dir.pump_.error();
+      cancel_directions(self, cancellation_type::terminal);
+    }
+
+    if (--pending_ == 0)
+    {
+      lock.unlock();
+      complete();
+    }
+  }
+
+  // Cancel the directions that have not yet finished. The mutex must be held.
+  void cancel_directions(const shared_ptr<relay_op>& self,
+      cancellation_type_t type)
+  {
+    if (!a_to_b_.done_)
+    {
+      asio::post(a_to_b_.pump_.get_executor(),
+          emit_handler<a_to_b_type>(self, a_to_b_, type));
+    }
+
+    if (!b_to_a_.done_)
+    {
+      asio::post(b_to_a_.pump_.get_executor(),
+          emit_handler<b_to_a_type>(self, b_to_a_, type));
+    }
+  }
+
+  // Called exactly once, without the lock held, to deliver the result.
+  void complete()
+  {
+    a_to_b_.pump_.finish();
+    b_to_a_.pump_.finish();
+
+    typename associated_cancellation_slot<Handler>::type slot
+      = (get_associated_cancellation_slot)(handler_);
+    if (slot.is_connected())
+      slot.clear();
+
+    asio::post(executor_,
+        detail::bind_handler(ASIO_MOVE_CAST(Handler)(handler_),
+          ec_, a_to_b_.pump_.bytes(), b_to_a_.pump_.bytes()));
+  }
+
+  typedef typename associated_executor<
+      Handler, executor_type>::type handler_ex_t;
+
+  typedef typename decay<
+      typename prefer_result<const handler_ex_t&,
+        execution::outstanding_work_t::tracked_t
+      >::type
+    >::type work_executor_type;
+
+  // Mutex to protect access to internal data.
+  asio::detail::mutex mutex_;
+
+  // The pool used when the caller does not supply one.
+  scoped_ptr<chunk_pool> own_pool_;
+
+  direction<a_to_b_type> a_to_b_;
+  direction<b_to_a_type> b_to_a_;
+
+  // The number of directions that have not yet finished.
+  int pending_;
+
+  // The first error, which is the result of the operation.
+  asio::error_code ec_;
+
+  Handler handler_;
+  work_executor_type executor_;
+};
+
+class initiate_async_relay
+{
+public:
+  template <typename RelayHandler,
+      typename AsyncStreamA, typename AsyncStreamB>
+  void operator()(ASIO_MOVE_ARG(RelayHandler) handler,
+      AsyncStreamA* a, AsyncStreamB* b, chunk_pool* pool) const
+  {
+    typedef relay_op<AsyncStreamA, AsyncStreamB,
+      typename decay<RelayHandler>::type> op;
+
+    non_const_lvalue<RelayHandler> handler2(handler);
+    op::start(shared_ptr<op>(new op(*a, *b, pool, handler2.value)));
+  }
+};
+
+} // namespace detail
+
+template <typename AsyncStreamA, typename AsyncStreamB,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      asio::uint64_t, asio::uint64_t)) RelayToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(RelayToken,
+    void (asio::error_code, asio::uint64_t, asio::uint64_t))
+async_relay(AsyncStreamA& a, AsyncStreamB& b, chunk_pool& pool,
+    ASIO_MOVE_ARG(RelayToken) token)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<RelayToken,
+      void (asio::error_code, asio::uint64_t, asio::uint64_t)>(
+        declval<detail::initiate_async_relay>(), token,
+        &a, &b, &pool)))
+{
+  return async_initiate<RelayToken,
+    void (asio::error_code, asio::uint64_t, asio::uint64_t)>(
+      detail::initiate_async_relay(), token, &a, &b, &pool);
+}
+
+template <typename AsyncStreamA, typename AsyncStreamB,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      asio::uint64_t, asio::uint64_t)) RelayToken>
+inline ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(RelayToken,
+    void (asio::error_code, asio::uint64_t, asio::uint64_t))
+async_relay(AsyncStreamA& a, AsyncStreamB& b,
+    ASIO_MOVE_ARG(RelayToken) token)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<RelayToken,
+      void (asio::error_code, asio::uint64_t, asio::uint64_t)>(
+        declval<detail::initiate_async_relay>(), token,
+        &a, &b, static_cast<chunk_pool*>(0))))
+{
+  return async_initiate<RelayToken,
+    void (asio::error_code, asio::uint64_t, asio::uint64_t)>(
+      detail::initiate_async_relay(), token,
+      &a, &b, static_cast<chunk_pool*>(0));
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_MOVE)
+
+#endif // ASIO_IMPL_RELAY_HPP
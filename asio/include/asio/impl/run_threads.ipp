@@ -0,0 +1,78 @@
+//
+// impl/run_threads.ipp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_RUN_THREADS_IPP
+#define ASIO_IMPL_RUN_THREADS_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_THREADS)
+
+#include <exception>
+#include "asio/detail/thread_group.hpp"
+#include "asio/io_context.hpp"
+#include "asio/run_threads.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+struct run_threads_function
+{
+  io_context* ctx_;
+  const thread_affinity* affinity_;
+  std::size_t index_;
+
+  void operator()()
+  {
+    asio::error_code ec;
+    affinity_->apply(index_, ec);
+
+#if !defined(ASIO_NO_EXCEPTIONS)
+    try
+    {
+#endif// !defined(ASIO_NO_EXCEPTIONS)
+      ctx_->run();
+#if !defined(ASIO_NO_EXCEPTIONS)
+    }
+    catch (...)
+    {
+      std::terminate();
+    }
+#endif// !defined(ASIO_NO_EXCEPTIONS)
+  }
+};
+
+} // namespace detail
+
+void run_threads(io_context& ctx, std::size_t num_threads,
+    const thread_affinity& affinity)
+{
+  detail::thread_group threads;
+  for (std::size_t i = 0; i < num_threads; ++i)
+  {
+    detail::run_threads_function f = { &ctx, &affinity, i };
+    threads.create_thread(f);
+  }
+  threads.join();
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_THREADS)
+
+#endif // ASIO_IMPL_RUN_THREADS_IPP
@@ -21,7 +21,10 @@
 
 #include "asio/impl/any_io_executor.ipp"
 #include "asio/impl/cancellation_signal.ipp"
+#include "asio/impl/config.ipp"
 #include "asio/impl/connect_pipe.ipp"
+#include "asio/impl/dfa_matcher.ipp"
+#include "asio/impl/dynamic_chunk_buffer.ipp"
 #include "asio/impl/error.ipp"
 #include "asio/impl/error_code.ipp"
 #include "asio/impl/execution_context.ipp"
@@ -29,12 +32,21 @@
 #include "asio/impl/handler_alloc_hook.ipp"
 #include "asio/impl/io_context.ipp"
 #include "asio/impl/multiple_exceptions.ipp"
+#include "asio/impl/offload.ipp"
+#include "asio/impl/run_threads.ipp"
 #include "asio/impl/serial_port_base.ipp"
 #include "asio/impl/system_context.ipp"
+#include "asio/impl/thread_affinity.ipp"
 #include "asio/impl/thread_pool.ipp"
+#include "asio/detail/impl/blocking_offload_service.ipp"
+#include "asio/detail/impl/buffer_search.ipp"
 #include "asio/detail/impl/buffer_sequence_adapter.ipp"
 #include "asio/detail/impl/descriptor_ops.ipp"
 #include "asio/detail/impl/dev_poll_reactor.ipp"
+#include "asio/detail/impl/dns_cache.ipp"
+#include "asio/detail/impl/dns_lookup.ipp"
+#include "asio/detail/impl/dns_ops.ipp"
+#include "asio/detail/impl/dns_resolver_service.ipp"
 #include "asio/detail/impl/epoll_reactor.ipp"
 #include "asio/detail/impl/eventfd_select_interrupter.ipp"
 #include "asio/detail/impl/handler_tracking.ipp"
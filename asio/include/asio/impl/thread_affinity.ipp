@@ -0,0 +1,182 @@
+//
+// impl/thread_affinity.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_THREAD_AFFINITY_IPP
+#define ASIO_IMPL_THREAD_AFFINITY_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_THREAD_AFFINITY)
+# if defined(ASIO_WINDOWS)
+#  include "asio/detail/socket_types.hpp"
+# else // defined(ASIO_WINDOWS)
+#  include <cstdio>
+#  include <pthread.h>
+#  include <sched.h>
+# endif // defined(ASIO_WINDOWS)
+#endif // defined(ASIO_HAS_THREAD_AFFINITY)
+
+#include "asio/detail/throw_error.hpp"
+#include "asio/error.hpp"
+#include "asio/thread_affinity.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+thread_affinity thread_affinity::numa_node(unsigned int node)
+{
+  asio::error_code ec;
+  thread_affinity affinity = numa_node(node, ec);
+  asio::detail::throw_error(ec, "numa_node");
+  return affinity;
+}
+
+thread_affinity thread_affinity::numa_node(
+    unsigned int node, asio::error_code& ec)
+{
+#if defined(ASIO_HAS_THREAD_AFFINITY)
+  std::vector<unsigned int> cpus;
+
+# if defined(ASIO_WINDOWS)
+  ULONGLONG mask = 0;
+  if (node > 0xFF || !::GetNumaNodeProcessorMask(
+        static_cast<UCHAR>(node), &mask))
+  {
+    ec = asio::error::invalid_argument;
+    return thread_affinity();
+  }
+  for (unsigned int cpu = 0; cpu < 64; ++cpu)
+    if ((mask & (static_cast<ULONGLONG>(1) << cpu)) != 0)
+      cpus.push_back(cpu);
+# else // defined(ASIO_WINDOWS)
+  // The node's CPUs are listed as ranges, such as "0-3,8-11".
+  char path[64];
+  std::sprintf(path, "/sys/devices/system/node/node%u/cpulist", node);
+  std::FILE* file = std::fopen(path, "r");
+  if (!file)
+  {
+    ec = asio::error::invalid_argument;
+    return thread_affinity();
+  }
+  unsigned int first = 0;
+  while (std::fscanf(file, "%u", &first) == 1)
+  {
+    unsigned int last = first;
+    int c = std::fgetc(file);
+    if (c == '-')
+    {
+      if (std::fscanf(file, "%u", &last) != 1)
+        break;
+      c = std::fgetc(file);
+    }
+    for (unsigned int cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+    if (c != ',')
+      break;
+  }
+  std::fclose(file);
+# endif // defined(ASIO_WINDOWS)
+
+  if (cpus.empty())
+  {
+    ec = asio::error::invalid_argument;
+    return thread_affinity();
+  }
+
+  ec = asio::error_code();
+  return thread_affinity(cpus, false);
+#else // defined(ASIO_HAS_THREAD_AFFINITY)
+  (void)node;
+  ec = asio::error::operation_not_supported;
+  return thread_affinity();
+#endif // defined(ASIO_HAS_THREAD_AFFINITY)
+}
+
+void thread_affinity::apply(std::size_t thread_index) const
+{
+  asio::error_code ec;
+  apply(thread_index, ec);
+  asio::detail::throw_error(ec, "apply");
+}
+
+ASIO_SYNC_OP_VOID thread_affinity::apply(
+    std::size_t thread_index, asio::error_code& ec) const
+{
+  if (cpus_.empty())
+  {
+    ec = asio::error_code();
+    ASIO_SYNC_OP_VOID_RETURN(ec);
+  }
+
+  std::size_t first = 0, last = cpus_.size();
+  if (per_thread_)
+  {
+    first = thread_index % cpus_.size();
+    last = first + 1;
+  }
+
+#if defined(ASIO_HAS_THREAD_AFFINITY)
+# if defined(ASIO_WINDOWS)
+  DWORD_PTR mask = 0;
+  for (std::size_t i = first; i < last; ++i)
+    if (cpus_[i] < sizeof(DWORD_PTR) * 8)
+      mask |= static_cast<DWORD_PTR>(1) << cpus_[i];
+  if (mask == 0)
+  {
+    ec = asio::error::invalid_argument;
+    ASIO_SYNC_OP_VOID_RETURN(ec);
+  }
+  if (!::SetThreadAffinityMask(::GetCurrentThread(), mask))
+  {
+    DWORD last_error = ::GetLastError();
+    ec = asio::error_code(last_error,
+        asio::error::get_system_category());
+    ASIO_SYNC_OP_VOID_RETURN(ec);
+  }
+# else // defined(ASIO_WINDOWS)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (std::size_t i = first; i < last; ++i)
+    if (cpus_[i] < CPU_SETSIZE)
+      CPU_SET(cpus_[i], &set);
+  if (CPU_COUNT(&set) == 0)
+  {
+    ec = asio::error::invalid_argument;
+    ASIO_SYNC_OP_VOID_RETURN(ec);
+  }
+  int result = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+  if (result != 0)
+  {
+    ec = asio::error_code(result,
+        asio::error::get_system_category());
+    ASIO_SYNC_OP_VOID_RETURN(ec);
+  }
+# endif // defined(ASIO_WINDOWS)
+
+  ec = asio::error_code();
+  ASIO_SYNC_OP_VOID_RETURN(ec);
+#else // defined(ASIO_HAS_THREAD_AFFINITY)
+  (void)first;
+  (void)last;
+  ec = asio::error::operation_not_supported;
+  ASIO_SYNC_OP_VOID_RETURN(ec);
+#endif // defined(ASIO_HAS_THREAD_AFFINITY)
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_THREAD_AFFINITY_IPP
@@ -199,14 +199,35 @@ void thread_pool::basic_executor_type<Allocator, Bits>::do_bulk_execute(
 {
   typedef typename decay<Function>::type function_type;
   typedef detail::bulk_executor_op<function_type, Allocator> op;
+  typedef typename op::state_type state_type;
 
-  // Allocate and construct operations to wrap the function.
+  if (n == 0)
+    return;
+
+  // Divide the range between no more operations than there are threads to
+  // run them. Each operation claims chunks of the range until it is used up.
+  std::size_t workers = static_cast<std::size_t>(
+      static_cast<long>(pool_->num_threads_));
+  if (workers == 0)
+    workers = 1;
+  else if (workers > n)
+    workers = n;
+
+  // Allocate and construct the state that holds the function.
+  typename state_type::ptr s = { detail::addressof(allocator_),
+      state_type::ptr::allocate(allocator_), 0 };
+  s.p = new (s.v) state_type(ASIO_MOVE_CAST(Function)(f),
+      allocator_, n, workers);
+  typename state_type::releaser state = { s.p };
+  s.v = s.p = 0;
+
+  // Allocate and construct operations to run the function.
   detail::op_queue<detail::scheduler_operation> ops;
-  for (std::size_t i = 0; i < n; ++i)
+  for (std::size_t i = 0; i < workers; ++i)
   {
     typename op::ptr p = { detail::addressof(allocator_),
         op::ptr::allocate(allocator_), 0 };
-    p.p = new (p.v) op(ASIO_MOVE_CAST(Function)(f), allocator_, i);
+    p.p = new (p.v) op(state.state_, allocator_);
     ops.push(p.p);
 
     if ((bits_ & relationship_continuation) != 0)
@@ -217,13 +238,13 @@ void thread_pool::basic_executor_type<Allocator, Bits>::do_bulk_execute(
     else
     {
       ASIO_HANDLER_CREATION((*pool_, *p.p,
-            "thread_pool", pool_, 0, "bulk)execute(blk=never,rel=fork)"));
+            "thread_pool", pool_, 0, "bulk_execute(blk=never,rel=fork)"));
     }
 
     p.v = p.p = 0;
   }
 
-  pool_->scheduler_.post_immediate_completions(n,
+  pool_->scheduler_.post_immediate_completions(workers,
       ops, (bits_ & relationship_continuation) != 0);
 }
 
@@ -17,7 +17,11 @@
 
 #include "asio/detail/config.hpp"
 #include <stdexcept>
+#include <vector>
 #include "asio/thread_pool.hpp"
+#include "asio/detail/event.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/thread.hpp"
 #include "asio/detail/throw_exception.hpp"
 
 #include "asio/detail/push_options.hpp"
@@ -27,9 +31,19 @@ namespace asio {
 struct thread_pool::thread_function
 {
   detail::scheduler* scheduler_;
+  const thread_affinity* affinity_;
+  std::size_t index_;
 
   void operator()()
   {
+    // Apply the affinity before the scheduler allocates any memory for this
+    // thread, so that the memory is local to the thread's NUMA node.
+    if (affinity_)
+    {
+      asio::error_code ec;
+      affinity_->apply(index_, ec);
+    }
+
 #if !defined(ASIO_NO_EXCEPTIONS)
     try
     {
@@ -46,6 +60,180 @@ struct thread_pool::thread_function
   }
 };
 
+struct thread_pool::elastic_state
+{
+  // A thread started by an elastic pool.
+  struct worker
+  {
+    detail::thread* thread_;
+    bool exited_;
+  };
+
+  explicit elastic_state(const elastic_options& options)
+    : options_(options),
+      probe_pending_(false),
+      monitor_(0)
+  {
+    if (options_.min_threads == 0)
+      options_.min_threads = 1;
+    if (options_.max_threads < options_.min_threads)
+      options_.max_threads = options_.min_threads;
+    if (options_.grow_threshold_usec <= 0)
+      options_.grow_threshold_usec = 1;
+  }
+
+  // Join and destroy the threads that have exited. The mutex must be held.
+  void reap()
+  {
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < workers_.size(); ++i)
+    {
+      if (workers_[i]->exited_)
+      {
+        workers_[i]->thread_->join();
+        delete workers_[i]->thread_;
+        delete workers_[i];
+      }
+      else
+        workers_[j++] = workers_[i];
+    }
+    workers_.resize(j);
+  }
+
+  elastic_options options_;
+  detail::mutex mutex_;
+  detail::event wakeup_;
+  bool probe_pending_;
+  scaling_statistics statistics_;
+  detail::thread* monitor_;
+  std::vector<worker*> workers_;
+};
+
+struct thread_pool::elastic_thread_function
+{
+  thread_pool* pool_;
+  elastic_state::worker* worker_;
+
+  void operator()()
+  {
+#if !defined(ASIO_NO_EXCEPTIONS)
+    try
+    {
+#endif// !defined(ASIO_NO_EXCEPTIONS)
+      for (;;)
+      {
+        asio::error_code ec;
+        pool_->scheduler_.run_until_idle(
+            pool_->elastic_->options_.idle_timeout_usec, ec);
+        if (retire())
+          return;
+      }
+#if !defined(ASIO_NO_EXCEPTIONS)
+    }
+    catch (...)
+    {
+      std::terminate();
+    }
+#endif// !defined(ASIO_NO_EXCEPTIONS)
+  }
+
+  // Called when the thread has had no work. Returns true if the thread should
+  // exit, either because the pool is stopped or because it has more threads
+  // than it needs.
+  bool retire()
+  {
+    elastic_state& state = *pool_->elastic_;
+    detail::mutex::scoped_lock lock(state.mutex_);
+    if (pool_->scheduler_.stopped())
+    {
+      // Wake the monitor so that it exits without waiting out its interval.
+      state.wakeup_.signal_all(lock);
+      return true;
+    }
+
+    if (static_cast<std::size_t>(pool_->num_threads_)
+        <= state.options_.min_threads)
+      return false;
+
+    --pool_->num_threads_;
+    --state.statistics_.threads;
+    ++state.statistics_.threads_retired;
+    worker_->exited_ = true;
+    return true;
+  }
+};
+
+struct thread_pool::elastic_probe
+{
+  elastic_state* state_;
+
+  void operator()()
+  {
+    detail::mutex::scoped_lock lock(state_->mutex_);
+    state_->probe_pending_ = false;
+  }
+};
+
+struct thread_pool::elastic_monitor_function
+{
+  thread_pool* pool_;
+
+  void operator()()
+  {
+#if !defined(ASIO_NO_EXCEPTIONS)
+    try
+    {
+#endif// !defined(ASIO_NO_EXCEPTIONS)
+      elastic_state& state = *pool_->elastic_;
+      detail::mutex::scoped_lock lock(state.mutex_);
+      while (!pool_->scheduler_.stopped())
+      {
+        // Sleep for one interval with the lock released. The event is
+        // signalled when the pool is stopped or joined.
+        bool woken = state.wakeup_.wait_for_usec(
+            lock, state.options_.grow_threshold_usec);
+        state.reap();
+
+        if (pool_->scheduler_.stopped())
+          break;
+        else if (woken)
+        {
+          // A full interval has not passed, so a pending probe cannot yet be
+          // said to be delayed.
+          state.wakeup_.clear(lock);
+        }
+        else if (state.probe_pending_)
+        {
+          // The last probe has waited in the queue for at least the growth
+          // threshold, so the existing threads are not keeping up.
+          ++state.statistics_.probes_delayed;
+          if (static_cast<std::size_t>(pool_->num_threads_)
+              < state.options_.max_threads)
+            pool_->add_elastic_thread();
+        }
+        else if (pool_->scheduler_.has_ready_handlers())
+        {
+          // Probe only when handlers are waiting, so that idle threads are
+          // not kept busy running probes.
+          state.probe_pending_ = true;
+          elastic_probe probe = { &state };
+          lock.unlock();
+          execution::execute(
+              asio::require(pool_->executor(), execution::blocking.never),
+              probe);
+          lock.lock();
+        }
+      }
+#if !defined(ASIO_NO_EXCEPTIONS)
+    }
+    catch (...)
+    {
+      std::terminate();
+    }
+#endif// !defined(ASIO_NO_EXCEPTIONS)
+  }
+};
+
 #if !defined(ASIO_NO_TS_EXECUTORS)
 namespace detail {
 
@@ -64,7 +252,7 @@ thread_pool::thread_pool()
 {
   scheduler_.work_started();
 
-  thread_function f = { &scheduler_ };
+  thread_function f = { &scheduler_, 0, 0 };
   threads_.create_threads(f, static_cast<std::size_t>(num_threads_));
 }
 #endif // !defined(ASIO_NO_TS_EXECUTORS)
@@ -90,10 +278,40 @@ thread_pool::thread_pool(std::size_t num_threads)
 {
   scheduler_.work_started();
 
-  thread_function f = { &scheduler_ };
+  thread_function f = { &scheduler_, 0, 0 };
   threads_.create_threads(f, static_cast<std::size_t>(num_threads_));
 }
 
+thread_pool::thread_pool(std::size_t num_threads,
+    const thread_affinity& affinity)
+  : scheduler_(add_scheduler(new detail::scheduler(
+          *this, num_threads == 1 ? 1 : 0, false))),
+    affinity_(affinity),
+    num_threads_(detail::clamp_thread_pool_size(num_threads))
+{
+  scheduler_.work_started();
+
+  for (std::size_t i = 0; i < static_cast<std::size_t>(num_threads_); ++i)
+  {
+    thread_function f = { &scheduler_, &affinity_, i };
+    threads_.create_thread(f);
+  }
+}
+
+thread_pool::thread_pool(const elastic_options& options)
+  : scheduler_(add_scheduler(new detail::scheduler(*this, 0, false))),
+    num_threads_(0),
+    elastic_(new elastic_state(options))
+{
+  scheduler_.work_started();
+
+  detail::mutex::scoped_lock lock(elastic_->mutex_);
+  for (std::size_t i = 0; i < elastic_->options_.min_threads; ++i)
+    add_elastic_thread();
+  elastic_monitor_function f = { this };
+  elastic_->monitor_ = new detail::thread(f);
+}
+
 thread_pool::~thread_pool()
 {
   stop();
@@ -103,18 +321,26 @@ thread_pool::~thread_pool()
 void thread_pool::stop()
 {
   scheduler_.stop();
+
+  if (elastic_.get())
+  {
+    detail::mutex::scoped_lock lock(elastic_->mutex_);
+    elastic_->wakeup_.signal_all(lock);
+  }
 }
 
 void thread_pool::attach()
 {
   ++num_threads_;
-  thread_function f = { &scheduler_ };
+  thread_function f = { &scheduler_, 0, 0 };
   f();
 }
 
 void thread_pool::join()
 {
-  if (!threads_.empty())
+  if (elastic_.get())
+    join_elastic();
+  else if (!threads_.empty())
   {
     scheduler_.work_finished();
     threads_.join();
@@ -130,10 +356,83 @@ detail::scheduler& thread_pool::add_scheduler(detail::scheduler* s)
 
 void thread_pool::wait()
 {
+  if (elastic_.get())
+  {
+    join_elastic();
+    return;
+  }
+
   scheduler_.work_finished();
   threads_.join();
 }
 
+thread_pool::scaling_statistics thread_pool::get_scaling_statistics() const
+{
+  if (elastic_state* state = const_cast<thread_pool*>(this)->elastic_.get())
+  {
+    detail::mutex::scoped_lock lock(state->mutex_);
+    return state->statistics_;
+  }
+
+  scaling_statistics statistics;
+  statistics.threads = static_cast<std::size_t>(num_threads_);
+  statistics.peak_threads = statistics.threads;
+  statistics.threads_started = statistics.threads;
+  return statistics;
+}
+
+void thread_pool::join_elastic()
+{
+  detail::mutex::scoped_lock lock(elastic_->mutex_);
+  detail::thread* monitor = elastic_->monitor_;
+  if (!monitor)
+    return;
+  elastic_->monitor_ = 0;
+  lock.unlock();
+
+  // The monitor continues to add threads until the scheduler runs out of work
+  // and stops. Each thread that sees the scheduler stopped wakes it.
+  scheduler_.work_finished();
+  lock.lock();
+  if (scheduler_.stopped())
+    elastic_->wakeup_.signal_all(lock);
+  lock.unlock();
+  monitor->join();
+  delete monitor;
+
+  // No more threads are added once the monitor has exited.
+  lock.lock();
+  std::vector<elastic_state::worker*> workers;
+  workers.swap(elastic_->workers_);
+  lock.unlock();
+  for (std::size_t i = 0; i < workers.size(); ++i)
+  {
+    workers[i]->thread_->join();
+    delete workers[i]->thread_;
+    delete workers[i];
+  }
+
+  lock.lock();
+  elastic_->statistics_.threads = 0;
+}
+
+void thread_pool::add_elastic_thread()
+{
+  elastic_state& state = *elastic_;
+  elastic_state::worker* w = new elastic_state::worker;
+  w->thread_ = 0;
+  w->exited_ = false;
+  state.workers_.push_back(w);
+
+  ++num_threads_;
+  if (++state.statistics_.threads > state.statistics_.peak_threads)
+    state.statistics_.peak_threads = state.statistics_.threads;
+  ++state.statistics_.threads_started;
+
+  elastic_thread_function f = { this, w };
+  w->thread_ = new detail::thread(f);
+}
+
 } // namespace asio
 
 #include "asio/detail/pop_options.hpp"
@@ -0,0 +1,316 @@
+//
+// impl/write_queue.hpp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_WRITE_QUEUE_HPP
+#define ASIO_IMPL_WRITE_QUEUE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/cancellation_type.hpp"
+#include "asio/post.hpp"
+#include "asio/write.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// The implementation of async_push and async_flush. A push first adds its
+// message to the queue. Both then wait, using the queue's notification timer,
+// until their condition holds. The timer never expires, and is cancelled to
+// wake the waiting operations whenever the state of the queue changes, or
+// when the queue is destroyed.
+template <typename Queue>
+class write_queue_op
+{
+public:
+  typedef typename Queue::impl impl_type;
+
+  // Construct an operation that waits for all queued messages to be written.
+  explicit write_queue_op(const shared_ptr<impl_type>& queue)
+    : queue_(queue),
+      flush_(true),
+      target_(0),
+      generation_(0),
+      state_(starting)
+  {
+  }
+
+  // Construct an operation that queues a message, then waits for room.
+  write_queue_op(const shared_ptr<impl_type>& queue,
+      ASIO_MOVE_ARG(std::string) message)
+    : queue_(queue),
+      message_(ASIO_MOVE_CAST(std::string)(message)),
+      flush_(false),
+      target_(0),
+      generation_(0),
+      state_(starting)
+  {
+  }
+
+  template <typename Self>
+  void operator()(Self& self,
+      const asio::error_code& = asio::error_code())
+  {
+    switch (state_)
+    {
+    case starting:
+      self.reset_cancellation_state(enable_total_cancellation());
+      generation_ = queue_->cancel_generation_;
+      if (flush_)
+        target_ = queue_->queued_total_;
+      else
+        queue_->enqueue(ASIO_MOVE_CAST(std::string)(message_));
+      if (ready())
+      {
+        // Complete via the executor, as the initiating function must not
+        // invoke the handler directly.
+        state_ = completing;
+        asio::post(ASIO_MOVE_CAST(Self)(self));
+        return;
+      }
+      break;
+    case waiting:
+      --queue_->waiters_;
+      if (self.get_cancellation_state().cancelled() != cancellation_type::none
+          || generation_ != queue_->cancel_generation_ || queue_->closed_)
+      {
+        self.complete(asio::error::operation_aborted);
+        return;
+      }
+      if (ready())
+      {
+        self.complete(result_);
+        return;
+      }
+      break;
+    default:
+      self.complete(result_);
+      return;
+    }
+
+    state_ = waiting;
+    ++queue_->waiters_;
+    queue_->notify_timer_.async_wait(ASIO_MOVE_CAST(Self)(self));
+  }
+
+private:
+  // Determine whether the operation can complete, and with what result.
+  bool ready()
+  {
+    if (queue_->error_)
+    {
+      result_ = queue_->error_;
+      return true;
+    }
+    if (flush_)
+      return queue_->written_total_ >= target_;
+    return queue_->pending_bytes_ <= queue_->max_pending_bytes_;
+  }
+
+  enum state_type { starting, waiting, completing };
+
+  shared_ptr<impl_type> queue_;
+  std::string message_;
+  bool flush_;
+  asio::uint64_t target_;
+  unsigned int generation_;
+  state_type state_;
+  asio::error_code result_;
+};
+
+} // namespace detail
+
+// A buffer sequence that refers to the buffers gathered for a write, without
+// copying them.
+template <typename AsyncWriteStream>
+class write_queue<AsyncWriteStream>::gathered_buffers
+{
+public:
+  typedef const_buffer value_type;
+  typedef const const_buffer* const_iterator;
+
+  explicit gathered_buffers(const std::vector<const_buffer>& buffers)
+    : begin_(&buffers[0]),
+      end_(&buffers[0] + buffers.size())
+  {
+  }
+
+  const_iterator begin() const
+  {
+    return begin_;
+  }
+
+  const_iterator end() const
+  {
+    return end_;
+  }
+
+private:
+  const_iterator begin_;
+  const_iterator end_;
+};
+
+template <typename AsyncWriteStream>
+class write_queue<AsyncWriteStream>::write_handler
+{
+public:
+  explicit write_handler(const detail::shared_ptr<impl>& queue)
+    : queue_(queue)
+  {
+  }
+
+  void operator()(const asio::error_code& ec, std::size_t)
+  {
+    queue_->handle_write(ec);
+  }
+
+private:
+  detail::shared_ptr<impl> queue_;
+};
+
+template <typename AsyncWriteStream>
+class write_queue<AsyncWriteStream>::batch_handler
+{
+public:
+  explicit batch_handler(const detail::shared_ptr<impl>& queue)
+    : queue_(queue)
+  {
+  }
+
+  void operator()(const asio::error_code&)
+  {
+    queue_->batching_ = false;
+    queue_->start_write();
+  }
+
+private:
+  detail::shared_ptr<impl> queue_;
+};
+
+template <typename AsyncWriteStream>
+write_queue<AsyncWriteStream>::impl::impl(next_layer_type& stream)
+  : stream_(stream),
+    notify_timer_(stream.get_executor()),
+    batch_timer_(stream.get_executor()),
+    max_buffers_(default_max_buffers),
+    max_pending_bytes_((std::numeric_limits<std::size_t>::max)()),
+    batch_delay_(duration::zero()),
+    pending_bytes_(0),
+    writing_(false),
+    batching_(false),
+    closed_(false),
+    write_count_(0),
+    queued_total_(0),
+    written_total_(0),
+    waiters_(0),
+    cancel_generation_(0)
+{
+  notify_timer_.expires_at((chrono::steady_clock::time_point::max)());
+}
+
+template <typename AsyncWriteStream>
+void write_queue<AsyncWriteStream>::impl::enqueue(
+    ASIO_MOVE_ARG(std::string) message)
+{
+  if (error_)
+    return;
+
+  pending_bytes_ += message.size();
+  queued_total_ += message.size();
+  messages_.push_back(ASIO_MOVE_CAST(std::string)(message));
+  schedule_write();
+}
+
+template <typename AsyncWriteStream>
+void write_queue<AsyncWriteStream>::impl::schedule_write()
+{
+  if (writing_)
+    return;
+
+  if (batching_)
+  {
+    // Stop waiting for more messages once a full write has accumulated.
+    if (messages_.size() >= max_buffers_)
+      batch_timer_.cancel();
+    return;
+  }
+
+  if (batch_delay_ > duration::zero() && messages_.size() < max_buffers_)
+  {
+    batching_ = true;
+    batch_timer_.expires_after(batch_delay_);
+    batch_timer_.async_wait(batch_handler(self_.lock()));
+    return;
+  }
+
+  start_write();
+}
+
+template <typename AsyncWriteStream>
+void write_queue<AsyncWriteStream>::impl::start_write()
+{
+  if (writing_ || messages_.empty() || error_ || closed_)
+    return;
+
+  writing_ = true;
+  write_count_ = messages_.size() < max_buffers_
+    ? messages_.size() : max_buffers_;
+  buffers_.clear();
+  for (std::size_t i = 0; i < write_count_; ++i)
+    buffers_.push_back(asio::buffer(messages_[i]));
+
+  asio::async_write(stream_, gathered_buffers(buffers_),
+      write_handler(self_.lock()));
+}
+
+template <typename AsyncWriteStream>
+void write_queue<AsyncWriteStream>::impl::handle_write(
+    const asio::error_code& ec)
+{
+  writing_ = false;
+  if (ec)
+  {
+    error_ = ec;
+    messages_.clear();
+    pending_bytes_ = 0;
+    if (batching_)
+      batch_timer_.cancel();
+  }
+  else
+  {
+    for (std::size_t i = 0; i < write_count_; ++i)
+    {
+      pending_bytes_ -= messages_.front().size();
+      written_total_ += messages_.front().size();
+      messages_.pop_front();
+    }
+
+    // Messages queued during the write have already been batched together.
+    start_write();
+  }
+
+  notify();
+}
+
+template <typename AsyncWriteStream>
+void write_queue<AsyncWriteStream>::impl::notify()
+{
+  if (waiters_ > 0)
+    notify_timer_.cancel();
+}
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_WRITE_QUEUE_HPP
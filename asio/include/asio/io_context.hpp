@@ -22,6 +22,7 @@
 #include "asio/async_result.hpp"
 #include "asio/detail/concurrency_hint.hpp"
 #include "asio/detail/cstdint.hpp"
+#include "asio/detail/scheduler_statistics.hpp"
 #include "asio/detail/wrapped_handler.hpp"
 #include "asio/error_code.hpp"
 #include "asio/execution.hpp"
@@ -62,6 +63,13 @@ namespace detail {
     ASIO_STATIC_CONSTEXPR(uintptr_t, relationship_continuation = 2);
     ASIO_STATIC_CONSTEXPR(uintptr_t, outstanding_work_tracked = 4);
     ASIO_STATIC_CONSTEXPR(uintptr_t, runtime_bits = 3);
+    ASIO_STATIC_CONSTEXPR(uintptr_t, max_priority = 3);
+#if defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+    ASIO_STATIC_CONSTEXPR(uintptr_t, priority_shift = 2);
+    ASIO_STATIC_CONSTEXPR(uintptr_t, target_bits = 15);
+#else // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+    ASIO_STATIC_CONSTEXPR(uintptr_t, target_bits = 3);
+#endif // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
   };
 } // namespace detail
 
@@ -191,7 +199,11 @@ namespace detail {
  * ...
  * work.reset(); // Allow run() to exit. @endcode
  */
+#if defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+class ASIO_ALIGNED_IO_CONTEXT io_context
+#else // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
 class io_context
+#endif // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
   : public execution_context
 {
 private:
@@ -231,6 +243,40 @@ public:
   /// The type used to count the number of handlers executed by the context.
   typedef std::size_t count_type;
 
+#if defined(GENERATING_DOCUMENTATION)
+  /// Statistics describing the behaviour of an io_context.
+  struct statistics
+  {
+    /// The number of times the reactor has been run.
+    uint64_t task_polls;
+
+    /// The number of reactor runs that were forced by the handler budget.
+    uint64_t forced_task_polls;
+
+    /// The number of measured intervals between runs of the reactor.
+    uint64_t task_poll_intervals;
+
+    /// The median interval, in microseconds.
+    uint64_t task_poll_interval_p50_usec;
+
+    /// The 99th percentile interval, in microseconds.
+    uint64_t task_poll_interval_p99_usec;
+
+    /// The longest interval, in microseconds.
+    uint64_t task_poll_interval_max_usec;
+
+    /// The number of interrupts sent to wake the reactor.
+    uint64_t task_interrupts_sent;
+
+    /// The number of wakeups that did not need an interrupt, because an
+    /// earlier interrupt had not yet been observed or the reactor was not
+    /// waiting.
+    uint64_t task_interrupts_suppressed;
+  };
+#else // defined(GENERATING_DOCUMENTATION)
+  typedef detail::scheduler_statistics statistics;
+#endif // defined(GENERATING_DOCUMENTATION)
+
   /// Constructor.
   ASIO_DECL io_context();
 
@@ -243,6 +289,18 @@ public:
    */
   ASIO_DECL explicit io_context(int concurrency_hint);
 
+  /// Constructor.
+  /**
+   * Construct with a service maker, to create an initial set of services and
+   * add them to the io_context. The concurrency hint is obtained from the @c
+   * scheduler.concurrency_hint configuration value, if present.
+   *
+   * @param initial_services Used to create the initial services. The @c make
+   * function will be called once at the beginning of construction.
+   */
+  ASIO_DECL explicit io_context(
+      const execution_context::service_maker& initial_services);
+
   /// Destructor.
   /**
    * On destruction, the io_context performs the following sequence of
@@ -523,6 +581,20 @@ public:
    */
   ASIO_DECL void restart();
 
+  /// Obtain statistics describing the behaviour of the io_context.
+  /**
+   * The statistics include the number of times the reactor has been run, how
+   * many of those runs were non-blocking polls forced by the handler budget,
+   * the distribution of the intervals between runs, and the number of
+   * interrupts sent to the reactor and suppressed. Intervals are measured
+   * only if the @c scheduler.statistics configuration key is @c true, or the
+   * @c scheduler.handler_budget_usec key is non-zero.
+   *
+   * @note On Windows, where the io_context is implemented using I/O completion
+   * ports, all of the statistics are zero.
+   */
+  ASIO_DECL statistics get_statistics() const;
+
 #if !defined(ASIO_NO_DEPRECATED)
   /// (Deprecated: Use restart().) Reset the io_context in preparation for a
   /// subsequent run() invocation.
@@ -635,6 +707,9 @@ private:
   // Helper function to add the implementation.
   ASIO_DECL impl_type& add_impl(impl_type* impl);
 
+  // Helper function to obtain the concurrency hint from the configuration.
+  ASIO_DECL static int configured_concurrency_hint(execution_context& ctx);
+
   // Backwards compatible overload for use with services derived from
   // io_context::service.
   template <typename Service>
@@ -666,6 +741,9 @@ public:
       const basic_executor_type& other) ASIO_NOEXCEPT
     : Allocator(static_cast<const Allocator&>(other)),
       target_(other.target_)
+#if !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+    , priority_(other.priority_)
+#endif // !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
   {
     if (Bits & outstanding_work_tracked)
       if (context_ptr())
@@ -677,6 +755,9 @@ public:
   basic_executor_type(basic_executor_type&& other) ASIO_NOEXCEPT
     : Allocator(ASIO_MOVE_CAST(Allocator)(other)),
       target_(other.target_)
+#if !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+    , priority_(other.priority_)
+#endif // !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
   {
     if (Bits & outstanding_work_tracked)
       other.target_ = 0;
@@ -721,7 +802,7 @@ private:
       execution::blocking_t::possibly_t) const
   {
     return basic_executor_type(context_ptr(),
-        *this, bits() & ~blocking_never);
+        *this, bits() & ~blocking_never, priority());
   }
 
   /// Obtain an executor with the @c blocking.never property.
@@ -738,7 +819,7 @@ private:
       execution::blocking_t::never_t) const
   {
     return basic_executor_type(context_ptr(),
-        *this, bits() | blocking_never);
+        *this, bits() | blocking_never, priority());
   }
 
   /// Obtain an executor with the @c relationship.fork property.
@@ -755,7 +836,7 @@ private:
       execution::relationship_t::fork_t) const
   {
     return basic_executor_type(context_ptr(),
-        *this, bits() & ~relationship_continuation);
+        *this, bits() & ~relationship_continuation, priority());
   }
 
   /// Obtain an executor with the @c relationship.continuation property.
@@ -772,7 +853,7 @@ private:
       execution::relationship_t::continuation_t) const
   {
     return basic_executor_type(context_ptr(),
-        *this, bits() | relationship_continuation);
+        *this, bits() | relationship_continuation, priority());
   }
 
   /// Obtain an executor with the @c outstanding_work.tracked property.
@@ -790,7 +871,7 @@ private:
   require(execution::outstanding_work_t::tracked_t) const
   {
     return basic_executor_type<Allocator, Bits | outstanding_work_tracked>(
-        context_ptr(), *this, bits());
+        context_ptr(), *this, bits(), priority());
   }
 
   /// Obtain an executor with the @c outstanding_work.untracked property.
@@ -808,7 +889,7 @@ private:
   require(execution::outstanding_work_t::untracked_t) const
   {
     return basic_executor_type<Allocator, Bits & ~outstanding_work_tracked>(
-        context_ptr(), *this, bits());
+        context_ptr(), *this, bits(), priority());
   }
 
   /// Obtain an executor with the specified @c allocator property.
@@ -826,7 +907,7 @@ private:
   require(execution::allocator_t<OtherAllocator> a) const
   {
     return basic_executor_type<OtherAllocator, Bits>(
-        context_ptr(), a.value(), bits());
+        context_ptr(), a.value(), bits(), priority());
   }
 
   /// Obtain an executor with the default @c allocator property.
@@ -843,7 +924,25 @@ private:
   require(execution::allocator_t<void>) const
   {
     return basic_executor_type<std::allocator<void>, Bits>(
-        context_ptr(), std::allocator<void>(), bits());
+        context_ptr(), std::allocator<void>(), bits(), priority());
+  }
+
+  /// Obtain an executor with the specified @c priority property.
+  /**
+   * Do not call this function directly. It is intended for use with the
+   * asio::require customisation point.
+   *
+   * For example:
+   * @code auto ex1 = my_io_context.get_executor();
+   * auto ex2 = asio::require(ex1,
+   *     asio::execution::priority(1)); @endcode
+   *
+   * Priorities above 3 are treated as 3.
+   */
+  ASIO_CONSTEXPR basic_executor_type require(
+      execution::priority_t p) const
+  {
+    return basic_executor_type(context_ptr(), *this, bits(), p.value());
   }
 
 #if !defined(GENERATING_DOCUMENTATION)
@@ -975,6 +1074,22 @@ private:
     return static_cast<const Allocator&>(*this);
   }
 
+  /// Query the current value of the @c priority property.
+  /**
+   * Do not call this function directly. It is intended for use with the
+   * asio::query customisation point.
+   *
+   * For example:
+   * @code auto ex = my_io_context.get_executor();
+   * unsigned int p = asio::query(ex,
+   *     asio::execution::priority); @endcode
+   */
+  ASIO_CONSTEXPR unsigned int query(
+      execution::priority_t) const ASIO_NOEXCEPT
+  {
+    return priority();
+  }
+
 public:
   /// Determine whether the io_context is running in the current thread.
   /**
@@ -991,6 +1106,9 @@ public:
       const basic_executor_type& b) ASIO_NOEXCEPT
   {
     return a.target_ == b.target_
+#if !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+      && a.priority_ == b.priority_
+#endif // !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
       && static_cast<const Allocator&>(a) == static_cast<const Allocator&>(b);
   }
 
@@ -1002,6 +1120,9 @@ public:
       const basic_executor_type& b) ASIO_NOEXCEPT
   {
     return a.target_ != b.target_
+#if !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+      || a.priority_ != b.priority_
+#endif // !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
       || static_cast<const Allocator&>(a) != static_cast<const Allocator&>(b);
   }
 
@@ -1108,16 +1229,26 @@ private:
   explicit basic_executor_type(io_context& i) ASIO_NOEXCEPT
     : Allocator(),
       target_(reinterpret_cast<uintptr_t>(&i))
+#if !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+    , priority_(0)
+#endif // !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
   {
     if (Bits & outstanding_work_tracked)
       context_ptr()->impl_.work_started();
   }
 
   // Constructor used by require().
-  basic_executor_type(io_context* i,
-      const Allocator& a, uintptr_t bits) ASIO_NOEXCEPT
+  basic_executor_type(io_context* i, const Allocator& a,
+      uintptr_t bits, unsigned int priority) ASIO_NOEXCEPT
     : Allocator(a),
-      target_(reinterpret_cast<uintptr_t>(i) | bits)
+#if defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+      target_(reinterpret_cast<uintptr_t>(i) | bits
+          | ((priority < max_priority ? priority : max_priority)
+            << priority_shift))
+#else // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+      target_(reinterpret_cast<uintptr_t>(i) | bits),
+      priority_(priority < max_priority ? priority : max_priority)
+#endif // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
   {
     if (Bits & outstanding_work_tracked)
       if (context_ptr())
@@ -1126,7 +1257,7 @@ private:
 
   io_context* context_ptr() const ASIO_NOEXCEPT
   {
-    return reinterpret_cast<io_context*>(target_ & ~runtime_bits);
+    return reinterpret_cast<io_context*>(target_ & ~target_bits);
   }
 
   uintptr_t bits() const ASIO_NOEXCEPT
@@ -1134,8 +1265,24 @@ private:
     return target_ & runtime_bits;
   }
 
-  // The underlying io_context and runtime bits.
+  unsigned int priority() const ASIO_NOEXCEPT
+  {
+#if defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+    return static_cast<unsigned int>(
+        (target_ & target_bits) >> priority_shift);
+#else // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+    return priority_;
+#endif // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+  }
+
+  // The underlying io_context, runtime bits and, when the io_context is
+  // aligned to 16 bytes, the priority.
   uintptr_t target_;
+
+#if !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+  // The priority with which functions are submitted.
+  unsigned int priority_;
+#endif // !defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
 };
 
 #if !defined(ASIO_NO_DEPRECATED)
@@ -1391,6 +1538,18 @@ struct require_member<
       OtherAllocator, Bits> result_type;
 };
 
+template <typename Allocator, uintptr_t Bits>
+struct require_member<
+    asio::io_context::basic_executor_type<Allocator, Bits>,
+    asio::execution::priority_t
+  >
+{
+  ASIO_STATIC_CONSTEXPR(bool, is_valid = true);
+  ASIO_STATIC_CONSTEXPR(bool, is_noexcept = false);
+  typedef asio::io_context::basic_executor_type<
+      Allocator, Bits> result_type;
+};
+
 #endif // !defined(ASIO_HAS_DEDUCED_REQUIRE_MEMBER_TRAIT)
 
 #if !defined(ASIO_HAS_DEDUCED_QUERY_STATIC_CONSTEXPR_MEMBER_TRAIT)
@@ -1512,6 +1671,17 @@ struct query_member<
   typedef Allocator result_type;
 };
 
+template <typename Allocator, uintptr_t Bits>
+struct query_member<
+    asio::io_context::basic_executor_type<Allocator, Bits>,
+    asio::execution::priority_t
+  >
+{
+  ASIO_STATIC_CONSTEXPR(bool, is_valid = true);
+  ASIO_STATIC_CONSTEXPR(bool, is_noexcept = true);
+  typedef unsigned int result_type;
+};
+
 #endif // !defined(ASIO_HAS_DEDUCED_QUERY_MEMBER_TRAIT)
 
 } // namespace traits
@@ -0,0 +1,417 @@
+//
+// ip/basic_dns_resolver.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IP_BASIC_DNS_RESOLVER_HPP
+#define ASIO_IP_BASIC_DNS_RESOLVER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#include <string>
+#include <vector>
+#include "asio/any_io_executor.hpp"
+#include "asio/async_result.hpp"
+#include "asio/detail/dns_ops.hpp"
+#include "asio/detail/dns_resolve_op.hpp"
+#include "asio/detail/dns_resolver_service.hpp"
+#include "asio/detail/handler_type_requirements.hpp"
+#include "asio/detail/io_object_impl.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/non_const_lvalue.hpp"
+#include "asio/detail/socket_types.hpp"
+#include "asio/detail/string_view.hpp"
+#include "asio/error.hpp"
+#include "asio/execution_context.hpp"
+#include "asio/ip/basic_resolver_results.hpp"
+
+#if defined(ASIO_HAS_MOVE)
+# include <utility>
+#endif // defined(ASIO_HAS_MOVE)
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace ip {
+
+/// Provides asynchronous host name resolution using DNS queries that are
+/// performed on the I/O executor.
+/**
+ * The basic_dns_resolver class template resolves host and service names to a
+ * list of endpoints, like basic_resolver, but without calling @c getaddrinfo
+ * on a background thread. Instead, it sends DNS queries over UDP sockets that
+ * belong to the resolver's execution context, so that any number of lookups
+ * may be in progress at once.
+ *
+ * A host name is resolved in the following order:
+ *
+ * @li A numeric address is used as-is. The handler is posted without any
+ * socket operations.
+ *
+ * @li A name listed in the hosts file is resolved to the addresses given
+ * there.
+ *
+ * @li An unexpired answer in the execution context's cache is used. The cache
+ * is shared by all DNS resolvers in the context. Answers are kept for the
+ * time-to-live given by the name server, and answers saying that the name or
+ * address type does not exist are kept for the time given by the zone's SOA
+ * record.
+ *
+ * @li Otherwise, AAAA and A queries are sent to each name server in turn until
+ * one answers. The name servers are read from the file
+ * <tt>/etc/resolv.conf</tt>, together with its @c timeout and @c attempts
+ * options.
+ *
+ * These settings may be changed using the @c dns section of the execution
+ * context's configuration. The @c resolv_conf and @c hosts keys name the files
+ * to read, the @c nameservers key gives a list of name servers to use instead
+ * of those in resolv.conf, the @c timeout_ms and @c attempts keys override
+ * the resolv.conf options, and the @c cache_size key limits the number of
+ * cached answers.
+ *
+ * Search domains are not applied, so names should be fully qualified. Service
+ * names are looked up in the local services database.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+template <typename InternetProtocol, typename Executor = any_io_executor>
+class basic_dns_resolver
+{
+private:
+  class initiate_async_resolve;
+
+public:
+  /// The type of the executor associated with the object.
+  typedef Executor executor_type;
+
+  /// Rebinds the resolver type to another executor.
+  template <typename Executor1>
+  struct rebind_executor
+  {
+    /// The resolver type when rebound to the specified executor.
+    typedef basic_dns_resolver<InternetProtocol, Executor1> other;
+  };
+
+  /// The protocol type.
+  typedef InternetProtocol protocol_type;
+
+  /// The endpoint type.
+  typedef typename InternetProtocol::endpoint endpoint_type;
+
+  /// The results type.
+  typedef basic_resolver_results<InternetProtocol> results_type;
+
+  /// Construct with executor.
+  /**
+   * This constructor creates a basic_dns_resolver.
+   *
+   * @param ex The I/O executor that the resolver will use, by default, to
+   * dispatch handlers for any asynchronous operations performed on the
+   * resolver. The DNS queries are also performed using this executor.
+   */
+  explicit basic_dns_resolver(const executor_type& ex)
+    : impl_(0, ex)
+  {
+  }
+
+  /// Construct with execution context.
+  /**
+   * This constructor creates a basic_dns_resolver.
+   *
+   * @param context An execution context which provides the I/O executor that
+   * the resolver will use, by default, to dispatch handlers for any
+   * asynchronous operations performed on the resolver.
+   */
+  template <typename ExecutionContext>
+  explicit basic_dns_resolver(ExecutionContext& context,
+      typename constraint<
+        is_convertible<ExecutionContext&, execution_context&>::value
+      >::type = 0)
+    : impl_(0, 0, context)
+  {
+  }
+
+#if defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+  /// Move-construct a basic_dns_resolver from another.
+  /**
+   * This constructor moves a resolver from one object to another.
+   *
+   * @param other The other basic_dns_resolver object from which the move will
+   * occur.
+   *
+   * @note Following the move, the moved-from object is in the same state as if
+   * constructed using the @c basic_dns_resolver(const executor_type&)
+   * constructor.
+   */
+  basic_dns_resolver(basic_dns_resolver&& other)
+    : impl_(std::move(other.impl_))
+  {
+  }
+
+  /// Move-assign a basic_dns_resolver from another.
+  /**
+   * This assignment operator moves a resolver from one object to another.
+   * Cancels any outstanding asynchronous operations associated with the target
+   * object.
+   *
+   * @param other The other basic_dns_resolver object from which the move will
+   * occur.
+   *
+   * @note Following the move, the moved-from object is in the same state as if
+   * constructed using the @c basic_dns_resolver(const executor_type&)
+   * constructor.
+   */
+  basic_dns_resolver& operator=(basic_dns_resolver&& other)
+  {
+    impl_ = std::move(other.impl_);
+    return *this;
+  }
+#endif // defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+
+  /// Destroys the resolver.
+  /**
+   * This function destroys the resolver, cancelling any outstanding
+   * asynchronous operations associated with the resolver as if by calling
+   * @c cancel.
+   */
+  ~basic_dns_resolver()
+  {
+  }
+
+  /// Get the executor associated with the object.
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return impl_.get_executor();
+  }
+
+  /// Cancel any asynchronous operations that are waiting on the resolver.
+  /**
+   * This function forces the completion of any pending asynchronous
+   * operations on the host resolver. The handler for each cancelled operation
+   * will be invoked with the asio::error::operation_aborted error code.
+   */
+  void cancel()
+  {
+    return impl_.get_service().cancel(impl_.get_implementation());
+  }
+
+  /// Asynchronously perform forward resolution of a query to a list of entries.
+  /**
+   * This function is used to resolve host and service names into a list of
+   * endpoint entries. It is an initiating function for an @ref
+   * asynchronous_operation, and always returns immediately.
+   *
+   * @param host A string identifying a location. May be a descriptive name or
+   * a numeric address string.
+   *
+   * @param service A string identifying the requested service. This may be a
+   * descriptive name or a numeric string corresponding to a port number. May
+   * be an empty string, in which case all resolved endpoints will have a port
+   * number of 0.
+   *
+   * @param token The @ref completion_token that will be used to produce a
+   * completion handler, which will be called when the resolve completes.
+   * Potential completion tokens include @ref use_future, @ref use_awaitable,
+   * @ref yield_context, or a function object with the correct completion
+   * signature. The function signature of the completion handler must be:
+   * @code void handler(
+   *   const asio::error_code& error, // Result of operation.
+   *   results_type results // Resolved endpoints as a range.
+   * ); @endcode
+   * Regardless of whether the asynchronous operation completes immediately or
+   * not, the completion handler will not be invoked from within this function.
+   * On immediate completion, invocation of the handler will be performed in a
+   * manner equivalent to using asio::post().
+   *
+   * A successful resolve operation is guaranteed to pass a non-empty range to
+   * the handler. The IPv6 addresses, if any, are listed before the IPv4
+   * addresses.
+   *
+   * @par Completion Signature
+   * @code void(asio::error_code, results_type) @endcode
+   *
+   * @par Errors
+   * @li asio::error::host_not_found: The name does not exist.
+   * @li asio::error::no_data: The name exists but has no addresses.
+   * @li asio::error::host_not_found_try_again: No name server answered.
+   * @li asio::error::service_not_found: The service is not known.
+   */
+  template <
+      ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+        results_type)) ResolveToken
+          ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type)>
+  ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(ResolveToken,
+      void (asio::error_code, results_type))
+  async_resolve(ASIO_STRING_VIEW_PARAM host,
+      ASIO_STRING_VIEW_PARAM service,
+      ASIO_MOVE_ARG(ResolveToken) token
+        ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
+    ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+      asio::async_initiate<ResolveToken,
+        void (asio::error_code, results_type)>(
+          declval<initiate_async_resolve>(), token,
+          declval<const std::string&>(), declval<const std::string&>(),
+          true, true)))
+  {
+    return asio::async_initiate<ResolveToken,
+      void (asio::error_code, results_type)>(
+        initiate_async_resolve(this), token,
+        static_cast<std::string>(host), static_cast<std::string>(service),
+        true, true);
+  }
+
+  /// Asynchronously perform forward resolution of a query to a list of entries.
+  /**
+   * This function is used to resolve host and service names into a list of
+   * endpoint entries. It is an initiating function for an @ref
+   * asynchronous_operation, and always returns immediately.
+   *
+   * @param protocol A protocol object, normally representing either the IPv4
+   * or IPv6 version of an internet protocol. Only addresses of that version
+   * are returned.
+   *
+   * @param host A string identifying a location. May be a descriptive name or
+   * a numeric address string.
+   *
+   * @param service A string identifying the requested service. This may be a
+   * descriptive name or a numeric string corresponding to a port number. May
+   * be an empty string, in which case all resolved endpoints will have a port
+   * number of 0.
+   *
+   * @param token The @ref completion_token that will be used to produce a
+   * completion handler, which will be called when the resolve completes.
+   * Potential completion tokens include @ref use_future, @ref use_awaitable,
+   * @ref yield_context, or a function object with the correct completion
+   * signature. The function signature of the completion handler must be:
+   * @code void handler(
+   *   const asio::error_code& error, // Result of operation.
+   *   results_type results // Resolved endpoints as a range.
+   * ); @endcode
+   * Regardless of whether the asynchronous operation completes immediately or
+   * not, the completion handler will not be invoked from within this function.
+   * On immediate completion, invocation of the handler will be performed in a
+   * manner equivalent to using asio::post().
+   *
+   * @par Completion Signature
+   * @code void(asio::error_code, results_type) @endcode
+   */
+  template <
+      ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+        results_type)) ResolveToken
+          ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type)>
+  ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(ResolveToken,
+      void (asio::error_code, results_type))
+  async_resolve(const protocol_type& protocol,
+      ASIO_STRING_VIEW_PARAM host, ASIO_STRING_VIEW_PARAM service,
+      ASIO_MOVE_ARG(ResolveToken) token
+        ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
+    ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+      asio::async_initiate<ResolveToken,
+        void (asio::error_code, results_type)>(
+          declval<initiate_async_resolve>(), token,
+          declval<const std::string&>(), declval<const std::string&>(),
+          true, true)))
+  {
+    bool v6 = protocol.family() == ASIO_OS_DEF(AF_INET6);
+    return asio::async_initiate<ResolveToken,
+      void (asio::error_code, results_type)>(
+        initiate_async_resolve(this), token,
+        static_cast<std::string>(host), static_cast<std::string>(service),
+        !v6, v6);
+  }
+
+private:
+  // Disallow copying and assignment.
+  basic_dns_resolver(const basic_dns_resolver&) ASIO_DELETED;
+  basic_dns_resolver& operator=(const basic_dns_resolver&) ASIO_DELETED;
+
+  class initiate_async_resolve
+  {
+  public:
+    typedef Executor executor_type;
+
+    explicit initiate_async_resolve(basic_dns_resolver* self)
+      : self_(self)
+    {
+    }
+
+    executor_type get_executor() const ASIO_NOEXCEPT
+    {
+      return self_->get_executor();
+    }
+
+    template <typename ResolveHandler>
+    void operator()(ASIO_MOVE_ARG(ResolveHandler) handler,
+        const std::string& host, const std::string& service,
+        bool want_v4, bool want_v6) const
+    {
+      // If you get an error on the following line it means that your handler
+      // does not meet the documented type requirements for a ResolveHandler.
+      ASIO_RESOLVE_HANDLER_CHECK(
+          ResolveHandler, handler, results_type) type_check;
+
+      typedef typename decay<ResolveHandler>::type handler_type;
+      typedef asio::detail::dns_resolve_op<
+        InternetProtocol, handler_type, Executor> op;
+
+      asio::detail::non_const_lvalue<ResolveHandler> handler2(handler);
+      asio::detail::dns_resolver_service& service_impl =
+        self_->impl_.get_service();
+
+      unsigned short port = 0;
+      std::string name;
+      std::vector<asio::ip::address> addresses;
+      asio::error_code ec;
+      if (!service.empty())
+      {
+        asio::detail::dns_ops::resolve_service(service,
+            InternetProtocol::v4().type(), port, ec);
+      }
+
+      if (ec || service_impl.cache().resolve_locally(
+            host, want_v4, want_v6, name, addresses, ec))
+      {
+        std::vector<endpoint_type> endpoints;
+        for (std::size_t i = 0; i < addresses.size(); ++i)
+          endpoints.push_back(endpoint_type(addresses[i], port));
+        asio::detail::post_dns_resolve_result(self_->impl_.get_executor(),
+            handler2.value, ec, results_type::create(endpoints.begin(),
+              endpoints.end(), host, service));
+        return;
+      }
+
+      asio::detail::shared_ptr<asio::detail::dns_lookup> lookup(
+          new op(self_->impl_.get_executor(), service_impl.cache(),
+            name, want_v4, want_v6, handler2.value, host, service, port));
+      service_impl.start_lookup(self_->impl_.get_implementation(), lookup);
+    }
+
+  private:
+    basic_dns_resolver* self_;
+  };
+
+  asio::detail::io_object_impl<
+    asio::detail::dns_resolver_service, Executor> impl_;
+};
+
+} // namespace ip
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_IP_BASIC_DNS_RESOLVER_HPP
@@ -0,0 +1,181 @@
+//
+// offload.hpp
+// ~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_OFFLOAD_HPP
+#define ASIO_OFFLOAD_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include "asio/async_result.hpp"
+#include "asio/detail/blocking_offload_service.hpp"
+#include "asio/detail/offload_op.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/execution_context.hpp"
+#include "asio/execution/executor.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename> class initiate_offload;
+
+} // namespace detail
+
+#if defined(GENERATING_DOCUMENTATION)
+/// Statistics describing the threads used by offload().
+struct offload_statistics
+{
+  /// The number of threads that have been started.
+  std::size_t threads;
+
+  /// The largest number of threads.
+  std::size_t peak_threads;
+
+  /// The number of functions waiting for a thread.
+  std::size_t queued;
+
+  /// The largest number of functions that have waited for a thread.
+  std::size_t peak_queued;
+
+  /// The number of functions that have been accepted.
+  uint64_t submitted;
+
+  /// The number of accepted functions that have returned.
+  uint64_t completed;
+
+  /// The number of functions that were rejected because the queue was full.
+  uint64_t rejected;
+};
+#else // defined(GENERATING_DOCUMENTATION)
+typedef detail::blocking_offload_statistics offload_statistics;
+#endif // defined(GENERATING_DOCUMENTATION)
+
+/// Runs a blocking function on a thread that is shared by an execution
+/// context for blocking work.
+/**
+ * This function submits a function object to a bounded pool of threads that
+ * belongs to the executor's execution context. The same threads are used by
+ * the context's resolvers, so that blocking calls such as file I/O and host
+ * name resolution do not stall the threads that run the context. When the
+ * function returns, its result is passed to the completion handler.
+ *
+ * Threads are started on demand, up to the number given by the
+ * @c offload.max_threads configuration key, and are kept until the context is
+ * shut down. If the @c offload.max_queued configuration key is nonzero and
+ * that many functions are already waiting for a thread, the function is not
+ * run and the handler is passed @c asio::error::try_again.
+ *
+ * @param ex The I/O executor. The pool of threads is owned by the executor's
+ * execution context.
+ *
+ * @param f The function object to be called. It is called on one of the
+ * pool's threads with the signature:
+ * @code R f(); @endcode
+ * The result type @c R must be move constructible and, unless it is @c void,
+ * default constructible and move assignable. If the function throws an
+ * asio::system_error, its error code is passed to the handler. If it throws
+ * any other exception, the handler is not called. Instead, the exception is
+ * rethrown by a function submitted to the handler's associated executor, so
+ * that it propagates from the thread that would have run the handler, such as
+ * out of io_context::run().
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler. The function signature of the completion handler must be:
+ * @code void handler(
+ *   const asio::error_code& error, // Result of operation.
+ *   R result // The value returned by f, if R is not void.
+ * ); @endcode
+ *
+ * The completion handler is never called from the current thread prior to
+ * returning from <tt>offload()</tt>. It is submitted for execution using the
+ * handler's associated executor, which defaults to @c ex.
+ *
+ * @par Completion Signature
+ * @code void(asio::error_code, R) @endcode
+ * or, if @c R is @c void,
+ * @code void(asio::error_code) @endcode
+ *
+ * If the executor's execution context is not safe to use from other threads,
+ * as with an io_context constructed with the @c ASIO_CONCURRENCY_HINT_UNSAFE
+ * concurrency hint, the function is not run and the handler is passed @c
+ * asio::error::operation_not_supported.
+ */
+template <typename Executor, typename Function,
+    ASIO_COMPLETION_TOKEN_FOR(
+      typename detail::offload_signature<Function>::type) CompletionToken
+        ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(Executor)>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(CompletionToken,
+    typename detail::offload_signature<Function>::type) offload(
+    const Executor& ex, ASIO_MOVE_ARG(Function) f,
+    ASIO_MOVE_ARG(CompletionToken) token
+      ASIO_DEFAULT_COMPLETION_TOKEN(Executor),
+    typename constraint<
+      execution::is_executor<Executor>::value
+    >::type = 0)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<CompletionToken,
+      typename detail::offload_signature<Function>::type>(
+        declval<detail::initiate_offload<Executor> >(),
+        token, ASIO_MOVE_CAST(Function)(f))));
+
+/// Runs a blocking function on a thread that is shared by an execution
+/// context for blocking work.
+/**
+ * @param ctx An execution context, from which the I/O executor is obtained.
+ *
+ * @param f The function object to be called.
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler.
+ *
+ * @returns <tt>offload(ctx.get_executor(), forward<Function>(f),
+ * forward<CompletionToken>(token))</tt>.
+ */
+template <typename ExecutionContext, typename Function,
+    ASIO_COMPLETION_TOKEN_FOR(
+      typename detail::offload_signature<Function>::type) CompletionToken
+        ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(
+          typename ExecutionContext::executor_type)>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(CompletionToken,
+    typename detail::offload_signature<Function>::type) offload(
+    ExecutionContext& ctx, ASIO_MOVE_ARG(Function) f,
+    ASIO_MOVE_ARG(CompletionToken) token
+      ASIO_DEFAULT_COMPLETION_TOKEN(
+        typename ExecutionContext::executor_type),
+    typename constraint<is_convertible<
+      ExecutionContext&, execution_context&>::value>::type = 0)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<CompletionToken,
+      typename detail::offload_signature<Function>::type>(
+        declval<detail::initiate_offload<
+          typename ExecutionContext::executor_type> >(),
+        token, ASIO_MOVE_CAST(Function)(f))));
+
+/// Obtain statistics describing the threads used by offload().
+/**
+ * The statistics cover all blocking work performed for the execution
+ * context, including host name resolution.
+ */
+ASIO_DECL offload_statistics get_offload_statistics(execution_context& ctx);
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/offload.hpp"
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/impl/offload.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_OFFLOAD_HPP
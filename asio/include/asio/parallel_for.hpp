@@ -0,0 +1,125 @@
+//
+// parallel_for.hpp
+// ~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_PARALLEL_FOR_HPP
+#define ASIO_PARALLEL_FOR_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/async_result.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/execution_context.hpp"
+#include "asio/execution/executor.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename> class initiate_parallel_for;
+
+} // namespace detail
+
+/// Invokes a function object for each index in a range, in parallel.
+/**
+ * This function divides the indices <tt>[0, n)</tt> between a number of
+ * workers that are submitted to the executor. The number of workers is the
+ * executor's @c execution::occupancy, if it can be queried, and otherwise
+ * one. Each worker repeatedly claims a chunk of the indices that remain, and
+ * calls <tt>f(i)</tt> for each index @c i in the chunk. Chunks become smaller
+ * as the range is used up, so that workers that finish early take on more of
+ * the range. When all indices have been processed, the completion handler is
+ * invoked exactly once.
+ *
+ * @param ex The target executor.
+ *
+ * @param n The number of indices in the range.
+ *
+ * @param f The function object to be called for each index. It is shared by
+ * all workers, and may be called concurrently from several threads, so it is
+ * called through a const reference. The function signature must be:
+ * @code void f(std::size_t i) const; @endcode
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler. The function signature of the completion handler must be:
+ * @code void handler(); @endcode
+ *
+ * The completion handler is never called from the current thread prior to
+ * returning from <tt>parallel_for()</tt>. It is submitted for execution using
+ * the handler's associated executor, which defaults to @c ex. If an exception
+ * is thrown by @c f, the indices that have not yet been claimed are abandoned.
+ * Once all workers have stopped, the exception is rethrown on the handler's
+ * associated executor, as if thrown by the completion handler, and the
+ * completion handler is not called.
+ *
+ * @par Completion Signature
+ * @code void() @endcode
+ */
+template <typename Executor, typename Function,
+    ASIO_COMPLETION_TOKEN_FOR(void()) NullaryToken
+      ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(Executor)>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(NullaryToken, void()) parallel_for(
+    const Executor& ex, std::size_t n, ASIO_MOVE_ARG(Function) f,
+    ASIO_MOVE_ARG(NullaryToken) token
+      ASIO_DEFAULT_COMPLETION_TOKEN(Executor),
+    typename constraint<
+      execution::is_executor<Executor>::value
+    >::type = 0)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<NullaryToken, void()>(
+        declval<detail::initiate_parallel_for<Executor> >(),
+        token, n, ASIO_MOVE_CAST(Function)(f))));
+
+/// Invokes a function object for each index in a range, in parallel.
+/**
+ * @param ctx An execution context, from which the target executor is obtained.
+ *
+ * @param n The number of indices in the range.
+ *
+ * @param f The function object to be called for each index.
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler. The function signature of the completion handler must be:
+ * @code void handler(); @endcode
+ *
+ * @returns <tt>parallel_for(ctx.get_executor(), n, forward<Function>(f),
+ * forward<NullaryToken>(token))</tt>.
+ *
+ * @par Completion Signature
+ * @code void() @endcode
+ */
+template <typename ExecutionContext, typename Function,
+    ASIO_COMPLETION_TOKEN_FOR(void()) NullaryToken
+      ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(
+        typename ExecutionContext::executor_type)>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(NullaryToken, void()) parallel_for(
+    ExecutionContext& ctx, std::size_t n, ASIO_MOVE_ARG(Function) f,
+    ASIO_MOVE_ARG(NullaryToken) token
+      ASIO_DEFAULT_COMPLETION_TOKEN(
+        typename ExecutionContext::executor_type),
+    typename constraint<is_convertible<
+      ExecutionContext&, execution_context&>::value>::type = 0)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<NullaryToken, void()>(
+        declval<detail::initiate_parallel_for<
+          typename ExecutionContext::executor_type> >(),
+        token, n, ASIO_MOVE_CAST(Function)(f))));
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/parallel_for.hpp"
+
+#endif // ASIO_PARALLEL_FOR_HPP
@@ -0,0 +1,146 @@
+//
+// parallel_reduce.hpp
+// ~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_PARALLEL_REDUCE_HPP
+#define ASIO_PARALLEL_REDUCE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include "asio/async_result.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/execution_context.hpp"
+#include "asio/execution/executor.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename> class initiate_parallel_reduce;
+
+} // namespace detail
+
+/// Combines the results of a function object applied to each index in a
+/// range, in parallel.
+/**
+ * This function divides the indices <tt>[0, n)</tt> between workers that are
+ * submitted to the executor, in the same way as @ref parallel_for. Each worker
+ * combines the values of <tt>map(i)</tt> for the indices @c i in the chunks it
+ * claims, using @c reduce, and then combines the value for each chunk with the
+ * result. The result starts with the value @c init, and is passed to the
+ * completion handler when all indices have been processed.
+ *
+ * As chunks are combined in an unspecified order, @c reduce must be
+ * associative and commutative.
+ *
+ * @param ex The target executor.
+ *
+ * @param n The number of indices in the range.
+ *
+ * @param init The initial value of the result.
+ *
+ * @param map The function object to be called for each index. It may be
+ * called concurrently from several threads, so it is called through a const
+ * reference. The function signature must be:
+ * @code T map(std::size_t i) const; @endcode
+ *
+ * @param reduce The function object used to combine two values. It may be
+ * called concurrently from several threads, so it is called through a const
+ * reference. The function signature must be:
+ * @code T reduce(const T& a, const T& b) const; @endcode
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler. The function signature of the completion handler must be:
+ * @code void handler(T result); @endcode
+ *
+ * The completion handler is never called from the current thread prior to
+ * returning from <tt>parallel_reduce()</tt>. It is submitted for execution
+ * using the handler's associated executor, which defaults to @c ex. If an
+ * exception is thrown by @c map or @c reduce, the indices that have not yet
+ * been claimed are abandoned. Once all workers have stopped, the exception is
+ * rethrown on the handler's associated executor, as if thrown by the
+ * completion handler, and the completion handler is not called.
+ *
+ * @par Completion Signature
+ * @code void(T) @endcode
+ */
+template <typename Executor, typename T,
+    typename MapFunction, typename ReduceFunction,
+    ASIO_COMPLETION_TOKEN_FOR(void(T)) ReduceToken
+      ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(Executor)>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(ReduceToken, void(T)) parallel_reduce(
+    const Executor& ex, std::size_t n, T init,
+    ASIO_MOVE_ARG(MapFunction) map, ASIO_MOVE_ARG(ReduceFunction) reduce,
+    ASIO_MOVE_ARG(ReduceToken) token
+      ASIO_DEFAULT_COMPLETION_TOKEN(Executor),
+    typename constraint<
+      execution::is_executor<Executor>::value
+    >::type = 0)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<ReduceToken, void(T)>(
+        declval<detail::initiate_parallel_reduce<Executor> >(),
+        token, n, init, ASIO_MOVE_CAST(MapFunction)(map),
+        ASIO_MOVE_CAST(ReduceFunction)(reduce))));
+
+/// Combines the results of a function object applied to each index in a
+/// range, in parallel.
+/**
+ * @param ctx An execution context, from which the target executor is obtained.
+ *
+ * @param n The number of indices in the range.
+ *
+ * @param init The initial value of the result.
+ *
+ * @param map The function object to be called for each index.
+ *
+ * @param reduce The function object used to combine two values.
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler. The function signature of the completion handler must be:
+ * @code void handler(T result); @endcode
+ *
+ * @returns <tt>parallel_reduce(ctx.get_executor(), n, init,
+ * forward<MapFunction>(map), forward<ReduceFunction>(reduce),
+ * forward<ReduceToken>(token))</tt>.
+ *
+ * @par Completion Signature
+ * @code void(T) @endcode
+ */
+template <typename ExecutionContext, typename T,
+    typename MapFunction, typename ReduceFunction,
+    ASIO_COMPLETION_TOKEN_FOR(void(T)) ReduceToken
+      ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(
+        typename ExecutionContext::executor_type)>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(ReduceToken, void(T)) parallel_reduce(
+    ExecutionContext& ctx, std::size_t n, T init,
+    ASIO_MOVE_ARG(MapFunction) map, ASIO_MOVE_ARG(ReduceFunction) reduce,
+    ASIO_MOVE_ARG(ReduceToken) token
+      ASIO_DEFAULT_COMPLETION_TOKEN(
+        typename ExecutionContext::executor_type),
+    typename constraint<is_convertible<
+      ExecutionContext&, execution_context&>::value>::type = 0)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<ReduceToken, void(T)>(
+        declval<detail::initiate_parallel_reduce<
+          typename ExecutionContext::executor_type> >(),
+        token, n, init, ASIO_MOVE_CAST(MapFunction)(map),
+        ASIO_MOVE_CAST(ReduceFunction)(reduce))));
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/parallel_reduce.hpp"
+
+#endif // ASIO_PARALLEL_REDUCE_HPP
@@ -0,0 +1,219 @@
+//
+// race_connect.hpp
+// ~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RACE_CONNECT_HPP
+#define ASIO_RACE_CONNECT_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if (defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)) \
+  || defined(GENERATING_DOCUMENTATION)
+
+#include "asio/async_result.hpp"
+#include "asio/basic_socket.hpp"
+#include "asio/connect.hpp"
+#include "asio/detail/chrono.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/error.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename, typename> class initiate_async_race_connect;
+
+} // namespace detail
+
+/**
+ * @defgroup async_race_connect asio::async_race_connect
+ *
+ * @brief The @c async_race_connect function is a composed asynchronous
+ * operation that establishes a socket connection by racing staggered
+ * connection attempts to the endpoints in a sequence.
+ */
+/*@{*/
+
+/// Asynchronously establishes a socket connection by racing staggered
+/// attempts to the endpoints in a sequence.
+/**
+ * This function implements the connection racing of "Happy Eyeballs" (RFC
+ * 8305). The endpoints are reordered so that their address families
+ * alternate, starting with the family of the first endpoint, while the order
+ * of the endpoints within each family is kept. A connection attempt is
+ * started on a new socket for the first endpoint. If it has not succeeded
+ * when the connection attempt delay expires, or as soon as it fails, an
+ * attempt is started for the next endpoint, without abandoning the attempts
+ * already in progress. The first attempt to succeed wins: its socket is moved
+ * into @c s and the remaining attempts are cancelled.
+ *
+ * Unlike @c async_connect, a slow or unreachable address therefore costs at
+ * most the attempt delay before the next address is tried, rather than a full
+ * connection timeout.
+ *
+ * It is an initiating function for an @ref asynchronous_operation, and always
+ * returns immediately.
+ *
+ * @param s The socket to be connected. If the socket is already open, it will
+ * be closed when a connection is established. The socket must not have any
+ * asynchronous operations outstanding.
+ *
+ * @param endpoints A sequence of endpoints.
+ *
+ * @param attempt_delay How long to wait for a connection attempt to succeed
+ * before starting the next one.
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler, which will be called when the connect completes.
+ * Potential completion tokens include @ref use_future, @ref use_awaitable,
+ * @ref yield_context, or a function object with the correct completion
+ * signature. The function signature of the completion handler must be:
+ * @code void handler(
+ *   // Result of operation. if the sequence is empty, set to
+ *   // asio::error::not_found. Otherwise, contains the
+ *   // error from the last connection attempt to fail.
+ *   const asio::error_code& error,
+ *
+ *   // On success, the successfully connected endpoint.
+ *   // Otherwise, a default-constructed endpoint.
+ *   const typename Protocol::endpoint& endpoint
+ * ); @endcode
+ * Regardless of whether the asynchronous operation completes immediately or
+ * not, the completion handler will not be invoked from within this function.
+ * On immediate completion, invocation of the handler will be performed in a
+ * manner equivalent to using asio::post().
+ *
+ * @par Completion Signature
+ * @code void(asio::error_code, typename Protocol::endpoint) @endcode
+ *
+ * @par Example
+ * @code void resolve_handler(
+ *     const asio::error_code& ec,
+ *     tcp::resolver::results_type results)
+ * {
+ *   if (!ec)
+ *   {
+ *     asio::async_race_connect(s, results,
+ *         std::chrono::milliseconds(100), connect_handler);
+ *   }
+ * } @endcode
+ *
+ * @par Per-Operation Cancellation
+ * This asynchronous operation supports cancellation for the following
+ * asio::cancellation_type values:
+ *
+ * @li @c cancellation_type::terminal
+ *
+ * @li @c cancellation_type::partial
+ *
+ * @li @c cancellation_type::total
+ *
+ * Cancellation closes the sockets of all attempts in progress, and the
+ * operation completes with asio::error::operation_aborted.
+ */
+template <typename Protocol, typename Executor, typename EndpointSequence,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      typename Protocol::endpoint)) RangeConnectToken
+        ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(Executor)>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(RangeConnectToken,
+    void (asio::error_code, typename Protocol::endpoint))
+async_race_connect(basic_socket<Protocol, Executor>& s,
+    const EndpointSequence& endpoints,
+    const chrono::steady_clock::duration& attempt_delay,
+    ASIO_MOVE_ARG(RangeConnectToken) token
+      ASIO_DEFAULT_COMPLETION_TOKEN(Executor),
+    typename constraint<is_endpoint_sequence<
+        EndpointSequence>::value>::type = 0)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<RangeConnectToken,
+      void (asio::error_code, typename Protocol::endpoint)>(
+        declval<detail::initiate_async_race_connect<Protocol, Executor> >(),
+        token, endpoints, attempt_delay)));
+
+/// Asynchronously establishes a socket connection by racing staggered
+/// attempts to the endpoints in a sequence.
+/**
+ * This function implements the connection racing of "Happy Eyeballs" (RFC
+ * 8305), using the connection attempt delay of 250 milliseconds that the RFC
+ * recommends. See the overload that takes an @c attempt_delay for details.
+ *
+ * @param s The socket to be connected. If the socket is already open, it will
+ * be closed when a connection is established. The socket must not have any
+ * asynchronous operations outstanding.
+ *
+ * @param endpoints A sequence of endpoints.
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler, which will be called when the connect completes.
+ * Potential completion tokens include @ref use_future, @ref use_awaitable,
+ * @ref yield_context, or a function object with the correct completion
+ * signature. The function signature of the completion handler must be:
+ * @code void handler(
+ *   // Result of operation. if the sequence is empty, set to
+ *   // asio::error::not_found. Otherwise, contains the
+ *   // error from the last connection attempt to fail.
+ *   const asio::error_code& error,
+ *
+ *   // On success, the successfully connected endpoint.
+ *   // Otherwise, a default-constructed endpoint.
+ *   const typename Protocol::endpoint& endpoint
+ * ); @endcode
+ * Regardless of whether the asynchronous operation completes immediately or
+ * not, the completion handler will not be invoked from within this function.
+ * On immediate completion, invocation of the handler will be performed in a
+ * manner equivalent to using asio::post().
+ *
+ * @par Completion Signature
+ * @code void(asio::error_code, typename Protocol::endpoint) @endcode
+ *
+ * @par Per-Operation Cancellation
+ * This asynchronous operation supports cancellation for the following
+ * asio::cancellation_type values:
+ *
+ * @li @c cancellation_type::terminal
+ *
+ * @li @c cancellation_type::partial
+ *
+ * @li @c cancellation_type::total
+ */
+template <typename Protocol, typename Executor, typename EndpointSequence,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      typename Protocol::endpoint)) RangeConnectToken
+        ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(Executor)>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(RangeConnectToken,
+    void (asio::error_code, typename Protocol::endpoint))
+async_race_connect(basic_socket<Protocol, Executor>& s,
+    const EndpointSequence& endpoints,
+    ASIO_MOVE_ARG(RangeConnectToken) token
+      ASIO_DEFAULT_COMPLETION_TOKEN(Executor),
+    typename constraint<is_endpoint_sequence<
+        EndpointSequence>::value>::type = 0)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<RangeConnectToken,
+      void (asio::error_code, typename Protocol::endpoint)>(
+        declval<detail::initiate_async_race_connect<Protocol, Executor> >(),
+        token, endpoints, declval<chrono::steady_clock::duration>())));
+
+/*@}*/
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/race_connect.hpp"
+
+#endif // (defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO))
+       //   || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_RACE_CONNECT_HPP
@@ -0,0 +1,181 @@
+//
+// relay.hpp
+// ~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RELAY_HPP
+#define ASIO_RELAY_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+
+#include "asio/async_result.hpp"
+#include "asio/detail/cstdint.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/dynamic_chunk_buffer.hpp"
+#include "asio/error.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+class initiate_async_relay;
+
+} // namespace detail
+
+/**
+ * @defgroup async_relay asio::async_relay
+ *
+ * @brief The @c async_relay function is a composed asynchronous operation
+ * that copies data in both directions between two streams.
+ */
+/*@{*/
+
+/// Start an asynchronous operation to copy data in both directions between
+/// two streams, using buffers from a pool.
+/**
+ * This function copies the data read from @c a to @c b, and the data read from
+ * @c b to @c a, until both streams reach end of file. It is the main loop of a
+ * proxy.
+ *
+ * When one stream reaches end of file, the sending side of the other stream is
+ * shut down, if it is a socket, and data continues to flow in the opposite
+ * direction. If a read or write fails, the other direction is cancelled.
+ *
+ * Each direction holds at most one chunk from @c pool at a time, and returns
+ * it to the pool whenever the data has been written. On Linux, when both
+ * streams are stream sockets, the data is instead moved between them through
+ * a pipe using @c splice, so that it is never copied into user space, and the
+ * pool is not used. The sockets are put into non-blocking mode while the data
+ * is relayed, and their original modes are restored before the completion
+ * handler is called.
+ *
+ * It is an initiating function for an @ref asynchronous_operation, and always
+ * returns immediately.
+ *
+ * @param a The first stream. The type must support the AsyncReadStream and
+ * AsyncWriteStream type requirements.
+ *
+ * @param b The second stream. The type must support the AsyncReadStream and
+ * AsyncWriteStream type requirements.
+ *
+ * @param pool The pool from which the buffers are obtained. The pool must
+ * remain valid until the completion handler is called.
+ *
+ * @param token The @ref completion_token that will be used to produce a
+ * completion handler, which will be called when the relay completes.
+ * Potential completion tokens include @ref use_future, @ref use_awaitable,
+ * @ref yield_context, or a function object with the correct completion
+ * signature. The function signature of the completion handler must be:
+ * @code void handler(
+ *   // Result of operation. Set to asio::error::operation_aborted
+ *   // if the operation was cancelled, or to the error that stopped the
+ *   // relay.
+ *   const asio::error_code& error,
+ *
+ *   // The number of bytes copied from a to b.
+ *   asio::uint64_t a_to_b,
+ *
+ *   // The number of bytes copied from b to a.
+ *   asio::uint64_t b_to_a
+ * ); @endcode
+ * Regardless of whether the asynchronous operation completes immediately or
+ * not, the completion handler will not be invoked from within this function.
+ * On immediate completion, invocation of the handler will be performed in a
+ * manner equivalent to using asio::post().
+ *
+ * @par Completion Signature
+ * @code void(asio::error_code, asio::uint64_t, asio::uint64_t) @endcode
+ *
+ * @par Example
+ * @code asio::chunk_pool pool(16384);
+ * ...
+ * asio::async_relay(client, server, pool,
+ *     [](asio::error_code ec, asio::uint64_t up, asio::uint64_t down)
+ *     {
+ *       ...
+ *     }); @endcode
+ *
+ * @par Per-Operation Cancellation
+ * This asynchronous operation supports cancellation for the following
+ * asio::cancellation_type values:
+ *
+ * @li @c cancellation_type::terminal
+ *
+ * @li @c cancellation_type::partial
+ *
+ * @li @c cancellation_type::total
+ *
+ * Cancellation is forwarded to the operations in both directions, using the
+ * executor of each direction's source stream. The streams should therefore
+ * share an executor, or handlers for both should run on a single thread.
+ */
+template <typename AsyncStreamA, typename AsyncStreamB,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      asio::uint64_t, asio::uint64_t)) RelayToken>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(RelayToken,
+    void (asio::error_code, asio::uint64_t, asio::uint64_t))
+async_relay(AsyncStreamA& a, AsyncStreamB& b, chunk_pool& pool,
+    ASIO_MOVE_ARG(RelayToken) token)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<RelayToken,
+      void (asio::error_code, asio::uint64_t, asio::uint64_t)>(
+        declval<detail::initiate_async_relay>(), token,
+        &a, &b, &pool)));
+
+/// Start an asynchronous operation to copy data in both directions between
+/// two streams.
+/**
+ * This function copies the data read from @c a to @c b, and the data read from
+ * @c b to @c a, until both streams reach end of file. The buffers are obtained
+ * from a pool owned by the operation. See the overload that takes a
+ * @c chunk_pool for details.
+ *
+ * @par Completion Signature
+ * @code void(asio::error_code, asio::uint64_t, asio::uint64_t) @endcode
+ *
+ * @par Per-Operation Cancellation
+ * This asynchronous operation supports cancellation for the following
+ * asio::cancellation_type values:
+ *
+ * @li @c cancellation_type::terminal
+ *
+ * @li @c cancellation_type::partial
+ *
+ * @li @c cancellation_type::total
+ */
+template <typename AsyncStreamA, typename AsyncStreamB,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      asio::uint64_t, asio::uint64_t)) RelayToken>
+ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(RelayToken,
+    void (asio::error_code, asio::uint64_t, asio::uint64_t))
+async_relay(AsyncStreamA& a, AsyncStreamB& b,
+    ASIO_MOVE_ARG(RelayToken) token)
+  ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+    async_initiate<RelayToken,
+      void (asio::error_code, asio::uint64_t, asio::uint64_t)>(
+        declval<detail::initiate_async_relay>(), token,
+        &a, &b, static_cast<chunk_pool*>(0))));
+
+/*@}*/
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/relay.hpp"
+
+#endif // defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_RELAY_HPP
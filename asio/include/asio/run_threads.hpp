@@ -0,0 +1,56 @@
+//
+// run_threads.hpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RUN_THREADS_HPP
+#define ASIO_RUN_THREADS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_THREADS) || defined(GENERATING_DOCUMENTATION)
+
+#include <cstddef>
+#include "asio/thread_affinity.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+class io_context;
+
+/// Run an io_context's event processing loop on a number of new threads.
+/**
+ * This function creates @c num_threads threads, each of which applies the
+ * affinity and then calls <tt>ctx.run()</tt>. The thread with index @c i
+ * passes @c i to <tt>affinity.apply()</tt>. If the affinity cannot be
+ * applied, the thread runs without it. The function blocks until all of the
+ * threads have exited.
+ *
+ * The io_context should be constructed with a concurrency hint that allows
+ * multiple threads. If a handler throws an exception, @c std::terminate is
+ * called.
+ */
+ASIO_DECL void run_threads(io_context& ctx, std::size_t num_threads,
+    const thread_affinity& affinity = thread_affinity());
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/impl/run_threads.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_THREADS) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_RUN_THREADS_HPP
@@ -0,0 +1,197 @@
+//
+// shared_const_buffer.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_SHARED_CONST_BUFFER_HPP
+#define ASIO_SHARED_CONST_BUFFER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <new>
+#include "asio/buffer.hpp"
+#include "asio/detail/atomic_count.hpp"
+#include "asio/detail/recycling_allocator.hpp"
+#include "asio/detail/type_traits.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+/// An immutable, reference-counted buffer.
+/**
+ * The shared_const_buffer class holds a copy of some data in memory that is
+ * shared by all copies of the object, and freed when the last copy is
+ * destroyed. It is a model of the ConstBufferSequence concept, and so may be
+ * passed directly to operations such as asio::async_write. Each operation
+ * keeps the data alive for as long as it needs it, so the same data can be
+ * written to many streams at once without being copied.
+ *
+ * The reference count and the data are held in a single allocation, which
+ * is recycled through the same thread-local cache as the memory for
+ * completion handlers when it is small enough.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe for const member functions. Copies of an object
+ * may be used and destroyed concurrently.
+ *
+ * @par Example
+ * @code asio::shared_const_buffer message(asio::buffer(data));
+ * for (std::size_t i = 0; i < sockets.size(); ++i)
+ *   asio::async_write(sockets[i], message, handler); @endcode
+ */
+class shared_const_buffer
+{
+public:
+  /// The type for each element in the list of buffers.
+  typedef const_buffer value_type;
+
+  /// A random-access iterator type that may be used to read elements.
+  typedef const const_buffer* const_iterator;
+
+  /// Construct an empty buffer.
+  shared_const_buffer() ASIO_NOEXCEPT
+    : block_(0)
+  {
+  }
+
+  /// Construct a buffer that holds a copy of the specified data.
+  shared_const_buffer(const void* data, std::size_t size)
+    : block_(0)
+  {
+    init(size);
+    asio::buffer_copy(asio::buffer(block_ + 1, size),
+        asio::const_buffer(data, size));
+  }
+
+  /// Construct a buffer that holds a copy of the data in a buffer sequence.
+  template <typename ConstBufferSequence>
+  explicit shared_const_buffer(const ConstBufferSequence& data,
+      typename constraint<
+        is_const_buffer_sequence<ConstBufferSequence>::value
+      >::type = 0)
+    : block_(0)
+  {
+    std::size_t size = asio::buffer_size(data);
+    init(size);
+    asio::buffer_copy(asio::buffer(block_ + 1, size), data);
+  }
+
+  /// Copy constructor.
+  /**
+   * There is deliberately no move constructor. Composed operations may move a
+   * buffer sequence while still using the original, so a moved-from object
+   * must continue to refer to the data.
+   */
+  shared_const_buffer(const shared_const_buffer& other) ASIO_NOEXCEPT
+    : block_(other.block_),
+      buffer_(other.buffer_)
+  {
+    if (block_)
+      detail::ref_count_up(block_->ref_count_);
+  }
+
+  /// Destructor.
+  ~shared_const_buffer()
+  {
+    release();
+  }
+
+  /// Assignment operator.
+  shared_const_buffer& operator=(const shared_const_buffer& other)
+    ASIO_NOEXCEPT
+  {
+    if (other.block_)
+      detail::ref_count_up(other.block_->ref_count_);
+    release();
+    block_ = other.block_;
+    buffer_ = other.buffer_;
+    return *this;
+  }
+
+  /// Get a pointer to the beginning of the data.
+  const void* data() const ASIO_NOEXCEPT
+  {
+    return buffer_.data();
+  }
+
+  /// Get the size of the data.
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return buffer_.size();
+  }
+
+  /// Get a random-access iterator to the first element.
+  const_iterator begin() const ASIO_NOEXCEPT
+  {
+    return &buffer_;
+  }
+
+  /// Get a random-access iterator for one past the last element.
+  const_iterator end() const ASIO_NOEXCEPT
+  {
+    return &buffer_ + 1;
+  }
+
+  /// Get the number of objects that share the data.
+  /**
+   * Returns zero for an empty buffer.
+   */
+  long use_count() const ASIO_NOEXCEPT
+  {
+    return block_ ? static_cast<long>(block_->ref_count_) : 0;
+  }
+
+private:
+  // The header of the allocated memory. The data follows it.
+  struct block
+  {
+    explicit block(std::size_t n)
+      : ref_count_(1),
+        count_(n)
+    {
+    }
+
+    detail::atomic_count ref_count_;
+    std::size_t count_;
+  };
+
+  void init(std::size_t size)
+  {
+    if (size == 0)
+      return;
+
+    std::size_t n = 1 + (size + sizeof(block) - 1) / sizeof(block);
+    block_ = new (detail::recycling_allocator<block>().allocate(n)) block(n);
+    buffer_ = const_buffer(block_ + 1, size);
+  }
+
+  void release() ASIO_NOEXCEPT
+  {
+    if (block_ && detail::ref_count_down(block_->ref_count_))
+    {
+      std::size_t n = block_->count_;
+      block_->~block();
+      detail::recycling_allocator<block>().deallocate(block_, n);
+    }
+  }
+
+  block* block_;
+  const_buffer buffer_;
+};
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#endif // ASIO_SHARED_CONST_BUFFER_HPP
@@ -0,0 +1,135 @@
+//
+// thread_affinity.hpp
+// ~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_THREAD_AFFINITY_HPP
+#define ASIO_THREAD_AFFINITY_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+#include <cstddef>
+#include <vector>
+#include "asio/error_code.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+
+/// Describes the CPUs on which a group of threads may run.
+/**
+ * A thread_affinity object is passed to a @ref thread_pool, or to
+ * @ref run_threads, to control the placement of the threads they create. Each
+ * thread applies the affinity to itself before it runs any handlers. As a
+ * result, the memory that a thread allocates for its own use, such as the
+ * handler memory cached by the thread, is first touched on the NUMA node
+ * where the thread runs.
+ *
+ * Affinity is supported on Linux and Windows. On other platforms, and when a
+ * CPU is not available to the process, threads run without affinity.
+ */
+class thread_affinity
+{
+public:
+  /// Constructs an affinity that allows threads to run on any CPU.
+  thread_affinity()
+    : per_thread_(false)
+  {
+  }
+
+  /// Creates an affinity that binds each thread to a single CPU.
+  /**
+   * The thread with index @c i is bound to the CPU <tt>cpus[i %
+   * cpus.size()]</tt>.
+   */
+  static thread_affinity per_thread(const std::vector<unsigned int>& cpus)
+  {
+    return thread_affinity(cpus, true);
+  }
+
+  /// Creates an affinity that allows each thread to run on any of a set of
+  /// CPUs.
+  static thread_affinity cpu_set(const std::vector<unsigned int>& cpus)
+  {
+    return thread_affinity(cpus, false);
+  }
+
+  /// Creates an affinity that allows each thread to run on any CPU of a NUMA
+  /// node.
+  /**
+   * @throws asio::system_error Thrown on failure. If the platform does not
+   * support thread affinity, the error is error::operation_not_supported.
+   */
+  ASIO_DECL static thread_affinity numa_node(unsigned int node);
+
+  /// Creates an affinity that allows each thread to run on any CPU of a NUMA
+  /// node.
+  /**
+   * @param ec Set to indicate what error occurred, if any. An affinity that
+   * allows threads to run on any CPU is returned on failure.
+   */
+  ASIO_DECL static thread_affinity numa_node(
+      unsigned int node, asio::error_code& ec);
+
+  /// Determine whether the affinity allows threads to run on any CPU.
+  bool empty() const
+  {
+    return cpus_.empty();
+  }
+
+  /// Get the CPUs described by the affinity.
+  const std::vector<unsigned int>& cpus() const
+  {
+    return cpus_;
+  }
+
+  /// Apply the affinity to the calling thread.
+  /**
+   * @param thread_index The index of the calling thread within its group,
+   * which selects the CPU when each thread is bound to a single CPU.
+   *
+   * @throws asio::system_error Thrown on failure.
+   */
+  ASIO_DECL void apply(std::size_t thread_index) const;
+
+  /// Apply the affinity to the calling thread.
+  /**
+   * @param thread_index The index of the calling thread within its group,
+   * which selects the CPU when each thread is bound to a single CPU.
+   *
+   * @param ec Set to indicate what error occurred, if any.
+   */
+  ASIO_DECL ASIO_SYNC_OP_VOID apply(std::size_t thread_index,
+      asio::error_code& ec) const;
+
+private:
+  thread_affinity(const std::vector<unsigned int>& cpus, bool per_thread)
+    : cpus_(cpus),
+      per_thread_(per_thread)
+  {
+  }
+
+  // The CPUs on which threads may run. Empty if there is no affinity.
+  std::vector<unsigned int> cpus_;
+
+  // Whether each thread is bound to a single CPU from the set.
+  bool per_thread_;
+};
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+# include "asio/impl/thread_affinity.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_THREAD_AFFINITY_HPP
@@ -17,10 +17,13 @@
 
 #include "asio/detail/config.hpp"
 #include "asio/detail/atomic_count.hpp"
+#include "asio/detail/cstdint.hpp"
 #include "asio/detail/scheduler.hpp"
+#include "asio/detail/scoped_ptr.hpp"
 #include "asio/detail/thread_group.hpp"
 #include "asio/execution.hpp"
 #include "asio/execution_context.hpp"
+#include "asio/thread_affinity.hpp"
 
 #include "asio/detail/push_options.hpp"
 
@@ -70,6 +73,18 @@ namespace detail {
  *
  * // Wait for all tasks in the pool to complete.
  * pool.join(); @endcode
+ *
+ * @par Elastic pools
+ *
+ * A pool constructed with an @c elastic_options object varies its number of
+ * threads with load. A monitoring thread periodically submits a probe function
+ * to the pool. If a probe has waited in the queue for longer than
+ * @c elastic_options::grow_threshold_usec, for example because the pool's
+ * threads are blocked, a thread is added. A thread that has found no work to
+ * do for @c elastic_options::idle_timeout_usec exits. The number of threads is
+ * kept between @c elastic_options::min_threads and
+ * @c elastic_options::max_threads. Scaling decisions are reported by
+ * @c get_scaling_statistics().
  */
 class thread_pool
   : public execution_context
@@ -95,6 +110,79 @@ public:
   /// Constructs a pool with a specified number of threads.
   ASIO_DECL thread_pool(std::size_t num_threads);
 
+  /// Parameters for a pool whose number of threads varies with load.
+  struct elastic_options
+  {
+    /// Default constructor.
+    elastic_options()
+      : min_threads(1),
+        max_threads(64),
+        grow_threshold_usec(10000),
+        idle_timeout_usec(10000000)
+    {
+    }
+
+    /// The number of threads started with the pool, below which threads are
+    /// not retired. Treated as 1 if zero.
+    std::size_t min_threads;
+
+    /// The maximum number of threads.
+    std::size_t max_threads;
+
+    /// The time, in microseconds, for which a function may wait in the queue
+    /// before a thread is added. This is also the interval at which the queue
+    /// is probed.
+    long grow_threshold_usec;
+
+    /// The time, in microseconds, after which an idle thread exits. Threads
+    /// only exit when a steady clock is available.
+    long idle_timeout_usec;
+  };
+
+  /// Statistics describing the scaling of a thread pool.
+  struct scaling_statistics
+  {
+    /// Default constructor.
+    scaling_statistics()
+      : threads(0),
+        peak_threads(0),
+        threads_started(0),
+        threads_retired(0),
+        probes_delayed(0)
+    {
+    }
+
+    /// The current number of threads in the pool.
+    std::size_t threads;
+
+    /// The largest number of threads that the pool has had.
+    std::size_t peak_threads;
+
+    /// The number of threads that have been started, including those started
+    /// when the pool was constructed.
+    uint64_t threads_started;
+
+    /// The number of threads that have exited after being idle.
+    uint64_t threads_retired;
+
+    /// The number of times a probe was found to have waited for longer than
+    /// the growth threshold.
+    uint64_t probes_delayed;
+  };
+
+  /// Constructs a pool with a specified number of threads and affinity.
+  /**
+   * Each thread created by the pool applies the affinity to itself, passing
+   * its index within the pool, before it runs any function objects. If the
+   * affinity cannot be applied, the thread runs without it. Threads attached
+   * to the pool using @c attach() are not affected.
+   */
+  ASIO_DECL thread_pool(std::size_t num_threads,
+      const thread_affinity& affinity);
+
+  /// Constructs a pool whose number of threads varies with load.
+  ASIO_DECL explicit thread_pool(const elastic_options& options);
+
   /// Destructor.
   /**
    * Automatically stops and joins the pool, if not explicitly done beforehand.
@@ -141,11 +229,29 @@ public:
    */
   ASIO_DECL void wait();
 
+  /// Obtain statistics describing the scaling of the pool.
+  /**
+   * For a pool with a fixed number of threads, only the thread counts are
+   * reported.
+   */
+  ASIO_DECL scaling_statistics get_scaling_statistics() const;
+
 private:
   thread_pool(const thread_pool&) ASIO_DELETED;
   thread_pool& operator=(const thread_pool&) ASIO_DELETED;
 
   struct thread_function;
+  struct elastic_thread_function;
+  struct elastic_probe;
+  struct elastic_monitor_function;
+  struct elastic_state;
+
+  // Stop the monitoring thread of an elastic pool, and wait for all of its
+  // threads to exit.
+  ASIO_DECL void join_elastic();
+
+  // Add a thread to an elastic pool. The state's mutex must be held.
+  ASIO_DECL void add_elastic_thread();
 
   // Helper function to create the underlying scheduler.
   ASIO_DECL detail::scheduler& add_scheduler(detail::scheduler* s);
@@ -153,11 +259,17 @@ private:
   // The underlying scheduler.
   detail::scheduler& scheduler_;
 
+  // The affinity applied by the threads in the pool.
+  thread_affinity affinity_;
+
   // The threads in the pool.
   detail::thread_group threads_;
 
   // The current number of threads in the pool.
   detail::atomic_count num_threads_;
+
+  // The state of an elastic pool, or null if the pool has a fixed size.
+  detail::scoped_ptr<elastic_state> elastic_;
 };
 
 /// Executor implementation type used to submit functions to a thread pool.
@@ -614,6 +726,13 @@ private:
 
 public:
   /// Bulk execution function.
+  /**
+   * Invokes @c f once for each index in <tt>[0, n)</tt>. The indices are
+   * divided into chunks that are claimed by up to one operation per thread in
+   * the pool, so that the cost of submission does not grow with @c n. Each
+   * operation invokes its own copy of the function object. If the function
+   * object throws, the indices that have not yet been claimed are abandoned.
+   */
   template <typename Function>
   void bulk_execute(ASIO_MOVE_ARG(Function) f, std::size_t n) const
   {
@@ -0,0 +1,404 @@
+//
+// write_queue.hpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_WRITE_QUEUE_HPP
+#define ASIO_WRITE_QUEUE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "asio/detail/config.hpp"
+
+#if defined(ASIO_HAS_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <string>
+#include <vector>
+#include "asio/async_result.hpp"
+#include "asio/basic_waitable_timer.hpp"
+#include "asio/buffer.hpp"
+#include "asio/compose.hpp"
+#include "asio/detail/chrono.hpp"
+#include "asio/detail/cstdint.hpp"
+#include "asio/detail/memory.hpp"
+#include "asio/detail/noncopyable.hpp"
+#include "asio/detail/type_traits.hpp"
+#include "asio/error.hpp"
+
+#include "asio/detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename Queue>
+class write_queue_op;
+
+} // namespace detail
+
+/// Serialises and coalesces the writes of many small messages to a stream.
+/**
+ * The write_queue class template owns a queue of outgoing messages for an
+ * AsyncWriteStream. Messages may be queued at any time, whether or not a
+ * write is in progress. The queue performs one write at a time, and each
+ * write gathers as many of the queued messages as possible, up to
+ * max_buffers(), into a single call to asio::async_write. A protocol that
+ * sends many small messages therefore needs far fewer system calls than one
+ * that writes each message separately.
+ *
+ * To bound memory use, the async_push function suspends the producer while
+ * more than max_pending_bytes() bytes are waiting to be written. The message
+ * itself is always queued immediately, so messages are written in the order
+ * in which they were pushed.
+ *
+ * A batch delay may be set, in which case the first message queued while the
+ * stream is idle waits for up to that long for more messages to join it. This
+ * is a portable alternative to TCP_CORK, and works with any stream type,
+ * including SSL streams.
+ *
+ * The stream must remain valid until all asynchronous operations have
+ * completed, including the writes that the queue performs on its behalf. The
+ * write_queue object may be destroyed at any time. Its outstanding async_push
+ * and async_flush operations then complete with
+ * asio::error::operation_aborted, no further writes are started, and the
+ * messages are released once any write in progress has completed. While the
+ * queue is in use, no other writes should be performed on the stream.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe. The queue should be used from the stream's
+ * executor, or from a strand when the stream's executor runs handlers on
+ * multiple threads.
+ *
+ * @par Example
+ * @code asio::write_queue<tcp::socket> queue(socket);
+ * queue.set_max_pending_bytes(1024 * 1024);
+ * ...
+ * queue.async_push(asio::buffer(message),
+ *     [](asio::error_code ec)
+ *     {
+ *       // The queue has room for more messages.
+ *     }); @endcode
+ */
+template <typename AsyncWriteStream>
+class write_queue
+  : private noncopyable
+{
+public:
+  /// The type of the next layer.
+  typedef typename remove_reference<AsyncWriteStream>::type next_layer_type;
+
+  /// The type of the executor associated with the object.
+  typedef typename next_layer_type::executor_type executor_type;
+
+  /// The type of the duration used for the batch delay.
+  typedef chrono::steady_clock::duration duration;
+
+  /// The default maximum number of messages gathered into one write.
+  static const std::size_t default_max_buffers = 64;
+
+  /// Construct a write queue for the given stream.
+  /**
+   * @param stream The stream to which messages are written. The object stores
+   * a reference to the stream.
+   */
+  explicit write_queue(next_layer_type& stream)
+    : impl_(new impl(stream))
+  {
+    impl_->self_ = impl_;
+  }
+
+  /// Destructor.
+  /**
+   * Outstanding async_push and async_flush operations complete with
+   * asio::error::operation_aborted. A write in progress is left to complete,
+   * but no further messages are written.
+   */
+  ~write_queue()
+  {
+    impl_->closed_ = true;
+    impl_->batch_timer_.cancel();
+    impl_->notify_timer_.cancel();
+  }
+
+  /// Get the executor associated with the object.
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return impl_->stream_.get_executor();
+  }
+
+  /// Get a reference to the next layer.
+  next_layer_type& next_layer()
+  {
+    return impl_->stream_;
+  }
+
+  /// Get the maximum number of messages gathered into one write.
+  std::size_t max_buffers() const
+  {
+    return impl_->max_buffers_;
+  }
+
+  /// Set the maximum number of messages gathered into one write.
+  /**
+   * A value of zero is treated as one.
+   */
+  void set_max_buffers(std::size_t n)
+  {
+    impl_->max_buffers_ = n > 0 ? n : 1;
+  }
+
+  /// Get the number of pending bytes above which async_push suspends the
+  /// producer.
+  std::size_t max_pending_bytes() const
+  {
+    return impl_->max_pending_bytes_;
+  }
+
+  /// Set the number of pending bytes above which async_push suspends the
+  /// producer.
+  void set_max_pending_bytes(std::size_t n)
+  {
+    impl_->max_pending_bytes_ = n;
+    impl_->notify();
+  }
+
+  /// Get the time for which the first message waits for others to join it.
+  duration batch_delay() const
+  {
+    return impl_->batch_delay_;
+  }
+
+  /// Set the time for which the first message waits for others to join it.
+  /**
+   * When the stream is idle and a message is queued, the write is deferred by
+   * up to this amount of time so that subsequent messages can be sent with
+   * it. The write starts early if max_buffers() messages are queued. A zero
+   * delay, which is the default, starts the write immediately.
+   */
+  void set_batch_delay(const duration& delay)
+  {
+    impl_->batch_delay_ = delay;
+  }
+
+  /// Get the number of bytes queued or being written.
+  std::size_t pending_bytes() const
+  {
+    return impl_->pending_bytes_;
+  }
+
+  /// Get the number of messages queued or being written.
+  std::size_t pending_messages() const
+  {
+    return impl_->messages_.size();
+  }
+
+  /// Get the error that stopped the queue, if any.
+  /**
+   * After a write fails, all pending messages are discarded, further messages
+   * are ignored, and outstanding and subsequent asynchronous operations
+   * complete with this error.
+   */
+  const asio::error_code& error() const
+  {
+    return impl_->error_;
+  }
+
+  /// Queue a message for writing, without waiting for room in the queue.
+  /**
+   * The data is copied into the queue, so the buffers need not remain valid
+   * after the function returns.
+   */
+  template <typename ConstBufferSequence>
+  void push(const ConstBufferSequence& message)
+  {
+    impl_->enqueue(to_string(message));
+  }
+
+  /// Queue a message for writing, and wait until there is room in the queue.
+  /**
+   * The data is copied into the queue immediately, so the buffers need not
+   * remain valid after the function returns, and messages are written in the
+   * order in which they are pushed. The operation completes when at most
+   * max_pending_bytes() bytes are waiting to be written.
+   *
+   * @param message The data to be written.
+   *
+   * @param token The @ref completion_token that will be used to produce a
+   * completion handler. The function signature of the completion handler must
+   * be:
+   * @code void handler(
+   *   const asio::error_code& error // Result of operation.
+   * ); @endcode
+   *
+   * @par Per-Operation Cancellation
+   * This asynchronous operation supports cancellation for the following
+   * asio::cancellation_type values:
+   *
+   * @li @c cancellation_type::terminal
+   *
+   * @li @c cancellation_type::partial
+   *
+   * @li @c cancellation_type::total
+   *
+   * Cancellation ends the wait for room with asio::error::operation_aborted.
+   * The message remains queued.
+   */
+  template <typename ConstBufferSequence,
+      ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code))
+        WaitToken ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type)>
+  ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(WaitToken,
+      void (asio::error_code))
+  async_push(const ConstBufferSequence& message,
+      ASIO_MOVE_ARG(WaitToken) token
+        ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
+    ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+      async_compose<WaitToken, void (asio::error_code)>(
+          declval<detail::write_queue_op<write_queue> >(),
+          token, declval<executor_type>())))
+  {
+    return async_compose<WaitToken, void (asio::error_code)>(
+        detail::write_queue_op<write_queue>(impl_, to_string(message)),
+        token, impl_->stream_.get_executor());
+  }
+
+  /// Wait until all messages queued so far have been written.
+  /**
+   * @param token The @ref completion_token that will be used to produce a
+   * completion handler. The function signature of the completion handler must
+   * be:
+   * @code void handler(
+   *   const asio::error_code& error // Result of operation.
+   * ); @endcode
+   *
+   * @par Per-Operation Cancellation
+   * This asynchronous operation supports cancellation for the following
+   * asio::cancellation_type values:
+   *
+   * @li @c cancellation_type::terminal
+   *
+   * @li @c cancellation_type::partial
+   *
+   * @li @c cancellation_type::total
+   *
+   * Cancellation ends the wait with asio::error::operation_aborted. The
+   * messages continue to be written.
+   */
+  template <
+      ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code))
+        WaitToken ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type)>
+  ASIO_INITFN_AUTO_RESULT_TYPE_PREFIX(WaitToken,
+      void (asio::error_code))
+  async_flush(
+      ASIO_MOVE_ARG(WaitToken) token
+        ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
+    ASIO_INITFN_AUTO_RESULT_TYPE_SUFFIX((
+      async_compose<WaitToken, void (asio::error_code)>(
+          declval<detail::write_queue_op<write_queue> >(),
+          token, declval<executor_type>())))
+  {
+    return async_compose<WaitToken, void (asio::error_code)>(
+        detail::write_queue_op<write_queue>(impl_),
+        token, impl_->stream_.get_executor());
+  }
+
+  /// Cancel all outstanding async_push and async_flush operations.
+  /**
+   * The operations complete with asio::error::operation_aborted. Queued
+   * messages, and any write in progress, are not affected.
+   */
+  void cancel()
+  {
+    ++impl_->cancel_generation_;
+    impl_->notify();
+  }
+
+private:
+  template <typename> friend class detail::write_queue_op;
+  struct impl;
+  class write_handler;
+  class batch_handler;
+  class gathered_buffers;
+
+  // Copy the data in a buffer sequence into a string.
+  template <typename ConstBufferSequence>
+  static std::string to_string(const ConstBufferSequence& buffers)
+  {
+    std::string s(asio::buffer_size(buffers), '\0');
+    asio::buffer_copy(asio::buffer(s), buffers);
+    return s;
+  }
+
+  typedef basic_waitable_timer<chrono::steady_clock,
+      wait_traits<chrono::steady_clock>, executor_type> timer_type;
+
+  // The state of the queue. It is shared with the queue's internal writes and
+  // timer waits, so that it remains valid until they have completed, even if
+  // the write_queue object is destroyed first.
+  struct impl
+    : private noncopyable
+  {
+    explicit impl(next_layer_type& stream);
+
+    // Add a message to the queue and start writing if the stream is idle.
+    void enqueue(ASIO_MOVE_ARG(std::string) message);
+
+    // Start a write, or arm the batch timer, if the stream is idle.
+    void schedule_write();
+
+    // Write as many queued messages as possible in one operation.
+    void start_write();
+
+    // Remove the written messages and continue with the next write.
+    void handle_write(const asio::error_code& ec);
+
+    // Wake all waiting operations so that they can check their conditions.
+    void notify();
+
+    next_layer_type& stream_;
+    timer_type notify_timer_;
+    timer_type batch_timer_;
+    std::deque<std::string> messages_;
+    std::vector<const_buffer> buffers_;
+    std::size_t max_buffers_;
+    std::size_t max_pending_bytes_;
+    duration batch_delay_;
+    std::size_t pending_bytes_;
+    bool writing_;
+    bool batching_;
+    bool closed_;
+    std::size_t write_count_;
+    asio::uint64_t queued_total_;
+    asio::uint64_t written_total_;
+    std::size_t waiters_;
+    unsigned int cancel_generation_;
+    asio::error_code error_;
+
+    // Used to share the state with the operations that the queue starts.
+    detail::weak_ptr<impl> self_;
+  };
+
+  detail::shared_ptr<impl> impl_;
+};
+
+template <typename AsyncWriteStream>
+const std::size_t write_queue<AsyncWriteStream>::default_max_buffers;
+
+} // namespace asio
+
+#include "asio/detail/pop_options.hpp"
+
+#include "asio/impl/write_queue.hpp"
+
+#endif // defined(ASIO_HAS_CHRONO) || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_WRITE_QUEUE_HPP
@@ -0,0 +1,115 @@
+//
+// affinity.cpp
+// ~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "asio.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Each chain posts its next handler when it runs. Handlers are posted from
+// the thread that ran the previous handler, so their memory comes from that
+// thread's cache but they may run on any thread in the pool.
+class chain
+{
+public:
+  chain(asio::thread_pool& pool, int count)
+    : pool_(pool),
+      count_(count)
+  {
+  }
+
+  void operator()()
+  {
+    if (--count_ > 0)
+      asio::post(pool_, *this);
+  }
+
+private:
+  asio::thread_pool& pool_;
+  int count_;
+};
+
+void run_test(const char* name, int thread_count, int chain_count,
+    int handler_count, const asio::thread_affinity& affinity)
+{
+  asio::steady_timer::clock_type::time_point start =
+    asio::steady_timer::clock_type::now();
+
+  asio::thread_pool pool(thread_count, affinity);
+  for (int i = 0; i < chain_count; ++i)
+    asio::post(pool, chain(pool, handler_count / chain_count));
+  pool.join();
+
+  asio::steady_timer::clock_type::duration elapsed =
+    asio::steady_timer::clock_type::now() - start;
+  double seconds = asio::chrono::duration_cast<
+    asio::chrono::microseconds>(elapsed).count() / 1000000.0;
+
+  std::printf("%-10s %d handlers in %.3f s: %.0f handlers/s\n", name,
+      (handler_count / chain_count) * chain_count, seconds,
+      (handler_count / chain_count) * chain_count / seconds);
+}
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    if (argc != 4)
+    {
+      std::cerr << "Usage: affinity <threads> <chains> <handlers>\n";
+      return 1;
+    }
+
+    using namespace std; // For atoi.
+    int thread_count = atoi(argv[1]);
+    int chain_count = atoi(argv[2]);
+    int handler_count = atoi(argv[3]);
+
+    run_test("none", thread_count, chain_count,
+        handler_count, asio::thread_affinity());
+
+    // All threads on the first NUMA node.
+    asio::error_code ec;
+    asio::thread_affinity node0 = asio::thread_affinity::numa_node(0, ec);
+    if (ec)
+    {
+      std::printf("local      skipped: %s\n", ec.message().c_str());
+      return 0;
+    }
+
+    run_test("local", thread_count, chain_count, handler_count, node0);
+
+    // Threads alternate between the first two NUMA nodes.
+    asio::thread_affinity node1 = asio::thread_affinity::numa_node(1, ec);
+    if (ec)
+    {
+      std::printf("cross-node skipped: only one NUMA node\n");
+      return 0;
+    }
+
+    std::vector<unsigned int> cpus;
+    for (std::size_t i = 0; i < node0.cpus().size()
+        && i < node1.cpus().size(); ++i)
+    {
+      cpus.push_back(node0.cpus()[i]);
+      cpus.push_back(node1.cpus()[i]);
+    }
+
+    run_test("cross-node", thread_count, chain_count, handler_count,
+        asio::thread_affinity::per_thread(cpus));
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Exception: " << e.what() << "\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+//
+// post.cpp
+// ~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "asio.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <sstream>
+
+// Each chain posts its next handler when it runs, so that the queue always
+// holds one ready handler per chain.
+class chain
+{
+public:
+  chain(asio::io_context& ioc, int count)
+    : io_context_(ioc),
+      count_(count)
+  {
+  }
+
+  void operator()()
+  {
+    if (--count_ > 0)
+      asio::post(io_context_, *this);
+  }
+
+private:
+  asio::io_context& io_context_;
+  int count_;
+};
+
+class run_function
+{
+public:
+  explicit run_function(asio::io_context& ioc)
+    : io_context_(ioc)
+  {
+  }
+
+  void operator()()
+  {
+    io_context_.run();
+  }
+
+private:
+  asio::io_context& io_context_;
+};
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    if (argc != 5)
+    {
+      std::cerr << "Usage: post <threads> <chains> <handlers> <batchsize>\n";
+      return 1;
+    }
+
+    using namespace std; // For atoi.
+    int thread_count = atoi(argv[1]);
+    int chain_count = atoi(argv[2]);
+    int handler_count = atoi(argv[3]);
+    int batch_size = atoi(argv[4]);
+
+    std::ostringstream config;
+    config << "scheduler.batch_size = " << batch_size << "\n";
+    asio::config_from_string config_maker(config.str());
+    asio::io_context ioc(config_maker);
+
+    for (int i = 0; i < chain_count; ++i)
+      asio::post(ioc, chain(ioc, handler_count / chain_count));
+
+    asio::steady_timer::clock_type::time_point start =
+      asio::steady_timer::clock_type::now();
+
+    std::list<asio::thread*> threads;
+    while (--thread_count > 0)
+    {
+      asio::thread* new_thread = new asio::thread(run_function(ioc));
+      threads.push_back(new_thread);
+    }
+
+    ioc.run();
+
+    while (!threads.empty())
+    {
+      threads.front()->join();
+      delete threads.front();
+      threads.pop_front();
+    }
+
+    asio::steady_timer::clock_type::duration elapsed =
+      asio::steady_timer::clock_type::now() - start;
+    double seconds = asio::chrono::duration_cast<
+      asio::chrono::microseconds>(elapsed).count() / 1000000.0;
+
+    std::printf("%d handlers in %.3f s: %.0f handlers/s\n",
+        (handler_count / chain_count) * chain_count, seconds,
+        (handler_count / chain_count) * chain_count / seconds);
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Exception: " << e.what() << "\n";
+  }
+
+  return 0;
+}
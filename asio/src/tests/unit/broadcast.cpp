@@ -0,0 +1,346 @@
+//
+// broadcast.cpp
+// ~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/broadcast.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+#include "asio/bind_cancellation_slot.hpp"
+#include "asio/bind_executor.hpp"
+#include "asio/cancellation_signal.hpp"
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "asio/steady_timer.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif // defined(ASIO_HAS_BOOST_BIND)
+using bindns::placeholders::_1;
+using bindns::placeholders::_2;
+
+// A stream that records the data written to it, or that never completes a
+// write unless it is cancelled.
+class test_stream
+{
+public:
+  typedef asio::io_context::executor_type executor_type;
+
+  explicit test_stream(asio::io_context& io_context, bool stalled = false)
+    : io_context_(io_context),
+      stalled_(stalled),
+      timer_(io_context)
+  {
+  }
+
+  test_stream(const test_stream& other)
+    : io_context_(other.io_context_),
+      stalled_(other.stalled_),
+      timer_(other.io_context_)
+  {
+  }
+
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return io_context_.get_executor();
+  }
+
+  const std::string& written() const
+  {
+    return written_;
+  }
+
+  template <typename ConstBufferSequence, typename Handler>
+  void async_write_some(const ConstBufferSequence& buffers, Handler handler)
+  {
+    if (stalled_)
+    {
+      // Wait on a timer that never expires, forwarding the cancellation slot
+      // so that the write may be cancelled.
+      timer_.expires_at((asio::chrono::steady_clock::time_point::max)());
+      timer_.async_wait(
+          asio::bind_cancellation_slot(
+            asio::get_associated_cancellation_slot(handler),
+            stalled_handler<Handler>(handler)));
+      return;
+    }
+
+    std::string data(asio::buffer_size(buffers), '\0');
+    asio::buffer_copy(asio::buffer(data), buffers);
+    written_ += data;
+    asio::post(get_executor(),
+        asio::detail::bind_handler(handler,
+          asio::error_code(), data.size()));
+  }
+
+private:
+  template <typename Handler>
+  class stalled_handler
+  {
+  public:
+    explicit stalled_handler(const Handler& handler)
+      : handler_(handler)
+    {
+    }
+
+    void operator()(const asio::error_code& ec)
+    {
+      handler_(ec, 0);
+    }
+
+  private:
+    Handler handler_;
+  };
+
+  asio::io_context& io_context_;
+  bool stalled_;
+  asio::steady_timer timer_;
+  std::string written_;
+};
+
+// Records the result of the write to each destination.
+template <typename Iterator>
+class destination_handler
+{
+public:
+  explicit destination_handler(std::vector<asio::error_code>* results)
+    : results_(results)
+  {
+  }
+
+  void operator()(const asio::error_code& ec,
+      std::size_t n, Iterator destination)
+  {
+    if (!ec)
+      ASIO_CHECK(n == (*destination)->written().size());
+    results_->push_back(ec);
+  }
+
+private:
+  std::vector<asio::error_code>* results_;
+};
+
+void handle_broadcast(const asio::error_code& ec, std::size_t delivered,
+    asio::error_code* out_ec, std::size_t* out_delivered, int* count)
+{
+  *out_ec = ec;
+  *out_delivered = delivered;
+  ++*count;
+}
+
+typedef std::vector<test_stream*>::iterator iterator;
+
+void broadcast_test_deliver()
+{
+  asio::io_context ioc;
+  test_stream s1(ioc), s2(ioc), s3(ioc);
+  std::vector<test_stream*> streams;
+  streams.push_back(&s1);
+  streams.push_back(&s2);
+  streams.push_back(&s3);
+
+  std::string data = "hello, world";
+  asio::shared_const_buffer message(asio::buffer(data));
+  std::vector<asio::error_code> results;
+  asio::error_code ec = asio::error::fault;
+  std::size_t delivered = 0;
+  int count = 0;
+
+  asio::async_broadcast(streams.begin(), streams.end(), message,
+      destination_handler<iterator>(&results),
+      bindns::bind(handle_broadcast, _1, _2, &ec, &delivered, &count));
+
+  // The writes share the message rather than copying it.
+  ASIO_CHECK(message.use_count() > 1);
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(delivered == 3);
+  ASIO_CHECK(results.size() == 3);
+  for (std::size_t i = 0; i < results.size(); ++i)
+    ASIO_CHECK(!results[i]);
+  ASIO_CHECK(s1.written() == data);
+  ASIO_CHECK(s2.written() == data);
+  ASIO_CHECK(s3.written() == data);
+  ASIO_CHECK(message.use_count() == 1);
+}
+
+void broadcast_test_references()
+{
+  asio::io_context ioc;
+  std::list<test_stream> streams;
+  streams.push_back(test_stream(ioc));
+  streams.push_back(test_stream(ioc));
+
+  std::string data = "hello";
+  asio::error_code ec = asio::error::fault;
+  std::size_t delivered = 0;
+  int count = 0;
+
+  asio::async_broadcast(streams.begin(), streams.end(),
+      asio::shared_const_buffer(data.data(), data.size()),
+      asio::chrono::seconds(60),
+      [](const asio::error_code& e, std::size_t n,
+        std::list<test_stream>::iterator destination)
+      {
+        ASIO_CHECK(!e);
+        ASIO_CHECK(n == destination->written().size());
+      },
+      bindns::bind(handle_broadcast, _1, _2, &ec, &delivered, &count));
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(delivered == 2);
+  ASIO_CHECK(streams.front().written() == data);
+  ASIO_CHECK(streams.back().written() == data);
+}
+
+void broadcast_test_empty()
+{
+  asio::io_context ioc;
+  std::vector<test_stream*> streams;
+  std::vector<asio::error_code> results;
+  asio::error_code ec = asio::error::fault;
+  std::size_t delivered = 1;
+  int count = 0;
+
+  asio::async_broadcast(streams.begin(), streams.end(),
+      asio::shared_const_buffer(),
+      destination_handler<iterator>(&results),
+      asio::bind_executor(ioc,
+        bindns::bind(handle_broadcast, _1, _2, &ec, &delivered, &count)));
+
+  // The handler is not invoked from within the initiating function.
+  ASIO_CHECK(count == 0);
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(delivered == 0);
+  ASIO_CHECK(results.empty());
+}
+
+void broadcast_test_timeout()
+{
+  asio::io_context ioc;
+  test_stream s1(ioc), s2(ioc, true), s3(ioc);
+  std::vector<test_stream*> streams;
+  streams.push_back(&s1);
+  streams.push_back(&s2);
+  streams.push_back(&s3);
+
+  std::string data = "hello";
+  asio::shared_const_buffer message(asio::buffer(data));
+  std::vector<asio::error_code> results;
+  asio::error_code ec = asio::error::fault;
+  std::size_t delivered = 0;
+  int count = 0;
+
+  asio::async_broadcast(streams.begin(), streams.end(), message,
+      asio::chrono::milliseconds(10),
+      destination_handler<iterator>(&results),
+      bindns::bind(handle_broadcast, _1, _2, &ec, &delivered, &count));
+
+  ioc.run();
+
+  // The stalled stream is evicted, and the others are unaffected.
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(delivered == 2);
+  ASIO_CHECK(results.size() == 3);
+  ASIO_CHECK(!results[0]);
+  ASIO_CHECK(!results[1]);
+  ASIO_CHECK(results[2] == asio::error::timed_out);
+  ASIO_CHECK(s1.written() == data);
+  ASIO_CHECK(s2.written().empty());
+  ASIO_CHECK(s3.written() == data);
+  ASIO_CHECK(message.use_count() == 1);
+}
+
+void broadcast_test_cancel()
+{
+  asio::io_context ioc;
+  test_stream s1(ioc), s2(ioc, true), s3(ioc, true);
+  std::vector<test_stream*> streams;
+  streams.push_back(&s1);
+  streams.push_back(&s2);
+  streams.push_back(&s3);
+
+  asio::cancellation_signal cancel_signal;
+  std::vector<asio::error_code> results;
+  asio::error_code ec;
+  std::size_t delivered = 0;
+  int count = 0;
+
+  asio::async_broadcast(streams.begin(), streams.end(),
+      asio::shared_const_buffer("hello", 5),
+      asio::chrono::seconds(60),
+      destination_handler<iterator>(&results),
+      asio::bind_cancellation_slot(cancel_signal.slot(),
+        bindns::bind(handle_broadcast, _1, _2, &ec, &delivered, &count)));
+
+  ioc.poll();
+  ASIO_CHECK(count == 0);
+  ASIO_CHECK(results.size() == 1);
+
+  cancel_signal.emit(asio::cancellation_type::terminal);
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(ec == asio::error::operation_aborted);
+  ASIO_CHECK(delivered == 1);
+  ASIO_CHECK(results.size() == 3);
+  ASIO_CHECK(!results[0]);
+  ASIO_CHECK(results[1] == asio::error::operation_aborted);
+  ASIO_CHECK(results[2] == asio::error::operation_aborted);
+}
+
+ASIO_TEST_SUITE
+(
+  "broadcast",
+  ASIO_TEST_CASE(broadcast_test_deliver)
+  ASIO_TEST_CASE(broadcast_test_references)
+  ASIO_TEST_CASE(broadcast_test_empty)
+  ASIO_TEST_CASE(broadcast_test_timeout)
+  ASIO_TEST_CASE(broadcast_test_cancel)
+)
+
+#else // defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
+
+ASIO_TEST_SUITE
+(
+  "broadcast",
+  ASIO_TEST_CASE(null_test)
+)
+
+#endif // defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
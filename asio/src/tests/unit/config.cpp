@@ -0,0 +1,139 @@
+//
+// config.cpp
+// ~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/config.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+#include "asio/io_context.hpp"
+#include "unit_test.hpp"
+
+void config_default_test()
+{
+  asio::io_context ctx;
+  asio::config cfg(ctx);
+
+  ASIO_CHECK(cfg.get("scheduler", "concurrency_hint", 42) == 42);
+  ASIO_CHECK(cfg.get("io_uring", "sqpoll", true) == true);
+  ASIO_CHECK(cfg.get("io_uring", "ring_size", 16u) == 16u);
+}
+
+void config_from_string_test()
+{
+  asio::io_context ctx(
+      asio::config_from_string(
+        "# A comment.\n"
+        "\n"
+        "scheduler.concurrency_hint = 1\n"
+        "io_uring.sqpoll = true\n"
+        "io_uring.sqpoll_cpu = -1\n"
+        "io_uring.ring_size = 0x100\n"
+        "io_uring.ring_size = 512\n"
+        "test.bad_bool = yes\n"
+        "test.bad_int = 12abc\n"
+        "test.large = 100000\n"));
+  asio::config cfg(ctx);
+
+  ASIO_CHECK(cfg.get("scheduler", "concurrency_hint", 0) == 1);
+  ASIO_CHECK(cfg.get("io_uring", "sqpoll", false) == true);
+  ASIO_CHECK(cfg.get("io_uring", "sqpoll_cpu", 0) == -1);
+  ASIO_CHECK(cfg.get("io_uring", "ring_size", 0u) == 512u);
+  ASIO_CHECK(cfg.get("io_uring", "missing", 7) == 7);
+
+#if !defined(ASIO_NO_EXCEPTIONS)
+  bool caught = false;
+  try
+  {
+    cfg.get("test", "bad_bool", false);
+  }
+  catch (std::invalid_argument&)
+  {
+    caught = true;
+  }
+  ASIO_CHECK(caught);
+
+  caught = false;
+  try
+  {
+    cfg.get("test", "bad_int", 0);
+  }
+  catch (std::invalid_argument&)
+  {
+    caught = true;
+  }
+  ASIO_CHECK(caught);
+
+  caught = false;
+  try
+  {
+    cfg.get("test", "large", static_cast<unsigned short>(0));
+  }
+  catch (std::out_of_range&)
+  {
+    caught = true;
+  }
+  ASIO_CHECK(caught);
+
+  caught = false;
+  try
+  {
+    cfg.get("io_uring", "sqpoll_cpu", 0u);
+  }
+  catch (std::invalid_argument&)
+  {
+    caught = true;
+  }
+  ASIO_CHECK(caught);
+#endif // !defined(ASIO_NO_EXCEPTIONS)
+}
+
+void config_from_string_prefix_test()
+{
+  asio::io_context ctx(
+      asio::config_from_string(
+        "mine.scheduler.concurrency_hint = 2\n"
+        "other.scheduler.concurrency_hint = 3\n", "mine"));
+  asio::config cfg(ctx);
+
+  ASIO_CHECK(cfg.get("scheduler", "concurrency_hint", 0) == 2);
+}
+
+void config_from_env_test()
+{
+#if !defined(ASIO_WINDOWS) && !defined(ASIO_WINDOWS_RUNTIME)
+  ::setenv("ASIO_CONFIG_TEST_SECTION_SOME_KEY", "123", 1);
+  ::setenv("MY_PREFIX_TEST_SECTION_SOME_KEY", "456", 1);
+
+  asio::config_from_env default_env;
+  asio::io_context ctx1(default_env);
+  ASIO_CHECK(asio::config(ctx1).get("test_section", "some_key", 0) == 123);
+
+  asio::io_context ctx2(asio::config_from_env("my_prefix"));
+  ASIO_CHECK(asio::config(ctx2).get("test_section", "some_key", 0) == 456);
+
+  ::unsetenv("ASIO_CONFIG_TEST_SECTION_SOME_KEY");
+  ::unsetenv("MY_PREFIX_TEST_SECTION_SOME_KEY");
+#endif // !defined(ASIO_WINDOWS) && !defined(ASIO_WINDOWS_RUNTIME)
+}
+
+ASIO_TEST_SUITE
+(
+  "config",
+  ASIO_TEST_CASE(config_default_test)
+  ASIO_TEST_CASE(config_from_string_test)
+  ASIO_TEST_CASE(config_from_string_prefix_test)
+  ASIO_TEST_CASE(config_from_env_test)
+)
@@ -0,0 +1,294 @@
+//
+// dfa_matcher.cpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/dfa_matcher.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "asio/buffer.hpp"
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "asio/read_until.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif // defined(ASIO_HAS_BOOST_BIND)
+using bindns::placeholders::_1;
+using bindns::placeholders::_2;
+
+// A stream that returns its data a few bytes at a time.
+class test_stream
+{
+public:
+  typedef asio::io_context::executor_type executor_type;
+
+  test_stream(asio::io_context& io_context,
+      const std::string& data, std::size_t chunk)
+    : io_context_(io_context),
+      data_(data),
+      position_(0),
+      chunk_(chunk)
+  {
+  }
+
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return io_context_.get_executor();
+  }
+
+  template <typename MutableBufferSequence>
+  std::size_t read_some(const MutableBufferSequence& buffers,
+      asio::error_code& ec)
+  {
+    std::size_t n = asio::buffer_copy(buffers,
+        asio::buffer(data_) + position_, chunk_);
+    position_ += n;
+    ec = n == 0 ? asio::error::eof : asio::error_code();
+    return n;
+  }
+
+  template <typename MutableBufferSequence>
+  std::size_t read_some(const MutableBufferSequence& buffers)
+  {
+    asio::error_code ec;
+    std::size_t n = read_some(buffers, ec);
+    if (ec)
+      throw asio::system_error(ec);
+    return n;
+  }
+
+  template <typename MutableBufferSequence, typename Handler>
+  void async_read_some(const MutableBufferSequence& buffers, Handler handler)
+  {
+    asio::error_code ec;
+    std::size_t n = read_some(buffers, ec);
+    asio::post(get_executor(), asio::detail::bind_handler(handler, ec, n));
+  }
+
+private:
+  asio::io_context& io_context_;
+  std::string data_;
+  std::size_t position_;
+  std::size_t chunk_;
+};
+
+// Feed the data to the matcher in chunks of the given size, returning the
+// offset of the end of the first match, or npos.
+std::size_t find_match(asio::dfa_matcher matcher,
+    const std::string& data, std::size_t chunk)
+{
+  for (std::size_t offset = 0; offset < data.size(); offset += chunk)
+  {
+    std::string::const_iterator begin = data.begin() + offset;
+    std::string::const_iterator end = (data.size() - offset > chunk)
+      ? begin + chunk : data.end();
+    std::pair<std::string::const_iterator, bool> result =
+      matcher(begin, end);
+    if (result.second)
+      return result.first - data.begin();
+    ASIO_CHECK(result.first == end);
+  }
+  return std::string::npos;
+}
+
+std::size_t find_match(const std::string& pattern, const std::string& data)
+{
+  asio::dfa_matcher matcher(pattern);
+  std::size_t end = find_match(matcher, data, data.size() + 1);
+  for (std::size_t chunk = 1; chunk < 4; ++chunk)
+    ASIO_CHECK(find_match(matcher, data, chunk) == end);
+  return end;
+}
+
+void test_literal()
+{
+  std::vector<std::string> terminators;
+  terminators.push_back("\r\n\r\n");
+  terminators.push_back("\n\n");
+  asio::dfa_matcher matcher(terminators, asio::dfa_matcher::literal);
+
+  const std::string header1 = "GET / HTTP/1.1\r\nHost: a\r\n\r\nbody";
+  const std::string header2 = "GET / HTTP/1.0\nHost: a\n\nbody";
+  const std::string header3 = "GET / HTTP/1.1\r\nHost: a\r\n";
+  for (std::size_t chunk = 1; chunk < 8; ++chunk)
+  {
+    ASIO_CHECK(find_match(matcher, header1, chunk) == header1.size() - 4);
+    ASIO_CHECK(find_match(matcher, header2, chunk) == header2.size() - 4);
+    ASIO_CHECK(find_match(matcher, header3, chunk) == std::string::npos);
+  }
+
+  // Metacharacters have no special meaning.
+  asio::dfa_matcher dots("a.b", asio::dfa_matcher::literal);
+  ASIO_CHECK(find_match(dots, "axbxa.b", 1) == 7);
+
+  // A match resets the matcher.
+  std::string two = "x\n\ny\n\n";
+  std::pair<std::string::iterator, bool> result =
+    matcher(two.begin(), two.end());
+  ASIO_CHECK(result.second && result.first == two.begin() + 3);
+  result = matcher(result.first, two.end());
+  ASIO_CHECK(result.second && result.first == two.end());
+
+  ASIO_CHECK(matcher.state_count() > 1);
+}
+
+void test_regex()
+{
+  const std::size_t npos = std::string::npos;
+
+  ASIO_CHECK(find_match("abc", "xxabcxx") == 5);
+  ASIO_CHECK(find_match("abc", "ababd") == npos);
+  ASIO_CHECK(find_match("a.c", "xa\ncabc") == 7);
+  ASIO_CHECK(find_match("ab*c", "xacx") == 3);
+  ASIO_CHECK(find_match("ab+c", "xacabbbc") == 8);
+  ASIO_CHECK(find_match("ab?c", "abbcabc") == 7);
+  ASIO_CHECK(find_match("a(bc|de)f", "abcdeadef") == 9);
+  ASIO_CHECK(find_match("cat|dog", "hotdog cat") == 6);
+  ASIO_CHECK(find_match("a{3}", "aabaaa") == 6);
+  ASIO_CHECK(find_match("ba{2,3}c", "baaaac baac") == 11);
+  ASIO_CHECK(find_match("xa{2,}y", "xay xaaaaay") == 11);
+  ASIO_CHECK(find_match("[0-9]+;", "ab12;") == 5);
+  ASIO_CHECK(find_match("[^a-z];", "ab;c;D;") == 7);
+  ASIO_CHECK(find_match("[]x]", "ab]") == 3);
+  ASIO_CHECK(find_match("[a-]", "zz-") == 3);
+  ASIO_CHECK(find_match("\\d\\d", "a1b23") == 5);
+  ASIO_CHECK(find_match("\\s\\S", "ab c") == 4);
+  ASIO_CHECK(find_match("\\w+\\W", "ab-c") == 3);
+  ASIO_CHECK(find_match("\\r\\n", "a\rb\r\n") == 5);
+  ASIO_CHECK(find_match("\\x41\\.", "A A.") == 4);
+  ASIO_CHECK(find_match("[\\x30-\\x32]", "a9b2") == 4);
+
+  // The match that ends first is reported, not the leftmost.
+  ASIO_CHECK(find_match("abcd|bc", "abcd") == 3);
+
+  // Several patterns at once.
+  std::vector<std::string> patterns;
+  patterns.push_back("\r?\n");
+  patterns.push_back("END");
+  asio::dfa_matcher matcher(patterns);
+  ASIO_CHECK(find_match(matcher, "abcEND\r\n", 1) == 6);
+  ASIO_CHECK(find_match(matcher, "abc\r\nEND", 1) == 5);
+}
+
+void test_invalid()
+{
+  const char* invalid[] = { "", "a*", "(ab", "ab)", "[ab", "*a", "a{",
+    "a{2,1}", "a{1001}", "\\", "\\q", "[z-a]", "^a", "a|", "(a|b?)" };
+  for (std::size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+  {
+    bool thrown = false;
+    try
+    {
+      asio::dfa_matcher matcher(invalid[i]);
+    }
+    catch (std::invalid_argument&)
+    {
+      thrown = true;
+    }
+    ASIO_CHECK(thrown);
+  }
+
+  bool thrown = false;
+  try
+  {
+    std::vector<std::string> no_patterns;
+    asio::dfa_matcher matcher(no_patterns);
+  }
+  catch (std::invalid_argument&)
+  {
+    thrown = true;
+  }
+  ASIO_CHECK(thrown);
+
+  // The automaton for this pattern needs one state per combination of the
+  // last 13 characters.
+  thrown = false;
+  try
+  {
+    asio::dfa_matcher matcher("a[ab]{12}");
+  }
+  catch (std::length_error&)
+  {
+    thrown = true;
+  }
+  ASIO_CHECK(thrown);
+}
+
+void async_read_handler(const asio::error_code& err,
+    std::size_t bytes_transferred, asio::error_code* out_err,
+    std::size_t* out_bytes_transferred)
+{
+  *out_err = err;
+  *out_bytes_transferred = bytes_transferred;
+}
+
+void test_read_until()
+{
+  asio::io_context ioc;
+  const std::string data = "HTTP/1.1 200 OK\r\nA: b\r\n\r\nbody";
+  asio::dfa_matcher matcher("\r\n\r\n|\n\n");
+
+  for (std::size_t chunk = 1; chunk < 8; ++chunk)
+  {
+    test_stream s(ioc, data, chunk);
+    std::string buffer;
+    asio::error_code ec;
+    std::size_t n = asio::read_until(s,
+        asio::dynamic_buffer(buffer), matcher, ec);
+    ASIO_CHECK(!ec);
+    ASIO_CHECK(n == data.size() - 4);
+  }
+
+  for (std::size_t chunk = 1; chunk < 8; ++chunk)
+  {
+    test_stream s(ioc, data, chunk);
+    std::string buffer;
+    asio::error_code ec;
+    std::size_t n = 0;
+    asio::async_read_until(s, asio::dynamic_buffer(buffer), matcher,
+        bindns::bind(async_read_handler, _1, _2, &ec, &n));
+    ioc.restart();
+    ioc.run();
+    ASIO_CHECK(!ec);
+    ASIO_CHECK(n == data.size() - 4);
+  }
+
+  test_stream s(ioc, "no terminator", 3);
+  std::string buffer;
+  asio::error_code ec;
+  asio::read_until(s, asio::dynamic_buffer(buffer), matcher, ec);
+  ASIO_CHECK(ec == asio::error::eof);
+}
+
+ASIO_TEST_SUITE
+(
+  "dfa_matcher",
+  ASIO_TEST_CASE(test_literal)
+  ASIO_TEST_CASE(test_regex)
+  ASIO_TEST_CASE(test_invalid)
+  ASIO_TEST_CASE(test_read_until)
+)
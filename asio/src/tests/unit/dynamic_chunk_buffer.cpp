@@ -0,0 +1,390 @@
+//
+// dynamic_chunk_buffer.cpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/dynamic_chunk_buffer.hpp"
+
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include "asio/buffers_iterator.hpp"
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "asio/read.hpp"
+#include "asio/read_until.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif // defined(ASIO_HAS_BOOST_BIND)
+using bindns::placeholders::_1;
+using bindns::placeholders::_2;
+
+// A stream that reads from and writes to strings a few bytes at a time.
+class test_stream
+{
+public:
+  typedef asio::io_context::executor_type executor_type;
+
+  test_stream(asio::io_context& io_context,
+      const std::string& data, std::size_t chunk)
+    : io_context_(io_context),
+      data_(data),
+      position_(0),
+      chunk_(chunk)
+  {
+  }
+
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return io_context_.get_executor();
+  }
+
+  const std::string& written() const
+  {
+    return written_;
+  }
+
+  template <typename MutableBufferSequence>
+  std::size_t read_some(const MutableBufferSequence& buffers,
+      asio::error_code& ec)
+  {
+    if (asio::buffer_size(buffers) == 0)
+    {
+      ec = asio::error_code();
+      return 0;
+    }
+
+    std::size_t n = asio::buffer_copy(buffers,
+        asio::buffer(data_) + position_, chunk_);
+    position_ += n;
+    ec = n == 0 ? asio::error::eof : asio::error_code();
+    return n;
+  }
+
+  template <typename MutableBufferSequence>
+  std::size_t read_some(const MutableBufferSequence& buffers)
+  {
+    asio::error_code ec;
+    std::size_t n = read_some(buffers, ec);
+    if (ec)
+      throw asio::system_error(ec);
+    return n;
+  }
+
+  template <typename MutableBufferSequence, typename Handler>
+  void async_read_some(const MutableBufferSequence& buffers, Handler handler)
+  {
+    asio::error_code ec;
+    std::size_t n = read_some(buffers, ec);
+    asio::post(get_executor(), asio::detail::bind_handler(handler, ec, n));
+  }
+
+  template <typename ConstBufferSequence>
+  std::size_t write_some(const ConstBufferSequence& buffers,
+      asio::error_code& ec)
+  {
+    std::string chunk(chunk_, '\0');
+    std::size_t n = asio::buffer_copy(asio::buffer(chunk), buffers);
+    written_.append(chunk, 0, n);
+    ec = asio::error_code();
+    return n;
+  }
+
+  template <typename ConstBufferSequence>
+  std::size_t write_some(const ConstBufferSequence& buffers)
+  {
+    asio::error_code ec;
+    return write_some(buffers, ec);
+  }
+
+  template <typename ConstBufferSequence, typename Handler>
+  void async_write_some(const ConstBufferSequence& buffers, Handler handler)
+  {
+    asio::error_code ec;
+    std::size_t n = write_some(buffers, ec);
+    asio::post(get_executor(), asio::detail::bind_handler(handler, ec, n));
+  }
+
+private:
+  asio::io_context& io_context_;
+  std::string data_;
+  std::size_t position_;
+  std::size_t chunk_;
+  std::string written_;
+};
+
+template <typename ConstBufferSequence>
+std::string to_string(const ConstBufferSequence& buffers)
+{
+  std::string s(asio::buffer_size(buffers), '\0');
+  asio::buffer_copy(asio::buffer(s), buffers);
+  return s;
+}
+
+template <typename BufferSequence>
+std::size_t buffer_count(const BufferSequence& buffers)
+{
+  return std::distance(asio::buffer_sequence_begin(buffers),
+      asio::buffer_sequence_end(buffers));
+}
+
+void test_pool()
+{
+  asio::chunk_pool pool(8, 2);
+  ASIO_CHECK(pool.chunk_size() == 8);
+  ASIO_CHECK(pool.cached_chunks() == 0);
+
+  {
+    asio::chunk_buffer b(pool);
+    asio::dynamic_buffer(b).grow(30);
+    ASIO_CHECK(b.chunk_count() == 4);
+    ASIO_CHECK(b.capacity() == 32);
+  }
+
+  // Only two of the returned chunks are kept.
+  ASIO_CHECK(pool.cached_chunks() == 2);
+
+  {
+    asio::chunk_buffer b(pool);
+    asio::dynamic_buffer(b).grow(10);
+    ASIO_CHECK(pool.cached_chunks() == 0);
+  }
+
+  asio::chunk_pool tiny(1);
+  ASIO_CHECK(tiny.chunk_size() >= sizeof(void*));
+}
+
+void test_v2()
+{
+  asio::chunk_pool pool(8);
+  asio::chunk_buffer storage(pool, 40);
+  asio::dynamic_chunk_buffer b(storage);
+  ASIO_CHECK(b.size() == 0);
+  ASIO_CHECK(b.max_size() == 40);
+  ASIO_CHECK(b.capacity() == 0);
+  ASIO_CHECK(buffer_count(b.data(0, b.size())) == 0);
+
+  const std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+  b.grow(20);
+  ASIO_CHECK(b.size() == 20);
+  ASIO_CHECK(b.capacity() == 24);
+  ASIO_CHECK(buffer_count(b.data(0, 20)) == 3);
+  asio::buffer_copy(b.data(0, 20), asio::buffer(alphabet, 20));
+  ASIO_CHECK(to_string(b.data(0, b.size())) == alphabet.substr(0, 20));
+  ASIO_CHECK(to_string(b.data(5, 10)) == alphabet.substr(5, 10));
+  ASIO_CHECK(buffer_count(b.data(5, 10)) == 2);
+  ASIO_CHECK(to_string(b.data(18, 100)) == alphabet.substr(18, 2));
+  ASIO_CHECK(to_string(b.data(20, 1)) == "");
+  ASIO_CHECK(to_string(b.data(100, 1)) == "");
+
+  const asio::dynamic_chunk_buffer& cb = b;
+  ASIO_CHECK(to_string(cb.data(7, 2)) == "hi");
+
+  // Consuming returns the chunks that are no longer needed.
+  b.consume(10);
+  ASIO_CHECK(storage.chunk_count() == 2);
+  ASIO_CHECK(pool.cached_chunks() == 1);
+  ASIO_CHECK(to_string(b.data(0, b.size())) == alphabet.substr(10, 10));
+
+  // Growing reuses the cached chunk, and the existing data is not moved.
+  asio::const_buffer first = *b.data(0, 1).begin();
+  b.grow(6);
+  asio::buffer_copy(b.data(10, 6), asio::buffer(alphabet) + 20);
+  ASIO_CHECK(pool.cached_chunks() == 0);
+  ASIO_CHECK(storage.chunk_count() == 3);
+  ASIO_CHECK((*b.data(0, 1).begin()).data() == first.data());
+  ASIO_CHECK(to_string(b.data(0, b.size())) == alphabet.substr(10, 16));
+
+  b.shrink(4);
+  ASIO_CHECK(to_string(b.data(0, b.size())) == alphabet.substr(10, 12));
+  ASIO_CHECK(storage.chunk_count() == 2);
+  ASIO_CHECK(pool.cached_chunks() == 1);
+
+  bool thrown = false;
+  try
+  {
+    b.grow(29);
+  }
+  catch (std::length_error&)
+  {
+    thrown = true;
+  }
+  ASIO_CHECK(thrown);
+  ASIO_CHECK(b.size() == 12);
+
+  // Copies share the underlying storage.
+  asio::dynamic_chunk_buffer copy(b);
+  copy.consume(2);
+  ASIO_CHECK(b.size() == 10);
+
+  // Emptying the buffer returns all of its chunks.
+  b.consume(100);
+  ASIO_CHECK(b.size() == 0);
+  ASIO_CHECK(storage.chunk_count() == 0);
+  ASIO_CHECK(pool.cached_chunks() == 3);
+}
+
+void test_v1()
+{
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  asio::chunk_pool pool(8);
+  asio::chunk_buffer storage(pool);
+  asio::dynamic_chunk_buffer b = asio::dynamic_buffer(storage);
+
+  asio::buffer_copy(b.prepare(10), asio::buffer("abcdefghij", 10));
+  b.commit(10);
+  ASIO_CHECK(to_string(b.data()) == "abcdefghij");
+  b.consume(9);
+  ASIO_CHECK(storage.chunk_count() == 1);
+
+  asio::dynamic_chunk_buffer::mutable_buffers_type prepared = b.prepare(17);
+  ASIO_CHECK(buffer_count(prepared) == 3);
+  ASIO_CHECK(asio::buffer_size(prepared) == 17);
+  asio::buffer_copy(prepared, asio::buffer("klmnopqrstuvwxyz!", 17));
+  b.commit(5);
+  ASIO_CHECK(to_string(b.data()) == "jklmno");
+  ASIO_CHECK(storage.chunk_count() == 1);
+
+  b.commit(100);
+  ASIO_CHECK(b.size() == 6);
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+}
+
+void test_buffers_iterator()
+{
+  asio::chunk_pool pool(8);
+  asio::chunk_buffer storage(pool);
+  asio::dynamic_chunk_buffer b(storage);
+  const std::string data = "the quick brown fox jumps over the lazy dog";
+  b.grow(data.size() + 2);
+  asio::buffer_copy(b.data(2, data.size()), asio::buffer(data));
+  b.consume(2);
+
+  typedef asio::dynamic_chunk_buffer::const_buffers_type buffers_type;
+  typedef asio::buffers_iterator<buffers_type> iterator;
+  const asio::dynamic_chunk_buffer& cb = b;
+  buffers_type buffers = cb.data(0, cb.size());
+  iterator begin = iterator::begin(buffers);
+  iterator end = iterator::end(buffers);
+  ASIO_CHECK(std::string(begin, end) == data);
+  ASIO_CHECK(end - begin == static_cast<std::ptrdiff_t>(data.size()));
+
+  std::string reversed;
+  for (iterator i = end; i != begin;)
+    reversed += *--i;
+  ASIO_CHECK(std::string(reversed.rbegin(), reversed.rend()) == data);
+  ASIO_CHECK(*(begin + 10) == 'b');
+}
+
+void async_handler(const asio::error_code& err,
+    std::size_t bytes_transferred, asio::error_code* out_err,
+    std::size_t* out_bytes_transferred)
+{
+  *out_err = err;
+  *out_bytes_transferred = bytes_transferred;
+}
+
+void test_read_write()
+{
+  asio::io_context ioc;
+  std::string data;
+  for (int i = 0; i < 100; ++i)
+    data += "0123456789abcdefghijklmnopqrstuvwxyz";
+
+  // A large body is held in many chunks and written with gather operations.
+  {
+    asio::chunk_pool pool(32);
+    asio::chunk_buffer storage(pool);
+    test_stream s(ioc, data, 1000);
+    asio::error_code ec;
+    std::size_t n = asio::read(s, asio::dynamic_buffer(storage), ec);
+    ASIO_CHECK(ec == asio::error::eof);
+    ASIO_CHECK(n == data.size());
+    ASIO_CHECK(storage.chunk_count() == (data.size() + 31) / 32);
+
+    n = asio::write(s, asio::dynamic_buffer(storage));
+    ASIO_CHECK(n == data.size());
+    ASIO_CHECK(s.written() == data);
+    ASIO_CHECK(storage.chunk_count() == 0);
+  }
+
+  {
+    asio::chunk_pool pool(32);
+    asio::chunk_buffer storage(pool);
+    test_stream s(ioc, data, 700);
+    asio::error_code ec;
+    std::size_t n = 0;
+    asio::async_read(s, asio::dynamic_buffer(storage),
+        asio::transfer_exactly(2000),
+        bindns::bind(async_handler, _1, _2, &ec, &n));
+    ioc.restart();
+    ioc.run();
+    ASIO_CHECK(!ec);
+    ASIO_CHECK(n == 2000);
+    ASIO_CHECK(storage.size() == 2000);
+
+    asio::async_write(s, asio::dynamic_buffer(storage),
+        bindns::bind(async_handler, _1, _2, &ec, &n));
+    ioc.restart();
+    ioc.run();
+    ASIO_CHECK(!ec);
+    ASIO_CHECK(n == 2000);
+    ASIO_CHECK(s.written() == data.substr(0, 2000));
+  }
+
+  // Delimiters that straddle chunk boundaries are found.
+  for (std::size_t chunk = 1; chunk < 20; chunk += 6)
+  {
+    asio::chunk_pool pool(8);
+    asio::chunk_buffer storage(pool);
+    const std::string lines = "first\r\nsecond line\r\nthird\r\n";
+    test_stream s(ioc, lines, chunk);
+    std::string result;
+    for (;;)
+    {
+      asio::error_code ec;
+      std::size_t n = asio::read_until(s,
+          asio::dynamic_buffer(storage), "\r\n", ec);
+      if (ec)
+      {
+        ASIO_CHECK(ec == asio::error::eof);
+        break;
+      }
+      result += to_string(asio::dynamic_buffer(storage).data(0, n));
+      asio::dynamic_buffer(storage).consume(n);
+    }
+    ASIO_CHECK(result == lines);
+  }
+}
+
+ASIO_TEST_SUITE
+(
+  "dynamic_chunk_buffer",
+  ASIO_TEST_CASE(test_pool)
+  ASIO_TEST_CASE(test_v2)
+  ASIO_TEST_CASE(test_v1)
+  ASIO_TEST_CASE(test_buffers_iterator)
+  ASIO_TEST_CASE(test_read_write)
+)
@@ -0,0 +1,373 @@
+//
+// dynamic_ring_buffer.cpp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/dynamic_ring_buffer.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "asio/read.hpp"
+#include "asio/read_until.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif // defined(ASIO_HAS_BOOST_BIND)
+using bindns::placeholders::_1;
+using bindns::placeholders::_2;
+
+// A stream that reads from and writes to strings a few bytes at a time.
+class test_stream
+{
+public:
+  typedef asio::io_context::executor_type executor_type;
+
+  test_stream(asio::io_context& io_context,
+      const std::string& data, std::size_t chunk)
+    : io_context_(io_context),
+      data_(data),
+      position_(0),
+      chunk_(chunk)
+  {
+  }
+
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return io_context_.get_executor();
+  }
+
+  const std::string& written() const
+  {
+    return written_;
+  }
+
+  template <typename MutableBufferSequence>
+  std::size_t read_some(const MutableBufferSequence& buffers,
+      asio::error_code& ec)
+  {
+    if (asio::buffer_size(buffers) == 0)
+    {
+      ec = asio::error_code();
+      return 0;
+    }
+
+    std::size_t n = asio::buffer_copy(buffers,
+        asio::buffer(data_) + position_, chunk_);
+    position_ += n;
+    ec = n == 0 ? asio::error::eof : asio::error_code();
+    return n;
+  }
+
+  template <typename MutableBufferSequence>
+  std::size_t read_some(const MutableBufferSequence& buffers)
+  {
+    asio::error_code ec;
+    std::size_t n = read_some(buffers, ec);
+    if (ec)
+      throw asio::system_error(ec);
+    return n;
+  }
+
+  template <typename MutableBufferSequence, typename Handler>
+  void async_read_some(const MutableBufferSequence& buffers, Handler handler)
+  {
+    asio::error_code ec;
+    std::size_t n = read_some(buffers, ec);
+    asio::post(get_executor(), asio::detail::bind_handler(handler, ec, n));
+  }
+
+  template <typename ConstBufferSequence>
+  std::size_t write_some(const ConstBufferSequence& buffers,
+      asio::error_code& ec)
+  {
+    std::string chunk(chunk_, '\0');
+    std::size_t n = asio::buffer_copy(asio::buffer(chunk), buffers);
+    written_.append(chunk, 0, n);
+    ec = asio::error_code();
+    return n;
+  }
+
+  template <typename ConstBufferSequence>
+  std::size_t write_some(const ConstBufferSequence& buffers)
+  {
+    asio::error_code ec;
+    return write_some(buffers, ec);
+  }
+
+  template <typename ConstBufferSequence, typename Handler>
+  void async_write_some(const ConstBufferSequence& buffers, Handler handler)
+  {
+    asio::error_code ec;
+    std::size_t n = write_some(buffers, ec);
+    asio::post(get_executor(), asio::detail::bind_handler(handler, ec, n));
+  }
+
+private:
+  asio::io_context& io_context_;
+  std::string data_;
+  std::size_t position_;
+  std::size_t chunk_;
+  std::string written_;
+};
+
+template <typename ConstBufferSequence>
+std::string to_string(const ConstBufferSequence& buffers)
+{
+  std::string s(asio::buffer_size(buffers), '\0');
+  asio::buffer_copy(asio::buffer(s), buffers);
+  return s;
+}
+
+template <typename BufferSequence>
+std::size_t buffer_count(const BufferSequence& buffers)
+{
+  return asio::buffer_sequence_end(buffers)
+    - asio::buffer_sequence_begin(buffers);
+}
+
+void test_v2()
+{
+  asio::ring_buffer storage(8);
+  asio::dynamic_ring_buffer b(storage);
+  ASIO_CHECK(b.size() == 0);
+  ASIO_CHECK(b.max_size() == 8);
+  ASIO_CHECK(b.capacity() == 8);
+
+  b.grow(6);
+  asio::buffer_copy(b.data(0, 6), asio::buffer("abcdef", 6));
+  b.consume(4);
+  ASIO_CHECK(b.size() == 2);
+  ASIO_CHECK(buffer_count(b.data(0, b.size())) == 1);
+
+  // The new bytes wrap around the end of the storage.
+  b.grow(5);
+  asio::buffer_copy(b.data(2, 5), asio::buffer("ghijk", 5));
+  ASIO_CHECK(storage.size() == 7);
+  ASIO_CHECK(buffer_count(b.data(0, b.size())) == 2);
+  ASIO_CHECK(to_string(b.data(0, b.size())) == "efghijk");
+  ASIO_CHECK(to_string(b.data(3, 100)) == "hijk");
+  ASIO_CHECK(to_string(b.data(7, 1)) == "");
+
+  const asio::dynamic_ring_buffer& cb = b;
+  ASIO_CHECK(to_string(cb.data(1, 3)) == "fgh");
+
+  bool thrown = false;
+  try
+  {
+    b.grow(2);
+  }
+  catch (std::length_error&)
+  {
+    thrown = true;
+  }
+  ASIO_CHECK(thrown);
+
+  b.shrink(2);
+  ASIO_CHECK(to_string(b.data(0, b.size())) == "efghi");
+
+  // Copies share the underlying storage.
+  asio::dynamic_ring_buffer copy(b);
+  copy.consume(3);
+  ASIO_CHECK(b.size() == 2);
+  ASIO_CHECK(to_string(b.data(0, b.size())) == "hi");
+
+  // Emptying the buffer makes the next data contiguous.
+  b.consume(100);
+  ASIO_CHECK(b.size() == 0);
+  b.grow(8);
+  ASIO_CHECK(buffer_count(b.data(0, b.size())) == 1);
+}
+
+void test_v1()
+{
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  asio::ring_buffer storage(8);
+  asio::dynamic_ring_buffer b = asio::dynamic_buffer(storage);
+
+  asio::buffer_copy(b.prepare(5), asio::buffer("abcde", 5));
+  b.commit(5);
+  ASIO_CHECK(to_string(b.data()) == "abcde");
+  b.consume(3);
+
+  asio::dynamic_ring_buffer::mutable_buffers_type prepared = b.prepare(6);
+  ASIO_CHECK(buffer_count(prepared) == 2);
+  ASIO_CHECK(asio::buffer_size(prepared) == 6);
+  asio::buffer_copy(prepared, asio::buffer("fghijk", 6));
+  b.commit(100);
+  ASIO_CHECK(b.size() == 8);
+  ASIO_CHECK(to_string(b.data()) == "defghijk");
+
+  bool thrown = false;
+  try
+  {
+    b.prepare(1);
+  }
+  catch (std::length_error&)
+  {
+    thrown = true;
+  }
+  ASIO_CHECK(thrown);
+
+  b.consume(7);
+  b.prepare(4);
+  b.commit(2);
+  ASIO_CHECK(b.size() == 3);
+  ASIO_CHECK(to_string(b.data()).substr(0, 1) == "k");
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+}
+
+void async_handler(const asio::error_code& err,
+    std::size_t bytes_transferred, asio::error_code* out_err,
+    std::size_t* out_bytes_transferred)
+{
+  *out_err = err;
+  *out_bytes_transferred = bytes_transferred;
+}
+
+void test_read_until()
+{
+  asio::io_context ioc;
+  std::string data;
+  for (int i = 0; i < 20; ++i)
+    data += "line " + std::string(i % 7 + 1, 'x') + "\n";
+
+  // The lines are consumed one at a time, so the data repeatedly wraps around
+  // the end of the storage.
+  for (std::size_t chunk = 1; chunk < 20; chunk += 6)
+  {
+    test_stream s(ioc, data, chunk);
+    asio::ring_buffer storage(16);
+    std::string lines;
+    for (;;)
+    {
+      asio::error_code ec;
+      std::size_t n = asio::read_until(s,
+          asio::dynamic_buffer(storage), '\n', ec);
+      if (ec)
+      {
+        ASIO_CHECK(ec == asio::error::eof);
+        break;
+      }
+      lines += to_string(asio::dynamic_buffer(storage).data(0, n));
+      asio::dynamic_buffer(storage).consume(n);
+    }
+    ASIO_CHECK(lines == data);
+  }
+
+  for (std::size_t chunk = 1; chunk < 20; chunk += 6)
+  {
+    test_stream s(ioc, data, chunk);
+    asio::ring_buffer storage(16);
+    std::string lines;
+    for (;;)
+    {
+      asio::error_code ec;
+      std::size_t n = 0;
+      asio::async_read_until(s, asio::dynamic_buffer(storage), "\n",
+          bindns::bind(async_handler, _1, _2, &ec, &n));
+      ioc.restart();
+      ioc.run();
+      if (ec)
+      {
+        ASIO_CHECK(ec == asio::error::eof);
+        break;
+      }
+      lines += to_string(asio::dynamic_buffer(storage).data(0, n));
+      asio::dynamic_buffer(storage).consume(n);
+    }
+    ASIO_CHECK(lines == data);
+  }
+
+  // A full buffer with no delimiter cannot be searched further.
+  test_stream s(ioc, "0123456789abcdefghij\n", 5);
+  asio::ring_buffer storage(16);
+  asio::error_code ec;
+  asio::read_until(s, asio::dynamic_buffer(storage), '\n', ec);
+  ASIO_CHECK(ec == asio::error::not_found);
+  ASIO_CHECK(storage.size() == 16);
+}
+
+void test_async_read_write()
+{
+  asio::io_context ioc;
+  std::string data;
+  for (int i = 0; i < 10; ++i)
+    data += "abcdefghijklmnopqrstuvwxyz";
+
+  // Copy the data from one stream to the other through a small buffer, with
+  // reads and writes of different sizes.
+  test_stream s(ioc, data, 7);
+  asio::ring_buffer storage(24);
+  asio::dynamic_buffer(storage).grow(5);
+  asio::dynamic_buffer(storage).consume(5);
+  asio::error_code ec;
+  for (;;)
+  {
+    std::size_t n = 0;
+    asio::async_read(s, asio::dynamic_buffer(storage),
+        asio::transfer_at_least(10),
+        bindns::bind(async_handler, _1, _2, &ec, &n));
+    ioc.restart();
+    ioc.run();
+    if (n == 0)
+      break;
+
+    std::size_t written = 0;
+    asio::async_write(s, asio::dynamic_buffer(storage),
+        bindns::bind(async_handler, _1, _2, &ec, &written));
+    ioc.restart();
+    ioc.run();
+    ASIO_CHECK(!ec);
+    ASIO_CHECK(written == n);
+    ASIO_CHECK(storage.size() == 0);
+  }
+  ASIO_CHECK(ec == asio::error::eof);
+  ASIO_CHECK(s.written() == data);
+
+  // Fill the buffer completely, then write it out.
+  test_stream s2(ioc, data, 10);
+  storage.clear();
+  asio::dynamic_buffer(storage).grow(20);
+  asio::dynamic_buffer(storage).consume(19);
+  std::size_t n = asio::read(s2, asio::dynamic_buffer(storage), ec);
+  ASIO_CHECK(n == 23);
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(buffer_count(
+        asio::dynamic_buffer(storage).data(0, storage.size())) == 2);
+  n = asio::write(s2, asio::dynamic_buffer(storage));
+  ASIO_CHECK(n == 24);
+  ASIO_CHECK(s2.written().substr(1) == data.substr(0, 23));
+}
+
+ASIO_TEST_SUITE
+(
+  "dynamic_ring_buffer",
+  ASIO_TEST_CASE(test_v2)
+  ASIO_TEST_CASE(test_v1)
+  ASIO_TEST_CASE(test_read_until)
+  ASIO_TEST_CASE(test_async_read_write)
+)
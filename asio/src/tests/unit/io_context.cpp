@@ -17,8 +17,12 @@
 #include "asio/io_context.hpp"
 
 #include <sstream>
+#include <vector>
 #include "asio/bind_executor.hpp"
+#include "asio/config.hpp"
 #include "asio/dispatch.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
 #include "asio/post.hpp"
 #include "asio/thread.hpp"
 #include "unit_test.hpp"
@@ -284,6 +288,545 @@ void io_context_test()
   ASIO_CHECK(exception_count == 2);
 }
 
+void record(std::vector<int>* order, int value)
+{
+  order->push_back(value);
+}
+
+void post_chain(io_context* ioc, int* count)
+{
+  if (--(*count) > 0)
+    asio::post(*ioc, bindns::bind(post_chain, ioc, count));
+}
+
+void io_context_batch_test()
+{
+  config_from_string config("scheduler.batch_size = 8\n");
+  io_context ioc(config);
+
+  // Handlers dequeued in batches still run in the order they were posted.
+  std::vector<int> order;
+  for (int i = 0; i < 20; ++i)
+    asio::post(ioc, bindns::bind(record, &order, i));
+
+  io_context::count_type n = ioc.run();
+
+  ASIO_CHECK(ioc.stopped());
+  ASIO_CHECK(n == 20);
+  ASIO_CHECK(order.size() == 20);
+  for (std::size_t i = 0; i < order.size(); ++i)
+    ASIO_CHECK(order[i] == static_cast<int>(i));
+
+  // Handlers that were dequeued with a throwing handler are not lost.
+  order.clear();
+  int exception_count = 0;
+  ioc.restart();
+  asio::post(ioc, bindns::bind(record, &order, 0));
+  asio::post(ioc, &throw_exception);
+  asio::post(ioc, bindns::bind(record, &order, 1));
+  asio::post(ioc, bindns::bind(record, &order, 2));
+  asio::post(ioc, &throw_exception);
+  asio::post(ioc, bindns::bind(record, &order, 3));
+
+  for (;;)
+  {
+    try
+    {
+      ioc.run();
+      break;
+    }
+    catch (int)
+    {
+      ++exception_count;
+    }
+  }
+
+  ASIO_CHECK(ioc.stopped());
+  ASIO_CHECK(exception_count == 2);
+  ASIO_CHECK(order.size() == 4);
+  for (std::size_t i = 0; i < order.size(); ++i)
+    ASIO_CHECK(order[i] == static_cast<int>(i));
+
+  // Work is accounted for correctly when handlers are run from many threads.
+  int counts[16];
+  ioc.restart();
+  for (int i = 0; i < 16; ++i)
+  {
+    counts[i] = 1000;
+    asio::post(ioc, bindns::bind(post_chain, &ioc, &counts[i]));
+  }
+
+  thread thread1(bindns::bind(io_context_run, &ioc));
+  thread thread2(bindns::bind(io_context_run, &ioc));
+  thread thread3(bindns::bind(io_context_run, &ioc));
+  ioc.run();
+  thread1.join();
+  thread2.join();
+  thread3.join();
+
+  ASIO_CHECK(ioc.stopped());
+  for (int i = 0; i < 16; ++i)
+    ASIO_CHECK(counts[i] == 0);
+}
+
+void set_flag(bool* flag)
+{
+  *flag = true;
+}
+
+void post_until_set(io_context* ioc, bool* flag, int* count)
+{
+  ++(*count);
+  if (!*flag)
+    asio::post(*ioc, bindns::bind(post_until_set, ioc, flag, count));
+}
+
+void io_context_budget_test()
+{
+  // Statistics are not measured by default.
+  io_context ioc1;
+  bool flag = false;
+  asio::post(ioc1, bindns::bind(set_flag, &flag));
+  ioc1.run();
+  io_context::statistics stats = ioc1.get_statistics();
+  ASIO_CHECK(flag);
+  ASIO_CHECK(stats.forced_task_polls == 0);
+  ASIO_CHECK(stats.task_poll_intervals == 0);
+
+  config_from_string config(
+      "scheduler.handler_budget = 16\n"
+      "scheduler.statistics = true\n");
+  io_context ioc(config);
+  flag = false;
+  int count = 0;
+
+  for (int i = 0; i < 1000; ++i)
+    asio::post(ioc, bindns::bind(post_until_set, &ioc, &flag, &count));
+
+  // The timer has already expired, but its handler cannot be queued until the
+  // reactor runs. Without a budget the reactor would only run after the
+  // first 1000 handlers, and the timer's handler would follow another 1000.
+  timer t(ioc, chronons::seconds(0));
+  t.async_wait(bindns::bind(set_flag, &flag));
+
+  ioc.run();
+
+  ASIO_CHECK(flag);
+  ASIO_CHECK(count < 2500);
+
+  stats = ioc.get_statistics();
+  ASIO_CHECK(stats.task_polls > 0);
+  ASIO_CHECK(stats.forced_task_polls > 0);
+  ASIO_CHECK(stats.forced_task_polls <= stats.task_polls);
+  ASIO_CHECK(stats.task_poll_intervals == stats.task_polls);
+  ASIO_CHECK(stats.task_poll_interval_p50_usec
+      <= stats.task_poll_interval_p99_usec);
+  ASIO_CHECK(stats.task_poll_interval_p99_usec
+      <= stats.task_poll_interval_max_usec);
+
+  // Forced polls may coincide with the task being dequeued by other threads.
+  int counts[16];
+  ioc.restart();
+  for (int i = 0; i < 16; ++i)
+  {
+    counts[i] = 1000;
+    asio::post(ioc, bindns::bind(post_chain, &ioc, &counts[i]));
+  }
+
+  thread thread1(bindns::bind(io_context_run, &ioc));
+  thread thread2(bindns::bind(io_context_run, &ioc));
+  thread thread3(bindns::bind(io_context_run, &ioc));
+  ioc.run();
+  thread1.join();
+  thread2.join();
+  thread3.join();
+
+  ASIO_CHECK(ioc.stopped());
+  for (int i = 0; i < 16; ++i)
+    ASIO_CHECK(counts[i] == 0);
+}
+
+void io_context_budget_run_for_test()
+{
+  config_from_string config("scheduler.handler_budget = 16\n");
+  io_context ioc(config);
+  bool flag = false;
+  int count = 0;
+
+  // As for io_context_budget_test, but using the functions that run one
+  // handler at a time.
+#if defined(ASIO_HAS_CHRONO)
+  for (int i = 0; i < 1000; ++i)
+    asio::post(ioc, bindns::bind(post_until_set, &ioc, &flag, &count));
+  timer t1(ioc, chronons::seconds(0));
+  t1.async_wait(bindns::bind(set_flag, &flag));
+
+  while (!ioc.stopped())
+    ioc.run_for(asio::chrono::seconds(10));
+
+  ASIO_CHECK(flag);
+  ASIO_CHECK(count < 2500);
+#endif // defined(ASIO_HAS_CHRONO)
+
+  ioc.restart();
+  flag = false;
+  count = 0;
+  for (int i = 0; i < 1000; ++i)
+    asio::post(ioc, bindns::bind(post_until_set, &ioc, &flag, &count));
+  timer t2(ioc, chronons::seconds(0));
+  t2.async_wait(bindns::bind(set_flag, &flag));
+
+  while (ioc.poll_one() > 0)
+  {
+  }
+
+  ASIO_CHECK(flag);
+  ASIO_CHECK(count < 2500);
+}
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+
+void handle_read(const asio::error_code& ec, std::size_t n, int* count)
+{
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(n > 0);
+  ++(*count);
+}
+
+void send_bytes(local::stream_protocol::socket* socket1,
+    local::stream_protocol::socket* socket2)
+{
+  socket1->send(buffer("x", 1));
+  if (socket2)
+    socket2->send(buffer("y", 1));
+}
+
+void io_context_budget_io_test()
+{
+  config_from_string config("scheduler.handler_budget = 1");
+  io_context ioc(config);
+  local::stream_protocol::socket a1(ioc), b1(ioc), a2(ioc), b2(ioc);
+  local::connect_pair(a1, b1);
+  local::connect_pair(a2, b2);
+
+  char data1[4], data2[4];
+  int count = 0;
+  a1.async_read_some(buffer(data1),
+      bindns::bind(handle_read, bindns::placeholders::_1,
+        bindns::placeholders::_2, &count));
+  a2.async_read_some(buffer(data2),
+      bindns::bind(handle_read, bindns::placeholders::_1,
+        bindns::placeholders::_2, &count));
+
+  // The first handler makes a1 ready, and the forced poll that follows queues
+  // it behind the task operation. The second makes a1 ready again while it is
+  // still at the back of the queue, and a2 ready for the first time, so that
+  // the next forced poll finds both.
+  local::stream_protocol::socket* no_socket = 0;
+  asio::post(ioc, bindns::bind(send_bytes, &b1, no_socket));
+  asio::post(ioc, bindns::bind(send_bytes, &b1, &b2));
+  asio::post(ioc, bindns::bind(increment, &count));
+
+  ioc.run();
+
+  ASIO_CHECK(count == 3);
+}
+
+void start_read(local::stream_protocol::socket* socket,
+    char* data, int* count)
+{
+  socket->async_read_some(buffer(data, 1),
+      bindns::bind(handle_read, bindns::placeholders::_1,
+        bindns::placeholders::_2, count));
+}
+
+void io_context_unsafe_thread_test()
+{
+  // The io_context is created on this thread, but its operations are started
+  // and completed on another. A non-locking concurrency hint allows this, so
+  // the backend must not be bound to the thread that created it.
+  io_context ioc(ASIO_CONCURRENCY_HINT_UNSAFE);
+  local::stream_protocol::socket a(ioc), b(ioc);
+  local::connect_pair(a, b);
+
+  char data[4];
+  int count = 0;
+  local::stream_protocol::socket* no_socket = 0;
+  asio::post(ioc, bindns::bind(start_read, &a, data, &count));
+  asio::post(ioc, bindns::bind(send_bytes, &b, no_socket));
+
+  thread thread1(bindns::bind(io_context_run, &ioc));
+  thread1.join();
+
+  ASIO_CHECK(ioc.stopped());
+  ASIO_CHECK(count == 1);
+}
+
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+
+void io_context_spin_test()
+{
+  config_from_string config("scheduler.max_spin = 10000\n");
+  io_context ioc(config);
+
+  // Idle threads spin before blocking, and must still be woken when there is
+  // work for them.
+  executor_work_guard<io_context::executor_type> w = make_work_guard(ioc);
+  thread thread1(bindns::bind(io_context_run, &ioc));
+  thread thread2(bindns::bind(io_context_run, &ioc));
+  thread thread3(bindns::bind(io_context_run, &ioc));
+
+  int counts[16];
+  for (int i = 0; i < 16; ++i)
+  {
+    counts[i] = 1000;
+    asio::post(ioc, bindns::bind(post_chain, &ioc, &counts[i]));
+  }
+
+  w.reset();
+  thread1.join();
+  thread2.join();
+  thread3.join();
+
+  ASIO_CHECK(ioc.stopped());
+  for (int i = 0; i < 16; ++i)
+    ASIO_CHECK(counts[i] == 0);
+
+  // Threads spinning when stop() is called must return.
+  ioc.restart();
+  executor_work_guard<io_context::executor_type> w2 = make_work_guard(ioc);
+  thread thread4(bindns::bind(io_context_run, &ioc));
+  thread thread5(bindns::bind(io_context_run, &ioc));
+  asio::post(ioc, bindns::bind(&io_context::stop, &ioc));
+  thread4.join();
+  thread5.join();
+
+  ASIO_CHECK(ioc.stopped());
+}
+
+void io_context_interrupt_test()
+{
+  io_context ioc;
+  int count = 0;
+
+  // Creating a timer ensures that the reactor is running.
+  timer t(ioc);
+
+  // Every post from a foreign thread must either interrupt the reactor, or be
+  // able to rely on an earlier interrupt.
+  executor_work_guard<io_context::executor_type> w = make_work_guard(ioc);
+  thread thread1(bindns::bind(io_context_run, &ioc));
+
+  for (int i = 0; i < 1000; ++i)
+    asio::post(ioc, bindns::bind(increment, &count));
+
+  w.reset();
+  thread1.join();
+
+  ASIO_CHECK(ioc.stopped());
+  ASIO_CHECK(count == 1000);
+
+  io_context::statistics stats = ioc.get_statistics();
+  ASIO_CHECK(stats.task_interrupts_sent
+      + stats.task_interrupts_suppressed >= 1000);
+}
+
+void reset_guard(executor_work_guard<io_context::executor_type>* w,
+    int* count)
+{
+  ++(*count);
+  w->reset();
+}
+
+void post_reset_guard(io_context* ioc,
+    executor_work_guard<io_context::executor_type>* w, int* count)
+{
+  asio::post(*ioc, bindns::bind(reset_guard, w, count));
+}
+
+void io_context_cross_wakeup_test()
+{
+  // A context that is waiting in run() is woken by a post from a thread that
+  // is running another context. With io_uring, the wakeup is sent from the
+  // poster's ring if possible, and otherwise by submitting to the target's.
+  const char* configs[] = {
+    "io_uring.msg_ring_wakeups = true\n",
+    "io_uring.msg_ring_wakeups = false\n"
+  };
+
+  for (int i = 0; i < 2; ++i)
+  {
+    config_from_string config(configs[i]);
+    io_context ioc1(config);
+
+    for (int j = 0; j < 20; ++j)
+    {
+      io_context* ioc2 = new io_context(config);
+      int count = 0;
+      {
+        // Creating a timer ensures that the reactor is running.
+        timer t(*ioc2);
+        executor_work_guard<io_context::executor_type> w =
+          make_work_guard(*ioc2);
+        thread thread1(bindns::bind(io_context_run, ioc2));
+
+        ioc1.restart();
+        asio::post(ioc1, bindns::bind(post_reset_guard, ioc2, &w, &count));
+        ioc1.run();
+        thread1.join();
+      }
+
+      ASIO_CHECK(count == 1);
+      ASIO_CHECK(ioc2->stopped());
+
+      // The target is destroyed before the poster's context next runs, and
+      // so before it sees the outcome of the wakeup.
+      delete ioc2;
+    }
+
+    ioc1.restart();
+    ioc1.poll();
+  }
+}
+
+void check_running_in_this_thread(io_context* ioc, bool* result)
+{
+  *result = ioc->get_executor().running_in_this_thread();
+}
+
+void post_and_poll(io_context* ioc, int* count)
+{
+  asio::post(*ioc, bindns::bind(increment, count));
+  ioc->poll();
+
+  // The nested poll() runs the handler that was just posted.
+  ASIO_CHECK(*count == 1);
+}
+
+void io_context_unsafe_test()
+{
+  io_context ioc(ASIO_CONCURRENCY_HINT_UNSAFE);
+  int count = 0;
+  bool running = true;
+
+  // The running thread is known without locking.
+  ASIO_CHECK(!ioc.get_executor().running_in_this_thread());
+  asio::post(ioc, bindns::bind(check_running_in_this_thread, &ioc, &running));
+  ioc.run();
+  ASIO_CHECK(running);
+  ASIO_CHECK(!ioc.get_executor().running_in_this_thread());
+
+  count = 10;
+  ioc.restart();
+  asio::post(ioc, bindns::bind(decrement_to_zero, &ioc, &count));
+  ioc.run();
+  ASIO_CHECK(count == 0);
+
+  count = 10;
+  ioc.restart();
+  asio::post(ioc, bindns::bind(nested_decrement_to_zero, &ioc, &count));
+  ioc.run();
+  ASIO_CHECK(count == 0);
+
+  count = 0;
+  ioc.restart();
+  asio::post(ioc, bindns::bind(post_and_poll, &ioc, &count));
+  ioc.run();
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(!ioc.get_executor().running_in_this_thread());
+
+  // Outstanding work keeps run() going until it is finished.
+  count = 0;
+  ioc.restart();
+  timer t(ioc, chronons::milliseconds(10));
+  t.async_wait(bindns::bind(increment, &count));
+  ASIO_CHECK(ioc.run() == 1);
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(ioc.stopped());
+
+  // A thread other than the one that created the io_context may run it, as
+  // long as only one thread uses it at a time.
+  count = 0;
+  ioc.restart();
+  asio::post(ioc, bindns::bind(check_running_in_this_thread, &ioc, &running));
+  asio::post(ioc, bindns::bind(increment, &count));
+  running = false;
+  thread thread1(bindns::bind(io_context_run, &ioc));
+  thread1.join();
+  ASIO_CHECK(running);
+  ASIO_CHECK(count == 1);
+}
+
+void io_context_priority_test()
+{
+  io_context ioc;
+  std::vector<int> order;
+
+  io_context::executor_type ex = ioc.get_executor();
+  io_context::executor_type ex1 =
+    asio::require(ex, asio::execution::priority(1));
+  io_context::executor_type ex2 =
+    asio::require(ex, asio::execution::priority(2));
+  ASIO_CHECK(ex1 != ex);
+  ASIO_CHECK(ex1 != ex2);
+  ASIO_CHECK(ex1 == asio::require(ex2, asio::execution::priority(1)));
+  ASIO_CHECK(asio::query(ex2, asio::execution::priority) == 2);
+  ASIO_CHECK(asio::query(asio::require(ex2, asio::execution::blocking.never),
+        asio::execution::priority) == 2);
+  ASIO_CHECK(asio::query(asio::require(ex, asio::execution::priority(9)),
+        asio::execution::priority) == 3);
+
+#if defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+  // The priority is held in the executor's pointer to the io_context.
+  ASIO_CHECK(sizeof(io_context::executor_type) == sizeof(void*));
+#endif // defined(ASIO_HAS_ALIGNED_IO_CONTEXT)
+
+  // Handlers run in order of priority, and in order of submission within
+  // each priority.
+  asio::post(ex, bindns::bind(record, &order, 0));
+  asio::post(ex1, bindns::bind(record, &order, 10));
+  asio::post(ex, bindns::bind(record, &order, 1));
+  asio::post(ex2, bindns::bind(record, &order, 20));
+  asio::post(ex1, bindns::bind(record, &order, 11));
+  asio::execution::execute(ex2, bindns::bind(record, &order, 21));
+  ioc.run();
+
+  static const int expected[] = { 20, 21, 10, 11, 0, 1 };
+  ASIO_CHECK(order.size() == 6);
+  for (std::size_t i = 0; i < order.size() && i < 6; ++i)
+    ASIO_CHECK(order[i] == expected[i]);
+
+  // The same order applies to poll().
+  order.clear();
+  ioc.restart();
+  asio::post(ex, bindns::bind(record, &order, 0));
+  asio::post(ex2, bindns::bind(record, &order, 20));
+  asio::post(ex1, bindns::bind(record, &order, 10));
+  ioc.poll();
+  ASIO_CHECK(order.size() == 3);
+  ASIO_CHECK(order.size() == 3 && order[0] == 20);
+  ASIO_CHECK(order.size() == 3 && order[1] == 10);
+  ASIO_CHECK(order.size() == 3 && order[2] == 0);
+
+  // With aging, a handler of lower priority runs after every two handlers of
+  // higher priority.
+  config_from_string config("scheduler.priority_aging = 2\n");
+  io_context ioc2(config);
+  io_context::executor_type ex3 =
+    asio::require(ioc2.get_executor(), asio::execution::priority(3));
+  for (int i = 0; i < 3; ++i)
+    asio::post(ioc2, bindns::bind(record, &order, i));
+  for (int i = 0; i < 6; ++i)
+    asio::post(ex3, bindns::bind(record, &order, 30 + i));
+  order.clear();
+  ioc2.run();
+
+  static const int aged[] = { 30, 31, 0, 32, 33, 1, 34, 35, 2 };
+  ASIO_CHECK(order.size() == 9);
+  for (std::size_t i = 0; i < order.size() && i < 9; ++i)
+    ASIO_CHECK(order[i] == aged[i]);
+}
+
 class test_service : public asio::io_context::service
 {
 public:
@@ -402,6 +945,18 @@ void io_context_executor_query_test()
       asio::query(ioc.get_executor(),
         asio::execution::allocator)
       == std::allocator<void>());
+
+  ASIO_CHECK(
+      asio::query(ioc.get_executor(),
+        asio::execution::priority)
+      == 0);
+
+  ASIO_CHECK(
+      asio::query(
+        asio::require(ioc.get_executor(),
+          asio::execution::priority(2)),
+        asio::execution::priority)
+      == 2);
 }
 
 void io_context_executor_execute_test()
@@ -579,6 +1134,18 @@ ASIO_TEST_SUITE
 (
   "io_context",
   ASIO_TEST_CASE(io_context_test)
+  ASIO_TEST_CASE(io_context_batch_test)
+  ASIO_TEST_CASE(io_context_budget_test)
+  ASIO_TEST_CASE(io_context_budget_run_for_test)
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  ASIO_TEST_CASE(io_context_budget_io_test)
+  ASIO_TEST_CASE(io_context_unsafe_thread_test)
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+  ASIO_TEST_CASE(io_context_spin_test)
+  ASIO_TEST_CASE(io_context_interrupt_test)
+  ASIO_TEST_CASE(io_context_cross_wakeup_test)
+  ASIO_TEST_CASE(io_context_unsafe_test)
+  ASIO_TEST_CASE(io_context_priority_test)
   ASIO_TEST_CASE(io_context_service_test)
   ASIO_TEST_CASE(io_context_executor_query_test)
   ASIO_TEST_CASE(io_context_executor_execute_test)
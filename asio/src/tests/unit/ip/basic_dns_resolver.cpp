@@ -0,0 +1,484 @@
+//
+// basic_dns_resolver.cpp
+// ~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/ip/basic_dns_resolver.hpp"
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+#include "asio/config.hpp"
+#include "asio/io_context.hpp"
+#include "asio/ip/tcp.hpp"
+#include "asio/ip/udp.hpp"
+#include "../unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+#if defined(ASIO_HAS_CHRONO)
+
+typedef asio::ip::basic_dns_resolver<asio::ip::tcp> dns_resolver;
+
+// A name server that answers queries for a fixed set of names:
+//  - www.example.com has the IPv4 address 192.0.2.1 and no IPv6 address.
+//  - dual.example.com has the addresses 192.0.2.2 and 2001:db8::2.
+//  - Any other name does not exist.
+// If it is silent, the server receives queries but does not answer them.
+class stand_in_server
+{
+public:
+  stand_in_server(asio::io_context& ctx, bool silent = false)
+    : socket_(ctx, asio::ip::udp::endpoint(
+          asio::ip::address_v4::loopback(), 0)),
+      buffer_(512),
+      silent_(silent),
+      queries_(0)
+  {
+    start_receive();
+  }
+
+  std::string config() const
+  {
+    char text[64];
+    std::sprintf(text, "dns.nameservers = 127.0.0.1:%u\n",
+        static_cast<unsigned>(socket_.local_endpoint().port()));
+    return text;
+  }
+
+  int queries() const
+  {
+    return queries_;
+  }
+
+  const std::set<unsigned short>& ids() const
+  {
+    return ids_;
+  }
+
+  const std::set<unsigned short>& ports() const
+  {
+    return ports_;
+  }
+
+private:
+  void start_receive()
+  {
+    socket_.async_receive_from(asio::buffer(buffer_), sender_,
+        bindns::bind(&stand_in_server::handle_receive, this,
+          bindns::placeholders::_1, bindns::placeholders::_2));
+  }
+
+  void handle_receive(const asio::error_code& ec, std::size_t length)
+  {
+    if (ec)
+      return;
+
+    ++queries_;
+    if (length >= 2)
+      ids_.insert(static_cast<unsigned short>((buffer_[0] << 8) | buffer_[1]));
+    ports_.insert(sender_.port());
+    if (!silent_)
+      respond(length);
+    start_receive();
+  }
+
+  void respond(std::size_t length)
+  {
+    // Extract the name and type from the question.
+    std::string name;
+    std::size_t pos = 12;
+    while (pos < length && buffer_[pos] != 0)
+    {
+      if (!name.empty())
+        name += '.';
+      name.append(reinterpret_cast<const char*>(&buffer_[pos + 1]),
+          buffer_[pos]);
+      pos += 1 + buffer_[pos];
+    }
+    int type = (buffer_[pos + 1] << 8) | buffer_[pos + 2];
+
+    std::vector<unsigned char> response(buffer_.begin(),
+        buffer_.begin() + pos + 5);
+    response[2] = 0x81;
+    response[3] = 0x80;
+
+    if (name == "www.example.com" && type == 1)
+    {
+      add_answer(response, 1, "\xC0\x00\x02\x01", 4);
+    }
+    else if (name == "dual.example.com" && type == 1)
+    {
+      add_answer(response, 1, "\xC0\x00\x02\x02", 4);
+    }
+    else if (name == "dual.example.com" && type == 28)
+    {
+      add_answer(response, 28,
+          "\x20\x01\x0D\xB8\0\0\0\0\0\0\0\0\0\0\0\x02", 16);
+    }
+    else
+    {
+      if (name != "www.example.com")
+        response[3] = 0x83;
+      add_soa(response);
+    }
+
+    socket_.send_to(asio::buffer(response), sender_);
+  }
+
+  static void add_record(std::vector<unsigned char>& response,
+      int type, const char* data, std::size_t length)
+  {
+    const unsigned char header[] = { 0xC0, 0x0C,
+      0, static_cast<unsigned char>(type), 0, 1, 0, 0, 0x01, 0x2C,
+      0, static_cast<unsigned char>(length) };
+    response.insert(response.end(), header, header + sizeof(header));
+    response.insert(response.end(), data, data + length);
+  }
+
+  static void add_answer(std::vector<unsigned char>& response,
+      int type, const char* data, std::size_t length)
+  {
+    response[7] = 1;
+    add_record(response, type, data, length);
+  }
+
+  static void add_soa(std::vector<unsigned char>& response)
+  {
+    // Root names for the server and mailbox, and a minimum TTL of 30 seconds.
+    response[9] = 1;
+    add_record(response, 6,
+        "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x1E", 22);
+  }
+
+  asio::ip::udp::socket socket_;
+  asio::ip::udp::endpoint sender_;
+  std::vector<unsigned char> buffer_;
+  bool silent_;
+  int queries_;
+  std::set<unsigned short> ids_;
+  std::set<unsigned short> ports_;
+};
+
+// Run the resolver's context until it has no more work, while also running
+// the server's context.
+void run_contexts(asio::io_context& ctx, asio::io_context& server_ctx)
+{
+  ctx.restart();
+  while (!ctx.stopped())
+  {
+    server_ctx.restart();
+    server_ctx.poll();
+    ctx.run_for(asio::chrono::milliseconds(1));
+  }
+}
+
+void resolve_handler(const asio::error_code& ec,
+    const dns_resolver::results_type& results,
+    asio::error_code* out_ec, std::vector<std::string>* out_endpoints)
+{
+  *out_ec = ec;
+  out_endpoints->clear();
+  for (dns_resolver::results_type::const_iterator iter = results.begin();
+      iter != results.end(); ++iter)
+  {
+    char port[16];
+    std::sprintf(port, ":%u", static_cast<unsigned>(iter->endpoint().port()));
+    out_endpoints->push_back(
+        iter->endpoint().address().to_string() + port);
+  }
+}
+
+#endif // defined(ASIO_HAS_CHRONO)
+
+void numeric_test()
+{
+#if defined(ASIO_HAS_CHRONO)
+  asio::io_context server_ctx;
+  stand_in_server server(server_ctx);
+  asio::io_context ctx(asio::config_from_string(server.config()));
+  dns_resolver resolver(ctx);
+
+  asio::error_code ec1 = asio::error::would_block;
+  std::vector<std::string> endpoints1;
+  resolver.async_resolve("127.0.0.1", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec1, &endpoints1));
+
+  asio::error_code ec2 = asio::error::would_block;
+  std::vector<std::string> endpoints2;
+  resolver.async_resolve(asio::ip::tcp::v4(), "::1", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec2, &endpoints2));
+
+  // The handlers must not be called before the io_context is run.
+  ASIO_CHECK(ec1 == asio::error::would_block);
+  ASIO_CHECK(ec2 == asio::error::would_block);
+
+  run_contexts(ctx, server_ctx);
+
+  ASIO_CHECK(!ec1);
+  ASIO_CHECK(endpoints1.size() == 1);
+  ASIO_CHECK(endpoints1.size() == 1 && endpoints1[0] == "127.0.0.1:80");
+  ASIO_CHECK(ec2 == asio::error::host_not_found);
+  ASIO_CHECK(endpoints2.empty());
+  ASIO_CHECK(server.queries() == 0);
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+void query_test()
+{
+#if defined(ASIO_HAS_CHRONO)
+  asio::io_context server_ctx;
+  stand_in_server server(server_ctx);
+  asio::io_context ctx(asio::config_from_string(server.config()));
+
+  dns_resolver resolver1(ctx);
+  asio::error_code ec = asio::error::would_block;
+  std::vector<std::string> endpoints;
+  resolver1.async_resolve("WWW.Example.com.", "8080",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &endpoints));
+
+  run_contexts(ctx, server_ctx);
+
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(endpoints.size() == 1);
+  ASIO_CHECK(endpoints.size() == 1 && endpoints[0] == "192.0.2.1:8080");
+  ASIO_CHECK(server.queries() == 2);
+
+  // Both answers are cached and shared with other resolvers.
+  dns_resolver resolver2(ctx);
+  ec = asio::error::would_block;
+  resolver2.async_resolve("www.example.com", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &endpoints));
+
+  run_contexts(ctx, server_ctx);
+
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(endpoints.size() == 1);
+  ASIO_CHECK(endpoints.size() == 1 && endpoints[0] == "192.0.2.1:80");
+  ASIO_CHECK(server.queries() == 2);
+
+  // IPv6 addresses are listed first.
+  ec = asio::error::would_block;
+  resolver2.async_resolve("dual.example.com", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &endpoints));
+
+  run_contexts(ctx, server_ctx);
+
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(endpoints.size() == 2);
+  ASIO_CHECK(endpoints.size() == 2 && endpoints[0] == "2001:db8::2:80");
+  ASIO_CHECK(endpoints.size() == 2 && endpoints[1] == "192.0.2.2:80");
+  ASIO_CHECK(server.queries() == 4);
+
+  // Only the requested address type is queried.
+  ec = asio::error::would_block;
+  resolver2.async_resolve(asio::ip::tcp::v6(), "www.example.com", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &endpoints));
+
+  run_contexts(ctx, server_ctx);
+
+  ASIO_CHECK(ec == asio::error::no_data);
+  ASIO_CHECK(endpoints.empty());
+  ASIO_CHECK(server.queries() == 4);
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+void negative_cache_test()
+{
+#if defined(ASIO_HAS_CHRONO)
+  asio::io_context server_ctx;
+  stand_in_server server(server_ctx);
+  asio::io_context ctx(asio::config_from_string(server.config()));
+  dns_resolver resolver(ctx);
+
+  asio::error_code ec = asio::error::would_block;
+  std::vector<std::string> endpoints;
+  resolver.async_resolve("missing.example.com", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &endpoints));
+
+  run_contexts(ctx, server_ctx);
+
+  ASIO_CHECK(ec == asio::error::host_not_found);
+  ASIO_CHECK(endpoints.empty());
+  int queries = server.queries();
+  ASIO_CHECK(queries >= 1 && queries <= 2);
+
+  ec = asio::error::would_block;
+  resolver.async_resolve("missing.example.com", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &endpoints));
+
+  run_contexts(ctx, server_ctx);
+
+  ASIO_CHECK(ec == asio::error::host_not_found);
+  ASIO_CHECK(server.queries() == queries);
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+void query_id_test()
+{
+#if defined(ASIO_HAS_CHRONO)
+  asio::io_context server_ctx;
+  stand_in_server server(server_ctx);
+  asio::io_context ctx(asio::config_from_string(server.config()));
+  dns_resolver resolver(ctx);
+
+  const int lookups = 8;
+  for (int i = 0; i < lookups; ++i)
+  {
+    char name[32];
+    std::sprintf(name, "missing%d.example.com", i);
+    asio::error_code ec = asio::error::would_block;
+    std::vector<std::string> endpoints;
+    resolver.async_resolve(name, "80",
+        bindns::bind(resolve_handler, bindns::placeholders::_1,
+          bindns::placeholders::_2, &ec, &endpoints));
+
+    run_contexts(ctx, server_ctx);
+
+    ASIO_CHECK(ec == asio::error::host_not_found);
+  }
+
+  // Each lookup uses its own source port, and the identifiers are not
+  // repeated. A collision between random ports or identifiers is possible,
+  // but unlikely enough for more than one to suggest a predictable choice.
+  ASIO_CHECK(server.queries() >= lookups);
+  ASIO_CHECK(server.ports().size() + 1 >= static_cast<std::size_t>(lookups));
+  ASIO_CHECK(server.ids().size() + 1 >=
+      static_cast<std::size_t>(server.queries()));
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+void hosts_file_test()
+{
+#if defined(ASIO_HAS_CHRONO)
+  const char* path = "basic_dns_resolver_hosts.tmp";
+  if (std::FILE* file = std::fopen(path, "w"))
+  {
+    std::fputs("# Test hosts file\n"
+        "10.1.2.3   www.example.com  alias # comment\n"
+        "fe80::1    alias\n", file);
+    std::fclose(file);
+  }
+
+  asio::io_context server_ctx;
+  stand_in_server server(server_ctx);
+  asio::io_context ctx(asio::config_from_string(
+        server.config() + "dns.hosts = " + path + "\n"));
+  dns_resolver resolver(ctx);
+
+  asio::error_code ec1 = asio::error::would_block;
+  std::vector<std::string> endpoints1;
+  resolver.async_resolve("www.example.com", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec1, &endpoints1));
+
+  asio::error_code ec2 = asio::error::would_block;
+  std::vector<std::string> endpoints2;
+  resolver.async_resolve(asio::ip::tcp::v4(), "ALIAS", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec2, &endpoints2));
+
+  run_contexts(ctx, server_ctx);
+  std::remove(path);
+
+  ASIO_CHECK(!ec1);
+  ASIO_CHECK(endpoints1.size() == 1);
+  ASIO_CHECK(endpoints1.size() == 1 && endpoints1[0] == "10.1.2.3:80");
+  ASIO_CHECK(!ec2);
+  ASIO_CHECK(endpoints2.size() == 1);
+  ASIO_CHECK(endpoints2.size() == 1 && endpoints2[0] == "10.1.2.3:80");
+  ASIO_CHECK(server.queries() == 0);
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+void timeout_test()
+{
+#if defined(ASIO_HAS_CHRONO)
+  asio::io_context server_ctx;
+  stand_in_server server(server_ctx, true);
+  asio::io_context ctx(asio::config_from_string(server.config()
+        + "dns.timeout_ms = 20\n"
+        + "dns.attempts = 2\n"));
+  dns_resolver resolver(ctx);
+
+  asio::error_code ec = asio::error::would_block;
+  std::vector<std::string> endpoints;
+  resolver.async_resolve(asio::ip::tcp::v4(), "www.example.com", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &endpoints));
+
+  run_contexts(ctx, server_ctx);
+
+  ASIO_CHECK(ec == asio::error::host_not_found_try_again);
+  ASIO_CHECK(endpoints.empty());
+  ASIO_CHECK(server.queries() == 2);
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+void cancel_test()
+{
+#if defined(ASIO_HAS_CHRONO)
+  asio::io_context server_ctx;
+  stand_in_server server(server_ctx, true);
+  asio::io_context ctx(asio::config_from_string(server.config()));
+  dns_resolver resolver(ctx);
+
+  asio::error_code ec = asio::error::would_block;
+  std::vector<std::string> endpoints;
+  resolver.async_resolve("www.example.com", "80",
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &endpoints));
+
+  resolver.cancel();
+
+  // The handler must not be called from within cancel().
+  ASIO_CHECK(ec == asio::error::would_block);
+
+  run_contexts(ctx, server_ctx);
+
+  ASIO_CHECK(ec == asio::error::operation_aborted);
+  ASIO_CHECK(endpoints.empty());
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+ASIO_TEST_SUITE
+(
+  "ip/basic_dns_resolver",
+  ASIO_TEST_CASE(numeric_test)
+  ASIO_TEST_CASE(query_test)
+  ASIO_TEST_CASE(negative_cache_test)
+  ASIO_TEST_CASE(query_id_test)
+  ASIO_TEST_CASE(hosts_file_test)
+  ASIO_TEST_CASE(timeout_test)
+  ASIO_TEST_CASE(cancel_test)
+)
@@ -20,8 +20,11 @@
 #include "asio/ip/tcp.hpp"
 
 #include <cstring>
+#include <vector>
+#include "asio/config.hpp"
 #include "asio/io_context.hpp"
 #include "asio/read.hpp"
+#include "asio/thread.hpp"
 #include "asio/write.hpp"
 #include "../unit_test.hpp"
 #include "../archetypes/async_result.hpp"
@@ -572,6 +575,14 @@ void handle_write(const asio::error_code& err,
   ASIO_CHECK(bytes_transferred == sizeof(write_data));
 }
 
+void handle_gather_write(const asio::error_code& err,
+    size_t bytes_transferred, size_t* bytes_written, bool* called)
+{
+  *called = true;
+  ASIO_CHECK(!err);
+  *bytes_written = bytes_transferred;
+}
+
 void handle_read_cancel(const asio::error_code& err,
     size_t bytes_transferred, bool* called)
 {
@@ -658,6 +669,33 @@ void test()
   ASIO_CHECK(write_completed);
   ASIO_CHECK(memcmp(read_buffer, write_data, sizeof(write_data)) == 0);
 
+  // Gathered write of more buffers than are passed to a single system call.
+
+  const size_t gather_count = 200;
+  std::vector<asio::const_buffer> gather_buffers;
+  for (size_t i = 0; i < gather_count; ++i)
+    gather_buffers.push_back(asio::buffer(write_data + i % 26, 26));
+
+  size_t gather_bytes_written = 0;
+  bool gather_write_completed = false;
+  server_side_socket.async_write_some(gather_buffers,
+      bindns::bind(handle_gather_write,
+        _1, _2, &gather_bytes_written, &gather_write_completed));
+
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(gather_write_completed);
+#if !defined(ASIO_HAS_IOCP) && !defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+  ASIO_CHECK(gather_bytes_written == gather_count * 26);
+#else // !defined(ASIO_HAS_IOCP) && !defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+  ASIO_CHECK(gather_bytes_written > 0);
+#endif // !defined(ASIO_HAS_IOCP) && !defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+
+  std::vector<char> gather_read_buffer(gather_bytes_written);
+  asio::read(client_side_socket, asio::buffer(gather_read_buffer));
+  for (size_t i = 0; i < gather_bytes_written; ++i)
+    ASIO_CHECK(gather_read_buffer[i] == write_data[(i / 26) % 26 + i % 26]);
+
   // Cancelled read.
 
   bool read_cancel_completed = false;
@@ -1025,6 +1063,174 @@ void test()
 
 //------------------------------------------------------------------------------
 
+// ip_tcp_sharded_runtime test
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The following test checks the runtime operation of TCP sockets when the
+// reactor is divided into shards and run from multiple threads.
+
+namespace ip_tcp_sharded_runtime {
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif // defined(ASIO_HAS_BOOST_BIND)
+using bindns::placeholders::_1;
+using bindns::placeholders::_2;
+
+const int num_rounds = 100;
+
+class echo_session
+{
+public:
+  explicit echo_session(asio::io_context& ioc)
+    : client_(ioc),
+      server_(ioc),
+      rounds_(0)
+  {
+  }
+
+  void start(asio::ip::tcp::acceptor& acceptor,
+      const asio::ip::tcp::endpoint& endpoint)
+  {
+    acceptor.async_accept(server_,
+        bindns::bind(&echo_session::handle_accept, this, _1));
+    client_.async_connect(endpoint,
+        bindns::bind(&echo_session::handle_connect, this, _1));
+  }
+
+  int rounds() const
+  {
+    return rounds_;
+  }
+
+private:
+  void handle_accept(const asio::error_code& err)
+  {
+    ASIO_CHECK(!err);
+    if (!err)
+      start_server_read();
+  }
+
+  void handle_connect(const asio::error_code& err)
+  {
+    ASIO_CHECK(!err);
+    if (!err)
+      start_round();
+  }
+
+  void start_round()
+  {
+    std::memset(client_data_, 'a' + rounds_ % 26, sizeof(client_data_));
+    asio::async_write(client_, asio::buffer(client_data_),
+        bindns::bind(&echo_session::handle_client_write, this, _1, _2));
+  }
+
+  void handle_client_write(const asio::error_code& err, std::size_t)
+  {
+    ASIO_CHECK(!err);
+    if (!err)
+    {
+      asio::async_read(client_, asio::buffer(echo_data_),
+          bindns::bind(&echo_session::handle_client_read, this, _1, _2));
+    }
+  }
+
+  void handle_client_read(const asio::error_code& err, std::size_t)
+  {
+    ASIO_CHECK(!err);
+    ASIO_CHECK(std::memcmp(client_data_, echo_data_, sizeof(echo_data_)) == 0);
+    if (!err && ++rounds_ < num_rounds)
+      start_round();
+    else
+      client_.close();
+  }
+
+  void start_server_read()
+  {
+    asio::async_read(server_, asio::buffer(server_data_),
+        bindns::bind(&echo_session::handle_server_read, this, _1, _2));
+  }
+
+  void handle_server_read(const asio::error_code& err, std::size_t)
+  {
+    if (err)
+    {
+      ASIO_CHECK(err == asio::error::eof);
+      server_.close();
+      return;
+    }
+
+    asio::async_write(server_, asio::buffer(server_data_),
+        bindns::bind(&echo_session::handle_server_write, this, _1, _2));
+  }
+
+  void handle_server_write(const asio::error_code& err, std::size_t)
+  {
+    ASIO_CHECK(!err);
+    if (!err)
+      start_server_read();
+  }
+
+  asio::ip::tcp::socket client_;
+  asio::ip::tcp::socket server_;
+  char client_data_[256];
+  char server_data_[256];
+  char echo_data_[256];
+  int rounds_;
+};
+
+void run_context(asio::io_context* ioc)
+{
+  ioc->run();
+}
+
+void run_sessions(const char* configuration)
+{
+  using namespace asio;
+  namespace ip = asio::ip;
+
+  config_from_string config(configuration);
+  io_context ioc(config);
+
+  ip::tcp::acceptor acceptor(ioc, ip::tcp::endpoint(ip::tcp::v4(), 0));
+  ip::tcp::endpoint server_endpoint = acceptor.local_endpoint();
+  server_endpoint.address(ip::address_v4::loopback());
+
+  // Each session's accept is queued in turn, so the sessions are started one
+  // at a time from the handlers.
+  const int num_sessions = 16;
+  echo_session* sessions[num_sessions];
+  for (int i = 0; i < num_sessions; ++i)
+    sessions[i] = new echo_session(ioc);
+  for (int i = 0; i < num_sessions; ++i)
+    sessions[i]->start(acceptor, server_endpoint);
+
+  asio::thread t1(bindns::bind(run_context, &ioc));
+  asio::thread t2(bindns::bind(run_context, &ioc));
+  asio::thread t3(bindns::bind(run_context, &ioc));
+  ioc.run();
+  t1.join();
+  t2.join();
+  t3.join();
+
+  for (int i = 0; i < num_sessions; ++i)
+  {
+    ASIO_CHECK(sessions[i]->rounds() == num_rounds);
+    delete sessions[i];
+  }
+}
+
+void test()
+{
+  run_sessions("reactor.shards = 4\n");
+  run_sessions("reactor.shards = 3\nreactor.shard_by_thread = true\n");
+}
+
+} // namespace ip_tcp_sharded_runtime
+
+//------------------------------------------------------------------------------
+
 // ip_tcp_resolver_compile test
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // The following test checks that all public member functions on the class
@@ -1344,6 +1550,7 @@ ASIO_TEST_SUITE
   ASIO_TEST_CASE(ip_tcp_socket_runtime::test)
   ASIO_COMPILE_TEST_CASE(ip_tcp_acceptor_compile::test)
   ASIO_TEST_CASE(ip_tcp_acceptor_runtime::test)
+  ASIO_TEST_CASE(ip_tcp_sharded_runtime::test)
   ASIO_COMPILE_TEST_CASE(ip_tcp_resolver_compile::test)
   ASIO_COMPILE_TEST_CASE(ip_tcp_resolver_entry_compile::test)
   ASIO_COMPILE_TEST_CASE(ip_tcp_resolver_entry_compile::test)
@@ -0,0 +1,285 @@
+//
+// offload.cpp
+// ~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/offload.hpp"
+
+#include "asio/config.hpp"
+#include "asio/detail/event.hpp"
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/throw_error.hpp"
+#include "asio/io_context.hpp"
+#include "asio/ip/tcp.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+using namespace asio;
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+int return_value(int value)
+{
+  return value;
+}
+
+void increment(int* count)
+{
+  ++(*count);
+}
+
+int throw_system_error()
+{
+  asio::detail::throw_error(asio::error::access_denied);
+  return 1;
+}
+
+struct test_exception {};
+
+void throw_test_exception()
+{
+  throw test_exception();
+}
+
+struct blocking_latch
+{
+  asio::detail::mutex mutex_;
+  asio::detail::event event_;
+};
+
+int wait_latch(blocking_latch* latch)
+{
+  asio::detail::mutex::scoped_lock lock(latch->mutex_);
+  latch->event_.wait(lock);
+  return 1;
+}
+
+void open_latch(blocking_latch* latch)
+{
+  asio::detail::mutex::scoped_lock lock(latch->mutex_);
+  latch->event_.signal_all(lock);
+}
+
+void value_handler(const asio::error_code& ec, int value,
+    asio::error_code* out_ec, int* out_value)
+{
+  *out_ec = ec;
+  *out_value = value;
+}
+
+void void_handler(const asio::error_code& ec, asio::error_code* out_ec)
+{
+  *out_ec = ec;
+}
+
+void resolve_handler(const asio::error_code& ec,
+    const asio::ip::tcp::resolver::results_type& results,
+    asio::error_code* out_ec, std::size_t* out_size)
+{
+  *out_ec = ec;
+  *out_size = results.size();
+}
+
+void offload_test()
+{
+#if defined(ASIO_HAS_THREADS)
+  io_context ctx;
+
+  asio::error_code ec1 = asio::error::would_block;
+  int value = 0;
+  offload(ctx.get_executor(), bindns::bind(return_value, 42),
+      bindns::bind(value_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec1, &value));
+
+  asio::error_code ec2 = asio::error::would_block;
+  int count = 0;
+  offload(ctx, bindns::bind(increment, &count),
+      bindns::bind(void_handler, bindns::placeholders::_1, &ec2));
+
+  // The handlers must not be called before the io_context is run.
+  ASIO_CHECK(value == 0);
+  ASIO_CHECK(ec1 == asio::error::would_block);
+  ASIO_CHECK(ec2 == asio::error::would_block);
+
+  ctx.run();
+
+  ASIO_CHECK(!ec1);
+  ASIO_CHECK(value == 42);
+  ASIO_CHECK(!ec2);
+  ASIO_CHECK(count == 1);
+
+  offload_statistics stats = get_offload_statistics(ctx);
+  ASIO_CHECK(stats.threads >= 1);
+  ASIO_CHECK(stats.threads <= 4);
+  ASIO_CHECK(stats.submitted == 2);
+  ASIO_CHECK(stats.rejected == 0);
+#endif // defined(ASIO_HAS_THREADS)
+}
+
+void offload_queue_limit_test()
+{
+#if defined(ASIO_HAS_THREADS)
+  io_context ctx(
+      config_from_string(
+        "offload.max_threads = 1\n"
+        "offload.max_queued = 1\n"));
+
+  // The first function occupies the only thread, the second waits for it, and
+  // the third is rejected.
+  blocking_latch latch;
+  asio::error_code ec1, ec2, ec3;
+  int value1 = 0, value2 = 0, value3 = -1;
+  offload(ctx, bindns::bind(wait_latch, &latch),
+      bindns::bind(value_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec1, &value1));
+  offload(ctx, bindns::bind(return_value, 2),
+      bindns::bind(value_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec2, &value2));
+  offload(ctx, bindns::bind(return_value, 3),
+      bindns::bind(value_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec3, &value3));
+
+  offload_statistics stats = get_offload_statistics(ctx);
+  ASIO_CHECK(stats.threads == 1);
+  ASIO_CHECK(stats.peak_queued == 1);
+  ASIO_CHECK(stats.submitted == 2);
+  ASIO_CHECK(stats.rejected == 1);
+
+  open_latch(&latch);
+  ctx.run();
+
+  ASIO_CHECK(!ec1);
+  ASIO_CHECK(value1 == 1);
+  ASIO_CHECK(!ec2);
+  ASIO_CHECK(value2 == 2);
+  ASIO_CHECK(ec3 == asio::error::try_again);
+  ASIO_CHECK(value3 == 0);
+
+  stats = get_offload_statistics(ctx);
+  ASIO_CHECK(stats.threads == 1);
+  ASIO_CHECK(stats.peak_threads == 1);
+#endif // defined(ASIO_HAS_THREADS)
+}
+
+void offload_exception_test()
+{
+#if defined(ASIO_HAS_THREADS) && !defined(ASIO_NO_EXCEPTIONS)
+  io_context ctx;
+
+  // The error code from a system_error is passed to the handler.
+  asio::error_code ec1;
+  int value = -1;
+  offload(ctx, throw_system_error,
+      bindns::bind(value_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec1, &value));
+
+  ctx.run();
+
+  ASIO_CHECK(ec1 == asio::error::access_denied);
+  ASIO_CHECK(value == 0);
+
+# if defined(ASIO_HAS_STD_EXCEPTION_PTR)
+  // Other exceptions are rethrown from the io_context, in place of calling
+  // the handler.
+  asio::error_code ec2 = asio::error::would_block;
+  offload(ctx, throw_test_exception,
+      bindns::bind(void_handler, bindns::placeholders::_1, &ec2));
+
+  ctx.restart();
+  bool caught = false;
+  try
+  {
+    ctx.run();
+  }
+  catch (const test_exception&)
+  {
+    caught = true;
+  }
+
+  ASIO_CHECK(caught);
+  ASIO_CHECK(ec2 == asio::error::would_block);
+
+  offload_statistics stats = get_offload_statistics(ctx);
+  ASIO_CHECK(stats.submitted == 2);
+# endif // defined(ASIO_HAS_STD_EXCEPTION_PTR)
+#endif // defined(ASIO_HAS_THREADS) && !defined(ASIO_NO_EXCEPTIONS)
+}
+
+void offload_unsafe_test()
+{
+#if defined(ASIO_HAS_THREADS)
+  // The completion cannot be posted from an offload thread.
+  io_context ctx(ASIO_CONCURRENCY_HINT_UNSAFE);
+
+  asio::error_code ec;
+  int value = -1;
+  offload(ctx, bindns::bind(return_value, 1),
+      bindns::bind(value_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &value));
+
+  ctx.run();
+
+  ASIO_CHECK(ec == asio::error::operation_not_supported);
+  ASIO_CHECK(value == 0);
+
+  offload_statistics stats = get_offload_statistics(ctx);
+  ASIO_CHECK(stats.threads == 0);
+  ASIO_CHECK(stats.submitted == 0);
+#endif // defined(ASIO_HAS_THREADS)
+}
+
+void offload_resolver_test()
+{
+#if defined(ASIO_HAS_THREADS)
+  io_context ctx;
+  asio::ip::tcp::resolver resolver(ctx);
+
+  asio::error_code ec = asio::error::would_block;
+  std::size_t size = 0;
+  resolver.async_resolve("127.0.0.1", "80",
+      asio::ip::tcp::resolver::numeric_host
+        | asio::ip::tcp::resolver::numeric_service,
+      bindns::bind(resolve_handler, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &size));
+
+  ctx.run();
+
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(size > 0);
+
+  // Host name resolution uses the same threads as offload().
+  offload_statistics stats = get_offload_statistics(ctx);
+  ASIO_CHECK(stats.threads == 1);
+  ASIO_CHECK(stats.submitted == 1);
+#endif // defined(ASIO_HAS_THREADS)
+}
+
+ASIO_TEST_SUITE
+(
+  "offload",
+  ASIO_TEST_CASE(offload_test)
+  ASIO_TEST_CASE(offload_queue_limit_test)
+  ASIO_TEST_CASE(offload_exception_test)
+  ASIO_TEST_CASE(offload_unsafe_test)
+  ASIO_TEST_CASE(offload_resolver_test)
+)
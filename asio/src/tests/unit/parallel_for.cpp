@@ -0,0 +1,197 @@
+//
+// parallel_for.cpp
+// ~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/parallel_for.hpp"
+
+#include <vector>
+#include "asio/io_context.hpp"
+#include "asio/thread_pool.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+using namespace asio;
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+void mark_index(std::vector<int>* marks, std::size_t i)
+{
+  ++(*marks)[i];
+}
+
+void increment(int* count)
+{
+  ++(*count);
+}
+
+struct test_exception {};
+
+void mark_index_or_throw(std::vector<int>* marks, std::size_t i)
+{
+  if (i == 3)
+    throw test_exception();
+  ++(*marks)[i];
+}
+
+void parallel_for_thread_pool_test()
+{
+  using bindns::placeholders::_1;
+
+  thread_pool pool(4);
+
+  std::vector<int> marks(10000);
+  int completions = 0;
+  asio::parallel_for(pool, marks.size(),
+      bindns::bind(mark_index, &marks, _1),
+      bindns::bind(increment, &completions));
+
+  std::vector<int> small_marks(2);
+  int small_completions = 0;
+  asio::parallel_for(pool.get_executor(), small_marks.size(),
+      bindns::bind(mark_index, &small_marks, _1),
+      bindns::bind(increment, &small_completions));
+
+  pool.wait();
+
+  for (std::size_t i = 0; i < marks.size(); ++i)
+    ASIO_CHECK(marks[i] == 1);
+  ASIO_CHECK(completions == 1);
+
+  for (std::size_t i = 0; i < small_marks.size(); ++i)
+    ASIO_CHECK(small_marks[i] == 1);
+  ASIO_CHECK(small_completions == 1);
+}
+
+void parallel_for_io_context_test()
+{
+  using bindns::placeholders::_1;
+
+  io_context ioc;
+
+  std::vector<int> marks(100);
+  int completions = 0;
+  asio::parallel_for(ioc, marks.size(),
+      bindns::bind(mark_index, &marks, _1),
+      bindns::bind(increment, &completions));
+
+  // The completion handler must not be called from the initiating function.
+  ASIO_CHECK(completions == 0);
+  ASIO_CHECK(marks[0] == 0);
+
+  ioc.run();
+
+  for (std::size_t i = 0; i < marks.size(); ++i)
+    ASIO_CHECK(marks[i] == 1);
+  ASIO_CHECK(completions == 1);
+}
+
+void parallel_for_empty_range_test()
+{
+  using bindns::placeholders::_1;
+
+  io_context ioc;
+
+  std::vector<int> marks(1);
+  int completions = 0;
+  asio::parallel_for(ioc.get_executor(), 0,
+      bindns::bind(mark_index, &marks, _1),
+      bindns::bind(increment, &completions));
+
+  ASIO_CHECK(completions == 0);
+
+  ioc.run();
+
+  ASIO_CHECK(marks[0] == 0);
+  ASIO_CHECK(completions == 1);
+}
+
+void parallel_for_abandoned_test()
+{
+  using bindns::placeholders::_1;
+
+  std::vector<int> marks(10);
+  int completions = 0;
+
+  {
+    io_context ioc;
+    asio::parallel_for(ioc, marks.size(),
+        bindns::bind(mark_index, &marks, _1),
+        bindns::bind(increment, &completions));
+  }
+
+  // Destroying the io_context destroys the workers without running them, and
+  // the completion handler is not called.
+  for (std::size_t i = 0; i < marks.size(); ++i)
+    ASIO_CHECK(marks[i] == 0);
+  ASIO_CHECK(completions == 0);
+}
+
+void parallel_for_exception_test()
+{
+#if defined(ASIO_HAS_STD_EXCEPTION_PTR) && !defined(ASIO_NO_EXCEPTIONS)
+  using bindns::placeholders::_1;
+
+  io_context ioc;
+
+  std::vector<int> marks(1000);
+  int completions = 0;
+  asio::parallel_for(ioc, marks.size(),
+      bindns::bind(mark_index_or_throw, &marks, _1),
+      bindns::bind(increment, &completions));
+
+  // The exception is rethrown from the io_context, in place of calling the
+  // completion handler.
+  bool caught = false;
+  try
+  {
+    ioc.run();
+  }
+  catch (const test_exception&)
+  {
+    caught = true;
+  }
+
+  ASIO_CHECK(caught);
+  ASIO_CHECK(completions == 0);
+
+  // The indices that had not been claimed are abandoned.
+  ASIO_CHECK(marks[0] == 1);
+  ASIO_CHECK(marks[3] == 0);
+  ASIO_CHECK(marks[marks.size() - 1] == 0);
+
+  // No work remains.
+  ioc.restart();
+  ASIO_CHECK(ioc.run() == 0);
+#endif // defined(ASIO_HAS_STD_EXCEPTION_PTR) && !defined(ASIO_NO_EXCEPTIONS)
+}
+
+ASIO_TEST_SUITE
+(
+  "parallel_for",
+  ASIO_TEST_CASE(parallel_for_thread_pool_test)
+  ASIO_TEST_CASE(parallel_for_io_context_test)
+  ASIO_TEST_CASE(parallel_for_empty_range_test)
+  ASIO_TEST_CASE(parallel_for_abandoned_test)
+  ASIO_TEST_CASE(parallel_for_exception_test)
+)
@@ -0,0 +1,170 @@
+//
+// parallel_reduce.cpp
+// ~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/parallel_reduce.hpp"
+
+#include "asio/bind_executor.hpp"
+#include "asio/io_context.hpp"
+#include "asio/thread_pool.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+using namespace asio;
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+unsigned long square(std::size_t i)
+{
+  return static_cast<unsigned long>(i * i);
+}
+
+unsigned long add(unsigned long a, unsigned long b)
+{
+  return a + b;
+}
+
+unsigned long maximum(unsigned long a, unsigned long b)
+{
+  return a > b ? a : b;
+}
+
+void store_result(unsigned long* result, int* count, unsigned long value)
+{
+  *result = value;
+  ++(*count);
+}
+
+struct test_exception {};
+
+unsigned long square_or_throw(std::size_t i)
+{
+  if (i == 3)
+    throw test_exception();
+  return static_cast<unsigned long>(i * i);
+}
+
+void parallel_reduce_thread_pool_test()
+{
+  using bindns::placeholders::_1;
+
+  thread_pool pool(4);
+
+  unsigned long sum = 0;
+  int sum_count = 0;
+  asio::parallel_reduce(pool, 1000, 7ul, square, add,
+      bindns::bind(store_result, &sum, &sum_count, _1));
+
+  unsigned long max = 0;
+  int max_count = 0;
+  asio::parallel_reduce(pool.get_executor(), 1000, 0ul, square, maximum,
+      bindns::bind(store_result, &max, &max_count, _1));
+
+  pool.wait();
+
+  ASIO_CHECK(sum == 7ul + 999ul * 1000ul * 1999ul / 6ul);
+  ASIO_CHECK(sum_count == 1);
+  ASIO_CHECK(max == 999ul * 999ul);
+  ASIO_CHECK(max_count == 1);
+}
+
+void parallel_reduce_io_context_test()
+{
+  using bindns::placeholders::_1;
+
+  io_context ioc;
+
+  unsigned long sum = 0;
+  int count = 0;
+  asio::parallel_reduce(ioc, 10, 0ul, square, add,
+      bindns::bind(store_result, &sum, &count, _1));
+
+  // The completion handler must not be called from the initiating function.
+  ASIO_CHECK(count == 0);
+
+  ioc.run();
+
+  ASIO_CHECK(sum == 285);
+  ASIO_CHECK(count == 1);
+}
+
+void parallel_reduce_empty_range_test()
+{
+  using bindns::placeholders::_1;
+
+  io_context ioc;
+
+  unsigned long result = 0;
+  int count = 0;
+  asio::parallel_reduce(ioc.get_executor(), 0, 42ul, square, add,
+      bindns::bind(store_result, &result, &count, _1));
+
+  ioc.run();
+
+  ASIO_CHECK(result == 42);
+  ASIO_CHECK(count == 1);
+}
+
+void parallel_reduce_exception_test()
+{
+#if defined(ASIO_HAS_STD_EXCEPTION_PTR) && !defined(ASIO_NO_EXCEPTIONS)
+  using bindns::placeholders::_1;
+
+  thread_pool pool(4);
+  io_context ioc;
+
+  // The workers run in the pool, and the exception is rethrown from the
+  // io_context, in place of calling the completion handler.
+  unsigned long result = 0;
+  int count = 0;
+  asio::parallel_reduce(pool, 1000, 0ul, square_or_throw, add,
+      asio::bind_executor(ioc,
+        bindns::bind(store_result, &result, &count, _1)));
+
+  bool caught = false;
+  try
+  {
+    ioc.run();
+  }
+  catch (const test_exception&)
+  {
+    caught = true;
+  }
+
+  pool.join();
+
+  ASIO_CHECK(caught);
+  ASIO_CHECK(result == 0);
+  ASIO_CHECK(count == 0);
+#endif // defined(ASIO_HAS_STD_EXCEPTION_PTR) && !defined(ASIO_NO_EXCEPTIONS)
+}
+
+ASIO_TEST_SUITE
+(
+  "parallel_reduce",
+  ASIO_TEST_CASE(parallel_reduce_thread_pool_test)
+  ASIO_TEST_CASE(parallel_reduce_io_context_test)
+  ASIO_TEST_CASE(parallel_reduce_empty_range_test)
+  ASIO_TEST_CASE(parallel_reduce_exception_test)
+)
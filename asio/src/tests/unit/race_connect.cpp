@@ -0,0 +1,248 @@
+//
+// race_connect.cpp
+// ~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/race_connect.hpp"
+
+#include <vector>
+#include "asio/bind_cancellation_slot.hpp"
+#include "asio/cancellation_signal.hpp"
+#include "asio/io_context.hpp"
+#include "asio/ip/tcp.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif // defined(ASIO_HAS_BOOST_BIND)
+using bindns::placeholders::_1;
+using bindns::placeholders::_2;
+
+#if defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
+
+void connect_handler(const asio::error_code& err,
+    const asio::ip::tcp::endpoint& endpoint,
+    asio::error_code* out_err, asio::ip::tcp::endpoint* out_endpoint)
+{
+  *out_err = err;
+  *out_endpoint = endpoint;
+}
+
+// Returns a loopback endpoint on which nothing is listening.
+asio::ip::tcp::endpoint refusing_endpoint(asio::io_context& ioc)
+{
+  asio::ip::tcp::acceptor acceptor(ioc,
+      asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  asio::ip::tcp::endpoint endpoint = acceptor.local_endpoint();
+  acceptor.close();
+  return endpoint;
+}
+
+void test_interleave()
+{
+  using asio::ip::tcp;
+  using asio::ip::address_v4;
+  using asio::ip::address_v6;
+
+  std::vector<tcp::endpoint> endpoints;
+  endpoints.push_back(tcp::endpoint(address_v6::loopback(), 1));
+  endpoints.push_back(tcp::endpoint(address_v6::loopback(), 2));
+  endpoints.push_back(tcp::endpoint(address_v6::loopback(), 3));
+  endpoints.push_back(tcp::endpoint(address_v4::loopback(), 4));
+  endpoints.push_back(tcp::endpoint(address_v4::loopback(), 5));
+
+  asio::detail::interleave_address_families(endpoints);
+
+  ASIO_CHECK(endpoints.size() == 5);
+  ASIO_CHECK(endpoints[0].port() == 1);
+  ASIO_CHECK(endpoints[1].port() == 4);
+  ASIO_CHECK(endpoints[2].port() == 2);
+  ASIO_CHECK(endpoints[3].port() == 5);
+  ASIO_CHECK(endpoints[4].port() == 3);
+}
+
+void test_empty()
+{
+  asio::io_context ioc;
+  asio::ip::tcp::socket socket(ioc);
+  std::vector<asio::ip::tcp::endpoint> endpoints;
+  asio::error_code ec;
+  asio::ip::tcp::endpoint result;
+
+  asio::async_race_connect(socket, endpoints,
+      bindns::bind(connect_handler, _1, _2, &ec, &result));
+
+  ioc.restart();
+  ioc.run();
+
+  ASIO_CHECK(ec == asio::error::not_found);
+  ASIO_CHECK(result == asio::ip::tcp::endpoint());
+  ASIO_CHECK(!socket.is_open());
+}
+
+void test_race()
+{
+  asio::io_context ioc;
+  asio::ip::tcp::acceptor acceptor(ioc,
+      asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  asio::ip::tcp::socket socket(ioc);
+  std::vector<asio::ip::tcp::endpoint> endpoints;
+  asio::error_code ec;
+  asio::ip::tcp::endpoint result;
+
+  // The first attempt fails, which starts the second without waiting for the
+  // (very long) attempt delay.
+  endpoints.push_back(refusing_endpoint(ioc));
+  endpoints.push_back(acceptor.local_endpoint());
+
+  asio::async_race_connect(socket, endpoints,
+      asio::chrono::seconds(60),
+      bindns::bind(connect_handler, _1, _2, &ec, &result));
+
+  ioc.restart();
+  ioc.run();
+
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(result == acceptor.local_endpoint());
+  ASIO_CHECK(socket.is_open());
+  ASIO_CHECK(socket.remote_endpoint(ec) == acceptor.local_endpoint());
+
+  // The existing socket is replaced by the winning attempt.
+  endpoints.clear();
+  endpoints.push_back(acceptor.local_endpoint());
+
+  asio::async_race_connect(socket, endpoints,
+      bindns::bind(connect_handler, _1, _2, &ec, &result));
+
+  ioc.restart();
+  ioc.run();
+
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(result == acceptor.local_endpoint());
+  ASIO_CHECK(socket.is_open());
+
+  // With no attempt delay, the attempts run in parallel and either may win.
+  asio::ip::tcp::acceptor acceptor2(ioc,
+      asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  endpoints.clear();
+  endpoints.push_back(acceptor.local_endpoint());
+  endpoints.push_back(acceptor2.local_endpoint());
+
+  asio::async_race_connect(socket, endpoints,
+      asio::chrono::steady_clock::duration::zero(),
+      bindns::bind(connect_handler, _1, _2, &ec, &result));
+
+  ioc.restart();
+  ioc.run();
+
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(result == acceptor.local_endpoint()
+      || result == acceptor2.local_endpoint());
+  ASIO_CHECK(socket.is_open());
+  ASIO_CHECK(socket.remote_endpoint(ec) == result);
+}
+
+void test_all_fail()
+{
+  asio::io_context ioc;
+  asio::ip::tcp::socket socket(ioc);
+  std::vector<asio::ip::tcp::endpoint> endpoints;
+  asio::error_code ec;
+  asio::ip::tcp::endpoint result;
+
+  endpoints.push_back(refusing_endpoint(ioc));
+  endpoints.push_back(refusing_endpoint(ioc));
+
+  asio::async_race_connect(socket, endpoints,
+      asio::chrono::milliseconds(1),
+      bindns::bind(connect_handler, _1, _2, &ec, &result));
+
+  ioc.restart();
+  ioc.run();
+
+  ASIO_CHECK(ec == asio::error::connection_refused);
+  ASIO_CHECK(result == asio::ip::tcp::endpoint());
+  ASIO_CHECK(!socket.is_open());
+}
+
+void test_cancel()
+{
+  asio::io_context ioc;
+  asio::ip::tcp::acceptor acceptor(ioc,
+      asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  asio::ip::tcp::socket socket(ioc);
+  std::vector<asio::ip::tcp::endpoint> endpoints;
+  asio::cancellation_signal cancel_signal;
+  asio::error_code ec;
+  asio::ip::tcp::endpoint result;
+
+  endpoints.push_back(acceptor.local_endpoint());
+  endpoints.push_back(acceptor.local_endpoint());
+
+  asio::async_race_connect(socket, endpoints,
+      asio::bind_cancellation_slot(cancel_signal.slot(),
+        bindns::bind(connect_handler, _1, _2, &ec, &result)));
+
+  cancel_signal.emit(asio::cancellation_type::terminal);
+
+  ioc.restart();
+  ioc.run();
+
+  ASIO_CHECK(ec == asio::error::operation_aborted);
+  ASIO_CHECK(result == asio::ip::tcp::endpoint());
+  ASIO_CHECK(!socket.is_open());
+}
+
+#else // defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
+
+void test_interleave()
+{
+}
+
+void test_empty()
+{
+}
+
+void test_race()
+{
+}
+
+void test_all_fail()
+{
+}
+
+void test_cancel()
+{
+}
+
+#endif // defined(ASIO_HAS_MOVE) && defined(ASIO_HAS_CHRONO)
+
+ASIO_TEST_SUITE
+(
+  "race_connect",
+  ASIO_TEST_CASE(test_interleave)
+  ASIO_TEST_CASE(test_empty)
+  ASIO_TEST_CASE(test_race)
+  ASIO_TEST_CASE(test_all_fail)
+  ASIO_TEST_CASE(test_cancel)
+)
@@ -17,6 +17,8 @@
 #include "asio/read_until.hpp"
 
 #include <cstring>
+#include <string>
+#include <vector>
 #include "archetypes/async_result.hpp"
 #include "asio/io_context.hpp"
 #include "asio/post.hpp"
@@ -1640,6 +1642,78 @@ void test_streambuf_async_read_until_match_condition()
 #endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
 }
 
+// Reference implementation of the partial search performed by read_until.
+std::pair<std::size_t, bool> reference_partial_search(
+    const std::string& data, std::size_t start, const std::string& delim)
+{
+  for (std::size_t i = start; i < data.size(); ++i)
+  {
+    std::size_t n = 0;
+    while (n < delim.size() && i + n < data.size() && data[i + n] == delim[n])
+      ++n;
+    if (n == delim.size())
+      return std::make_pair(i, true);
+    if (i + n == data.size() && n > 0)
+      return std::make_pair(i, false);
+  }
+  return std::make_pair(data.size(), false);
+}
+
+void test_buffer_search()
+{
+  // Data with few distinct characters has many near matches.
+  std::string data;
+  unsigned int seed = 1;
+  for (int i = 0; i < 300; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    data += "ab\n"[(seed >> 16) % 3];
+  }
+  data += "aababab\n";
+
+  const char* delims[] = { "\n", "ab", "aab", "ab\na", "b\nb\nab",
+    "abababababababababab", "x" };
+
+  // Split the data into segments of varying size, including empty ones.
+  const std::size_t segment_sizes[] = { 0, 1, 5, 16, 2, 0, 31, 3, 64 };
+  const std::size_t num_sizes = sizeof(segment_sizes) / sizeof(std::size_t);
+  for (std::size_t first_size = 0; first_size < num_sizes; ++first_size)
+  {
+    std::vector<asio::const_buffer> buffers;
+    for (std::size_t offset = 0, i = first_size; offset < data.size(); ++i)
+    {
+      std::size_t size = segment_sizes[i % num_sizes];
+      if (size > data.size() - offset)
+        size = data.size() - offset;
+      buffers.push_back(asio::buffer(data.data() + offset, size));
+      offset += size;
+    }
+
+    for (std::size_t start = 0; start <= data.size(); start += 7)
+    {
+      std::size_t pos = asio::detail::buffer_find(buffers, start, '\n');
+      std::size_t expected = data.find('\n', start);
+      ASIO_CHECK(pos == (expected == std::string::npos
+            ? data.size() : expected));
+
+      for (std::size_t d = 0; d < sizeof(delims) / sizeof(delims[0]); ++d)
+      {
+        std::string delim(delims[d]);
+        std::pair<std::size_t, bool> result =
+          asio::detail::buffer_partial_search(
+              buffers, start, delim.data(), delim.length());
+        ASIO_CHECK(result == reference_partial_search(data, start, delim));
+      }
+    }
+
+    // A partial match at the end of the data.
+    std::pair<std::size_t, bool> result =
+      asio::detail::buffer_partial_search(buffers, 0, "\nZ", 2);
+    ASIO_CHECK(result.first == data.size() - 1);
+    ASIO_CHECK(!result.second);
+  }
+}
+
 ASIO_TEST_SUITE
 (
   "read_until",
@@ -1655,4 +1729,5 @@ ASIO_TEST_SUITE
   ASIO_TEST_CASE(test_streambuf_async_read_until_string)
   ASIO_TEST_CASE(test_dynamic_string_async_read_until_match_condition)
   ASIO_TEST_CASE(test_streambuf_async_read_until_match_condition)
+  ASIO_TEST_CASE(test_buffer_search)
 )
@@ -0,0 +1,301 @@
+//
+// relay.cpp
+// ~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/relay.hpp"
+
+#include <string>
+#include "asio/bind_cancellation_slot.hpp"
+#include "asio/cancellation_signal.hpp"
+#include "asio/io_context.hpp"
+#include "asio/ip/tcp.hpp"
+#include "asio/read.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_MOVE)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif // defined(ASIO_HAS_BOOST_BIND)
+using bindns::placeholders::_1;
+using bindns::placeholders::_2;
+using bindns::placeholders::_3;
+
+using asio::ip::tcp;
+
+// Wraps a socket so that the relay must copy the data through its buffers.
+class wrapped_stream
+{
+public:
+  typedef tcp::socket::executor_type executor_type;
+
+  explicit wrapped_stream(tcp::socket& socket)
+    : socket_(socket)
+  {
+  }
+
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return socket_.get_executor();
+  }
+
+  template <typename MutableBufferSequence, typename Handler>
+  void async_read_some(const MutableBufferSequence& buffers,
+      ASIO_MOVE_ARG(Handler) handler)
+  {
+    socket_.async_read_some(buffers, ASIO_MOVE_CAST(Handler)(handler));
+  }
+
+  template <typename ConstBufferSequence, typename Handler>
+  void async_write_some(const ConstBufferSequence& buffers,
+      ASIO_MOVE_ARG(Handler) handler)
+  {
+    socket_.async_write_some(buffers, ASIO_MOVE_CAST(Handler)(handler));
+  }
+
+private:
+  tcp::socket& socket_;
+};
+
+void connect_pair(tcp::acceptor& acceptor,
+    tcp::socket& client, tcp::socket& server)
+{
+  client.connect(acceptor.local_endpoint());
+  acceptor.accept(server);
+}
+
+std::string make_data(std::size_t n)
+{
+  std::string data(n, '\0');
+  for (std::size_t i = 0; i < n; ++i)
+    data[i] = static_cast<char>(i % 251);
+  return data;
+}
+
+void handle_write(const asio::error_code& ec,
+    std::size_t, tcp::socket* socket)
+{
+  ASIO_CHECK(!ec);
+  asio::error_code ignored_ec;
+  socket->shutdown(tcp::socket::shutdown_send, ignored_ec);
+}
+
+void handle_read(const asio::error_code& ec,
+    std::size_t, asio::error_code* out_ec)
+{
+  *out_ec = ec;
+}
+
+void handle_relay(const asio::error_code& ec,
+    asio::uint64_t a_to_b, asio::uint64_t b_to_a,
+    asio::error_code* out_ec, asio::uint64_t* out_a_to_b,
+    asio::uint64_t* out_b_to_a, int* count)
+{
+  *out_ec = ec;
+  *out_a_to_b = a_to_b;
+  *out_b_to_a = b_to_a;
+  ++*count;
+}
+
+void relay_test_sockets()
+{
+  asio::io_context ioc;
+  tcp::acceptor acceptor(ioc,
+      tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  tcp::socket c1(ioc), s1(ioc), s2(ioc), c2(ioc);
+  connect_pair(acceptor, c1, s1);
+  connect_pair(acceptor, c2, s2);
+  s2.native_non_blocking(true);
+
+  asio::error_code ec = asio::error::fault;
+  asio::uint64_t a_to_b = 0, b_to_a = 0;
+  int count = 0;
+
+  asio::async_relay(s1, s2,
+      bindns::bind(handle_relay, _1, _2, _3,
+        &ec, &a_to_b, &b_to_a, &count));
+
+  // Large enough to fill the socket buffers in one direction.
+  std::string up_data = make_data(1024 * 1024);
+  std::string down_data = make_data(1000);
+  std::string up_result, down_result;
+  asio::error_code up_ec, down_ec;
+
+  asio::async_write(c1, asio::buffer(up_data),
+      bindns::bind(handle_write, _1, _2, &c1));
+  asio::async_write(c2, asio::buffer(down_data),
+      bindns::bind(handle_write, _1, _2, &c2));
+  asio::async_read(c2, asio::dynamic_buffer(up_result),
+      bindns::bind(handle_read, _1, _2, &up_ec));
+  asio::async_read(c1, asio::dynamic_buffer(down_result),
+      bindns::bind(handle_read, _1, _2, &down_ec));
+
+  ioc.run();
+
+  // End of file is passed on in each direction.
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(a_to_b == up_data.size());
+  ASIO_CHECK(b_to_a == down_data.size());
+  ASIO_CHECK(up_ec == asio::error::eof);
+  ASIO_CHECK(up_result == up_data);
+  ASIO_CHECK(down_ec == asio::error::eof);
+  ASIO_CHECK(down_result == down_data);
+
+  // The sockets are returned in their original non-blocking modes.
+  ASIO_CHECK(!s1.native_non_blocking());
+  ASIO_CHECK(s2.native_non_blocking());
+}
+
+void relay_test_copy()
+{
+  asio::io_context ioc;
+  tcp::acceptor acceptor(ioc,
+      tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  tcp::socket c1(ioc), s1(ioc), s2(ioc), c2(ioc);
+  connect_pair(acceptor, c1, s1);
+  connect_pair(acceptor, c2, s2);
+
+  asio::chunk_pool pool(4096);
+  wrapped_stream w1(s1);
+  asio::error_code ec = asio::error::fault;
+  asio::uint64_t a_to_b = 0, b_to_a = 0;
+  int count = 0;
+
+  asio::async_relay(w1, s2, pool,
+      bindns::bind(handle_relay, _1, _2, _3,
+        &ec, &a_to_b, &b_to_a, &count));
+
+  std::string up_data = make_data(1024 * 1024);
+  std::string down_data = make_data(100000);
+  std::string up_result, down_result(down_data.size(), '\0');
+  asio::error_code up_ec, down_ec;
+
+  asio::async_write(c1, asio::buffer(up_data),
+      bindns::bind(handle_write, _1, _2, &c1));
+  asio::async_write(c2, asio::buffer(down_data),
+      bindns::bind(handle_write, _1, _2, &c2));
+  asio::async_read(c2, asio::dynamic_buffer(up_result),
+      bindns::bind(handle_read, _1, _2, &up_ec));
+
+  // The wrapped stream cannot be shut down, so the data sent to it is not
+  // followed by end of file.
+  asio::async_read(c1, asio::buffer(down_result),
+      bindns::bind(handle_read, _1, _2, &down_ec));
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(a_to_b == up_data.size());
+  ASIO_CHECK(b_to_a == down_data.size());
+  ASIO_CHECK(up_ec == asio::error::eof);
+  ASIO_CHECK(up_result == up_data);
+  ASIO_CHECK(!down_ec);
+  ASIO_CHECK(down_result == down_data);
+
+  // The buffers are returned to the pool.
+  ASIO_CHECK(pool.cached_chunks() > 0);
+}
+
+void relay_test_cancel()
+{
+  asio::io_context ioc;
+  tcp::acceptor acceptor(ioc,
+      tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  tcp::socket c1(ioc), s1(ioc), s2(ioc), c2(ioc);
+  connect_pair(acceptor, c1, s1);
+  connect_pair(acceptor, c2, s2);
+
+  asio::cancellation_signal cancel_signal;
+  asio::error_code ec;
+  asio::uint64_t a_to_b = 1, b_to_a = 1;
+  int count = 0;
+
+  asio::async_relay(s1, s2,
+      asio::bind_cancellation_slot(cancel_signal.slot(),
+        bindns::bind(handle_relay, _1, _2, _3,
+          &ec, &a_to_b, &b_to_a, &count)));
+
+  ioc.poll();
+  ASIO_CHECK(count == 0);
+
+  cancel_signal.emit(asio::cancellation_type::terminal);
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(ec == asio::error::operation_aborted);
+  ASIO_CHECK(a_to_b == 0);
+  ASIO_CHECK(b_to_a == 0);
+}
+
+void relay_test_error()
+{
+  asio::io_context ioc;
+  tcp::acceptor acceptor(ioc,
+      tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  tcp::socket c1(ioc), s1(ioc), s2(ioc), c2(ioc);
+  connect_pair(acceptor, c1, s1);
+  connect_pair(acceptor, c2, s2);
+
+  asio::chunk_pool pool;
+  wrapped_stream w1(s1);
+  asio::error_code ec;
+  asio::uint64_t a_to_b = 1, b_to_a = 1;
+  int count = 0;
+
+  // A failure in one direction cancels the other.
+  s2.close();
+
+  asio::async_relay(w1, s2, pool,
+      bindns::bind(handle_relay, _1, _2, _3,
+        &ec, &a_to_b, &b_to_a, &count));
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(ec == asio::error::bad_descriptor);
+  ASIO_CHECK(a_to_b == 0);
+  ASIO_CHECK(b_to_a == 0);
+}
+
+ASIO_TEST_SUITE
+(
+  "relay",
+  ASIO_TEST_CASE(relay_test_sockets)
+  ASIO_TEST_CASE(relay_test_copy)
+  ASIO_TEST_CASE(relay_test_cancel)
+  ASIO_TEST_CASE(relay_test_error)
+)
+
+#else // defined(ASIO_HAS_MOVE)
+
+ASIO_TEST_SUITE
+(
+  "relay",
+  ASIO_TEST_CASE(null_test)
+)
+
+#endif // defined(ASIO_HAS_MOVE)
@@ -0,0 +1,81 @@
+//
+// run_threads.cpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/run_threads.hpp"
+
+#include "asio/detail/atomic_count.hpp"
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+using namespace asio;
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+void increment(asio::detail::atomic_count* count)
+{
+  ++(*count);
+}
+
+void run_threads_test()
+{
+#if defined(ASIO_HAS_THREADS)
+  io_context ioc;
+
+  asio::detail::atomic_count count(0);
+  for (int i = 0; i < 100; ++i)
+    asio::post(ioc, bindns::bind(increment, &count));
+
+  asio::run_threads(ioc, 4);
+
+  ASIO_CHECK(count == 100);
+  ASIO_CHECK(ioc.stopped());
+#endif // defined(ASIO_HAS_THREADS)
+}
+
+void run_threads_affinity_test()
+{
+#if defined(ASIO_HAS_THREADS)
+  io_context ioc;
+
+  asio::detail::atomic_count count(0);
+  for (int i = 0; i < 100; ++i)
+    asio::post(ioc, bindns::bind(increment, &count));
+
+  std::vector<unsigned int> cpus;
+  cpus.push_back(0);
+  asio::run_threads(ioc, 2, thread_affinity::cpu_set(cpus));
+
+  ASIO_CHECK(count == 100);
+#endif // defined(ASIO_HAS_THREADS)
+}
+
+ASIO_TEST_SUITE
+(
+  "run_threads",
+  ASIO_TEST_CASE(run_threads_test)
+  ASIO_TEST_CASE(run_threads_affinity_test)
+)
@@ -0,0 +1,94 @@
+//
+// shared_const_buffer.cpp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/shared_const_buffer.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "unit_test.hpp"
+
+void shared_const_buffer_test_construct()
+{
+  asio::shared_const_buffer b1;
+  ASIO_CHECK(b1.size() == 0);
+  ASIO_CHECK(b1.use_count() == 0);
+  ASIO_CHECK(asio::buffer_size(b1) == 0);
+
+  const char data[] = "hello, world";
+  asio::shared_const_buffer b2(data, sizeof(data) - 1);
+  ASIO_CHECK(b2.size() == sizeof(data) - 1);
+  ASIO_CHECK(b2.data() != data);
+  ASIO_CHECK(std::memcmp(b2.data(), data, sizeof(data) - 1) == 0);
+  ASIO_CHECK(b2.use_count() == 1);
+
+  // The data in a buffer sequence is gathered into a single buffer.
+  std::string s1 = "hello, ";
+  std::string s2 = "world";
+  std::vector<asio::const_buffer> buffers;
+  buffers.push_back(asio::buffer(s1));
+  buffers.push_back(asio::buffer(s2));
+  asio::shared_const_buffer b3(buffers);
+  ASIO_CHECK(b3.size() == s1.size() + s2.size());
+  ASIO_CHECK(std::memcmp(b3.data(), data, sizeof(data) - 1) == 0);
+  ASIO_CHECK(b3.end() - b3.begin() == 1);
+  ASIO_CHECK(asio::buffer_size(b3) == b3.size());
+
+  asio::shared_const_buffer b4(asio::buffer(s1, 0));
+  ASIO_CHECK(b4.size() == 0);
+  ASIO_CHECK(b4.use_count() == 0);
+}
+
+void shared_const_buffer_test_copy()
+{
+  std::string s = "hello";
+  asio::shared_const_buffer b1(asio::buffer(s));
+  ASIO_CHECK(b1.use_count() == 1);
+
+  {
+    asio::shared_const_buffer b2(b1);
+    ASIO_CHECK(b1.use_count() == 2);
+    ASIO_CHECK(b2.data() == b1.data());
+    ASIO_CHECK(b2.size() == b1.size());
+
+    asio::shared_const_buffer b3;
+    b3 = b2;
+    ASIO_CHECK(b1.use_count() == 3);
+    ASIO_CHECK(b3.data() == b1.data());
+  }
+
+  ASIO_CHECK(b1.use_count() == 1);
+
+  // Copying the buffer sequence does not copy the data.
+  std::vector<asio::shared_const_buffer> copies(10, b1);
+  ASIO_CHECK(b1.use_count() == 11);
+  ASIO_CHECK(copies[9].data() == b1.data());
+  copies.clear();
+  ASIO_CHECK(b1.use_count() == 1);
+
+  // A moved-from object still refers to the data.
+  asio::shared_const_buffer b4(ASIO_MOVE_CAST(asio::shared_const_buffer)(b1));
+  ASIO_CHECK(b1.use_count() == 2);
+  ASIO_CHECK(b1.data() == b4.data());
+  ASIO_CHECK(b1.size() == s.size());
+}
+
+ASIO_TEST_SUITE
+(
+  "shared_const_buffer",
+  ASIO_TEST_CASE(shared_const_buffer_test_construct)
+  ASIO_TEST_CASE(shared_const_buffer_test_copy)
+)
@@ -0,0 +1,104 @@
+//
+// thread_affinity.cpp
+// ~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/thread_affinity.hpp"
+
+#include "asio/error.hpp"
+#include "asio/post.hpp"
+#include "asio/thread_pool.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+using namespace asio;
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+void thread_affinity_test()
+{
+  thread_affinity none;
+  ASIO_CHECK(none.empty());
+
+  asio::error_code ec;
+  none.apply(0, ec);
+  ASIO_CHECK(!ec);
+
+  std::vector<unsigned int> cpus;
+  cpus.push_back(0);
+  cpus.push_back(1);
+
+  thread_affinity pinned = thread_affinity::per_thread(cpus);
+  ASIO_CHECK(!pinned.empty());
+  ASIO_CHECK(pinned.cpus() == cpus);
+
+  thread_affinity set = thread_affinity::cpu_set(cpus);
+  ASIO_CHECK(!set.empty());
+  ASIO_CHECK(set.cpus() == cpus);
+
+  std::vector<unsigned int> bad_cpus;
+  bad_cpus.push_back(1000000);
+  thread_affinity bad = thread_affinity::per_thread(bad_cpus);
+  bad.apply(0, ec);
+  ASIO_CHECK(!!ec);
+
+  thread_affinity no_node = thread_affinity::numa_node(1000000, ec);
+  ASIO_CHECK(!!ec);
+  ASIO_CHECK(no_node.empty());
+
+#if defined(ASIO_HAS_THREAD_AFFINITY) && defined(__linux__)
+  // Node 0 exists on every NUMA-capable Linux system.
+  thread_affinity node = thread_affinity::numa_node(0, ec);
+  if (!ec)
+    ASIO_CHECK(!node.empty());
+#endif // defined(ASIO_HAS_THREAD_AFFINITY) && defined(__linux__)
+}
+
+void increment(int* count)
+{
+  ++(*count);
+}
+
+void thread_pool_affinity_test()
+{
+  std::vector<unsigned int> cpus;
+  cpus.push_back(0);
+
+  // The pool's threads run whether or not the affinity could be applied.
+  thread_pool pool(2, thread_affinity::per_thread(cpus));
+
+  int count = 0;
+  for (int i = 0; i < 10; ++i)
+    asio::post(pool, bindns::bind(increment, &count));
+
+  pool.join();
+
+  ASIO_CHECK(count == 10);
+}
+
+ASIO_TEST_SUITE
+(
+  "thread_affinity",
+  ASIO_TEST_CASE(thread_affinity_test)
+  ASIO_TEST_CASE(thread_pool_affinity_test)
+)
@@ -16,9 +16,13 @@
 // Test that header file is self-contained.
 #include "asio/thread_pool.hpp"
 
+#include "asio/detail/chrono.hpp"
+#include "asio/detail/event.hpp"
+#include "asio/detail/mutex.hpp"
 #include "asio/dispatch.hpp"
 #include "asio/post.hpp"
 #include "unit_test.hpp"
+#include <vector>
 
 #if defined(ASIO_HAS_BOOST_BIND)
 # include <boost/bind/bind.hpp>
@@ -39,6 +43,11 @@ void increment(int* count)
   ++(*count);
 }
 
+void mark_index(std::vector<int>* marks, std::size_t i)
+{
+  ++(*marks)[i];
+}
+
 void decrement_to_zero(thread_pool* pool, int* count)
 {
   if (*count > 0)
@@ -514,6 +523,135 @@ void thread_pool_executor_bulk_execute_test()
   ASIO_CHECK(count == 20);
 }
 
+void thread_pool_executor_bulk_execute_range_test()
+{
+  using bindns::placeholders::_1;
+
+  thread_pool pool(4);
+
+  std::vector<int> marks(10000);
+  pool.executor().bulk_execute(
+      bindns::bind(mark_index, &marks, _1), marks.size());
+
+  std::vector<int> small_marks(3);
+  pool.executor().bulk_execute(
+      bindns::bind(mark_index, &small_marks, _1), small_marks.size());
+
+  pool.executor().bulk_execute(
+      bindns::bind(mark_index, &small_marks, _1), 0);
+
+  pool.wait();
+
+  for (std::size_t i = 0; i < marks.size(); ++i)
+    ASIO_CHECK(marks[i] == 1);
+  for (std::size_t i = 0; i < small_marks.size(); ++i)
+    ASIO_CHECK(small_marks[i] == 1);
+}
+
+struct blocking_latch
+{
+  asio::detail::mutex mutex_;
+  asio::detail::event event_;
+};
+
+void wait_latch(blocking_latch* latch, int* count)
+{
+  asio::detail::mutex::scoped_lock lock(latch->mutex_);
+  latch->event_.wait(lock);
+  ++(*count);
+}
+
+void open_latch(blocking_latch* latch)
+{
+  asio::detail::mutex::scoped_lock lock(latch->mutex_);
+  latch->event_.signal_all(lock);
+}
+
+void thread_pool_elastic_test()
+{
+#if defined(ASIO_HAS_THREADS)
+  thread_pool::elastic_options options;
+  options.min_threads = 1;
+  options.max_threads = 4;
+  options.grow_threshold_usec = 1000;
+
+  thread_pool pool(options);
+
+  thread_pool::scaling_statistics stats = pool.get_scaling_statistics();
+  ASIO_CHECK(stats.threads == 1);
+  ASIO_CHECK(stats.threads_started == 1);
+
+  // The first function blocks the only thread until the second function runs,
+  // so the second function can only run on a thread added by the pool.
+  blocking_latch latch;
+  int count = 0;
+  asio::post(pool, bindns::bind(wait_latch, &latch, &count));
+  asio::post(pool, bindns::bind(open_latch, &latch));
+
+  pool.wait();
+
+  ASIO_CHECK(count == 1);
+
+  stats = pool.get_scaling_statistics();
+  ASIO_CHECK(stats.threads == 0);
+  ASIO_CHECK(stats.peak_threads >= 2);
+  ASIO_CHECK(stats.peak_threads <= 4);
+  ASIO_CHECK(stats.threads_started >= 2);
+  ASIO_CHECK(stats.probes_delayed >= 1);
+
+  thread_pool fixed_pool(3);
+  stats = fixed_pool.get_scaling_statistics();
+  ASIO_CHECK(stats.threads == 3);
+  ASIO_CHECK(stats.peak_threads == 3);
+  ASIO_CHECK(stats.threads_retired == 0);
+#endif // defined(ASIO_HAS_THREADS)
+}
+
+void thread_pool_elastic_join_test()
+{
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_CHRONO)
+  typedef asio::chrono::steady_clock clock;
+
+  // The monitor's interval is far longer than the test, so joining must wake
+  // it rather than wait for the interval to pass.
+  thread_pool::elastic_options options;
+  options.grow_threshold_usec = 10000000;
+
+  clock::time_point start = clock::now();
+  {
+    thread_pool pool(options);
+    int count = 0;
+    asio::post(pool, bindns::bind(increment, &count));
+    pool.join();
+    ASIO_CHECK(count == 1);
+  }
+  ASIO_CHECK(clock::now() - start < asio::chrono::seconds(5));
+
+  start = clock::now();
+  {
+    thread_pool pool(options);
+    pool.stop();
+    pool.join();
+  }
+  ASIO_CHECK(clock::now() - start < asio::chrono::seconds(5));
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_CHRONO)
+}
+
+void thread_pool_affinity_test()
+{
+#if defined(ASIO_HAS_THREADS)
+  thread_pool pool(2, thread_affinity());
+  thread_pool::scaling_statistics stats = pool.get_scaling_statistics();
+  ASIO_CHECK(stats.threads == 2);
+
+  int count = 0;
+  asio::post(pool, bindns::bind(increment, &count));
+  asio::post(pool, bindns::bind(increment, &count));
+  pool.wait();
+  ASIO_CHECK(count == 2);
+#endif // defined(ASIO_HAS_THREADS)
+}
+
 ASIO_TEST_SUITE
 (
   "thread_pool",
@@ -522,5 +660,9 @@ ASIO_TEST_SUITE
   ASIO_TEST_CASE(thread_pool_executor_query_test)
   ASIO_TEST_CASE(thread_pool_executor_execute_test)
   ASIO_TEST_CASE(thread_pool_executor_bulk_execute_test)
+  ASIO_TEST_CASE(thread_pool_executor_bulk_execute_range_test)
   ASIO_TEST_CASE(thread_pool_scheduler_test)
+  ASIO_TEST_CASE(thread_pool_elastic_test)
+  ASIO_TEST_CASE(thread_pool_elastic_join_test)
+  ASIO_TEST_CASE(thread_pool_affinity_test)
 )
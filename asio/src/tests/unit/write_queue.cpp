@@ -0,0 +1,462 @@
+//
+// write_queue.cpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2022 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/write_queue.hpp"
+
+#include <iterator>
+#include <string>
+#include <vector>
+#include "asio/bind_cancellation_slot.hpp"
+#include "asio/cancellation_signal.hpp"
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_CHRONO)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif // defined(ASIO_HAS_BOOST_BIND)
+using bindns::placeholders::_1;
+
+// A stream that records each write, and can be made to fail after a given
+// number of bytes.
+class test_stream
+{
+public:
+  typedef asio::io_context::executor_type executor_type;
+
+  explicit test_stream(asio::io_context& io_context)
+    : io_context_(io_context),
+      limit_(std::string::npos)
+  {
+  }
+
+  executor_type get_executor() ASIO_NOEXCEPT
+  {
+    return io_context_.get_executor();
+  }
+
+  void fail_after(std::size_t n)
+  {
+    limit_ = n;
+  }
+
+  const std::string& written() const
+  {
+    return written_;
+  }
+
+  // The number of buffers passed to each call to write_some.
+  const std::vector<std::size_t>& writes() const
+  {
+    return writes_;
+  }
+
+  template <typename ConstBufferSequence>
+  std::size_t write_some(const ConstBufferSequence& buffers,
+      asio::error_code& ec)
+  {
+    writes_.push_back(std::distance(asio::buffer_sequence_begin(buffers),
+          asio::buffer_sequence_end(buffers)));
+
+    if (written_.size() >= limit_)
+    {
+      ec = asio::error::broken_pipe;
+      return 0;
+    }
+
+    std::string data(asio::buffer_size(buffers), '\0');
+    asio::buffer_copy(asio::buffer(data), buffers);
+    std::size_t n = data.size() < limit_ - written_.size()
+      ? data.size() : limit_ - written_.size();
+    written_.append(data, 0, n);
+    ec = asio::error_code();
+    return n;
+  }
+
+  template <typename ConstBufferSequence, typename Handler>
+  void async_write_some(const ConstBufferSequence& buffers, Handler handler)
+  {
+    asio::error_code ec;
+    std::size_t n = write_some(buffers, ec);
+    asio::post(get_executor(), asio::detail::bind_handler(handler, ec, n));
+  }
+
+private:
+  asio::io_context& io_context_;
+  std::size_t limit_;
+  std::string written_;
+  std::vector<std::size_t> writes_;
+};
+
+typedef asio::write_queue<test_stream> queue_type;
+
+void handle_wait(const asio::error_code& ec, asio::error_code* result,
+    int* count)
+{
+  *result = ec;
+  ++*count;
+}
+
+void handle_push(const asio::error_code& ec, queue_type* queue,
+    std::size_t* pending)
+{
+  ASIO_CHECK(!ec);
+  *pending = queue->pending_bytes();
+}
+
+void write_queue_test_coalesce()
+{
+  asio::io_context ioc;
+  test_stream s(ioc);
+  queue_type queue(s);
+
+  std::string expected;
+  for (int i = 0; i < 10; ++i)
+  {
+    std::string message(i + 1, static_cast<char>('a' + i));
+    queue.push(asio::buffer(message));
+    expected += message;
+  }
+
+  // The first message is written as soon as it is queued. The others are
+  // gathered into a single write while the first is in progress.
+  ASIO_CHECK(queue.pending_messages() == 10);
+  ASIO_CHECK(queue.pending_bytes() == expected.size());
+
+  ioc.run();
+
+  ASIO_CHECK(s.written() == expected);
+  ASIO_CHECK(s.writes().size() == 2);
+  ASIO_CHECK(s.writes()[0] == 1);
+  ASIO_CHECK(s.writes()[1] == 9);
+  ASIO_CHECK(queue.pending_messages() == 0);
+  ASIO_CHECK(queue.pending_bytes() == 0);
+}
+
+void write_queue_test_max_buffers()
+{
+  asio::io_context ioc;
+  test_stream s(ioc);
+  queue_type queue(s);
+
+  queue.set_max_buffers(4);
+  ASIO_CHECK(queue.max_buffers() == 4);
+
+  std::string expected;
+  for (int i = 0; i < 10; ++i)
+  {
+    std::string message(3, static_cast<char>('0' + i));
+    queue.push(asio::buffer(message));
+    expected += message;
+  }
+
+  ioc.run();
+
+  ASIO_CHECK(s.written() == expected);
+  ASIO_CHECK(s.writes().size() == 4);
+  ASIO_CHECK(s.writes()[0] == 1);
+  ASIO_CHECK(s.writes()[1] == 4);
+  ASIO_CHECK(s.writes()[2] == 4);
+  ASIO_CHECK(s.writes()[3] == 1);
+
+  queue.set_max_buffers(0);
+  ASIO_CHECK(queue.max_buffers() == 1);
+}
+
+void write_queue_test_batch_delay()
+{
+  asio::io_context ioc;
+  test_stream s(ioc);
+  queue_type queue(s);
+
+  queue.set_batch_delay(asio::chrono::milliseconds(10));
+
+  std::string expected;
+  for (int i = 0; i < 10; ++i)
+  {
+    std::string message(2, static_cast<char>('a' + i));
+    queue.push(asio::buffer(message));
+    expected += message;
+  }
+
+  ioc.run();
+
+  ASIO_CHECK(s.written() == expected);
+  ASIO_CHECK(s.writes().size() == 1);
+  ASIO_CHECK(s.writes()[0] == 10);
+
+  // A full batch is written without waiting for the delay to expire.
+  asio::io_context ioc2;
+  test_stream s2(ioc2);
+  queue_type queue2(s2);
+
+  queue2.set_batch_delay(asio::chrono::hours(1));
+  queue2.set_max_buffers(4);
+
+  for (int i = 0; i < 8; ++i)
+    queue2.push(asio::buffer("xy", 2));
+
+  asio::chrono::steady_clock::time_point start
+    = asio::chrono::steady_clock::now();
+  ioc2.run();
+
+  ASIO_CHECK(asio::chrono::steady_clock::now() - start
+      < asio::chrono::minutes(1));
+  ASIO_CHECK(s2.written().size() == 16);
+  ASIO_CHECK(s2.writes().size() == 2);
+  ASIO_CHECK(s2.writes()[0] == 4);
+  ASIO_CHECK(s2.writes()[1] == 4);
+}
+
+void write_queue_test_backpressure()
+{
+  asio::io_context ioc;
+  test_stream s(ioc);
+  queue_type queue(s);
+
+  queue.set_max_pending_bytes(10);
+  ASIO_CHECK(queue.max_pending_bytes() == 10);
+
+  std::size_t pending[4] = { 100, 100, 100, 100 };
+  std::string expected;
+  for (int i = 0; i < 4; ++i)
+  {
+    std::string message(8, static_cast<char>('a' + i));
+    queue.async_push(asio::buffer(message),
+        bindns::bind(handle_push, _1, &queue, &pending[i]));
+    expected += message;
+  }
+
+  // All of the messages are queued immediately.
+  ASIO_CHECK(queue.pending_bytes() == 32);
+
+  ioc.run();
+
+  // The first message fits within the limit, so its producer resumes at
+  // once. The others resume only after the queue has drained below the limit.
+  ASIO_CHECK(pending[0] != 100);
+  for (int i = 1; i < 4; ++i)
+    ASIO_CHECK(pending[i] <= 10);
+  ASIO_CHECK(s.written() == expected);
+  ASIO_CHECK(queue.pending_bytes() == 0);
+}
+
+void write_queue_test_flush()
+{
+  asio::io_context ioc;
+  test_stream s(ioc);
+  queue_type queue(s);
+
+  asio::error_code result = asio::error::fault;
+  int count = 0;
+
+  queue.async_flush(bindns::bind(handle_wait, _1, &result, &count));
+  ioc.poll();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(!result);
+
+  ioc.restart();
+  for (int i = 0; i < 5; ++i)
+    queue.push(asio::buffer("hello", 5));
+
+  result = asio::error::fault;
+  count = 0;
+  queue.async_flush(bindns::bind(handle_wait, _1, &result, &count));
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(!result);
+  ASIO_CHECK(s.written().size() == 25);
+  ASIO_CHECK(queue.pending_bytes() == 0);
+}
+
+void write_queue_test_error()
+{
+  asio::io_context ioc;
+  test_stream s(ioc);
+  queue_type queue(s);
+
+  s.fail_after(12);
+
+  for (int i = 0; i < 5; ++i)
+    queue.push(asio::buffer("hello", 5));
+
+  asio::error_code result;
+  int count = 0;
+  queue.async_flush(bindns::bind(handle_wait, _1, &result, &count));
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(result == asio::error::broken_pipe);
+  ASIO_CHECK(queue.error() == asio::error::broken_pipe);
+  ASIO_CHECK(queue.pending_messages() == 0);
+  ASIO_CHECK(queue.pending_bytes() == 0);
+  ASIO_CHECK(s.written().size() == 12);
+
+  // Once the queue has failed, new messages are discarded and operations
+  // complete with the error.
+  ioc.restart();
+  result = asio::error_code();
+  count = 0;
+  queue.async_push(asio::buffer("hello", 5),
+      bindns::bind(handle_wait, _1, &result, &count));
+
+  ioc.run();
+
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(result == asio::error::broken_pipe);
+  ASIO_CHECK(queue.pending_messages() == 0);
+  ASIO_CHECK(s.written().size() == 12);
+}
+
+void write_queue_test_cancel()
+{
+  asio::io_context ioc;
+  test_stream s(ioc);
+  queue_type queue(s);
+
+  queue.set_max_pending_bytes(0);
+
+  asio::error_code result1, result2;
+  int count1 = 0, count2 = 0;
+  queue.async_push(asio::buffer("hello", 5),
+      bindns::bind(handle_wait, _1, &result1, &count1));
+  queue.async_flush(bindns::bind(handle_wait, _1, &result2, &count2));
+
+  queue.cancel();
+  ioc.run();
+
+  // Cancellation ends the waits, but the message is still written.
+  ASIO_CHECK(count1 == 1);
+  ASIO_CHECK(result1 == asio::error::operation_aborted);
+  ASIO_CHECK(count2 == 1);
+  ASIO_CHECK(result2 == asio::error::operation_aborted);
+  ASIO_CHECK(s.written() == "hello");
+
+  // Operations started after the cancellation are unaffected.
+  ioc.restart();
+  result1 = asio::error::fault;
+  count1 = 0;
+  queue.async_push(asio::buffer("world", 5),
+      bindns::bind(handle_wait, _1, &result1, &count1));
+
+  ioc.run();
+
+  ASIO_CHECK(count1 == 1);
+  ASIO_CHECK(!result1);
+  ASIO_CHECK(s.written() == "helloworld");
+}
+
+void write_queue_test_per_operation_cancel()
+{
+  asio::io_context ioc;
+  test_stream s(ioc);
+  queue_type queue(s);
+
+  queue.set_max_pending_bytes(0);
+
+  asio::cancellation_signal signal;
+  asio::error_code result1, result2;
+  int count1 = 0, count2 = 0;
+  queue.async_push(asio::buffer("hello", 5),
+      asio::bind_cancellation_slot(signal.slot(),
+        bindns::bind(handle_wait, _1, &result1, &count1)));
+  queue.async_flush(bindns::bind(handle_wait, _1, &result2, &count2));
+
+  signal.emit(asio::cancellation_type::partial);
+  ioc.run();
+
+  // Only the operation bound to the signal is cancelled.
+  ASIO_CHECK(count1 == 1);
+  ASIO_CHECK(result1 == asio::error::operation_aborted);
+  ASIO_CHECK(count2 == 1);
+  ASIO_CHECK(!result2);
+  ASIO_CHECK(s.written() == "hello");
+}
+
+void write_queue_test_destroy()
+{
+  asio::io_context ioc;
+  test_stream s(ioc);
+  queue_type* queue = new queue_type(s);
+
+  // The first message is being written, and the second waits for it.
+  asio::error_code result = asio::error::fault;
+  int count = 0;
+  queue->push(asio::buffer("hello", 5));
+  queue->push(asio::buffer("world", 5));
+  queue->async_flush(bindns::bind(handle_wait, _1, &result, &count));
+  delete queue;
+
+  ioc.run();
+
+  // The write in progress completes, but no further messages are written.
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(result == asio::error::operation_aborted);
+  ASIO_CHECK(s.written() == "hello");
+
+  // A queue that is waiting for a batch to accumulate.
+  queue = new queue_type(s);
+  queue->set_batch_delay(asio::chrono::hours(1));
+  queue->push(asio::buffer("more", 4));
+  delete queue;
+
+  asio::chrono::steady_clock::time_point start
+    = asio::chrono::steady_clock::now();
+  ioc.restart();
+  ioc.run();
+
+  ASIO_CHECK(asio::chrono::steady_clock::now() - start
+      < asio::chrono::minutes(1));
+  ASIO_CHECK(s.written() == "hello");
+}
+
+ASIO_TEST_SUITE
+(
+  "write_queue",
+  ASIO_TEST_CASE(write_queue_test_coalesce)
+  ASIO_TEST_CASE(write_queue_test_max_buffers)
+  ASIO_TEST_CASE(write_queue_test_batch_delay)
+  ASIO_TEST_CASE(write_queue_test_backpressure)
+  ASIO_TEST_CASE(write_queue_test_flush)
+  ASIO_TEST_CASE(write_queue_test_error)
+  ASIO_TEST_CASE(write_queue_test_cancel)
+  ASIO_TEST_CASE(write_queue_test_per_operation_cancel)
+  ASIO_TEST_CASE(write_queue_test_destroy)
+)
+
+#else // defined(ASIO_HAS_CHRONO)
+
+ASIO_TEST_SUITE
+(
+  "write_queue",
+  ASIO_TEST_CASE(null_test)
+)
+
+#endif // defined(ASIO_HAS_CHRONO)